@@ -1,3 +1,9 @@
 D:\APP\Vulkan\Bin\glslc.exe D:\OpenglGit\GwVulkan\Res\vertFrag\shader.vert -o D:\OpenglGit\GwVulkan\Res\spv\vert.spv
 
 D:\APP\Vulkan\Bin\glslc.exe D:\OpenglGit\GwVulkan\Res\vertFrag\shader.frag -o D:\OpenglGit\GwVulkan\Res\spv\frag.spv
+
+D:\APP\Vulkan\Bin\glslc.exe D:\OpenglGit\GwVulkan\Res\vertFrag\instanced.vert -o D:\OpenglGit\GwVulkan\Res\spv\vert_instanced.spv
+
+D:\APP\Vulkan\Bin\glslc.exe D:\OpenglGit\GwVulkan\Res\vertFrag\cull.comp -o D:\OpenglGit\GwVulkan\Res\spv\comp_cull.spv
+
+D:\APP\Vulkan\Bin\glslc.exe D:\OpenglGit\GwVulkan\Res\vertFrag\simulate.comp -o D:\OpenglGit\GwVulkan\Res\spv\comp_simulate.spv
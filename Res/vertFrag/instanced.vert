@@ -0,0 +1,23 @@
+#version 450
+
+layout(location = 0) in vec2 inPosition;
+layout(location = 1) in vec3 inColor;
+
+// per-instance: xy = offset, z = scale, w = rotation (radians)
+layout(location = 2) in vec4 inTransform;
+layout(location = 3) in vec4 inInstanceColor;
+
+layout(location = 0) out vec3 fragColor;
+
+layout(set = 0, binding = 0) uniform SceneUniforms {
+    vec4 tint;
+} scene;
+
+void main() {
+    float s = sin(inTransform.w);
+    float c = cos(inTransform.w);
+    vec2 p = inPosition * inTransform.z;
+    p = vec2(c * p.x - s * p.y, s * p.x + c * p.y) + inTransform.xy;
+    gl_Position = vec4(p, 0.0, 1.0);
+    fragColor = inColor * inInstanceColor.rgb * scene.tint.rgb;
+}
\ No newline at end of file
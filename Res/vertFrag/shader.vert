@@ -5,7 +5,11 @@ layout(location = 1) in vec3 inColor;
 
 layout(location = 0) out vec3 fragColor;
 
+layout(set = 0, binding = 0) uniform SceneUniforms {
+    vec4 tint;
+} scene;
+
 void main() {
     gl_Position = vec4(inPosition, 0.0, 1.0);
-    fragColor = inColor;
+    fragColor = inColor * scene.tint.rgb;
 }
\ No newline at end of file
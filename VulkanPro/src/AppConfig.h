@@ -0,0 +1,256 @@
+﻿#ifndef APPCONFIG_H_
+#define APPCONFIG_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 程序运行配置，由命令行参数填充后传给 TriangleFunc。
+ *
+ * 默认值对应原有的窗口模式；无头（headless）模式用于 CI / 渲染农场上的吞吐量基准测试。
+ */
+struct AppConfig {
+	/**
+	 * @brief 允许配置的最大 Frames in Flight 数量。
+	 */
+	static constexpr int kMaxFramesInFlight = 4;
+
+	/**
+	 * @brief 渲染图模糊链允许配置的最大降采样级数。
+	 */
+	static constexpr int kMaxBlurLevels = 8;
+
+	/**
+	 * @brief 是否以无头模式运行（不创建窗口、Surface 与交换链，渲染到离屏图像）。
+	 */
+	bool headless = false;
+
+	/**
+	 * @brief 窗口或离屏渲染目标的宽高（像素）。
+	 */
+	uint32_t width = 800;
+	uint32_t height = 600;
+
+	/**
+	 * @brief 同时在 GPU 上执行的最大帧数（Frames in Flight），取值 1 ~ kMaxFramesInFlight。
+	 *
+	 * 越小输入延迟越低，越大 CPU 与 GPU 越不容易互相等待。无头模式下离屏渲染目标的数量与之相同。
+	 */
+	int framesInFlight = 2;
+
+	/**
+	 * @brief 期望的交换链图像数量，0 表示使用驱动最小值 + 1。
+	 *
+	 * 实际数量会被限制在 Surface 支持的范围内。
+	 */
+	uint32_t swapchainImages = 0;
+
+	/**
+	 * @brief 无头模式运行的帧数，0 表示不按帧数限制。
+	 */
+	uint32_t benchFrames = 0;
+
+	/**
+	 * @brief 无头模式运行的秒数，0 表示不按时间限制。
+	 *
+	 * 帧数与秒数都为 0 时默认运行 1000 帧。
+	 */
+	double benchSeconds = 0.0;
+
+	/**
+	 * @brief 基准测试报告输出文件，为空时只打印到标准输出。
+	 *
+	 * 窗口模式下指定该项时同样会记录帧耗时，并在退出时写入报告。
+	 */
+	std::string reportPath;
+
+	/**
+	 * @brief 基准测试名称，为空时只测量默认场景。除 resize-storm 与 idle 外都在无头模式下运行。
+	 *
+	 * - "vertex-memory"：对比同一网格放在 HOST_VISIBLE 与 DEVICE_LOCAL 内存中的绘制吞吐量。
+	 * - "allocator-stress"：反复创建、销毁数万个缓冲与图像，输出显存分配器的耗时与碎片统计。
+	 * - "frames-in-flight"：依次以 1 ~ kMaxFramesInFlight 帧并发运行，对比吞吐量与 CPU 阻塞时间。
+	 * - "parallel-record"：数千次绘制的场景下，对比单线程录制与 1 ~ N 个线程并行录制次级命令缓冲。
+	 * - "instancing"：同一网格绘制 20 万份（可用 --instances 修改），对比逐对象绘制、单次实例化绘制
+	 *   以及每帧增量更新 1% 实例数据的实例化绘制。逐对象绘制很慢，建议配合 --frames 使用。
+	 * - "gpu-driven"：100 万个对象（可用 --instances 修改）铺在 4 倍视口面积上，对比 CPU 逐对象剔除并提交绘制
+	 *   与计算着色器剔除 + 间接绘制。CPU 提交很慢，建议配合 --frames 使用。
+	 * - "async-compute"：20 万个实例（可用 --instances 修改）的运动由计算着色器模拟，对比计算与图形串行执行
+	 *   和在异步计算队列上重叠执行的帧耗时，并报告计算耗时被图形工作掩盖的比例。
+	 * - "pipeline-variants"：请求 200 个管线变体，对比工作线程池并行编译（期间用通用管线继续渲染）与渲染线程串行编译的
+	 *   首帧耗时和全部就绪耗时。
+	 * - "command-cache"：静态场景下对比每帧重新录制与复用缓存的命令缓冲的录制耗时，建议配合 --mesh-grid 与 --draws 使用。
+	 * - "upload-batch"：上传 4000 个大小随机的设备本地缓冲，对比每个资源单独提交并等待与经上传队列批量提交的总耗时和提交次数。
+	 * - "render-graph"：需要 --render-graph。依次以场景直接输出、--blur-levels 级（默认 4）模糊链、同一模糊链但瞬态图像
+	 *   不共用显存运行，报告每帧的通道数、屏障数与批次数以及瞬态图像的显存占用。
+	 * - "texture-streaming"：需要 --texture-dir。预取目录中的所有图像并持续渲染，直到每个纹理都驻留过一次，
+	 *   报告帧耗时分布、解码与上传量、峰值显存占用与逐出次数。可用 --texture-budget 调小预算观察逐出。
+	 * - "resize-storm"：仅窗口模式。连续 --frames 帧（默认 600）每帧改变窗口尺寸，报告持续重建交换链期间的最差帧耗时。
+	 * - "idle"：仅窗口模式。静态场景下先连续渲染、再按需渲染各 --seconds 秒（默认 5），对比绘制帧数与空闲等待时间占比。
+	 *   测量期间不要操作窗口。
+	 */
+	std::string bench;
+
+	/**
+	 * @brief 场景网格的细分数，绘制 N×N 个四边形组成的网格；0 表示使用默认三角形。
+	 */
+	uint32_t meshGrid = 0;
+
+	/**
+	 * @brief 场景网格拆分成的绘制次数，0 表示整个网格一次绘制。
+	 */
+	uint32_t sceneDraws = 0;
+
+	/**
+	 * @brief 并行录制次级命令缓冲的工作线程数，0 表示在主线程直接录制主命令缓冲。
+	 */
+	uint32_t recordThreads = 0;
+
+	/**
+	 * @brief 实例化绘制场景网格的份数，0 表示不使用实例化路径。
+	 */
+	uint32_t instances = 0;
+
+	/**
+	 * @brief 实例化场景中每帧修改（旋转）的实例数，用于演示增量更新。
+	 */
+	uint32_t instanceUpdates = 0;
+
+	/**
+	 * @brief 实例化场景改为 GPU 驱动渲染：计算着色器剔除实例并生成间接绘制命令。需要 instances 大于 0。
+	 */
+	bool gpuDriven = false;
+
+	/**
+	 * @brief 实例运动由计算着色器模拟，并提交到异步计算队列（没有独立计算队列族时提交到图形队列）。
+	 *
+	 * 需要 instances 大于 0，不能与 gpuDriven 同时使用。
+	 */
+	bool asyncCompute = false;
+
+	/**
+	 * @brief 实例模拟每帧的积分子步数，用于调节计算负载。
+	 */
+	uint32_t simSubsteps = 16;
+
+	/**
+	 * @brief 使用 VK_KHR_dynamic_rendering 直接向交换链图像视图渲染，不创建渲染通道与帧缓冲。
+	 *
+	 * 交换链重建时不再需要重建帧缓冲；设备不支持时退回渲染通道。
+	 */
+	bool dynamicRendering = false;
+
+	/**
+	 * @brief 呈现策略："low-latency"（MAILBOX 优先）、"power-saver"（FIFO 垂直同步）或 "uncapped"（IMMEDIATE 优先）。
+	 *
+	 * 窗口模式下可在 ImGui 中切换。指定 --report 时退出前为每种用过的策略输出帧间隔与延迟统计。
+	 */
+	std::string presentPolicy = "low-latency";
+
+	/**
+	 * @brief 支持 VK_KHR_present_wait 时，CPU 最多领先显示的帧数（1 ~ 8）。
+	 */
+	uint32_t presentLatencyFrames = 1;
+
+	/**
+	 * @brief 使用图形队列上的一个 VK_KHR_timeline_semaphore 代替每帧栅栏同步 CPU 与 GPU。
+	 *
+	 * 每次提交触发递增的序号，等待与完成查询都基于该序号，不再需要重置栅栏；设备不支持时退回栅栏。
+	 */
+	bool timelineSync = false;
+
+	/**
+	 * @brief SPIR-V 着色器所在目录，着色器按文件名（如 vert.spv）在其中查找。
+	 */
+	std::string shaderDir = "spv";
+
+	/**
+	 * @brief GLSL 着色器源文件目录，--compile-shaders 与 --hot-reload 从这里读取。
+	 */
+	std::string shaderSourceDir = "vertFrag";
+
+	/**
+	 * @brief 编译结果的磁盘缓存目录，按源码内容与宏定义的哈希命名。
+	 */
+	std::string shaderCacheDir = "spv_cache";
+
+	/**
+	 * @brief 编译着色器时的预处理宏，"NAME" 或 "NAME=VALUE"。
+	 */
+	std::vector<std::string> shaderDefines;
+
+	/**
+	 * @brief 将 shaderSourceDir 中的所有着色器编译到 shaderDir 后退出，代替 Res/shader.bat。
+	 */
+	bool compileShaders = false;
+
+	/**
+	 * @brief 窗口模式下后台监视 shaderSourceDir 中的 .vert / .frag，修改后重新编译并在帧边界替换图形管线。
+	 */
+	bool hotReload = false;
+
+	/**
+	 * @brief 管线变体的后台编译线程数，0 表示硬件线程数 - 1（至少 1 个）。
+	 */
+	uint32_t pipelineThreads = 0;
+
+	/**
+	 * @brief 缓存录制好的场景命令缓冲，场景状态不变时直接重新提交，ImGui 每帧单独录制。
+	 *
+	 * 每帧更新实例数据（--instance-updates）或模拟实例运动时退回逐帧录制。窗口模式下可在 ImGui 中切换。
+	 */
+	bool cacheCommands = false;
+
+	/**
+	 * @brief 按需渲染：没有输入事件、ImGui 交互或场景变化时阻塞等待事件，不再绘制新帧。
+	 *
+	 * 实例每帧更新或模拟时场景一直在变化，照常逐帧绘制。窗口模式下可在 ImGui 中切换。
+	 */
+	bool onDemand = false;
+
+	/**
+	 * @brief 窗口模式的帧率上限，0 表示不限制（只受呈现模式约束）。
+	 */
+	double maxFps = 0.0;
+
+	/**
+	 * @brief 纹理流送的图像目录（png / jpg / tga / bmp / ktx2 / dds），为空时不创建纹理流送器。
+	 *
+	 * ktx2 / dds 中的块压缩格式（BC / ETC2 / ASTC）直接上传自带的 mip 链，设备不支持时 BC1 ~ BC5 在 CPU 上转码。
+	 * 窗口模式下在“纹理浏览”窗口中分页显示，只有当前页的纹理会被加载。
+	 */
+	std::string textureDir;
+
+	/**
+	 * @brief 驻留纹理的显存预算（MB），超出时逐出最久未使用的纹理。
+	 */
+	uint32_t textureBudgetMB = 256;
+
+	/**
+	 * @brief 每帧最多上传的纹理数据量（KB），大图像跨多帧分段上传。
+	 */
+	uint32_t textureUploadKB = 8192;
+
+	/**
+	 * @brief 纹理解码线程数，0 表示硬件线程数 - 1（至少 1 个）。
+	 */
+	uint32_t textureThreads = 0;
+
+	/**
+	 * @brief 每帧把场景、模糊链与 ImGui 声明为渲染图中的通道，屏障与瞬态图像由渲染图管理。
+	 *
+	 * 需要 VK_KHR_dynamic_rendering（会自动请求），设备不支持时退回原有的渲染路径。渲染图模式下不使用并行录制与命令缓存。
+	 */
+	bool renderGraph = false;
+
+	/**
+	 * @brief 渲染图中模糊链的降采样级数（0 ~ kMaxBlurLevels），0 表示场景直接渲染到交换链图像。
+	 *
+	 * 场景先渲染到瞬态图像，逐级减半再逐级放大回交换链图像（vkCmdBlitImage 线性过滤），生命周期不重叠的中间图像共用显存。
+	 * 窗口模式下可在 ImGui 中修改。
+	 */
+	uint32_t blurLevels = 0;
+};
+
+#endif    // !APPCONFIG_H_
@@ -0,0 +1,69 @@
+﻿#include "FrameLimiter.h"
+
+#include <cmath>
+#include <thread>
+
+FrameLimiter::FrameLimiter() {}
+
+FrameLimiter::~FrameLimiter() {}
+
+void FrameLimiter::SetTargetFps(double fps)
+{
+	if (fps <= 0.0) {
+		_targetFps = 0.0;
+		_period = std::chrono::steady_clock::duration{ 0 };
+	}
+	else {
+		_targetFps = fps;
+		_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / fps));
+	}
+	_hasNext = false;
+}
+
+std::chrono::steady_clock::duration FrameLimiter::Wait()
+{
+	if (!IsActive()) {
+		return std::chrono::steady_clock::duration{ 0 };
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	// 第一帧或落后超过一个周期：从现在重新计时，不补帧
+	if (!_hasNext || start - _next > _period) {
+		_next = start;
+		_hasNext = true;
+	}
+	else if (start < _next) {
+		preciseSleep(_next);
+	}
+	_next += _period;
+
+	return std::chrono::steady_clock::now() - start;
+}
+
+void FrameLimiter::preciseSleep(std::chrono::steady_clock::time_point deadline)
+{
+	// 剩余时间足够时逐次睡眠 1 ms，同时更新单次睡眠耗时的估计
+	double remaining = std::chrono::duration<double>(deadline - std::chrono::steady_clock::now()).count();
+	while (remaining > _estimate) {
+		auto sleepStart = std::chrono::steady_clock::now();
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		double observed = std::chrono::duration<double>(std::chrono::steady_clock::now() - sleepStart).count();
+		remaining -= observed;
+
+		if (_count >= kMaxSleepSamples) {
+			_count = 1;
+			_m2 = 0.0;
+		}
+		_count++;
+		double delta = observed - _mean;
+		_mean += delta / static_cast<double>(_count);
+		_m2 += delta * (observed - _mean);
+		_estimate = _mean + std::sqrt(_m2 / static_cast<double>(_count - 1));
+	}
+
+	// 最后一段自旋，让出时间片但不进入睡眠
+	while (std::chrono::steady_clock::now() < deadline) {
+		std::this_thread::yield();
+	}
+}
@@ -0,0 +1,81 @@
+﻿#ifndef FRAMELIMITER_H_
+#define FRAMELIMITER_H_
+
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief 帧率上限：按固定周期排定每帧的开始时间，睡眠到接近目标时刻后自旋补齐剩余时间。
+ *
+ * 操作系统的睡眠粒度与唤醒延迟因平台而异（Windows 默认约 15.6 ms），因此每次只睡眠 1 ms，
+ * 并在线统计单次睡眠实际耗时的均值与标准差；剩余时间小于“均值 + 标准差”时改为自旋，
+ * 既不会睡过头，也只在最后一小段占用 CPU。
+ *
+ * 落后超过一个周期（如卡顿或空闲后恢复）时重新对齐，不会连续追帧。
+ */
+class FrameLimiter
+{
+public:
+	FrameLimiter();
+
+	~FrameLimiter();
+
+public:
+	/**
+	 * @brief 设置帧率上限，0 或负数表示不限制。
+	 */
+	void SetTargetFps(double fps);
+
+	/**
+	 * @brief 当前帧率上限，0 表示不限制。
+	 */
+	double TargetFps() const { return _targetFps; }
+
+	/**
+	 * @brief 是否设置了帧率上限。
+	 */
+	bool IsActive() const { return _period.count() > 0; }
+
+	/**
+	 * @brief 等待到本帧排定的开始时间并排定下一帧。未设置上限时立即返回。
+	 *
+	 * @return 实际等待的时长。
+	 */
+	std::chrono::steady_clock::duration Wait();
+
+	/**
+	 * @brief 丢弃已排定的时间，下一次 Wait() 立即返回并从该时刻重新计时。空闲或最小化恢复后调用。
+	 */
+	void Reset() { _hasNext = false; }
+
+	/**
+	 * @brief 当前开始自旋的阈值（毫秒），即单次 1 ms 睡眠耗时的均值 + 标准差。
+	 */
+	double SpinThresholdMs() const { return _estimate * 1000.0; }
+
+private:
+	/**
+	 * @brief 睡眠 + 自旋直到 deadline。
+	 */
+	void preciseSleep(std::chrono::steady_clock::time_point deadline);
+
+	// 在线统计的样本上限，达到后以当前均值为起点重新统计，跟随系统负载变化
+	static constexpr uint64_t kMaxSleepSamples = 1000;
+
+private:
+	double _targetFps = 0.0;
+
+	std::chrono::steady_clock::duration _period{ 0 };
+
+	// 下一帧排定的开始时间
+	std::chrono::steady_clock::time_point _next{};
+	bool _hasNext = false;
+
+	// 单次 1 ms 睡眠耗时（秒）的 Welford 统计
+	double _estimate = 5e-3;
+	double _mean = 5e-3;
+	double _m2 = 0.0;
+	uint64_t _count = 1;
+};
+
+#endif    // !FRAMELIMITER_H_
@@ -0,0 +1,226 @@
+﻿#include "FramePhaseProfiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+namespace {
+	// 每个数量级（2 的幂）内的线性子桶位数：前 128 个桶精确到 1 ns，之后每个数量级 64 个桶
+	constexpr uint32_t kSubBucketBits = 7;
+	constexpr uint64_t kSubBucketCount = 1ull << kSubBucketBits;
+	constexpr uint64_t kSubBucketHalf = kSubBucketCount / 2;
+
+	// 可区分的最大值为 2^36 ns（约 68 秒），更大的值计入最后一个桶
+	constexpr uint32_t kMaxValueBits = 36;
+	constexpr uint64_t kMaxValue = (1ull << kMaxValueBits) - 1;
+	constexpr uint32_t kBucketCount = static_cast<uint32_t>(kSubBucketCount + (kMaxValueBits - kSubBucketBits) * kSubBucketHalf);
+
+	// 环形缓冲保存的帧数
+	constexpr uint64_t kFrameHistory = 4096;
+
+	const char* kPhaseNames[FramePhaseProfiler::PhaseCount] = {
+		"poll_events",
+		"fence_wait",
+		"acquire",
+		"record",
+		"submit",
+		"present",
+		"recreate",
+		"pace",
+		"limit",
+		"stream",
+	};
+
+	// 有效位数，即最高位 1 的位置 + 1
+	uint32_t bitWidth(uint64_t value)
+	{
+		uint32_t width = 0;
+		while (value != 0) {
+			value >>= 1;
+			width++;
+		}
+		return width;
+	}
+}
+
+FramePhaseProfiler::FramePhaseProfiler()
+	: _buckets(new std::atomic<uint64_t>[static_cast<size_t>(kBucketCount) * PhaseCount])
+	, _frames(new FrameRecord[kFrameHistory])
+{
+	Reset();
+}
+
+FramePhaseProfiler::~FramePhaseProfiler() {}
+
+void FramePhaseProfiler::Add(Phase phase, std::chrono::steady_clock::duration duration)
+{
+	int64_t count = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+	uint64_t ns = count > 0 ? static_cast<uint64_t>(count) : 0;
+
+	_currentNs[phase] += ns;
+
+	// 只有渲染线程写入，读取方只需要看到最终值，因此全部使用 relaxed
+	_buckets[static_cast<size_t>(phase) * kBucketCount + bucketIndex(ns)].fetch_add(1, std::memory_order_relaxed);
+	_counts[phase].fetch_add(1, std::memory_order_relaxed);
+	if (ns > _maxNs[phase].load(std::memory_order_relaxed)) {
+		_maxNs[phase].store(ns, std::memory_order_relaxed);
+		_maxFrame[phase].store(_frameIndex.load(std::memory_order_relaxed), std::memory_order_relaxed);
+	}
+}
+
+void FramePhaseProfiler::EndFrame()
+{
+	uint64_t frame = _frameIndex.load(std::memory_order_relaxed);
+	FrameRecord& record = _frames[frame % kFrameHistory];
+
+	// 先标记为无效，读取方据此丢弃写入中的记录
+	record.sequence.store(0, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+
+	for (uint32_t i = 0; i < PhaseCount; i++) {
+		uint64_t us = (_currentNs[i] + 500) / 1000;
+		record.phaseUs[i].store(static_cast<uint32_t>(std::min<uint64_t>(us, UINT32_MAX)), std::memory_order_relaxed);
+		_currentNs[i] = 0;
+	}
+
+	record.sequence.store(frame + 1, std::memory_order_release);
+	_frameIndex.store(frame + 1, std::memory_order_release);
+}
+
+void FramePhaseProfiler::Reset()
+{
+	for (size_t i = 0; i < static_cast<size_t>(kBucketCount) * PhaseCount; i++) {
+		_buckets[i].store(0, std::memory_order_relaxed);
+	}
+
+	for (uint32_t i = 0; i < PhaseCount; i++) {
+		_counts[i].store(0, std::memory_order_relaxed);
+		_maxNs[i].store(0, std::memory_order_relaxed);
+		_maxFrame[i].store(0, std::memory_order_relaxed);
+		_currentNs[i] = 0;
+	}
+
+	for (uint64_t i = 0; i < kFrameHistory; i++) {
+		_frames[i].sequence.store(0, std::memory_order_relaxed);
+		for (uint32_t j = 0; j < PhaseCount; j++) {
+			_frames[i].phaseUs[j].store(0, std::memory_order_relaxed);
+		}
+	}
+
+	_frameIndex.store(0, std::memory_order_release);
+}
+
+FramePhaseProfiler::PhaseSummary FramePhaseProfiler::Summary(Phase phase) const
+{
+	PhaseSummary summary;
+	summary.count = _counts[phase].load(std::memory_order_relaxed);
+	if (summary.count == 0) {
+		return summary;
+	}
+
+	summary.p50 = static_cast<double>(percentile(phase, summary.count, 0.50)) / 1e6;
+	summary.p99 = static_cast<double>(percentile(phase, summary.count, 0.99)) / 1e6;
+	summary.max = static_cast<double>(_maxNs[phase].load(std::memory_order_relaxed)) / 1e6;
+	summary.maxFrame = _maxFrame[phase].load(std::memory_order_relaxed);
+	return summary;
+}
+
+bool FramePhaseProfiler::DumpToFile(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file.is_open()) {
+		std::cerr << "无法写入帧阶段耗时文件: " << path << std::endl;
+		return false;
+	}
+
+	// 第一部分：各阶段摘要
+	file << "phase,count,p50_ms,p99_ms,max_ms,max_frame\n";
+	for (uint32_t i = 0; i < PhaseCount; i++) {
+		PhaseSummary summary = Summary(static_cast<Phase>(i));
+		file << kPhaseNames[i] << ',' << summary.count << ',' << summary.p50 << ',' << summary.p99 << ','
+			<< summary.max << ',' << summary.maxFrame << '\n';
+	}
+
+	// 第二部分：最近若干帧的逐阶段耗时（微秒），从旧到新
+	file << "\nframe";
+	for (uint32_t i = 0; i < PhaseCount; i++) {
+		file << ',' << kPhaseNames[i] << "_us";
+	}
+	file << '\n';
+
+	uint64_t end = _frameIndex.load(std::memory_order_acquire);
+	uint64_t begin = end > kFrameHistory ? end - kFrameHistory : 0;
+	uint32_t values[PhaseCount];
+	for (uint64_t frame = begin; frame < end; frame++) {
+		const FrameRecord& record = _frames[frame % kFrameHistory];
+
+		uint64_t before = record.sequence.load(std::memory_order_acquire);
+		for (uint32_t i = 0; i < PhaseCount; i++) {
+			values[i] = record.phaseUs[i].load(std::memory_order_relaxed);
+		}
+		std::atomic_thread_fence(std::memory_order_acquire);
+		uint64_t after = record.sequence.load(std::memory_order_relaxed);
+
+		// 读取期间被新帧覆盖的记录直接跳过
+		if (before != frame + 1 || after != before) {
+			continue;
+		}
+
+		file << frame;
+		for (uint32_t i = 0; i < PhaseCount; i++) {
+			file << ',' << values[i];
+		}
+		file << '\n';
+	}
+
+	return file.good();
+}
+
+const char* FramePhaseProfiler::PhaseName(Phase phase)
+{
+	return phase < PhaseCount ? kPhaseNames[phase] : "unknown";
+}
+
+uint32_t FramePhaseProfiler::bucketIndex(uint64_t ns)
+{
+	ns = std::min(ns, kMaxValue);
+	if (ns < kSubBucketCount) {
+		return static_cast<uint32_t>(ns);
+	}
+
+	// 数量级 m 内的值右移 m 位后落在 [64, 128)
+	uint32_t magnitude = bitWidth(ns) - kSubBucketBits;
+	return static_cast<uint32_t>(kSubBucketCount + (magnitude - 1) * kSubBucketHalf + (ns >> magnitude) - kSubBucketHalf);
+}
+
+uint64_t FramePhaseProfiler::bucketUpperBound(uint32_t index)
+{
+	if (index < kSubBucketCount) {
+		return index;
+	}
+
+	uint32_t offset = index - static_cast<uint32_t>(kSubBucketCount);
+	uint32_t magnitude = offset / static_cast<uint32_t>(kSubBucketHalf) + 1;
+	uint64_t subBucket = offset % kSubBucketHalf + kSubBucketHalf;
+	return ((subBucket + 1) << magnitude) - 1;
+}
+
+uint64_t FramePhaseProfiler::percentile(Phase phase, uint64_t total, double p) const
+{
+	// 最近秩法：取第 ceil(p * n) 个样本所在的桶
+	uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p * static_cast<double>(total))));
+	uint64_t maxNs = _maxNs[phase].load(std::memory_order_relaxed);
+
+	const std::atomic<uint64_t>* buckets = &_buckets[static_cast<size_t>(phase) * kBucketCount];
+	uint64_t cumulative = 0;
+	for (uint32_t i = 0; i < kBucketCount; i++) {
+		cumulative += buckets[i].load(std::memory_order_relaxed);
+		if (cumulative >= rank) {
+			// 桶上界不会超过实际最大值
+			return std::min(bucketUpperBound(i), maxNs);
+		}
+	}
+
+	return maxNs;
+}
@@ -0,0 +1,138 @@
+﻿#ifndef FRAMEPHASEPROFILER_H_
+#define FRAMEPHASEPROFILER_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+/**
+ * @brief CPU 帧阶段计时器，用于定位偶发的帧耗时尖刺来自哪个阶段。
+ *
+ * 每个阶段维护一个 HDR 风格（对数-线性分桶）的直方图，相对误差约 1.6%，可在不保存原始样本的情况下
+ * 给出任意时长内的 p50/p99/max；另有一个固定大小的环形缓冲保存最近若干帧的逐阶段耗时，便于查看尖刺帧的构成。
+ *
+ * 所有存储在构造时一次性分配，Add / EndFrame 只做原子操作，不分配内存也不加锁。
+ * 写入只允许在渲染线程进行，Summary / DumpToFile 可在任意线程读取（环形缓冲用序号校验丢弃被覆盖中的记录）。
+ */
+class FramePhaseProfiler
+{
+public:
+	/**
+	 * @brief 一帧中被计时的阶段。
+	 */
+	enum Phase : uint32_t {
+		PollEvents,    // glfwPollEvents
+		FenceWait,     // vkWaitForFences
+		Acquire,       // vkAcquireNextImageKHR
+		Record,        // 重置并记录命令缓冲
+		Submit,        // vkQueueSubmit
+		Present,       // vkQueuePresentKHR
+		Recreate,      // recreateSwapChain
+		Pace,          // vkWaitForPresentKHR（按呈现完成控制帧节奏）
+		Limit,         // FrameLimiter::Wait（帧率上限）
+		Stream,        // TextureStreamer::Update（纹理流送的解码收集与上传录制）
+		PhaseCount
+	};
+
+	/**
+	 * @brief 一个阶段的统计摘要（毫秒）。
+	 */
+	struct PhaseSummary {
+		// 样本数量
+		uint64_t count = 0;
+
+		double p50 = 0.0;
+		double p99 = 0.0;
+		double max = 0.0;
+
+		// 最大值出现在第几帧
+		uint64_t maxFrame = 0;
+	};
+
+public:
+	FramePhaseProfiler();
+
+	~FramePhaseProfiler();
+
+	FramePhaseProfiler(const FramePhaseProfiler&) = delete;
+	FramePhaseProfiler& operator=(const FramePhaseProfiler&) = delete;
+
+public:
+	/**
+	 * @brief 记录当前帧某个阶段的一次耗时。同一帧内同一阶段多次记录时累加。
+	 */
+	void Add(Phase phase, std::chrono::steady_clock::duration duration);
+
+	/**
+	 * @brief 结束当前帧，将各阶段耗时写入环形缓冲。
+	 */
+	void EndFrame();
+
+	/**
+	 * @brief 清空直方图与环形缓冲。只能在渲染线程调用。
+	 */
+	void Reset();
+
+	/**
+	 * @brief 计算某个阶段的统计摘要。
+	 */
+	PhaseSummary Summary(Phase phase) const;
+
+	/**
+	 * @brief 将各阶段摘要与最近若干帧的逐阶段耗时写入文本文件。
+	 *
+	 * @return true 写入成功。
+	 */
+	bool DumpToFile(const std::string& path) const;
+
+	/**
+	 * @brief 阶段名称。
+	 */
+	static const char* PhaseName(Phase phase);
+
+private:
+	/**
+	 * @brief 环形缓冲中的一帧记录，sequence 为帧序号 + 1，0 表示无效或正在写入。
+	 */
+	struct FrameRecord {
+		std::atomic<uint64_t> sequence{ 0 };
+		std::atomic<uint32_t> phaseUs[PhaseCount];
+	};
+
+	/**
+	 * @brief 纳秒值对应的直方图桶索引。
+	 */
+	static uint32_t bucketIndex(uint64_t ns);
+
+	/**
+	 * @brief 直方图桶所覆盖区间的上界（纳秒）。
+	 */
+	static uint64_t bucketUpperBound(uint32_t index);
+
+	/**
+	 * @brief 从直方图中按最近秩法取分位数（纳秒）。
+	 */
+	uint64_t percentile(Phase phase, uint64_t total, double p) const;
+
+private:
+	// 各阶段的直方图桶计数，按阶段连续存放
+	std::unique_ptr<std::atomic<uint64_t>[]> _buckets;
+
+	// 各阶段的样本数与最大值（纳秒）
+	std::atomic<uint64_t> _counts[PhaseCount];
+	std::atomic<uint64_t> _maxNs[PhaseCount];
+	std::atomic<uint64_t> _maxFrame[PhaseCount];
+
+	// 最近若干帧的逐阶段耗时
+	std::unique_ptr<FrameRecord[]> _frames;
+
+	// 已结束的帧数，即下一帧的序号
+	std::atomic<uint64_t> _frameIndex{ 0 };
+
+	// 当前帧各阶段的累计耗时（纳秒），只由渲染线程访问
+	uint64_t _currentNs[PhaseCount] = {};
+};
+
+#endif    // !FRAMEPHASEPROFILER_H_
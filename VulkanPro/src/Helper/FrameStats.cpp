@@ -0,0 +1,100 @@
+﻿#include "FrameStats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+FrameStats::FrameStats() {}
+
+FrameStats::~FrameStats() {}
+
+void FrameStats::Reserve(size_t count)
+{
+	_cpuTimes.reserve(count);
+	_gpuTimes.reserve(count);
+	_fenceWaits.reserve(count);
+	_acquireWaits.reserve(count);
+}
+
+void FrameStats::Clear()
+{
+	_cpuTimes.clear();
+	_gpuTimes.clear();
+	_fenceWaits.clear();
+	_acquireWaits.clear();
+	_fields.clear();
+}
+
+void FrameStats::AddCpuTime(double ms)
+{
+	_cpuTimes.push_back(ms);
+}
+
+void FrameStats::AddGpuTime(double ms)
+{
+	_gpuTimes.push_back(ms);
+}
+
+void FrameStats::AddFenceWait(double ms)
+{
+	_fenceWaits.push_back(ms);
+}
+
+void FrameStats::AddAcquireWait(double ms)
+{
+	_acquireWaits.push_back(ms);
+}
+
+void FrameStats::AddField(const std::string& key, int64_t value)
+{
+	_fields.emplace_back(key, value);
+}
+
+std::string FrameStats::ToJson(const std::string& name, double elapsedSeconds) const
+{
+	double fps = elapsedSeconds > 0.0 ? static_cast<double>(_cpuTimes.size()) / elapsedSeconds : 0.0;
+
+	std::ostringstream out;
+	out << "{\"name\":\"" << name << "\"";
+	for (const auto& field : _fields) {
+		out << ",\"" << field.first << "\":" << field.second;
+	}
+	out << ",\"frames\":" << _cpuTimes.size()
+		<< ",\"seconds\":" << elapsedSeconds
+		<< ",\"fps\":" << fps
+		<< ",\"cpu_ms\":" << percentilesJson(_cpuTimes)
+		<< ",\"gpu_ms\":" << percentilesJson(_gpuTimes)
+		<< ",\"fence_wait_ms\":" << percentilesJson(_fenceWaits)
+		<< ",\"acquire_wait_ms\":" << percentilesJson(_acquireWaits)
+		<< "}";
+	return out.str();
+}
+
+double FrameStats::Percentile(std::vector<double> samples, double p)
+{
+	if (samples.empty()) {
+		return 0.0;
+	}
+
+	// 最近秩法：取第 ceil(p * n) 个样本
+	size_t rank = static_cast<size_t>(std::ceil(std::clamp(p, 0.0, 1.0) * samples.size()));
+	size_t index = rank == 0 ? 0 : rank - 1;
+
+	std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+	return samples[index];
+}
+
+std::string FrameStats::percentilesJson(const std::vector<double>& samples)
+{
+	if (samples.empty()) {
+		return "null";
+	}
+
+	std::ostringstream out;
+	out << "{\"p50\":" << Percentile(samples, 0.50)
+		<< ",\"p95\":" << Percentile(samples, 0.95)
+		<< ",\"p99\":" << Percentile(samples, 0.99)
+		<< ",\"max\":" << *std::max_element(samples.begin(), samples.end())
+		<< "}";
+	return out.str();
+}
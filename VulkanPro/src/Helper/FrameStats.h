@@ -0,0 +1,105 @@
+﻿#ifndef FRAMESTATS_H_
+#define FRAMESTATS_H_
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief 帧耗时统计，用于基准测试结束后输出机器可读的报告。
+ *
+ * 分别记录每帧的 CPU 耗时、GPU 耗时以及 CPU 阻塞等待的时间（毫秒），结束时计算帧率及 p50/p95/p99 分位数，
+ * 并以单行 JSON 的形式输出，便于 CI 脚本解析与回归追踪。
+ */
+class FrameStats
+{
+public:
+	FrameStats();
+
+	~FrameStats();
+
+public:
+	/**
+	 * @brief 预留样本空间，避免测量过程中发生内存分配。
+	 */
+	void Reserve(size_t count);
+
+	/**
+	 * @brief 清空所有样本。
+	 */
+	void Clear();
+
+	/**
+	 * @brief 记录一帧的 CPU 耗时（毫秒）。
+	 */
+	void AddCpuTime(double ms);
+
+	/**
+	 * @brief 记录一帧的 GPU 耗时（毫秒）。
+	 */
+	void AddGpuTime(double ms);
+
+	/**
+	 * @brief 记录一帧在 vkWaitForFences 上阻塞的时间（毫秒）。
+	 */
+	void AddFenceWait(double ms);
+
+	/**
+	 * @brief 记录一帧在 vkAcquireNextImageKHR 上阻塞的时间（毫秒），无头模式下没有该项。
+	 */
+	void AddAcquireWait(double ms);
+
+	/**
+	 * @brief 附加一个整数字段到报告中（如 frames_in_flight），Clear() 时一并清空。
+	 */
+	void AddField(const std::string& key, int64_t value);
+
+	/**
+	 * @brief 已记录的 CPU 帧数。
+	 */
+	size_t FrameCount() const { return _cpuTimes.size(); }
+
+	/**
+	 * @brief 生成 JSON 格式的报告。
+	 *
+	 * @param name           报告名称（如 "headless"）。
+	 * @param elapsedSeconds 测量期间的总耗时（秒），用于计算帧率。
+	 * @return std::string   单行 JSON 文本。
+	 */
+	std::string ToJson(const std::string& name, double elapsedSeconds) const;
+
+public:
+	/**
+	 * @brief 计算样本的分位数（最近秩法）。
+	 *
+	 * @param samples 样本（按值传递，函数内部排序）。
+	 * @param p       分位数，取值 [0, 1]。
+	 * @return double 分位数值，样本为空时返回 0。
+	 */
+	static double Percentile(std::vector<double> samples, double p);
+
+private:
+	/**
+	 * @brief 将一组样本的分位数写成 JSON 对象，样本为空时输出 null。
+	 */
+	static std::string percentilesJson(const std::vector<double>& samples);
+
+private:
+	// 每帧 CPU 耗时（毫秒）
+	std::vector<double> _cpuTimes;
+
+	// 每帧 GPU 耗时（毫秒），设备不支持时间戳时为空
+	std::vector<double> _gpuTimes;
+
+	// 每帧等待栅栏的时间（毫秒）
+	std::vector<double> _fenceWaits;
+
+	// 每帧获取交换链图像的时间（毫秒）
+	std::vector<double> _acquireWaits;
+
+	// 附加的整数字段，按添加顺序输出
+	std::vector<std::pair<std::string, int64_t>> _fields;
+};
+
+#endif    // !FRAMESTATS_H_
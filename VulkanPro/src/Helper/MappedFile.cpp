@@ -0,0 +1,100 @@
+﻿#include "MappedFile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile() {}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& path)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	_file = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(file, &size)) {
+		return false;
+	}
+	_size = static_cast<size_t>(size.QuadPart);
+	if (_size == 0) {
+		return true;
+	}
+
+	_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (_mapping == nullptr) {
+		return false;
+	}
+	_data = MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0);
+	return _data != nullptr;
+#else
+	_fd = open(path.c_str(), O_RDONLY);
+	if (_fd < 0) {
+		return false;
+	}
+
+	struct stat info;
+	if (fstat(_fd, &info) != 0) {
+		return false;
+	}
+	_size = static_cast<size_t>(info.st_size);
+	if (_size == 0) {
+		return true;
+	}
+
+	void* data = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _fd, 0);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+	_data = data;
+	return true;
+#endif
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+	if (_data != nullptr) {
+		UnmapViewOfFile(_data);
+	}
+	if (_mapping != nullptr) {
+		CloseHandle(_mapping);
+	}
+	if (_file != nullptr) {
+		CloseHandle(_file);
+	}
+	_mapping = nullptr;
+	_file = nullptr;
+#else
+	if (_data != nullptr) {
+		munmap(_data, _size);
+	}
+	if (_fd >= 0) {
+		close(_fd);
+	}
+	_fd = -1;
+#endif
+	_data = nullptr;
+	_size = 0;
+}
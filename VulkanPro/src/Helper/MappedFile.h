@@ -0,0 +1,51 @@
+﻿#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief 只读内存映射文件，析构时解除映射。映射地址按页对齐。
+ *
+ * 文件内容按需由操作系统换页读入，不经过中间缓冲。
+ */
+class MappedFile
+{
+public:
+	MappedFile();
+
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+public:
+	/**
+	 * @brief 打开并映射整个文件。空文件打开成功但 Data() 为 nullptr。
+	 *
+	 * @return 打开或映射失败时返回 false。
+	 */
+	bool Open(const std::string& path);
+
+	/**
+	 * @brief 解除映射并关闭文件。
+	 */
+	void Close();
+
+	const void* Data() const { return _data; }
+
+	size_t Size() const { return _size; }
+
+private:
+#ifdef _WIN32
+	// HANDLE，避免在头文件中包含 windows.h
+	void* _file = nullptr;
+	void* _mapping = nullptr;
+#else
+	int _fd = -1;
+#endif
+	void* _data = nullptr;
+	size_t _size = 0;
+};
+
+#endif    // !MAPPEDFILE_H_
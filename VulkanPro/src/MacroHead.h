@@ -1,6 +1,8 @@
 ﻿#include <optional>
 #include <array>
 
+#include "Render/GpuAllocator.h"
+
 /**
  * @brief 存储 Vulkan 队列族索引信息，用于选择合适的物理设备。
  *
@@ -22,6 +24,22 @@ struct QueueFamilyIndices {
 	 */
 	std::optional<uint32_t> presentFamily;
 
+	/**
+	 * @brief 异步计算队列族索引（可选值）。
+	 *
+	 * 优先选择不支持图形的专用计算队列族，其次是图形队列族以外支持计算的队列族；
+	 * 都没有时为空，计算工作在图形队列上提交。不参与 isComplete() 判断。
+	 */
+	std::optional<uint32_t> computeFamily;
+
+	/**
+	 * @brief 专用传输队列族索引（可选值）。
+	 *
+	 * 只选择既不支持图形也不支持计算的队列族（通常是独立的 DMA 引擎）；没有时为空，上传在图形队列上提交。
+	 * 不参与 isComplete() 判断。
+	 */
+	std::optional<uint32_t> transferFamily;
+
 	/**
 	 * @brief 判断是否已找到所有所需的队列族。
 	 *
@@ -86,8 +104,167 @@ struct Vertex {
 	}
 };
 
+/**
+ * @brief 每个实例的数据，作为第二个顶点绑定（VK_VERTEX_INPUT_RATE_INSTANCE）传给 vert_instanced 着色器。
+ */
+struct InstanceData {
+	// xy 为平移，z 为缩放，w 为旋转角（弧度）
+	glm::vec4 transform;
+
+	// 实例颜色，与顶点颜色相乘（a 未使用）
+	glm::vec4 color;
+
+	static VkVertexInputBindingDescription getBindingDescription() {
+		VkVertexInputBindingDescription bindingDescription{};
+		bindingDescription.binding = 1;
+		bindingDescription.stride = sizeof(InstanceData);
+		bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+		return bindingDescription;
+	}
+
+	static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions() {
+		std::array<VkVertexInputAttributeDescription, 2> attributeDescriptions{};
+
+		attributeDescriptions[0].binding = 1;
+		attributeDescriptions[0].location = 2;
+		attributeDescriptions[0].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		attributeDescriptions[0].offset = offsetof(InstanceData, transform);
+
+		attributeDescriptions[1].binding = 1;
+		attributeDescriptions[1].location = 3;
+		attributeDescriptions[1].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+		attributeDescriptions[1].offset = offsetof(InstanceData, color);
+
+		return attributeDescriptions;
+	}
+};
+
+/**
+ * @brief 场景顶点着色器的每帧 uniform（set 0，binding 0，动态偏移），按 std140 布局，每帧写入 FrameRingBuffer。
+ */
+struct SceneUniforms {
+	// 与顶点颜色相乘的色调（a 未使用）
+	glm::vec4 tint;
+};
+
 const std::vector<Vertex> vertices = {
 	{{0.0f, -0.5f}, {1.0f, 1.0f, 1.0f}},
 	{{0.5f, 0.5f}, {0.0f,1.0f, 0.0f}},
 	{{-0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}}
-};
\ No newline at end of file
+};
+
+/**
+ * @brief 默认三角形的索引数据。
+ */
+const std::vector<uint32_t> vertexIndices = { 0, 1, 2 };
+
+/**
+ * @brief 网格在 GPU 上的顶点缓冲、索引缓冲及其显存分配。
+ */
+struct MeshBuffers {
+	VkBuffer vertexBuffer = VK_NULL_HANDLE;
+
+	GpuAllocation vertexAlloc;
+
+	VkBuffer indexBuffer = VK_NULL_HANDLE;
+
+	GpuAllocation indexAlloc;
+
+	// 索引数量（vkCmdDrawIndexed 使用）
+	uint32_t indexCount = 0;
+};
+
+/**
+ * @brief 场景绘制列表中的一次绘制：场景网格索引缓冲中的一段连续区间。
+ */
+struct DrawItem {
+	uint32_t firstIndex = 0;
+
+	uint32_t indexCount = 0;
+};
+
+/**
+ * @brief 一次设备本地缓冲上传请求。
+ *
+ * 多个请求合并到同一个暂存缓冲和同一个命令缓冲中提交，
+ * 上传完成后 buffer / allocation 指向新创建的 DEVICE_LOCAL 缓冲及其显存分配。
+ */
+struct BufferUpload {
+	// 源数据（主机内存）
+	const void* data = nullptr;
+
+	// 数据大小（字节）
+	VkDeviceSize size = 0;
+
+	// 目标缓冲用途（如 VERTEX_BUFFER / INDEX_BUFFER），内部会追加 TRANSFER_DST
+	VkBufferUsageFlags usage = 0;
+
+	// 输出：创建的缓冲
+	VkBuffer* buffer = nullptr;
+
+	// 输出：缓冲的显存分配
+	GpuAllocation* allocation = nullptr;
+};
+
+/**
+ * @brief 缓存的场景命令缓冲及录制时的状态版本，版本与当前版本一致时可以直接重新提交。
+ */
+struct CachedCommandBuffer {
+	VkCommandBuffer buffer = VK_NULL_HANDLE;
+
+	// 录制时的 _commandVersion，0 表示需要重新录制
+	uint64_t version = 0;
+};
+
+/**
+ * @brief 纹理浏览器中一个缩略图的 ImGui 描述符集，及创建它时的图像视图与纹理驻留代数。
+ *
+ * 纹理驻留、被逐出或重新驻留后视图或代数改变，描述符集需要重新创建。
+ */
+struct TextureThumbnail {
+	VkDescriptorSet set = VK_NULL_HANDLE;
+	VkImageView view = VK_NULL_HANDLE;
+	uint32_t generation = 0;
+};
+
+/**
+ * @brief 场景管线的一个变体：只在固定功能状态上不同，由 PipelineManager 在后台编译。
+ *
+ * 默认值即通用管线的状态。Key() 把各字段压缩成 9 位的键，FromKey() 还原。
+ */
+struct PipelineVariant {
+	// 剔除模式（VK_CULL_MODE_*，0 ~ 3）
+	VkCullModeFlags cullMode = VK_CULL_MODE_BACK_BIT;
+
+	VkFrontFace frontFace = VK_FRONT_FACE_CLOCKWISE;
+
+	// 是否开启 alpha 混合
+	bool blend = false;
+
+	// 颜色写入掩码（VK_COLOR_COMPONENT_*，0 ~ 15）
+	VkColorComponentFlags writeMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+
+	// 是否为实例化管线（顶点着色器与顶点输入不同）
+	bool instanced = false;
+
+	uint64_t Key() const
+	{
+		return static_cast<uint64_t>(cullMode & 3u)
+			| static_cast<uint64_t>(frontFace == VK_FRONT_FACE_COUNTER_CLOCKWISE ? 1u : 0u) << 2
+			| static_cast<uint64_t>(blend ? 1u : 0u) << 3
+			| static_cast<uint64_t>(writeMask & 15u) << 4
+			| static_cast<uint64_t>(instanced ? 1u : 0u) << 8;
+	}
+
+	static PipelineVariant FromKey(uint64_t key)
+	{
+		PipelineVariant variant;
+		variant.cullMode = static_cast<VkCullModeFlags>(key & 3u);
+		variant.frontFace = (key >> 2) & 1u ? VK_FRONT_FACE_COUNTER_CLOCKWISE : VK_FRONT_FACE_CLOCKWISE;
+		variant.blend = ((key >> 3) & 1u) != 0;
+		variant.writeMask = static_cast<VkColorComponentFlags>((key >> 4) & 15u);
+		variant.instanced = ((key >> 8) & 1u) != 0;
+		return variant;
+	}
+};
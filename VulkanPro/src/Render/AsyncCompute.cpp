@@ -0,0 +1,248 @@
+﻿#include "AsyncCompute.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+AsyncCompute::AsyncCompute() {}
+
+AsyncCompute::~AsyncCompute() {}
+
+void AsyncCompute::Init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t computeFamily, VkQueue computeQueue,
+	uint32_t graphicsFamily, uint32_t frameCount)
+{
+	_device = device;
+	_computeFamily = computeFamily;
+	_graphicsFamily = graphicsFamily;
+	_queue = computeQueue;
+
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	poolInfo.queueFamilyIndex = computeFamily;
+
+	if (vkCreateCommandPool(_device, &poolInfo, nullptr, &_commandPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create compute command pool!");
+	}
+
+	_commandBuffers.resize(frameCount);
+
+	VkCommandBufferAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.commandPool = _commandPool;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandBufferCount = frameCount;
+
+	if (vkAllocateCommandBuffers(_device, &allocInfo, _commandBuffers.data()) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate compute command buffers!");
+	}
+
+	createSemaphores();
+	_submitted = 0;
+
+	_profiler.Init(physicalDevice, device, computeFamily, frameCount, 1);
+	ResetStats();
+}
+
+void AsyncCompute::Destroy()
+{
+	if (_commandPool == VK_NULL_HANDLE) {
+		return;
+	}
+
+	_profiler.Destroy();
+	destroySemaphores();
+
+	// 销毁命令池会一并释放其中的命令缓冲
+	vkDestroyCommandPool(_device, _commandPool, nullptr);
+	_commandPool = VK_NULL_HANDLE;
+	_commandBuffers.clear();
+}
+
+void AsyncCompute::SetLatency(uint32_t latency)
+{
+	_latency = std::clamp(latency, 1u, kMaxLatency);
+	Reset();
+}
+
+void AsyncCompute::Reset()
+{
+	// 链尾的信号量可能已触发但永远不会被等待，直接重建
+	destroySemaphores();
+	createSemaphores();
+	_submitted = 0;
+}
+
+void AsyncCompute::Submit(uint32_t frame, const RecordFunc& record)
+{
+	VkCommandBuffer commandBuffer = _commandBuffers[frame];
+	vkResetCommandBuffer(commandBuffer, 0);
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("failed to begin recording compute command buffer!");
+	}
+
+	_profiler.BeginFrame(commandBuffer, frame);
+	{
+		GpuProfiler::Scope scope(_profiler, commandBuffer, "compute");
+		record(commandBuffer);
+	}
+
+	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to record compute command buffer!");
+	}
+
+	uint32_t slot = static_cast<uint32_t>(_submitted % kMaxLatency);
+
+	// 等待 latency 帧之前的图形提交读完本次要覆盖的资源；链的开头没有可等待的信号
+	VkSemaphore waitSemaphore = VK_NULL_HANDLE;
+	VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+	if (_submitted >= _latency) {
+		waitSemaphore = _graphicsDone[(_submitted - _latency) % kMaxLatency];
+	}
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.waitSemaphoreCount = waitSemaphore != VK_NULL_HANDLE ? 1 : 0;
+	submitInfo.pWaitSemaphores = &waitSemaphore;
+	submitInfo.pWaitDstStageMask = &waitStage;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &_computeDone[slot];
+
+	if (vkQueueSubmit(_queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+		throw std::runtime_error("failed to submit compute command buffer!");
+	}
+	_submitted++;
+}
+
+VkSemaphore AsyncCompute::WaitSemaphore() const
+{
+	return _computeDone[(_submitted + kMaxLatency - 1) % kMaxLatency];
+}
+
+VkSemaphore AsyncCompute::SignalSemaphore() const
+{
+	return _graphicsDone[(_submitted + kMaxLatency - 1) % kMaxLatency];
+}
+
+void AsyncCompute::RecordRelease(VkCommandBuffer commandBuffer, VkBuffer buffer) const
+{
+	if (!IsAsync()) {
+		return;
+	}
+
+	// 释放：dstStage / dstAccess 在释放端被忽略
+	VkBufferMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = 0;
+	barrier.srcQueueFamilyIndex = _computeFamily;
+	barrier.dstQueueFamilyIndex = _graphicsFamily;
+	barrier.buffer = buffer;
+	barrier.offset = 0;
+	barrier.size = VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+		0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+void AsyncCompute::RecordAcquire(VkCommandBuffer commandBuffer, VkBuffer buffer, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) const
+{
+	if (!IsAsync()) {
+		return;
+	}
+
+	// 获取：srcAccess 在获取端被忽略，srcStage 与信号量的等待阶段一致
+	VkBufferMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = dstAccess;
+	barrier.srcQueueFamilyIndex = _computeFamily;
+	barrier.dstQueueFamilyIndex = _graphicsFamily;
+	barrier.buffer = buffer;
+	barrier.offset = 0;
+	barrier.size = VK_WHOLE_SIZE;
+
+	vkCmdPipelineBarrier(commandBuffer, dstStage, dstStage, 0, 0, nullptr, 1, &barrier, 0, nullptr);
+}
+
+void AsyncCompute::SubmitImmediate(const RecordFunc& record)
+{
+	VkCommandBufferAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.commandPool = _commandPool;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandBufferCount = 1;
+
+	VkCommandBuffer commandBuffer;
+	if (vkAllocateCommandBuffers(_device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate compute command buffer!");
+	}
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	record(commandBuffer);
+	vkEndCommandBuffer(commandBuffer);
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+
+	if (vkQueueSubmit(_queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+		throw std::runtime_error("failed to submit compute command buffer!");
+	}
+	vkQueueWaitIdle(_queue);
+
+	vkFreeCommandBuffers(_device, _commandPool, 1, &commandBuffer);
+}
+
+void AsyncCompute::Collect(uint32_t frame)
+{
+	if (_profiler.Collect(frame)) {
+		_timeSumMs += _profiler.LastFrameMs();
+		_timeCount++;
+	}
+}
+
+double AsyncCompute::AverageMs() const
+{
+	return _timeCount > 0 ? _timeSumMs / static_cast<double>(_timeCount) : -1.0;
+}
+
+void AsyncCompute::ResetStats()
+{
+	_timeSumMs = 0.0;
+	_timeCount = 0;
+}
+
+void AsyncCompute::createSemaphores()
+{
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+	for (uint32_t i = 0; i < kMaxLatency; i++) {
+		if (vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &_computeDone[i]) != VK_SUCCESS ||
+			vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &_graphicsDone[i]) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create compute semaphores!");
+		}
+	}
+}
+
+void AsyncCompute::destroySemaphores()
+{
+	for (uint32_t i = 0; i < kMaxLatency; i++) {
+		vkDestroySemaphore(_device, _computeDone[i], nullptr);
+		vkDestroySemaphore(_device, _graphicsDone[i], nullptr);
+		_computeDone[i] = VK_NULL_HANDLE;
+		_graphicsDone[i] = VK_NULL_HANDLE;
+	}
+}
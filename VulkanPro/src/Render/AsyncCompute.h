@@ -0,0 +1,174 @@
+﻿#ifndef ASYNCCOMPUTE_H_
+#define ASYNCCOMPUTE_H_
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "GpuProfiler.h"
+
+/**
+ * @brief 异步计算队列上的逐帧计算任务调度。
+ *
+ * 每帧的计算任务录制到计算队列族自己的命令缓冲中，单独提交到计算队列，与图形队列通过二值信号量同步：
+ *
+ * - 第 N 帧的计算提交触发 WaitSemaphore()，第 N 帧的图形提交等待它后才读取计算结果；
+ * - 第 N 帧的图形提交触发 SignalSemaphore()，第 N + latency 帧的计算提交等待它后才覆盖图形读取过的资源。
+ *
+ * latency 为 2 且计算结果双缓冲时，第 N 帧的计算与第 N - 1 帧的图形在 GPU 上并行执行；
+ * latency 为 1 时两者完全串行，用于对比计算耗时被图形工作掩盖的比例。
+ *
+ * 计算队列族与图形队列族不同时，跨队列使用的资源需要转移所有权：计算端用 RecordRelease() 释放，
+ * 图形端用 RecordAcquire() 获取。内容不需要保留的资源（下一次会被完整覆盖）无需转移，只靠信号量保证执行顺序。
+ * 没有独立的计算队列族时退化为在图形队列上提交，所有权转移为空操作。
+ */
+class AsyncCompute
+{
+public:
+	/**
+	 * @brief 录制回调：将本帧的计算工作写入计算命令缓冲。
+	 */
+	using RecordFunc = std::function<void(VkCommandBuffer commandBuffer)>;
+
+	/**
+	 * @brief 信号量环的长度，也是 latency 的上限。
+	 */
+	static constexpr uint32_t kMaxLatency = 2;
+
+public:
+	AsyncCompute();
+
+	~AsyncCompute();
+
+public:
+	/**
+	 * @brief 创建命令池、每个帧槽位的命令缓冲、同步信号量与计算队列上的 GPU 计时器。
+	 *
+	 * @param physicalDevice 物理设备。
+	 * @param device         逻辑设备。
+	 * @param computeFamily  计算队列族索引。
+	 * @param computeQueue   计算队列（没有独立计算队列族时为图形队列）。
+	 * @param graphicsFamily 图形队列族索引。
+	 * @param frameCount     帧槽位数量（Frames in Flight）。
+	 *
+	 * @throws std::runtime_error 创建失败时抛出。
+	 */
+	void Init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t computeFamily, VkQueue computeQueue,
+		uint32_t graphicsFamily, uint32_t frameCount);
+
+	/**
+	 * @brief 销毁所有资源。调用前 GPU 必须不再使用它们。
+	 */
+	void Destroy();
+
+	/**
+	 * @brief 是否在独立的计算队列族上提交。
+	 */
+	bool IsAsync() const { return _computeFamily != _graphicsFamily; }
+
+	/**
+	 * @brief 计算队列族索引。
+	 */
+	uint32_t QueueFamily() const { return _computeFamily; }
+
+	/**
+	 * @brief 设置计算提交等待的图形帧间隔（1 ~ kMaxLatency），会重新开始信号量链，调用前设备必须空闲。
+	 */
+	void SetLatency(uint32_t latency);
+
+	/**
+	 * @brief 重新开始信号量链：重建所有信号量，丢弃尚未被等待的信号。调用前设备必须空闲。
+	 */
+	void Reset();
+
+	/**
+	 * @brief 下一次提交的序号（自上次 Reset() 起），可用于选择双缓冲的结果。
+	 */
+	uint64_t NextSubmission() const { return _submitted; }
+
+	/**
+	 * @brief 录制并提交一帧的计算工作。帧槽位的栅栏必须已经触发。
+	 *
+	 * 每次提交之后必须紧接着一次等待 WaitSemaphore()、触发 SignalSemaphore() 的图形提交。
+	 *
+	 * @throws std::runtime_error 录制或提交失败时抛出。
+	 */
+	void Submit(uint32_t frame, const RecordFunc& record);
+
+	/**
+	 * @brief 最近一次 Submit() 的计算完成信号量，由同一帧的图形提交等待。
+	 */
+	VkSemaphore WaitSemaphore() const;
+
+	/**
+	 * @brief 最近一次 Submit() 对应的图形完成信号量，由同一帧的图形提交触发。
+	 */
+	VkSemaphore SignalSemaphore() const;
+
+	/**
+	 * @brief 在计算命令缓冲中释放缓冲的所有权给图形队列族（计算着色器写入之后）。
+	 */
+	void RecordRelease(VkCommandBuffer commandBuffer, VkBuffer buffer) const;
+
+	/**
+	 * @brief 在图形命令缓冲中获取缓冲的所有权，之后可在 dstStage 以 dstAccess 访问。
+	 */
+	void RecordAcquire(VkCommandBuffer commandBuffer, VkBuffer buffer, VkPipelineStageFlags dstStage, VkAccessFlags dstAccess) const;
+
+	/**
+	 * @brief 在计算队列上立即执行一段命令并等待完成，用于初始化只由计算队列访问的资源。
+	 *
+	 * @throws std::runtime_error 提交失败时抛出。
+	 */
+	void SubmitImmediate(const RecordFunc& record);
+
+	/**
+	 * @brief 回读帧槽位上一次提交的计算耗时。只应在该槽位的图形栅栏触发后调用。
+	 */
+	void Collect(uint32_t frame);
+
+	/**
+	 * @brief 自上次 ResetStats() 以来计算工作的平均 GPU 耗时（毫秒），不支持时间戳时为负数。
+	 */
+	double AverageMs() const;
+
+	/**
+	 * @brief 清空耗时统计。
+	 */
+	void ResetStats();
+
+private:
+	/**
+	 * @brief 创建信号量环。
+	 */
+	void createSemaphores();
+
+	/**
+	 * @brief 销毁信号量环。
+	 */
+	void destroySemaphores();
+
+private:
+	VkDevice _device = VK_NULL_HANDLE;
+
+	uint32_t _computeFamily = 0;
+	uint32_t _graphicsFamily = 0;
+	VkQueue _queue = VK_NULL_HANDLE;
+
+	VkCommandPool _commandPool = VK_NULL_HANDLE;
+	std::vector<VkCommandBuffer> _commandBuffers;
+
+	// 计算完成 / 图形完成信号量环，按提交序号取模
+	VkSemaphore _computeDone[kMaxLatency] = {};
+	VkSemaphore _graphicsDone[kMaxLatency] = {};
+
+	uint32_t _latency = kMaxLatency;
+	uint64_t _submitted = 0;
+
+	// 计算队列上的时间戳
+	GpuProfiler _profiler;
+	double _timeSumMs = 0.0;
+	uint64_t _timeCount = 0;
+};
+
+#endif    // !ASYNCCOMPUTE_H_
@@ -0,0 +1,39 @@
+﻿#include "DeletionQueue.h"
+
+#include <stdexcept>
+#include <utility>
+
+DeletionQueue::DeletionQueue() {}
+
+DeletionQueue::~DeletionQueue() {}
+
+void DeletionQueue::Push(uint64_t serial, DestroyFunc destroy)
+{
+	if (!_entries.empty() && serial < _entries.back().serial) {
+		throw std::runtime_error("deletion serial must not decrease!");
+	}
+
+	Entry entry;
+	entry.serial = serial;
+	entry.destroy = std::move(destroy);
+	_entries.push_back(std::move(entry));
+}
+
+void DeletionQueue::Collect(uint64_t completedSerial)
+{
+	while (!_entries.empty() && _entries.front().serial <= completedSerial) {
+		// 先出队再执行，回调中再次入队也不会破坏迭代
+		DestroyFunc destroy = std::move(_entries.front().destroy);
+		_entries.pop_front();
+		destroy();
+	}
+}
+
+void DeletionQueue::Flush()
+{
+	while (!_entries.empty()) {
+		DestroyFunc destroy = std::move(_entries.front().destroy);
+		_entries.pop_front();
+		destroy();
+	}
+}
@@ -0,0 +1,63 @@
+﻿#ifndef DELETIONQUEUE_H_
+#define DELETIONQUEUE_H_
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+/**
+ * @brief 按提交序号延迟销毁 Vulkan 对象的队列。
+ *
+ * 每次图形提交对应一个递增的序号。仍可能被在途帧使用的对象以"当前最后一次提交的序号"入队，
+ * 等到该序号的提交完成（对应帧槽位的栅栏触发，或图形时间线达到该值）后再销毁，销毁时不需要 vkDeviceWaitIdle。
+ *
+ * 同一队列上栅栏信号操作的同步范围包含提交顺序更早的所有命令，因此某个帧槽位的栅栏触发时，
+ * 序号不大于该槽位最后一次提交的条目都可以安全销毁。
+ */
+class DeletionQueue
+{
+public:
+	/**
+	 * @brief 销毁回调。
+	 */
+	using DestroyFunc = std::function<void()>;
+
+public:
+	DeletionQueue();
+
+	~DeletionQueue();
+
+public:
+	/**
+	 * @brief 入队一个销毁回调，序号为 serial 的提交完成后执行。
+	 *
+	 * 序号必须单调不减。
+	 */
+	void Push(uint64_t serial, DestroyFunc destroy);
+
+	/**
+	 * @brief 执行序号不大于 completedSerial 的所有销毁回调。
+	 */
+	void Collect(uint64_t completedSerial);
+
+	/**
+	 * @brief 执行所有销毁回调。调用前 GPU 必须已经空闲。
+	 */
+	void Flush();
+
+	/**
+	 * @brief 尚未执行的销毁回调数量。
+	 */
+	size_t PendingCount() const { return _entries.size(); }
+
+private:
+	struct Entry {
+		uint64_t serial = 0;
+		DestroyFunc destroy;
+	};
+
+	// 按序号递增排列，只需从队首检查
+	std::deque<Entry> _entries;
+};
+
+#endif    // !DELETIONQUEUE_H_
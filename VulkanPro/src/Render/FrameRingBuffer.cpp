@@ -0,0 +1,77 @@
+﻿#include "FrameRingBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+FrameRingBuffer::FrameRingBuffer() {}
+
+FrameRingBuffer::~FrameRingBuffer() {}
+
+void FrameRingBuffer::Init(VkPhysicalDevice physicalDevice, GpuAllocator& allocator, VkDeviceSize frameSize, uint32_t frameCount,
+	VkBufferUsageFlags usage)
+{
+	_allocator = &allocator;
+	_frameCount = std::max(1u, frameCount);
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	_uniformAlignment = std::max<VkDeviceSize>(properties.limits.minUniformBufferOffsetAlignment, 1);
+
+	// 分区起点同时满足 uniform 与存储缓冲的偏移对齐，各分区内的对齐计算互不影响
+	VkDeviceSize partitionAlignment = std::max({ _uniformAlignment, properties.limits.minStorageBufferOffsetAlignment, VkDeviceSize(16) });
+	_frameSize = (std::max<VkDeviceSize>(frameSize, 1) + partitionAlignment - 1) / partitionAlignment * partitionAlignment;
+
+	_allocator->CreateBuffer(_frameSize * _frameCount, usage,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, _buffer, _allocation);
+
+	_frameBegin = 0;
+	_head = 0;
+	_peakUsed = 0;
+}
+
+void FrameRingBuffer::Destroy()
+{
+	if (_allocator == nullptr) {
+		return;
+	}
+
+	_allocator->DestroyBuffer(_buffer, _allocation);
+	_allocator = nullptr;
+	_frameSize = 0;
+	_frameCount = 0;
+	_frameBegin = 0;
+	_head = 0;
+}
+
+void FrameRingBuffer::BeginFrame(uint32_t frame)
+{
+	_peakUsed = std::max(_peakUsed, FrameUsed());
+
+	_frameBegin = static_cast<VkDeviceSize>(frame % _frameCount) * _frameSize;
+	_head = _frameBegin;
+}
+
+FrameRingBuffer::Slice FrameRingBuffer::Allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+	alignment = std::max<VkDeviceSize>(alignment, 1);
+	VkDeviceSize offset = (_head + alignment - 1) & ~(alignment - 1);
+	if (offset + size > _frameBegin + _frameSize) {
+		throw std::runtime_error("frame ring buffer overflow!");
+	}
+	_head = offset + size;
+
+	Slice slice;
+	slice.buffer = _buffer;
+	slice.offset = offset;
+	slice.size = size;
+	slice.data = static_cast<char*>(_allocation.mapped) + offset;
+	return slice;
+}
+
+FrameRingBuffer::Slice FrameRingBuffer::Push(const void* data, VkDeviceSize size, VkDeviceSize alignment)
+{
+	Slice slice = Allocate(size, alignment);
+	std::memcpy(slice.data, data, static_cast<size_t>(size));
+	return slice;
+}
@@ -0,0 +1,133 @@
+﻿#ifndef FRAMERINGBUFFER_H_
+#define FRAMERINGBUFFER_H_
+
+#include <cstdint>
+
+#include "GpuAllocator.h"
+
+/**
+ * @brief 持久映射、按帧槽位分区的线性环形缓冲，用于每帧变化的 uniform 与顶点数据。
+ *
+ * 一个主机可见的缓冲平均分成 frameCount 个分区，帧槽位 i 只写分区 i。BeginFrame() 把写入位置重置到
+ * 该分区开头，之后每次 Allocate() 只是对齐并前移写入位置，返回映射地址与缓冲内偏移；没有
+ * vkMapMemory / vkUnmapMemory，也没有每帧的分配与释放。
+ *
+ * 分区的复用由帧槽位的栅栏（或时间线序号）保证：调用 BeginFrame(frame) 时该槽位上一次提交必须已经完成。
+ * uniform 切片按 minUniformBufferOffsetAlignment 对齐，可直接作为 VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC
+ * 的动态偏移使用。
+ */
+class FrameRingBuffer
+{
+public:
+	/**
+	 * @brief 一次分配得到的切片。
+	 */
+	struct Slice {
+		VkBuffer buffer = VK_NULL_HANDLE;
+
+		// 切片在缓冲中的偏移，也是绑定时的动态偏移
+		VkDeviceSize offset = 0;
+
+		VkDeviceSize size = 0;
+
+		// 切片的映射地址，写入后无需刷新（内存为 HOST_COHERENT）
+		void* data = nullptr;
+
+		uint32_t DynamicOffset() const { return static_cast<uint32_t>(offset); }
+	};
+
+public:
+	FrameRingBuffer();
+
+	~FrameRingBuffer();
+
+public:
+	/**
+	 * @brief 创建缓冲并查询对齐要求。
+	 *
+	 * @param physicalDevice 物理设备，用于查询 uniform / 存储缓冲的偏移对齐。
+	 * @param allocator      显存分配器。
+	 * @param frameSize      每个帧槽位可分配的字节数，会向上取整到对齐要求。
+	 * @param frameCount     分区数量，不小于可能使用的最大 Frames in Flight。
+	 * @param usage          缓冲用途（uniform、顶点、索引等）。
+	 *
+	 * @throws std::runtime_error 创建缓冲失败时抛出。
+	 */
+	void Init(VkPhysicalDevice physicalDevice, GpuAllocator& allocator, VkDeviceSize frameSize, uint32_t frameCount,
+		VkBufferUsageFlags usage);
+
+	/**
+	 * @brief 销毁缓冲。调用前 GPU 必须不再使用它。
+	 */
+	void Destroy();
+
+	/**
+	 * @brief 是否已创建。
+	 */
+	bool IsValid() const { return _buffer != VK_NULL_HANDLE; }
+
+	/**
+	 * @brief 开始帧槽位 frame 的分配，丢弃该分区上一轮的内容。该槽位上一次提交必须已经完成。
+	 */
+	void BeginFrame(uint32_t frame);
+
+	/**
+	 * @brief 在当前分区中分配 size 字节，起始偏移按 alignment（2 的幂）对齐。
+	 *
+	 * @throws std::runtime_error 当前分区剩余空间不足时抛出。
+	 */
+	Slice Allocate(VkDeviceSize size, VkDeviceSize alignment);
+
+	/**
+	 * @brief 分配一个 uniform 切片，按 minUniformBufferOffsetAlignment 对齐。
+	 */
+	Slice AllocateUniform(VkDeviceSize size) { return Allocate(size, _uniformAlignment); }
+
+	/**
+	 * @brief 分配并写入 data，返回切片。
+	 */
+	Slice Push(const void* data, VkDeviceSize size, VkDeviceSize alignment);
+
+	/**
+	 * @brief 环形缓冲本身，描述符与顶点绑定都指向它。
+	 */
+	VkBuffer Buffer() const { return _buffer; }
+
+	/**
+	 * @brief uniform 切片的偏移对齐（minUniformBufferOffsetAlignment）。
+	 */
+	VkDeviceSize UniformAlignment() const { return _uniformAlignment; }
+
+	/**
+	 * @brief 每个分区的字节数。
+	 */
+	VkDeviceSize FrameSize() const { return _frameSize; }
+
+	/**
+	 * @brief 当前帧已分配的字节数（含对齐填充）。
+	 */
+	VkDeviceSize FrameUsed() const { return _head - _frameBegin; }
+
+	/**
+	 * @brief 单帧分配量的历史峰值。
+	 */
+	VkDeviceSize PeakUsed() const { return _peakUsed; }
+
+private:
+	GpuAllocator* _allocator = nullptr;
+
+	VkBuffer _buffer = VK_NULL_HANDLE;
+	GpuAllocation _allocation;
+
+	VkDeviceSize _uniformAlignment = 1;
+	VkDeviceSize _frameSize = 0;
+	uint32_t _frameCount = 0;
+
+	// 当前分区的起点与写入位置（缓冲内偏移）
+	VkDeviceSize _frameBegin = 0;
+	VkDeviceSize _head = 0;
+
+	VkDeviceSize _peakUsed = 0;
+};
+
+#endif    // !FRAMERINGBUFFER_H_
@@ -0,0 +1,381 @@
+﻿#include "GpuAllocator.h"
+
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+	// 堆小于该大小时内存块缩小为堆的 1/8，避免一个块占满整个堆
+	constexpr VkDeviceSize kSmallHeapLimit = 1024ull * 1024 * 1024;
+
+	VkDeviceSize alignUp(VkDeviceSize value, VkDeviceSize alignment)
+	{
+		return alignment > 1 ? (value + alignment - 1) / alignment * alignment : value;
+	}
+}
+
+GpuAllocator::GpuAllocator() {}
+
+GpuAllocator::~GpuAllocator() {}
+
+void GpuAllocator::Init(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize)
+{
+	_device = device;
+	vkGetPhysicalDeviceMemoryProperties(physicalDevice, &_memoryProperties);
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	_bufferImageGranularity = std::max<VkDeviceSize>(properties.limits.bufferImageGranularity, 1);
+
+	// 每种内存类型两个池：线性资源与非线性资源
+	_pools.clear();
+	_pools.resize(static_cast<size_t>(_memoryProperties.memoryTypeCount) * 2);
+	for (uint32_t type = 0; type < _memoryProperties.memoryTypeCount; type++) {
+		VkDeviceSize heapSize = _memoryProperties.memoryHeaps[_memoryProperties.memoryTypes[type].heapIndex].size;
+		VkDeviceSize size = heapSize < kSmallHeapLimit ? std::min(blockSize, heapSize / 8) : blockSize;
+
+		for (uint32_t kind = 0; kind < 2; kind++) {
+			_pools[type * 2 + kind].memoryType = type;
+			_pools[type * 2 + kind].blockSize = size;
+		}
+	}
+}
+
+void GpuAllocator::Destroy()
+{
+	if (_device == VK_NULL_HANDLE) {
+		return;
+	}
+
+	if (_allocationCount != 0) {
+		std::cerr << "GpuAllocator: 销毁时仍有 " << _allocationCount << " 个分配未释放" << std::endl;
+	}
+
+	// vkFreeMemory 会隐式解除映射
+	for (auto& pool : _pools) {
+		for (auto& block : pool.blocks) {
+			if (block) {
+				vkFreeMemory(_device, block->memory, nullptr);
+			}
+		}
+	}
+	for (const auto& dedicated : _dedicated) {
+		vkFreeMemory(_device, dedicated.first, nullptr);
+	}
+
+	_pools.clear();
+	_dedicated.clear();
+	_allocationCount = 0;
+	_bytesUsed = 0;
+	_bytesWasted = 0;
+	_device = VK_NULL_HANDLE;
+}
+
+GpuAllocation GpuAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear)
+{
+	uint32_t memoryType = FindMemoryType(requirements.memoryTypeBits, properties);
+	uint32_t index = poolIndex(memoryType, linear);
+	Pool& pool = _pools[index];
+
+	GpuAllocation allocation;
+	allocation.pool = index;
+
+	// 大资源独占一块内存，避免一个资源撑满整个内存块
+	if (requirements.size > pool.blockSize / 2) {
+		char* mapped = nullptr;
+		allocation.memory = allocateDeviceMemory(memoryType, requirements.size, &mapped);
+		allocation.offset = 0;
+		allocation.size = requirements.size;
+		allocation.mapped = mapped;
+		allocation.block = UINT32_MAX;
+		allocation.rangeSize = requirements.size;
+		_dedicated[allocation.memory] = requirements.size;
+	}
+	else {
+		bool found = false;
+		for (size_t i = 0; i < pool.blocks.size() && !found; i++) {
+			if (pool.blocks[i] && allocateFromBlock(*pool.blocks[i], requirements.size, requirements.alignment, allocation)) {
+				allocation.block = static_cast<uint32_t>(i);
+				found = true;
+			}
+		}
+
+		if (!found) {
+			// 现有内存块都放不下，新建一块（复用已释放的槽位，保持其他分配的块索引不变）
+			auto block = std::make_unique<Block>();
+			block->size = pool.blockSize;
+			block->memory = allocateDeviceMemory(memoryType, block->size, &block->mapped);
+			insertFreeRange(*block, 0, block->size);
+
+			auto slot = std::find(pool.blocks.begin(), pool.blocks.end(), nullptr);
+			if (slot == pool.blocks.end()) {
+				slot = pool.blocks.insert(pool.blocks.end(), nullptr);
+			}
+			*slot = std::move(block);
+
+			allocateFromBlock(**slot, requirements.size, requirements.alignment, allocation);
+			allocation.block = static_cast<uint32_t>(slot - pool.blocks.begin());
+		}
+	}
+
+	_allocationCount++;
+	_bytesUsed += allocation.size;
+	_bytesWasted += allocation.rangeSize - allocation.size;
+	return allocation;
+}
+
+void GpuAllocator::Free(GpuAllocation& allocation)
+{
+	if (allocation.memory == VK_NULL_HANDLE) {
+		return;
+	}
+
+	_allocationCount--;
+	_bytesUsed -= allocation.size;
+	_bytesWasted -= allocation.rangeSize - allocation.size;
+
+	if (allocation.block == UINT32_MAX) {
+		_dedicated.erase(allocation.memory);
+		vkFreeMemory(_device, allocation.memory, nullptr);
+		allocation = GpuAllocation();
+		return;
+	}
+
+	Pool& pool = _pools[allocation.pool];
+	Block& block = *pool.blocks[allocation.block];
+	insertFreeRange(block, allocation.rangeOffset, allocation.rangeSize);
+	block.allocationCount--;
+
+	// 块已完全空闲：池中若还有其他空块则立即归还，否则保留一块以免反复申请
+	if (block.allocationCount == 0) {
+		bool hasOtherEmpty = std::any_of(pool.blocks.begin(), pool.blocks.end(), [&](const std::unique_ptr<Block>& other) {
+			return other && other.get() != &block && other->allocationCount == 0;
+		});
+		if (hasOtherEmpty) {
+			vkFreeMemory(_device, block.memory, nullptr);
+			pool.blocks[allocation.block].reset();
+		}
+	}
+
+	allocation = GpuAllocation();
+}
+
+void GpuAllocator::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+	VkBuffer& buffer, GpuAllocation& allocation)
+{
+	VkBufferCreateInfo bufferInfo{};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = size;
+	bufferInfo.usage = usage;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+
+	if (vkCreateBuffer(_device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create buffer!");
+	}
+
+	VkMemoryRequirements memRequirements;
+	vkGetBufferMemoryRequirements(_device, buffer, &memRequirements);
+
+	allocation = Allocate(memRequirements, properties, true);
+	vkBindBufferMemory(_device, buffer, allocation.memory, allocation.offset);
+}
+
+void GpuAllocator::CreateImage(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties,
+	VkImage& image, GpuAllocation& allocation)
+{
+	if (vkCreateImage(_device, &imageInfo, nullptr, &image) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create image!");
+	}
+
+	VkMemoryRequirements memRequirements;
+	vkGetImageMemoryRequirements(_device, image, &memRequirements);
+
+	allocation = Allocate(memRequirements, properties, imageInfo.tiling == VK_IMAGE_TILING_LINEAR);
+	vkBindImageMemory(_device, image, allocation.memory, allocation.offset);
+}
+
+void GpuAllocator::DestroyBuffer(VkBuffer& buffer, GpuAllocation& allocation)
+{
+	if (buffer != VK_NULL_HANDLE) {
+		vkDestroyBuffer(_device, buffer, nullptr);
+		buffer = VK_NULL_HANDLE;
+	}
+	Free(allocation);
+}
+
+void GpuAllocator::DestroyImage(VkImage& image, GpuAllocation& allocation)
+{
+	if (image != VK_NULL_HANDLE) {
+		vkDestroyImage(_device, image, nullptr);
+		image = VK_NULL_HANDLE;
+	}
+	Free(allocation);
+}
+
+uint32_t GpuAllocator::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+{
+	for (uint32_t i = 0; i < _memoryProperties.memoryTypeCount; i++) {
+		if ((typeFilter & (1 << i)) && (_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+			return i;
+		}
+	}
+
+	throw std::runtime_error("failed to find suitable memory type!");
+}
+
+GpuAllocatorStats GpuAllocator::GetStats() const
+{
+	GpuAllocatorStats stats;
+	stats.dedicatedCount = static_cast<uint32_t>(_dedicated.size());
+	stats.allocationCount = _allocationCount;
+	stats.deviceAllocations = _deviceAllocations;
+	stats.bytesUsed = _bytesUsed;
+	stats.bytesWasted = _bytesWasted;
+
+	// 块内除最大空闲区间以外的空闲字节，视为碎片
+	VkDeviceSize fragmentedBytes = 0;
+	for (const auto& pool : _pools) {
+		for (const auto& block : pool.blocks) {
+			if (!block) {
+				continue;
+			}
+			stats.blockCount++;
+			stats.bytesReserved += block->size;
+
+			VkDeviceSize blockFree = 0;
+			for (const auto& range : block->freeByOffset) {
+				blockFree += range.second;
+			}
+			VkDeviceSize blockLargest = block->freeBySize.empty() ? 0 : block->freeBySize.rbegin()->first;
+
+			stats.bytesFree += blockFree;
+			stats.largestFreeRange = std::max(stats.largestFreeRange, blockLargest);
+			fragmentedBytes += blockFree - blockLargest;
+		}
+	}
+	if (stats.bytesFree > 0) {
+		stats.fragmentation = static_cast<double>(fragmentedBytes) / static_cast<double>(stats.bytesFree);
+	}
+	for (const auto& dedicated : _dedicated) {
+		stats.bytesReserved += dedicated.second;
+	}
+
+	return stats;
+}
+
+std::string GpuAllocator::StatsJson() const
+{
+	GpuAllocatorStats stats = GetStats();
+
+	std::ostringstream out;
+	out << "{\"blocks\":" << stats.blockCount
+		<< ",\"dedicated\":" << stats.dedicatedCount
+		<< ",\"allocations\":" << stats.allocationCount
+		<< ",\"device_allocations\":" << stats.deviceAllocations
+		<< ",\"reserved_bytes\":" << stats.bytesReserved
+		<< ",\"used_bytes\":" << stats.bytesUsed
+		<< ",\"wasted_bytes\":" << stats.bytesWasted
+		<< ",\"free_bytes\":" << stats.bytesFree
+		<< ",\"largest_free_range\":" << stats.largestFreeRange
+		<< ",\"fragmentation\":" << stats.fragmentation
+		<< "}";
+	return out.str();
+}
+
+bool GpuAllocator::allocateFromBlock(Block& block, VkDeviceSize size, VkDeviceSize alignment, GpuAllocation& allocation)
+{
+	// 从不小于 size 的最小空闲区间开始查找，对齐填充放不下时继续尝试更大的区间
+	for (auto it = block.freeBySize.lower_bound({ size, 0 }); it != block.freeBySize.end(); ++it) {
+		VkDeviceSize rangeOffset = it->second;
+		VkDeviceSize rangeSize = it->first;
+		VkDeviceSize offset = alignUp(rangeOffset, alignment);
+		if (offset + size > rangeOffset + rangeSize) {
+			continue;
+		}
+
+		eraseFreeRange(block, block.freeByOffset.find(rangeOffset));
+
+		// 头部的对齐填充计入本次分配（浪费），尾部剩余部分放回空闲链表
+		VkDeviceSize used = offset + size - rangeOffset;
+		if (used < rangeSize) {
+			insertFreeRange(block, rangeOffset + used, rangeSize - used);
+		}
+
+		allocation.memory = block.memory;
+		allocation.offset = offset;
+		allocation.size = size;
+		allocation.mapped = block.mapped ? block.mapped + offset : nullptr;
+		allocation.rangeOffset = rangeOffset;
+		allocation.rangeSize = used;
+		block.allocationCount++;
+		return true;
+	}
+
+	return false;
+}
+
+VkDeviceMemory GpuAllocator::allocateDeviceMemory(uint32_t memoryType, VkDeviceSize size, char** mapped)
+{
+	VkMemoryAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocInfo.allocationSize = size;
+	allocInfo.memoryTypeIndex = memoryType;
+
+	VkDeviceMemory memory;
+	if (vkAllocateMemory(_device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate device memory!");
+	}
+	_deviceAllocations++;
+
+	// 主机可见内存整块持久映射
+	*mapped = nullptr;
+	if (_memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT) {
+		void* data;
+		if (vkMapMemory(_device, memory, 0, VK_WHOLE_SIZE, 0, &data) != VK_SUCCESS) {
+			vkFreeMemory(_device, memory, nullptr);
+			throw std::runtime_error("failed to map device memory!");
+		}
+		*mapped = static_cast<char*>(data);
+	}
+
+	return memory;
+}
+
+void GpuAllocator::insertFreeRange(Block& block, VkDeviceSize offset, VkDeviceSize size)
+{
+	auto next = block.freeByOffset.lower_bound(offset);
+
+	// 与前一个空闲区间相邻则合并
+	if (next != block.freeByOffset.begin()) {
+		auto prev = std::prev(next);
+		if (prev->first + prev->second == offset) {
+			offset = prev->first;
+			size += prev->second;
+			eraseFreeRange(block, prev);
+		}
+	}
+
+	// 与后一个空闲区间相邻则合并
+	if (next != block.freeByOffset.end() && offset + size == next->first) {
+		size += next->second;
+		eraseFreeRange(block, next);
+	}
+
+	block.freeByOffset[offset] = size;
+	block.freeBySize.insert({ size, offset });
+}
+
+void GpuAllocator::eraseFreeRange(Block& block, std::map<VkDeviceSize, VkDeviceSize>::iterator it)
+{
+	block.freeBySize.erase({ it->second, it->first });
+	block.freeByOffset.erase(it);
+}
+
+uint32_t GpuAllocator::poolIndex(uint32_t memoryType, bool linear) const
+{
+	// granularity 为 1 时线性与非线性资源可以安全相邻，共用同一个池
+	bool separate = _bufferImageGranularity > 1;
+	return memoryType * 2 + ((separate && !linear) ? 1 : 0);
+}
@@ -0,0 +1,251 @@
+﻿#ifndef GPUALLOCATOR_H_
+#define GPUALLOCATOR_H_
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "vulkan/vulkan.h"
+
+/**
+ * @brief 一次显存分配的结果，由 GpuAllocator 创建和回收。
+ *
+ * 资源应绑定到 memory 的 offset 处；主机可见内存的 mapped 指向该偏移处的持久映射地址。
+ */
+struct GpuAllocation {
+	// 所在的 VkDeviceMemory（内存块或独占分配）
+	VkDeviceMemory memory = VK_NULL_HANDLE;
+
+	// 资源在 memory 中的起始偏移（已按要求对齐）
+	VkDeviceSize offset = 0;
+
+	// 资源请求的大小（字节）
+	VkDeviceSize size = 0;
+
+	// 主机可见内存的映射地址（已加上 offset），其他内存为 nullptr
+	void* mapped = nullptr;
+
+	// 内部使用：所属内存池与内存块，独占分配时 block 为 UINT32_MAX
+	uint32_t pool = 0;
+	uint32_t block = UINT32_MAX;
+
+	// 内部使用：在内存块中实际占用的区间（含对齐填充）
+	VkDeviceSize rangeOffset = 0;
+	VkDeviceSize rangeSize = 0;
+};
+
+/**
+ * @brief 分配器统计信息。
+ */
+struct GpuAllocatorStats {
+	// 内存块数量（不含独占分配）
+	uint32_t blockCount = 0;
+
+	// 独占分配数量
+	uint32_t dedicatedCount = 0;
+
+	// 当前存活的分配数量（含独占分配）
+	uint32_t allocationCount = 0;
+
+	// 累计调用 vkAllocateMemory 的次数
+	uint64_t deviceAllocations = 0;
+
+	// 向驱动申请的总字节数（内存块 + 独占分配）
+	VkDeviceSize bytesReserved = 0;
+
+	// 资源实际请求的字节数
+	VkDeviceSize bytesUsed = 0;
+
+	// 对齐填充浪费的字节数
+	VkDeviceSize bytesWasted = 0;
+
+	// 内存块中的空闲字节数
+	VkDeviceSize bytesFree = 0;
+
+	// 最大的连续空闲区间
+	VkDeviceSize largestFreeRange = 0;
+
+	/**
+	 * @brief 碎片率：各内存块中不属于该块最大空闲区间的空闲字节占总空闲字节的比例，
+	 *        0 表示每个块的空闲空间都是连续的。
+	 */
+	double fragmentation = 0.0;
+};
+
+/**
+ * @brief 子分配的 GPU 显存分配器。
+ *
+ * 每种内存类型预先申请大块 VkDeviceMemory（内存块），缓冲与图像在块内按最佳适配的空闲链表子分配，
+ * 释放时与相邻空闲区间合并。超过块大小一半的资源单独调用 vkAllocateMemory（独占分配）。
+ *
+ * - 线性资源（缓冲、线性图像）与非线性资源（OPTIMAL 图像）在 bufferImageGranularity > 1 时
+ *   放在不同的内存块中，从而不会出现两者相邻于同一 granularity 页内的情况。
+ * - 主机可见的内存块在创建时整块映射，分配结果直接给出映射地址，无需逐次 vkMapMemory。
+ * - 完全空闲的内存块每个内存池最多保留一个，其余立即归还驱动。
+ */
+class GpuAllocator
+{
+public:
+	GpuAllocator();
+
+	~GpuAllocator();
+
+public:
+	/**
+	 * @brief 初始化分配器。
+	 *
+	 * @param physicalDevice 物理设备，用于查询内存类型与 bufferImageGranularity。
+	 * @param device         逻辑设备。
+	 * @param blockSize      默认内存块大小（字节），小于 1 GiB 的堆会自动缩小为堆大小的 1/8。
+	 */
+	void Init(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize = 64ull * 1024 * 1024);
+
+	/**
+	 * @brief 释放所有内存块与独占分配，调用前所有资源必须已经销毁。
+	 */
+	void Destroy();
+
+	/**
+	 * @brief 按内存需求分配显存。
+	 *
+	 * @param requirements 资源的内存需求（大小、对齐、可用内存类型）。
+	 * @param properties   需要的内存属性。
+	 * @param linear       是否为线性资源（缓冲或线性图像）。
+	 * @return GpuAllocation 分配结果。
+	 *
+	 * @throws std::runtime_error 找不到合适的内存类型或 vkAllocateMemory 失败时抛出。
+	 */
+	GpuAllocation Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties, bool linear);
+
+	/**
+	 * @brief 归还一次分配，并将 allocation 重置为空。空分配直接忽略。
+	 */
+	void Free(GpuAllocation& allocation);
+
+	/**
+	 * @brief 创建缓冲并为其分配、绑定显存。
+	 *
+	 * @throws std::runtime_error 创建或分配失败时抛出。
+	 */
+	void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties,
+		VkBuffer& buffer, GpuAllocation& allocation);
+
+	/**
+	 * @brief 创建图像并为其分配、绑定显存。
+	 *
+	 * @throws std::runtime_error 创建或分配失败时抛出。
+	 */
+	void CreateImage(const VkImageCreateInfo& imageInfo, VkMemoryPropertyFlags properties,
+		VkImage& image, GpuAllocation& allocation);
+
+	/**
+	 * @brief 销毁缓冲并归还其显存。
+	 */
+	void DestroyBuffer(VkBuffer& buffer, GpuAllocation& allocation);
+
+	/**
+	 * @brief 销毁图像并归还其显存。
+	 */
+	void DestroyImage(VkImage& image, GpuAllocation& allocation);
+
+	/**
+	 * @brief 查找满足属性要求的内存类型索引。
+	 *
+	 * @throws std::runtime_error 找不到时抛出。
+	 */
+	uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+	/**
+	 * @brief 汇总当前统计信息。
+	 */
+	GpuAllocatorStats GetStats() const;
+
+	/**
+	 * @brief 以 JSON 对象形式输出统计信息，便于写入基准测试报告。
+	 */
+	std::string StatsJson() const;
+
+private:
+	/**
+	 * @brief 一个大块 VkDeviceMemory 及其空闲区间。
+	 *
+	 * 空闲区间同时按偏移（用于合并相邻区间）与按大小（用于最佳适配查找）索引。
+	 */
+	struct Block {
+		VkDeviceMemory memory = VK_NULL_HANDLE;
+		VkDeviceSize size = 0;
+		char* mapped = nullptr;
+
+		// 偏移 -> 大小
+		std::map<VkDeviceSize, VkDeviceSize> freeByOffset;
+
+		// (大小, 偏移)
+		std::set<std::pair<VkDeviceSize, VkDeviceSize>> freeBySize;
+
+		// 块内存活的分配数量
+		uint32_t allocationCount = 0;
+	};
+
+	/**
+	 * @brief 同一内存类型、同一资源类别的内存块集合。
+	 */
+	struct Pool {
+		uint32_t memoryType = 0;
+		VkDeviceSize blockSize = 0;
+		std::vector<std::unique_ptr<Block>> blocks;
+	};
+
+	/**
+	 * @brief 在内存块中按最佳适配查找可容纳 size 字节（按 alignment 对齐）的空闲区间。
+	 *
+	 * @return true 分配成功，结果写入 allocation。
+	 */
+	bool allocateFromBlock(Block& block, VkDeviceSize size, VkDeviceSize alignment, GpuAllocation& allocation);
+
+	/**
+	 * @brief 向驱动申请一块内存，主机可见时同时整块映射。
+	 *
+	 * @throws std::runtime_error vkAllocateMemory 失败时抛出。
+	 */
+	VkDeviceMemory allocateDeviceMemory(uint32_t memoryType, VkDeviceSize size, char** mapped);
+
+	/**
+	 * @brief 将区间插入空闲链表，并与前后相邻的空闲区间合并。
+	 */
+	static void insertFreeRange(Block& block, VkDeviceSize offset, VkDeviceSize size);
+
+	/**
+	 * @brief 从空闲链表中移除一个区间。
+	 */
+	static void eraseFreeRange(Block& block, std::map<VkDeviceSize, VkDeviceSize>::iterator it);
+
+	/**
+	 * @brief 计算内存池索引：每种内存类型两个池，分别存放线性与非线性资源。
+	 */
+	uint32_t poolIndex(uint32_t memoryType, bool linear) const;
+
+private:
+	VkDevice _device = VK_NULL_HANDLE;
+
+	VkPhysicalDeviceMemoryProperties _memoryProperties{};
+
+	// 线性与非线性资源之间需要满足的间隔
+	VkDeviceSize _bufferImageGranularity = 1;
+
+	std::vector<Pool> _pools;
+
+	// 独占分配：memory -> 大小
+	std::map<VkDeviceMemory, VkDeviceSize> _dedicated;
+
+	// 统计
+	uint32_t _allocationCount = 0;
+	uint64_t _deviceAllocations = 0;
+	VkDeviceSize _bytesUsed = 0;
+	VkDeviceSize _bytesWasted = 0;
+};
+
+#endif    // !GPUALLOCATOR_H_
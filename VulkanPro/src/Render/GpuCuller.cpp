@@ -0,0 +1,234 @@
+﻿#include "GpuCuller.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+GpuCuller::GpuCuller() {}
+
+GpuCuller::~GpuCuller() {}
+
+void GpuCuller::Init(VkPhysicalDevice physicalDevice, VkDevice device, GpuAllocator& allocator, VkPipelineCache pipelineCache,
+	VkShaderModule shader, uint32_t maxObjects, bool drawIndirectCount, bool multiDrawIndirect)
+{
+	_device = device;
+	_allocator = &allocator;
+	_maxObjects = maxObjects;
+	_objectCount = 0;
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	_maxDrawCount = multiDrawIndirect ? std::max(1u, properties.limits.maxDrawIndirectCount) : 1;
+
+	// 线程组数量超出限制时无法一次派发
+	uint64_t groups = (static_cast<uint64_t>(maxObjects) + kGroupSize - 1) / kGroupSize;
+	if (groups > properties.limits.maxComputeWorkGroupCount[0]) {
+		throw std::runtime_error("too many objects for GPU culling!");
+	}
+
+	// 计数缓冲中的数量同样受 maxDrawIndirectCount 限制，超出时退回固定槽位的方式
+	_drawIndexedIndirectCount = nullptr;
+	if (drawIndirectCount && maxObjects <= properties.limits.maxDrawIndirectCount) {
+		_drawIndexedIndirectCount = (PFN_vkCmdDrawIndexedIndirectCountKHR)vkGetDeviceProcAddr(device, "vkCmdDrawIndexedIndirectCountKHR");
+	}
+
+	createPipeline(pipelineCache, shader);
+	createDescriptorSet();
+
+	VkDeviceSize commandSize = static_cast<VkDeviceSize>(std::max(1u, maxObjects)) * sizeof(VkDrawIndexedIndirectCommand);
+	_allocator->CreateBuffer(commandSize, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _commandBuffer, _commandAllocation);
+	_allocator->CreateBuffer(sizeof(uint32_t), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _countBuffer, _countAllocation);
+
+	VkDescriptorBufferInfo commandInfo{ _commandBuffer, 0, VK_WHOLE_SIZE };
+	VkDescriptorBufferInfo countInfo{ _countBuffer, 0, VK_WHOLE_SIZE };
+
+	VkWriteDescriptorSet writes[2]{};
+	for (uint32_t i = 0; i < 2; i++) {
+		writes[i].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		writes[i].dstSet = _descriptorSet;
+		writes[i].dstBinding = i + 1;
+		writes[i].descriptorCount = 1;
+		writes[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	}
+	writes[0].pBufferInfo = &commandInfo;
+	writes[1].pBufferInfo = &countInfo;
+	vkUpdateDescriptorSets(_device, 2, writes, 0, nullptr);
+}
+
+void GpuCuller::Destroy()
+{
+	if (_allocator == nullptr) {
+		return;
+	}
+
+	_allocator->DestroyBuffer(_commandBuffer, _commandAllocation);
+	_allocator->DestroyBuffer(_countBuffer, _countAllocation);
+
+	// 销毁描述符池会一并释放其中的描述符集
+	vkDestroyDescriptorPool(_device, _descriptorPool, nullptr);
+	vkDestroyPipeline(_device, _pipeline, nullptr);
+	vkDestroyPipelineLayout(_device, _pipelineLayout, nullptr);
+	vkDestroyDescriptorSetLayout(_device, _setLayout, nullptr);
+
+	_descriptorPool = VK_NULL_HANDLE;
+	_descriptorSet = VK_NULL_HANDLE;
+	_pipeline = VK_NULL_HANDLE;
+	_pipelineLayout = VK_NULL_HANDLE;
+	_setLayout = VK_NULL_HANDLE;
+	_drawIndexedIndirectCount = nullptr;
+	_objectCount = 0;
+	_allocator = nullptr;
+}
+
+void GpuCuller::SetObjects(VkBuffer objectBuffer, uint32_t objectCount)
+{
+	_objectCount = std::min(objectCount, _maxObjects);
+
+	VkDescriptorBufferInfo objectInfo{ objectBuffer, 0, VK_WHOLE_SIZE };
+
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = _descriptorSet;
+	write.dstBinding = 0;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	write.pBufferInfo = &objectInfo;
+	vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
+}
+
+void GpuCuller::RecordCull(VkCommandBuffer commandBuffer, const float viewRect[4], uint32_t indexCount, float meshRadius)
+{
+	if (_objectCount == 0) {
+		return;
+	}
+
+	// 前一帧的间接绘制可能仍在读取命令与计数缓冲（同一队列），覆盖前先等待（读后写，只需执行依赖）
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 0, nullptr, 0, nullptr, 0, nullptr);
+
+	VkMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+
+	if (UsesDrawCount()) {
+		vkCmdFillBuffer(commandBuffer, _countBuffer, 0, sizeof(uint32_t), 0);
+
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+			1, &barrier, 0, nullptr, 0, nullptr);
+	}
+
+	CullParams params{};
+	std::copy(viewRect, viewRect + 4, params.viewRect);
+	params.objectCount = _objectCount;
+	params.indexCount = indexCount;
+	params.meshRadius = meshRadius;
+	params.compact = UsesDrawCount() ? 1 : 0;
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pipelineLayout, 0, 1, &_descriptorSet, 0, nullptr);
+	vkCmdPushConstants(commandBuffer, _pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullParams), &params);
+	vkCmdDispatch(commandBuffer, (_objectCount + kGroupSize - 1) / kGroupSize, 1, 1);
+
+	// 计算着色器写入的命令与计数在间接绘制阶段读取
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT, 0,
+		1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void GpuCuller::RecordDraw(VkCommandBuffer commandBuffer) const
+{
+	if (_objectCount == 0) {
+		return;
+	}
+
+	const uint32_t stride = sizeof(VkDrawIndexedIndirectCommand);
+	if (UsesDrawCount()) {
+		_drawIndexedIndirectCount(commandBuffer, _commandBuffer, 0, _countBuffer, 0, _objectCount, stride);
+		return;
+	}
+
+	// 固定槽位：按 maxDrawIndirectCount 分批提交全部槽位
+	for (uint32_t first = 0; first < _objectCount; first += _maxDrawCount) {
+		uint32_t count = std::min(_maxDrawCount, _objectCount - first);
+		vkCmdDrawIndexedIndirect(commandBuffer, _commandBuffer, static_cast<VkDeviceSize>(first) * stride, count, stride);
+	}
+}
+
+void GpuCuller::createPipeline(VkPipelineCache pipelineCache, VkShaderModule shader)
+{
+	// 绑定 0：对象列表，绑定 1：间接绘制命令，绑定 2：可见数量
+	VkDescriptorSetLayoutBinding bindings[3]{};
+	for (uint32_t i = 0; i < 3; i++) {
+		bindings[i].binding = i;
+		bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[i].descriptorCount = 1;
+		bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = 3;
+	layoutInfo.pBindings = bindings;
+
+	if (vkCreateDescriptorSetLayout(_device, &layoutInfo, nullptr, &_setLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create culling descriptor set layout!");
+	}
+
+	VkPushConstantRange pushRange{};
+	pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushRange.offset = 0;
+	pushRange.size = sizeof(CullParams);
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = 1;
+	pipelineLayoutInfo.pSetLayouts = &_setLayout;
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pPushConstantRanges = &pushRange;
+
+	if (vkCreatePipelineLayout(_device, &pipelineLayoutInfo, nullptr, &_pipelineLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create culling pipeline layout!");
+	}
+
+	VkComputePipelineCreateInfo pipelineInfo{};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineInfo.stage.module = shader;
+	pipelineInfo.stage.pName = "main";
+	pipelineInfo.layout = _pipelineLayout;
+
+	if (vkCreateComputePipelines(_device, pipelineCache, 1, &pipelineInfo, nullptr, &_pipeline) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create culling pipeline!");
+	}
+}
+
+void GpuCuller::createDescriptorSet()
+{
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSize.descriptorCount = 3;
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.maxSets = 1;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+
+	if (vkCreateDescriptorPool(_device, &poolInfo, nullptr, &_descriptorPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create culling descriptor pool!");
+	}
+
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = _descriptorPool;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &_setLayout;
+
+	if (vkAllocateDescriptorSets(_device, &allocInfo, &_descriptorSet) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate culling descriptor set!");
+	}
+}
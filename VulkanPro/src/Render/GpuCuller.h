@@ -0,0 +1,145 @@
+﻿#ifndef GPUCULLER_H_
+#define GPUCULLER_H_
+
+#include <cstdint>
+
+#include "GpuAllocator.h"
+
+/**
+ * @brief 计算着色器视锥剔除 + 间接绘制（GPU 驱动渲染）。
+ *
+ * 对象列表（实例数据）以存储缓冲的形式交给计算着色器，每个线程测试一个对象的包围圆是否与视口矩形相交，
+ * 可见对象以 VkDrawIndexedIndirectCommand 写入间接绘制缓冲（firstInstance 为对象索引）。
+ * 无论对象有多少，CPU 每帧只录制一次 vkCmdDispatch 与一次间接绘制。
+ *
+ * - 支持 VK_KHR_draw_indirect_count 时：命令紧凑排列，可见数量写入计数缓冲，由 vkCmdDrawIndexedIndirectCountKHR 读取。
+ * - 否则：每个对象占据固定槽位，不可见对象的 instanceCount 为 0，以最大数量调用 vkCmdDrawIndexedIndirect；
+ *   不支持 multiDrawIndirect 时逐条调用。
+ */
+class GpuCuller
+{
+public:
+	/**
+	 * @brief 计算着色器的推送常量，布局与 cull.comp 中的 CullParams 一致。
+	 */
+	struct CullParams {
+		// 视口矩形：最小 x、最小 y、最大 x、最大 y
+		float viewRect[4];
+
+		// 对象数量
+		uint32_t objectCount;
+
+		// 每个对象绘制的索引数
+		uint32_t indexCount;
+
+		// 网格的包围圆半径（乘以对象缩放得到对象半径）
+		float meshRadius;
+
+		// 非 0 时紧凑输出并累加计数
+		uint32_t compact;
+	};
+
+	/**
+	 * @brief 每个线程组的线程数，与 cull.comp 中的 local_size_x 一致。
+	 */
+	static constexpr uint32_t kGroupSize = 64;
+
+public:
+	GpuCuller();
+
+	~GpuCuller();
+
+public:
+	/**
+	 * @brief 创建剔除管线、描述符与间接绘制缓冲。
+	 *
+	 * @param physicalDevice       物理设备，用于查询间接绘制相关的限制与特性。
+	 * @param device               逻辑设备。
+	 * @param allocator            显存分配器。
+	 * @param pipelineCache        管线缓存。
+	 * @param shader               剔除计算着色器模块，调用方在 Init() 返回后即可销毁。
+	 * @param maxObjects           最大对象数量。
+	 * @param drawIndirectCount    设备是否启用了 VK_KHR_draw_indirect_count。
+	 * @param multiDrawIndirect    设备是否启用了 multiDrawIndirect 特性。
+	 *
+	 * @throws std::runtime_error 创建失败时抛出。
+	 */
+	void Init(VkPhysicalDevice physicalDevice, VkDevice device, GpuAllocator& allocator, VkPipelineCache pipelineCache,
+		VkShaderModule shader, uint32_t maxObjects, bool drawIndirectCount, bool multiDrawIndirect);
+
+	/**
+	 * @brief 销毁所有资源。调用前 GPU 必须不再使用它们。
+	 */
+	void Destroy();
+
+	/**
+	 * @brief 是否已创建。
+	 */
+	bool IsValid() const { return _pipeline != VK_NULL_HANDLE; }
+
+	/**
+	 * @brief 是否使用计数缓冲（vkCmdDrawIndexedIndirectCountKHR）。
+	 */
+	bool UsesDrawCount() const { return _drawIndexedIndirectCount != nullptr; }
+
+	/**
+	 * @brief 指定对象列表所在的存储缓冲（每个对象 32 字节：transform 与 color）。
+	 *
+	 * 对象缓冲重建后需要重新调用。
+	 */
+	void SetObjects(VkBuffer objectBuffer, uint32_t objectCount);
+
+	/**
+	 * @brief 录制剔除：清零计数、派发计算着色器，并插入间接绘制所需的屏障。必须在渲染通道之外调用。
+	 *
+	 * @param viewRect   视口矩形（最小 x、最小 y、最大 x、最大 y）。
+	 * @param indexCount 每个对象绘制的索引数。
+	 * @param meshRadius 网格的包围圆半径。
+	 */
+	void RecordCull(VkCommandBuffer commandBuffer, const float viewRect[4], uint32_t indexCount, float meshRadius);
+
+	/**
+	 * @brief 录制间接绘制。调用方需已绑定图形管线、顶点缓冲（绑定 1 为对象缓冲）与索引缓冲。
+	 */
+	void RecordDraw(VkCommandBuffer commandBuffer) const;
+
+private:
+	/**
+	 * @brief 创建描述符集布局、管线布局与计算管线。
+	 */
+	void createPipeline(VkPipelineCache pipelineCache, VkShaderModule shader);
+
+	/**
+	 * @brief 创建描述符池并分配描述符集。
+	 */
+	void createDescriptorSet();
+
+private:
+	VkDevice _device = VK_NULL_HANDLE;
+
+	GpuAllocator* _allocator = nullptr;
+
+	VkDescriptorSetLayout _setLayout = VK_NULL_HANDLE;
+	VkPipelineLayout _pipelineLayout = VK_NULL_HANDLE;
+	VkPipeline _pipeline = VK_NULL_HANDLE;
+
+	VkDescriptorPool _descriptorPool = VK_NULL_HANDLE;
+	VkDescriptorSet _descriptorSet = VK_NULL_HANDLE;
+
+	// 间接绘制命令与可见数量
+	VkBuffer _commandBuffer = VK_NULL_HANDLE;
+	GpuAllocation _commandAllocation;
+	VkBuffer _countBuffer = VK_NULL_HANDLE;
+	GpuAllocation _countAllocation;
+
+	uint32_t _maxObjects = 0;
+	uint32_t _objectCount = 0;
+
+	// 单次 vkCmdDrawIndexedIndirect 的最大命令数（不支持 multiDrawIndirect 时为 1）
+	uint32_t _maxDrawCount = 1;
+
+	// VK_KHR_draw_indirect_count 的函数指针，未启用时为空
+	PFN_vkCmdDrawIndexedIndirectCountKHR _drawIndexedIndirectCount = nullptr;
+};
+
+#endif    // !GPUCULLER_H_
@@ -0,0 +1,243 @@
+﻿#include "GpuProfiler.h"
+
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+	// 滑动平均的窗口帧数
+	constexpr size_t kAverageWindow = 120;
+
+	// CSV 导出保留的帧数
+	constexpr size_t kCsvFrames = 600;
+}
+
+GpuProfiler::Scope::Scope(GpuProfiler& profiler, VkCommandBuffer commandBuffer, const char* name)
+	: _profiler(profiler)
+	, _commandBuffer(commandBuffer)
+{
+	_profiler.BeginScope(_commandBuffer, name);
+}
+
+GpuProfiler::Scope::~Scope()
+{
+	_profiler.EndScope(_commandBuffer);
+}
+
+GpuProfiler::GpuProfiler() {}
+
+GpuProfiler::~GpuProfiler() {}
+
+void GpuProfiler::Init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamily, uint32_t frameCount, uint32_t maxScopes)
+{
+	_device = device;
+	_maxScopes = maxScopes;
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+
+	// 查询队列族的时间戳有效位数
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+	uint32_t validBits = queueFamily < queueFamilyCount ? queueFamilies[queueFamily].timestampValidBits : 0;
+	if (validBits == 0 || properties.limits.timestampPeriod <= 0.0f) {
+		std::cout << "图形队列不支持时间戳查询，GPU 耗时将不可用" << std::endl;
+		return;
+	}
+
+	_timestampPeriod = properties.limits.timestampPeriod;
+	_timestampMask = validBits >= 64 ? ~0ull : ((1ull << validBits) - 1);
+
+	// 每个帧槽位 maxScopes 个作用域，每个作用域两个查询（开始/结束）
+	VkQueryPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+	poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+	poolInfo.queryCount = frameCount * _maxScopes * 2;
+
+	if (vkCreateQueryPool(_device, &poolInfo, nullptr, &_queryPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create timestamp query pool!");
+	}
+
+	_slots.assign(frameCount, FrameSlot());
+	for (auto& slot : _slots) {
+		slot.scopes.reserve(_maxScopes);
+	}
+	_timestamps.resize(static_cast<size_t>(_maxScopes) * 2);
+}
+
+void GpuProfiler::Destroy()
+{
+	if (_queryPool != VK_NULL_HANDLE) {
+		vkDestroyQueryPool(_device, _queryPool, nullptr);
+		_queryPool = VK_NULL_HANDLE;
+	}
+
+	_slots.clear();
+	_scopeStack.clear();
+	_results.clear();
+	_history.clear();
+	_historyNext.clear();
+	_frames.clear();
+	_frameCounter = 0;
+	_lastFrameMs = 0.0;
+}
+
+void GpuProfiler::BeginFrame(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+	if (!IsSupported()) {
+		return;
+	}
+
+	_recordingSlot = frame;
+	_scopeStack.clear();
+
+	FrameSlot& slot = _slots[frame];
+	slot.scopes.clear();
+	slot.pending = true;
+
+	vkCmdResetQueryPool(commandBuffer, _queryPool, frame * _maxScopes * 2, _maxScopes * 2);
+}
+
+void GpuProfiler::ReplayFrame(uint32_t frame)
+{
+	if (!IsSupported()) {
+		return;
+	}
+
+	_slots[frame].pending = true;
+}
+
+void GpuProfiler::BeginScope(VkCommandBuffer commandBuffer, const char* name)
+{
+	if (!IsSupported()) {
+		return;
+	}
+
+	FrameSlot& slot = _slots[_recordingSlot];
+	if (slot.scopes.size() >= _maxScopes) {
+		// 超出上限：仍然入栈，保证 EndScope 配对
+		_scopeStack.push_back(UINT32_MAX);
+		return;
+	}
+
+	uint32_t index = static_cast<uint32_t>(slot.scopes.size());
+	slot.scopes.push_back({ name, static_cast<uint32_t>(_scopeStack.size()) });
+	_scopeStack.push_back(index);
+
+	uint32_t query = _recordingSlot * _maxScopes * 2 + index * 2;
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, _queryPool, query);
+}
+
+void GpuProfiler::EndScope(VkCommandBuffer commandBuffer)
+{
+	if (!IsSupported() || _scopeStack.empty()) {
+		return;
+	}
+
+	uint32_t index = _scopeStack.back();
+	_scopeStack.pop_back();
+	if (index == UINT32_MAX) {
+		return;
+	}
+
+	uint32_t query = _recordingSlot * _maxScopes * 2 + index * 2 + 1;
+	vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, _queryPool, query);
+}
+
+bool GpuProfiler::Collect(uint32_t frame)
+{
+	if (!IsSupported() || frame >= _slots.size() || !_slots[frame].pending) {
+		return false;
+	}
+
+	FrameSlot& slot = _slots[frame];
+	slot.pending = false;
+	if (slot.scopes.empty()) {
+		return false;
+	}
+
+	// 栅栏已触发，不带 WAIT 标志读取，结果一定可用
+	uint32_t queryCount = static_cast<uint32_t>(slot.scopes.size()) * 2;
+	VkResult result = vkGetQueryPoolResults(_device, _queryPool, frame * _maxScopes * 2, queryCount,
+		queryCount * sizeof(uint64_t), _timestamps.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+	if (result != VK_SUCCESS) {
+		return false;
+	}
+
+	FrameRecord record;
+	record.frame = _frameCounter++;
+	record.samples.reserve(slot.scopes.size());
+
+	_lastFrameMs = 0.0;
+	for (size_t i = 0; i < slot.scopes.size(); i++) {
+		// 按有效位回绕后换算为毫秒
+		uint64_t ticks = (_timestamps[i * 2 + 1] - _timestamps[i * 2]) & _timestampMask;
+		double ms = static_cast<double>(ticks) * _timestampPeriod / 1e6;
+
+		uint32_t index = resultIndex(slot.scopes[i].name, slot.scopes[i].depth);
+		std::vector<double>& history = _history[index];
+		if (history.size() < kAverageWindow) {
+			history.push_back(ms);
+		}
+		else {
+			history[_historyNext[index]] = ms;
+		}
+		_historyNext[index] = (_historyNext[index] + 1) % kAverageWindow;
+
+		_results[index].lastMs = ms;
+		_results[index].averageMs = std::accumulate(history.begin(), history.end(), 0.0) / static_cast<double>(history.size());
+
+		if (slot.scopes[i].depth == 0) {
+			_lastFrameMs += ms;
+		}
+		record.samples.emplace_back(index, ms);
+	}
+
+	_frames.push_back(std::move(record));
+	if (_frames.size() > kCsvFrames) {
+		_frames.pop_front();
+	}
+
+	return true;
+}
+
+bool GpuProfiler::ExportCsv(const std::string& path) const
+{
+	std::ofstream file(path, std::ios::trunc);
+	if (!file.is_open()) {
+		std::cerr << "无法写入 GPU 计时文件: " << path << std::endl;
+		return false;
+	}
+
+	file << "frame,scope,depth,gpu_ms\n";
+	for (const auto& record : _frames) {
+		for (const auto& sample : record.samples) {
+			const ScopeResult& scope = _results[sample.first];
+			file << record.frame << ',' << scope.name << ',' << scope.depth << ',' << sample.second << '\n';
+		}
+	}
+
+	return file.good();
+}
+
+uint32_t GpuProfiler::resultIndex(const char* name, uint32_t depth)
+{
+	for (size_t i = 0; i < _results.size(); i++) {
+		if (_results[i].depth == depth && _results[i].name == name) {
+			return static_cast<uint32_t>(i);
+		}
+	}
+
+	ScopeResult result;
+	result.name = name;
+	result.depth = depth;
+	_results.push_back(result);
+	_history.emplace_back();
+	_history.back().reserve(kAverageWindow);
+	_historyNext.push_back(0);
+	return static_cast<uint32_t>(_results.size() - 1);
+}
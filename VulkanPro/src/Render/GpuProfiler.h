@@ -0,0 +1,204 @@
+﻿#ifndef GPUPROFILER_H_
+#define GPUPROFILER_H_
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "vulkan/vulkan.h"
+
+/**
+ * @brief 基于时间戳查询（VkQueryPool）的 GPU 分段计时器。
+ *
+ * 在命令缓冲中用 BeginScope / EndScope（或 Scope 对象）包围要测量的命令，作用域可以嵌套。
+ * 每个 Frame in Flight 槽位拥有独立的一段查询，结果在该槽位的栅栏触发后才回读，
+ * 因此回读不会阻塞 CPU，数据比当前帧晚 _framesInFlight 帧。
+ *
+ * 图形队列不支持时间戳（timestampValidBits 为 0）时所有接口都是空操作，IsSupported() 返回 false。
+ */
+class GpuProfiler
+{
+public:
+	/**
+	 * @brief 一个作用域的计时结果。
+	 */
+	struct ScopeResult {
+		// 作用域名称
+		std::string name;
+
+		// 嵌套深度，最外层为 0
+		uint32_t depth = 0;
+
+		// 最近一帧的耗时（毫秒）
+		double lastMs = 0.0;
+
+		// 最近若干帧的滑动平均耗时（毫秒）
+		double averageMs = 0.0;
+	};
+
+	/**
+	 * @brief RAII 作用域：构造时 BeginScope，析构时 EndScope。
+	 */
+	class Scope
+	{
+	public:
+		Scope(GpuProfiler& profiler, VkCommandBuffer commandBuffer, const char* name);
+
+		~Scope();
+
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+
+	private:
+		GpuProfiler& _profiler;
+		VkCommandBuffer _commandBuffer;
+	};
+
+public:
+	GpuProfiler();
+
+	~GpuProfiler();
+
+public:
+	/**
+	 * @brief 创建查询池。
+	 *
+	 * @param physicalDevice 物理设备，用于查询 timestampPeriod 与 timestampValidBits。
+	 * @param device         逻辑设备。
+	 * @param queueFamily    提交命令的队列族索引。
+	 * @param frameCount     帧槽位数量（Frames in Flight）。
+	 * @param maxScopes      每帧最多的作用域数量，超出的作用域被忽略。
+	 *
+	 * @throws std::runtime_error 创建查询池失败时抛出。
+	 */
+	void Init(VkPhysicalDevice physicalDevice, VkDevice device, uint32_t queueFamily, uint32_t frameCount, uint32_t maxScopes = 32);
+
+	/**
+	 * @brief 销毁查询池并清空统计。
+	 */
+	void Destroy();
+
+	/**
+	 * @brief 设备是否支持时间戳查询。
+	 */
+	bool IsSupported() const { return _queryPool != VK_NULL_HANDLE; }
+
+	/**
+	 * @brief 开始录制某个帧槽位：重置该槽位的查询。必须在渲染通道之外调用。
+	 */
+	void BeginFrame(VkCommandBuffer commandBuffer, uint32_t frame);
+
+	/**
+	 * @brief 重新提交之前为该槽位录制的命令缓冲时调用：查询与作用域不变，只标记为待回读。
+	 *
+	 * 命令缓冲中的作用域结构必须与该槽位最近一次录制的相同。
+	 */
+	void ReplayFrame(uint32_t frame);
+
+	/**
+	 * @brief 开始一个作用域，写入开始时间戳。
+	 *
+	 * @param name 作用域名称，需在回读前保持有效（通常为字符串字面量）。
+	 */
+	void BeginScope(VkCommandBuffer commandBuffer, const char* name);
+
+	/**
+	 * @brief 结束最近一个未结束的作用域，写入结束时间戳。
+	 */
+	void EndScope(VkCommandBuffer commandBuffer);
+
+	/**
+	 * @brief 回读帧槽位上一次提交的时间戳，更新统计。
+	 *
+	 * 只应在该槽位的栅栏触发后调用，不会等待 GPU。
+	 *
+	 * @return true 读到了新的一帧数据。
+	 */
+	bool Collect(uint32_t frame);
+
+	/**
+	 * @brief 最近一帧所有最外层作用域的耗时之和（毫秒）。
+	 */
+	double LastFrameMs() const { return _lastFrameMs; }
+
+	/**
+	 * @brief 所有出现过的作用域的统计结果，按首次出现的顺序排列。
+	 */
+	const std::vector<ScopeResult>& Results() const { return _results; }
+
+	/**
+	 * @brief 将最近若干帧的逐帧数据导出为 CSV（frame,scope,depth,gpu_ms）。
+	 *
+	 * @return true 写入成功。
+	 */
+	bool ExportCsv(const std::string& path) const;
+
+private:
+	/**
+	 * @brief 录制中的一个作用域，查询索引为 2*i 与 2*i+1（相对于帧槽位起点）。
+	 */
+	struct ScopeRecord {
+		const char* name;
+		uint32_t depth;
+	};
+
+	/**
+	 * @brief 帧槽位的录制状态。
+	 */
+	struct FrameSlot {
+		std::vector<ScopeRecord> scopes;
+
+		// 是否有尚未回读的提交
+		bool pending = false;
+	};
+
+	/**
+	 * @brief 一帧的回读结果，用于 CSV 导出：(结果索引, 耗时毫秒)。
+	 */
+	struct FrameRecord {
+		uint64_t frame;
+		std::vector<std::pair<uint32_t, double>> samples;
+	};
+
+	/**
+	 * @brief 查找或新建作用域的统计项。
+	 */
+	uint32_t resultIndex(const char* name, uint32_t depth);
+
+private:
+	VkDevice _device = VK_NULL_HANDLE;
+
+	VkQueryPool _queryPool = VK_NULL_HANDLE;
+
+	// 时间戳计数到纳秒的换算系数
+	double _timestampPeriod = 1.0;
+
+	// 时间戳有效位掩码
+	uint64_t _timestampMask = ~0ull;
+
+	uint32_t _maxScopes = 0;
+
+	std::vector<FrameSlot> _slots;
+
+	// 当前录制的帧槽位及未结束作用域的栈（UINT32_MAX 表示超出上限被忽略的作用域）
+	uint32_t _recordingSlot = 0;
+	std::vector<uint32_t> _scopeStack;
+
+	// 回读缓冲，避免每帧分配
+	std::vector<uint64_t> _timestamps;
+
+	// 各作用域的统计结果与滑动窗口
+	std::vector<ScopeResult> _results;
+	std::vector<std::vector<double>> _history;
+	std::vector<size_t> _historyNext;
+
+	// 最近若干帧的逐帧数据
+	std::deque<FrameRecord> _frames;
+	uint64_t _frameCounter = 0;
+
+	double _lastFrameMs = 0.0;
+};
+
+#endif    // !GPUPROFILER_H_
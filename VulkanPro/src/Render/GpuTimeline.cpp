@@ -0,0 +1,81 @@
+﻿#include "GpuTimeline.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+GpuTimeline::GpuTimeline() {}
+
+GpuTimeline::~GpuTimeline() {}
+
+void GpuTimeline::Init(VkDevice device, uint64_t initialValue)
+{
+	_device = device;
+
+	_getCounterValue = (PFN_vkGetSemaphoreCounterValueKHR)vkGetDeviceProcAddr(device, "vkGetSemaphoreCounterValueKHR");
+	_waitSemaphores = (PFN_vkWaitSemaphoresKHR)vkGetDeviceProcAddr(device, "vkWaitSemaphoresKHR");
+	if (_getCounterValue == nullptr || _waitSemaphores == nullptr) {
+		throw std::runtime_error("failed to load timeline semaphore commands!");
+	}
+
+	VkSemaphoreTypeCreateInfoKHR typeInfo{};
+	typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO_KHR;
+	typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE_KHR;
+	typeInfo.initialValue = initialValue;
+
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &typeInfo;
+
+	if (vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &_semaphore) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create timeline semaphore!");
+	}
+	_completed = initialValue;
+}
+
+void GpuTimeline::Destroy()
+{
+	if (_semaphore == VK_NULL_HANDLE) {
+		return;
+	}
+
+	vkDestroySemaphore(_device, _semaphore, nullptr);
+	_semaphore = VK_NULL_HANDLE;
+}
+
+uint64_t GpuTimeline::CompletedValue()
+{
+	uint64_t value = 0;
+	if (_getCounterValue(_device, _semaphore, &value) == VK_SUCCESS) {
+		_completed = std::max(_completed, value);
+	}
+	return _completed;
+}
+
+bool GpuTimeline::IsComplete(uint64_t value)
+{
+	return value <= _completed || value <= CompletedValue();
+}
+
+bool GpuTimeline::Wait(uint64_t value, uint64_t timeoutNs)
+{
+	if (value <= _completed) {
+		return true;
+	}
+
+	VkSemaphoreWaitInfoKHR waitInfo{};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO_KHR;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &_semaphore;
+	waitInfo.pValues = &value;
+
+	VkResult result = _waitSemaphores(_device, &waitInfo, timeoutNs);
+	if (result == VK_TIMEOUT) {
+		return false;
+	}
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("failed to wait for timeline semaphore!");
+	}
+
+	_completed = std::max(_completed, value);
+	return true;
+}
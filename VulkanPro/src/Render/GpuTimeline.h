@@ -0,0 +1,81 @@
+﻿#ifndef GPUTIMELINE_H_
+#define GPUTIMELINE_H_
+
+#include <cstdint>
+
+#include "vulkan/vulkan.h"
+
+/**
+ * @brief 基于 VK_KHR_timeline_semaphore 的队列进度时钟。
+ *
+ * 一个队列一个时间线信号量，每次提交触发一个单调递增的值。CPU 通过 Wait() 等待某个值，
+ * 或用 IsComplete() 查询"值 N 对应的提交是否已完成"，不需要为每个帧槽位或每个子系统各建一组栅栏，
+ * 也不需要重置。
+ *
+ * 同一队列上信号操作的同步范围包含提交顺序更早的所有命令，因此值 N 完成时，所有不大于 N 的值都已完成。
+ */
+class GpuTimeline
+{
+public:
+	GpuTimeline();
+
+	~GpuTimeline();
+
+public:
+	/**
+	 * @brief 创建时间线信号量并获取扩展命令。设备必须启用 timelineSemaphore 特性。
+	 *
+	 * @param device       逻辑设备。
+	 * @param initialValue 初始值，视为已完成；重建时传入上一次最后触发的值可以保持时钟连续。
+	 *
+	 * @throws std::runtime_error 创建失败或无法获取扩展命令时抛出。
+	 */
+	void Init(VkDevice device, uint64_t initialValue);
+
+	/**
+	 * @brief 销毁信号量。调用前 GPU 必须不再使用它。
+	 */
+	void Destroy();
+
+	/**
+	 * @brief 是否已创建。
+	 */
+	bool IsValid() const { return _semaphore != VK_NULL_HANDLE; }
+
+	/**
+	 * @brief 时间线信号量，提交时放入 pSignalSemaphores 并通过 VkTimelineSemaphoreSubmitInfoKHR 指定值。
+	 */
+	VkSemaphore Semaphore() const { return _semaphore; }
+
+	/**
+	 * @brief GPU 已完成的最大值。会查询一次信号量计数。
+	 */
+	uint64_t CompletedValue();
+
+	/**
+	 * @brief 值为 value 的提交是否已完成。已知完成时不调用 Vulkan。
+	 */
+	bool IsComplete(uint64_t value);
+
+	/**
+	 * @brief 阻塞等待值为 value 的提交完成。
+	 *
+	 * @return 超时返回 false。
+	 *
+	 * @throws std::runtime_error 等待失败（如设备丢失）时抛出。
+	 */
+	bool Wait(uint64_t value, uint64_t timeoutNs = UINT64_MAX);
+
+private:
+	VkDevice _device = VK_NULL_HANDLE;
+	VkSemaphore _semaphore = VK_NULL_HANDLE;
+
+	// 最近一次观测到的完成值，只增不减
+	uint64_t _completed = 0;
+
+	// Vulkan 1.0 实例下需通过 vkGetDeviceProcAddr 获取
+	PFN_vkGetSemaphoreCounterValueKHR _getCounterValue = nullptr;
+	PFN_vkWaitSemaphoresKHR _waitSemaphores = nullptr;
+};
+
+#endif    // !GPUTIMELINE_H_
@@ -0,0 +1,148 @@
+﻿#include "InstanceBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+InstanceBuffer::InstanceBuffer() {}
+
+InstanceBuffer::~InstanceBuffer() {}
+
+void InstanceBuffer::Init(GpuAllocator& allocator, uint32_t stride, uint32_t capacity, uint32_t frameCount)
+{
+	_allocator = &allocator;
+	_stride = stride;
+	_capacity = capacity;
+	_count = 0;
+
+	// 除作为顶点缓冲外，GPU 剔除还以存储缓冲读取实例数据
+	VkDeviceSize size = static_cast<VkDeviceSize>(stride) * capacity;
+	_allocator->CreateBuffer(size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _buffer, _allocation);
+
+	_stagingBuffers.assign(frameCount, VK_NULL_HANDLE);
+	_stagingAllocations.assign(frameCount, GpuAllocation());
+	for (uint32_t i = 0; i < frameCount; i++) {
+		_allocator->CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			_stagingBuffers[i], _stagingAllocations[i]);
+	}
+
+	uint32_t chunkCount = (capacity + kChunkInstances - 1) / kChunkInstances;
+	_data.assign(static_cast<size_t>(size), 0);
+	_dirty.assign(chunkCount, 0);
+	_dirtyCount = 0;
+	_regions.reserve(chunkCount);
+}
+
+void InstanceBuffer::Destroy()
+{
+	if (_allocator == nullptr) {
+		return;
+	}
+
+	_allocator->DestroyBuffer(_buffer, _allocation);
+	for (size_t i = 0; i < _stagingBuffers.size(); i++) {
+		_allocator->DestroyBuffer(_stagingBuffers[i], _stagingAllocations[i]);
+	}
+	_stagingBuffers.clear();
+	_stagingAllocations.clear();
+
+	_data.clear();
+	_dirty.clear();
+	_dirtyCount = 0;
+	_regions.clear();
+	_count = 0;
+	_capacity = 0;
+	_allocator = nullptr;
+}
+
+void InstanceBuffer::Update(uint32_t first, uint32_t count, const void* data)
+{
+	if (count == 0) {
+		return;
+	}
+	if (first > _capacity || count > _capacity - first) {
+		throw std::runtime_error("instance update out of range!");
+	}
+
+	memcpy(_data.data() + static_cast<size_t>(first) * _stride, data, static_cast<size_t>(count) * _stride);
+
+	uint32_t lastChunk = (first + count - 1) / kChunkInstances;
+	for (uint32_t chunk = first / kChunkInstances; chunk <= lastChunk; chunk++) {
+		if (!_dirty[chunk]) {
+			_dirty[chunk] = 1;
+			_dirtyCount++;
+		}
+	}
+}
+
+void InstanceBuffer::SetCount(uint32_t count)
+{
+	_count = std::min(count, _capacity);
+}
+
+VkDeviceSize InstanceBuffer::RecordUpload(VkCommandBuffer commandBuffer, uint32_t frame)
+{
+	if (_dirtyCount == 0) {
+		return 0;
+	}
+
+	// 相邻的脏块合并成一个复制区间，暂存缓冲与设备缓冲使用相同偏移
+	char* staging = static_cast<char*>(_stagingAllocations[frame].mapped);
+	VkDeviceSize chunkBytes = static_cast<VkDeviceSize>(kChunkInstances) * _stride;
+	VkDeviceSize totalBytes = _data.size();
+	VkDeviceSize uploaded = 0;
+
+	_regions.clear();
+	uint32_t chunkCount = static_cast<uint32_t>(_dirty.size());
+	for (uint32_t chunk = 0; chunk < chunkCount; ) {
+		if (!_dirty[chunk]) {
+			chunk++;
+			continue;
+		}
+
+		uint32_t end = chunk;
+		while (end < chunkCount && _dirty[end]) {
+			_dirty[end] = 0;
+			end++;
+		}
+
+		VkDeviceSize offset = chunk * chunkBytes;
+		VkDeviceSize size = std::min(end * chunkBytes, totalBytes) - offset;
+		memcpy(staging + offset, _data.data() + offset, static_cast<size_t>(size));
+
+		VkBufferCopy region{};
+		region.srcOffset = offset;
+		region.dstOffset = offset;
+		region.size = size;
+		_regions.push_back(region);
+
+		uploaded += size;
+		chunk = end;
+	}
+	_dirtyCount = 0;
+
+	// 之前提交的帧可能仍在读取实例数据，复制前先等待其顶点输入与剔除阶段完成（读后写）
+	VkBufferMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer = _buffer;
+	barrier.offset = 0;
+	barrier.size = VK_WHOLE_SIZE;
+
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr, 1, &barrier, 0, nullptr);
+
+	vkCmdCopyBuffer(commandBuffer, _stagingBuffers[frame], _buffer, static_cast<uint32_t>(_regions.size()), _regions.data());
+
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+		0, nullptr, 1, &barrier, 0, nullptr);
+
+	return uploaded;
+}
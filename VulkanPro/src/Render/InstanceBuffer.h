@@ -0,0 +1,115 @@
+﻿#ifndef INSTANCEBUFFER_H_
+#define INSTANCEBUFFER_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "GpuAllocator.h"
+
+/**
+ * @brief 设备本地的实例数据缓冲，支持增量更新。
+ *
+ * 实例数据按固定步长存放在一个 DEVICE_LOCAL 的顶点缓冲中，作为 VK_VERTEX_INPUT_RATE_INSTANCE 的绑定使用，
+ * 同时也可作为存储缓冲供计算着色器读取（见 GpuCuller）。
+ * Update() 只修改 CPU 端副本并按块（kChunkInstances 个实例）标记脏区；RecordUpload() 在帧命令缓冲中
+ * 把本帧累积的脏块经由该帧槽位的暂存缓冲复制到设备缓冲，一次 vkCmdCopyBuffer 提交所有区间。
+ *
+ * 每个帧槽位有独立的暂存缓冲（容量与设备缓冲相同），写入时该槽位的栅栏已触发，不会覆盖 GPU 正在读取的数据。
+ */
+class InstanceBuffer
+{
+public:
+	/**
+	 * @brief 脏区跟踪的粒度（实例数）。
+	 */
+	static constexpr uint32_t kChunkInstances = 256;
+
+public:
+	InstanceBuffer();
+
+	~InstanceBuffer();
+
+public:
+	/**
+	 * @brief 创建设备缓冲与各帧槽位的暂存缓冲。
+	 *
+	 * @param allocator  显存分配器。
+	 * @param stride     每个实例的字节数。
+	 * @param capacity   最大实例数。
+	 * @param frameCount 帧槽位数量（Frames in Flight）。
+	 *
+	 * @throws std::runtime_error 创建缓冲失败时抛出。
+	 */
+	void Init(GpuAllocator& allocator, uint32_t stride, uint32_t capacity, uint32_t frameCount);
+
+	/**
+	 * @brief 销毁所有缓冲。调用前 GPU 必须不再使用它们。
+	 */
+	void Destroy();
+
+	/**
+	 * @brief 是否已创建。
+	 */
+	bool IsValid() const { return _buffer != VK_NULL_HANDLE; }
+
+	/**
+	 * @brief 更新 [first, first + count) 的实例数据，下一次 RecordUpload() 时上传。
+	 *
+	 * @throws std::runtime_error 超出容量时抛出。
+	 */
+	void Update(uint32_t first, uint32_t count, const void* data);
+
+	/**
+	 * @brief 设置参与绘制的实例数量（不超过容量）。
+	 */
+	void SetCount(uint32_t count);
+
+	/**
+	 * @brief 参与绘制的实例数量。
+	 */
+	uint32_t Count() const { return _count; }
+
+	/**
+	 * @brief 是否有尚未上传的脏块，下一次 RecordUpload() 会录制复制命令。
+	 */
+	bool HasPendingUpload() const { return _dirtyCount > 0; }
+
+	/**
+	 * @brief 设备缓冲，绑定为实例顶点缓冲。
+	 */
+	VkBuffer Buffer() const { return _buffer; }
+
+	/**
+	 * @brief 录制本帧的上传命令：复制脏块并插入屏障。必须在渲染通道之外调用。
+	 *
+	 * 帧槽位 frame 的栅栏必须已经触发。
+	 *
+	 * @return VkDeviceSize 本次上传的字节数，没有脏块时为 0 且不录制任何命令。
+	 */
+	VkDeviceSize RecordUpload(VkCommandBuffer commandBuffer, uint32_t frame);
+
+private:
+	GpuAllocator* _allocator = nullptr;
+
+	uint32_t _stride = 0;
+	uint32_t _capacity = 0;
+	uint32_t _count = 0;
+
+	// 设备本地的实例缓冲
+	VkBuffer _buffer = VK_NULL_HANDLE;
+	GpuAllocation _allocation;
+
+	// 每个帧槽位一个持久映射的暂存缓冲
+	std::vector<VkBuffer> _stagingBuffers;
+	std::vector<GpuAllocation> _stagingAllocations;
+
+	// CPU 端副本与按块的脏标记
+	std::vector<char> _data;
+	std::vector<char> _dirty;
+	uint32_t _dirtyCount = 0;
+
+	// 复用的复制区间列表，避免每帧分配
+	std::vector<VkBufferCopy> _regions;
+};
+
+#endif    // !INSTANCEBUFFER_H_
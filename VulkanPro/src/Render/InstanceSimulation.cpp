@@ -0,0 +1,182 @@
+﻿#include "InstanceSimulation.h"
+
+#include <stdexcept>
+
+InstanceSimulation::InstanceSimulation() {}
+
+InstanceSimulation::~InstanceSimulation() {}
+
+void InstanceSimulation::Init(VkDevice device, GpuAllocator& allocator, VkPipelineCache pipelineCache, VkShaderModule shader,
+	uint32_t instanceCount, uint32_t stride)
+{
+	_device = device;
+	_allocator = &allocator;
+	_instanceCount = instanceCount;
+	_size = static_cast<VkDeviceSize>(instanceCount) * stride;
+
+	_allocator->CreateBuffer(_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+		VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _state, _stateAllocation);
+	for (uint32_t i = 0; i < kOutputCount; i++) {
+		_allocator->CreateBuffer(_size, VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _outputs[i], _outputAllocations[i]);
+	}
+
+	createPipeline(pipelineCache, shader);
+	createDescriptorSets();
+}
+
+void InstanceSimulation::Destroy()
+{
+	if (_allocator == nullptr) {
+		return;
+	}
+
+	_allocator->DestroyBuffer(_state, _stateAllocation);
+	for (uint32_t i = 0; i < kOutputCount; i++) {
+		_allocator->DestroyBuffer(_outputs[i], _outputAllocations[i]);
+		_descriptorSets[i] = VK_NULL_HANDLE;
+	}
+
+	// 销毁描述符池会一并释放其中的描述符集
+	vkDestroyDescriptorPool(_device, _descriptorPool, nullptr);
+	vkDestroyPipeline(_device, _pipeline, nullptr);
+	vkDestroyPipelineLayout(_device, _pipelineLayout, nullptr);
+	vkDestroyDescriptorSetLayout(_device, _setLayout, nullptr);
+
+	_descriptorPool = VK_NULL_HANDLE;
+	_pipeline = VK_NULL_HANDLE;
+	_pipelineLayout = VK_NULL_HANDLE;
+	_setLayout = VK_NULL_HANDLE;
+	_allocator = nullptr;
+}
+
+void InstanceSimulation::RecordSeed(VkCommandBuffer commandBuffer, VkBuffer staging)
+{
+	VkBufferCopy region{};
+	region.size = _size;
+	vkCmdCopyBuffer(commandBuffer, staging, _state, 1, &region);
+
+	VkMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+		1, &barrier, 0, nullptr, 0, nullptr);
+}
+
+void InstanceSimulation::RecordStep(VkCommandBuffer commandBuffer, uint32_t output, uint32_t substeps, float dt)
+{
+	// 上一步（同一队列上更早的提交）对状态缓冲的读写完成后才能再次推进
+	VkMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+		1, &barrier, 0, nullptr, 0, nullptr);
+
+	SimParams params{};
+	params.instanceCount = _instanceCount;
+	params.substeps = substeps > 0 ? substeps : 1;
+	params.dt = dt;
+
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pipeline);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, _pipelineLayout, 0, 1, &_descriptorSets[output], 0, nullptr);
+	vkCmdPushConstants(commandBuffer, _pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(SimParams), &params);
+	vkCmdDispatch(commandBuffer, (_instanceCount + kGroupSize - 1) / kGroupSize, 1, 1);
+}
+
+void InstanceSimulation::createPipeline(VkPipelineCache pipelineCache, VkShaderModule shader)
+{
+	// 绑定 0：模拟状态，绑定 1：输出
+	VkDescriptorSetLayoutBinding bindings[2]{};
+	for (uint32_t i = 0; i < 2; i++) {
+		bindings[i].binding = i;
+		bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		bindings[i].descriptorCount = 1;
+		bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	}
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = 2;
+	layoutInfo.pBindings = bindings;
+
+	if (vkCreateDescriptorSetLayout(_device, &layoutInfo, nullptr, &_setLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create simulation descriptor set layout!");
+	}
+
+	VkPushConstantRange pushRange{};
+	pushRange.stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+	pushRange.offset = 0;
+	pushRange.size = sizeof(SimParams);
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = 1;
+	pipelineLayoutInfo.pSetLayouts = &_setLayout;
+	pipelineLayoutInfo.pushConstantRangeCount = 1;
+	pipelineLayoutInfo.pPushConstantRanges = &pushRange;
+
+	if (vkCreatePipelineLayout(_device, &pipelineLayoutInfo, nullptr, &_pipelineLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create simulation pipeline layout!");
+	}
+
+	VkComputePipelineCreateInfo pipelineInfo{};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+	pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+	pipelineInfo.stage.module = shader;
+	pipelineInfo.stage.pName = "main";
+	pipelineInfo.layout = _pipelineLayout;
+
+	if (vkCreateComputePipelines(_device, pipelineCache, 1, &pipelineInfo, nullptr, &_pipeline) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create simulation pipeline!");
+	}
+}
+
+void InstanceSimulation::createDescriptorSets()
+{
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+	poolSize.descriptorCount = 2 * kOutputCount;
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.maxSets = kOutputCount;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+
+	if (vkCreateDescriptorPool(_device, &poolInfo, nullptr, &_descriptorPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create simulation descriptor pool!");
+	}
+
+	VkDescriptorSetLayout layouts[kOutputCount] = { _setLayout, _setLayout };
+
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = _descriptorPool;
+	allocInfo.descriptorSetCount = kOutputCount;
+	allocInfo.pSetLayouts = layouts;
+
+	if (vkAllocateDescriptorSets(_device, &allocInfo, _descriptorSets) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate simulation descriptor sets!");
+	}
+
+	// 每个描述符集对应一个输出缓冲，状态缓冲共用
+	for (uint32_t i = 0; i < kOutputCount; i++) {
+		VkDescriptorBufferInfo stateInfo{ _state, 0, VK_WHOLE_SIZE };
+		VkDescriptorBufferInfo outputInfo{ _outputs[i], 0, VK_WHOLE_SIZE };
+
+		VkWriteDescriptorSet writes[2]{};
+		for (uint32_t j = 0; j < 2; j++) {
+			writes[j].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			writes[j].dstSet = _descriptorSets[i];
+			writes[j].dstBinding = j;
+			writes[j].descriptorCount = 1;
+			writes[j].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		}
+		writes[0].pBufferInfo = &stateInfo;
+		writes[1].pBufferInfo = &outputInfo;
+		vkUpdateDescriptorSets(_device, 2, writes, 0, nullptr);
+	}
+}
@@ -0,0 +1,124 @@
+﻿#ifndef INSTANCESIMULATION_H_
+#define INSTANCESIMULATION_H_
+
+#include <cstdint>
+
+#include "GpuAllocator.h"
+
+/**
+ * @brief 在计算着色器中模拟实例运动（simulate.comp），结果双缓冲供图形队列绘制。
+ *
+ * 模拟状态保存在只由计算队列访问的存储缓冲中，每一步原地推进状态并把结果写入两个输出缓冲之一；
+ * 图形队列把输出缓冲作为实例顶点缓冲（绑定 1）读取。输出双缓冲使第 N 帧的计算可以与读取另一份输出的
+ * 第 N - 1 帧图形工作同时执行（见 AsyncCompute）。
+ */
+class InstanceSimulation
+{
+public:
+	/**
+	 * @brief 计算着色器的推送常量，布局与 simulate.comp 中的 SimParams 一致。
+	 */
+	struct SimParams {
+		uint32_t instanceCount;
+
+		// 每帧积分的子步数，用于调节计算负载
+		uint32_t substeps;
+
+		// 每帧的时间步长（秒）
+		float dt;
+	};
+
+	/**
+	 * @brief 每个线程组的线程数，与 simulate.comp 中的 local_size_x 一致。
+	 */
+	static constexpr uint32_t kGroupSize = 64;
+
+	/**
+	 * @brief 输出缓冲的份数。
+	 */
+	static constexpr uint32_t kOutputCount = 2;
+
+public:
+	InstanceSimulation();
+
+	~InstanceSimulation();
+
+public:
+	/**
+	 * @brief 创建状态与输出缓冲、描述符与计算管线。
+	 *
+	 * @param device         逻辑设备。
+	 * @param allocator      显存分配器。
+	 * @param pipelineCache  管线缓存。
+	 * @param shader         simulate.comp 的着色器模块，调用方在 Init() 返回后即可销毁。
+	 * @param instanceCount  实例数量。
+	 * @param stride         每个实例的字节数（InstanceData，32 字节）。
+	 *
+	 * @throws std::runtime_error 创建失败时抛出。
+	 */
+	void Init(VkDevice device, GpuAllocator& allocator, VkPipelineCache pipelineCache, VkShaderModule shader,
+		uint32_t instanceCount, uint32_t stride);
+
+	/**
+	 * @brief 销毁所有资源。调用前 GPU 必须不再使用它们。
+	 */
+	void Destroy();
+
+	/**
+	 * @brief 是否已创建。
+	 */
+	bool IsValid() const { return _pipeline != VK_NULL_HANDLE; }
+
+	/**
+	 * @brief 录制初始状态的复制（从暂存缓冲），应在访问状态缓冲的同一队列上执行。
+	 */
+	void RecordSeed(VkCommandBuffer commandBuffer, VkBuffer staging);
+
+	/**
+	 * @brief 录制一步模拟：推进状态并写入输出缓冲 output。
+	 *
+	 * 开头的屏障保证上一步对状态缓冲的写入可见；输出缓冲的后续屏障（或所有权转移）由调用方负责。
+	 */
+	void RecordStep(VkCommandBuffer commandBuffer, uint32_t output, uint32_t substeps, float dt);
+
+	/**
+	 * @brief 输出缓冲，作为实例顶点缓冲绑定。
+	 */
+	VkBuffer Output(uint32_t index) const { return _outputs[index]; }
+
+private:
+	/**
+	 * @brief 创建描述符集布局、管线布局与计算管线。
+	 */
+	void createPipeline(VkPipelineCache pipelineCache, VkShaderModule shader);
+
+	/**
+	 * @brief 创建描述符池，每个输出缓冲分配一个描述符集。
+	 */
+	void createDescriptorSets();
+
+private:
+	VkDevice _device = VK_NULL_HANDLE;
+
+	GpuAllocator* _allocator = nullptr;
+
+	uint32_t _instanceCount = 0;
+	VkDeviceSize _size = 0;
+
+	VkDescriptorSetLayout _setLayout = VK_NULL_HANDLE;
+	VkPipelineLayout _pipelineLayout = VK_NULL_HANDLE;
+	VkPipeline _pipeline = VK_NULL_HANDLE;
+
+	VkDescriptorPool _descriptorPool = VK_NULL_HANDLE;
+	VkDescriptorSet _descriptorSets[kOutputCount] = {};
+
+	// 模拟状态（只由计算队列访问）
+	VkBuffer _state = VK_NULL_HANDLE;
+	GpuAllocation _stateAllocation;
+
+	// 双缓冲的输出
+	VkBuffer _outputs[kOutputCount] = {};
+	GpuAllocation _outputAllocations[kOutputCount];
+};
+
+#endif    // !INSTANCESIMULATION_H_
@@ -0,0 +1,228 @@
+﻿#include "ParallelRecorder.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+ParallelRecorder::ParallelRecorder() {}
+
+ParallelRecorder::~ParallelRecorder()
+{
+	// 保证线程在对象销毁前退出；命令池应已由 Destroy() 释放
+	if (!_threads.empty()) {
+		Destroy();
+	}
+}
+
+void ParallelRecorder::Init(VkDevice device, uint32_t queueFamily, uint32_t frameCount, uint32_t threadCount)
+{
+	_device = device;
+	_queueFamily = queueFamily;
+	if (threadCount == 0) {
+		return;
+	}
+
+	_frames.resize(frameCount);
+	for (auto& frame : _frames) {
+		frame.pools.resize(threadCount, VK_NULL_HANDLE);
+		frame.buffers.resize(threadCount, VK_NULL_HANDLE);
+		for (uint32_t i = 0; i < threadCount; i++) {
+			createPool(frame.pools[i], frame.buffers[i]);
+		}
+		createPool(frame.mainPool, frame.mainBuffer);
+	}
+
+	_recorded.assign(threadCount, 0);
+	_errors.assign(threadCount, nullptr);
+	_results.reserve(threadCount);
+
+	_stop = false;
+	_generation = 0;
+	_pending = 0;
+	for (uint32_t i = 0; i < threadCount; i++) {
+		_threads.emplace_back(&ParallelRecorder::workerLoop, this, i);
+	}
+}
+
+void ParallelRecorder::Destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_startCondition.notify_all();
+
+	for (auto& thread : _threads) {
+		thread.join();
+	}
+	_threads.clear();
+
+	// 销毁命令池会一并释放其中的命令缓冲
+	for (auto& frame : _frames) {
+		for (auto pool : frame.pools) {
+			vkDestroyCommandPool(_device, pool, nullptr);
+		}
+		if (frame.mainPool != VK_NULL_HANDLE) {
+			vkDestroyCommandPool(_device, frame.mainPool, nullptr);
+		}
+	}
+	_frames.clear();
+	_recorded.clear();
+	_errors.clear();
+	_results.clear();
+	_record = nullptr;
+}
+
+void ParallelRecorder::Begin(uint32_t frame, const VkCommandBufferInheritanceInfo& inheritance, uint32_t itemCount, const RecordFunc& record)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_frame = frame;
+		_itemCount = itemCount;
+		_inheritance = inheritance;
+		_inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		_record = record;
+		_pending = static_cast<uint32_t>(_threads.size());
+		_generation++;
+	}
+	_startCondition.notify_all();
+}
+
+const std::vector<VkCommandBuffer>& ParallelRecorder::Wait()
+{
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		_doneCondition.wait(lock, [this]() { return _pending == 0; });
+	}
+
+	for (auto& error : _errors) {
+		if (error) {
+			std::exception_ptr first = error;
+			for (auto& e : _errors) {
+				e = nullptr;
+			}
+			std::rethrow_exception(first);
+		}
+	}
+
+	// 按切片顺序收集，保持与单线程录制相同的绘制顺序
+	_results.clear();
+	for (size_t i = 0; i < _threads.size(); i++) {
+		if (_recorded[i]) {
+			_results.push_back(_frames[_frame].buffers[i]);
+		}
+	}
+	return _results;
+}
+
+VkCommandBuffer ParallelRecorder::BeginMainSecondary(uint32_t frame, const VkCommandBufferInheritanceInfo& inheritance)
+{
+	FrameResources& resources = _frames[frame];
+
+	VkCommandBufferInheritanceInfo inheritanceInfo = inheritance;
+	inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+
+	vkResetCommandPool(_device, resources.mainPool, 0);
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	beginInfo.pInheritanceInfo = &inheritanceInfo;
+
+	if (vkBeginCommandBuffer(resources.mainBuffer, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("failed to begin recording secondary command buffer!");
+	}
+	return resources.mainBuffer;
+}
+
+void ParallelRecorder::workerLoop(uint32_t worker)
+{
+	uint64_t seen = 0;
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_startCondition.wait(lock, [&]() { return _stop || _generation != seen; });
+			if (_stop) {
+				return;
+			}
+			seen = _generation;
+		}
+
+		// 录制期间不持有锁，各线程只访问自己的命令池
+		try {
+			recordSlice(worker);
+		}
+		catch (...) {
+			_errors[worker] = std::current_exception();
+		}
+
+		bool last = false;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			last = --_pending == 0;
+		}
+		if (last) {
+			_doneCondition.notify_one();
+		}
+	}
+}
+
+void ParallelRecorder::recordSlice(uint32_t worker)
+{
+	// 连续切片：前 itemCount % threadCount 个线程多分一个条目
+	uint32_t threadCount = static_cast<uint32_t>(_threads.size());
+	uint32_t base = _itemCount / threadCount;
+	uint32_t extra = _itemCount % threadCount;
+	uint32_t first = worker * base + std::min(worker, extra);
+	uint32_t count = base + (worker < extra ? 1 : 0);
+
+	_recorded[worker] = count > 0;
+	if (count == 0) {
+		return;
+	}
+
+	FrameResources& resources = _frames[_frame];
+	beginSecondary(resources.pools[worker], resources.buffers[worker]);
+
+	_record(resources.buffers[worker], first, count);
+
+	if (vkEndCommandBuffer(resources.buffers[worker]) != VK_SUCCESS) {
+		throw std::runtime_error("failed to record secondary command buffer!");
+	}
+}
+
+void ParallelRecorder::createPool(VkCommandPool& pool, VkCommandBuffer& buffer)
+{
+	// 每帧整体重置，不需要单独重置命令缓冲
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = _queueFamily;
+
+	if (vkCreateCommandPool(_device, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create secondary command pool!");
+	}
+
+	VkCommandBufferAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.commandPool = pool;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+	allocInfo.commandBufferCount = 1;
+
+	if (vkAllocateCommandBuffers(_device, &allocInfo, &buffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate secondary command buffer!");
+	}
+}
+
+void ParallelRecorder::beginSecondary(VkCommandPool pool, VkCommandBuffer buffer)
+{
+	vkResetCommandPool(_device, pool, 0);
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	beginInfo.pInheritanceInfo = &_inheritance;
+
+	if (vkBeginCommandBuffer(buffer, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("failed to begin recording secondary command buffer!");
+	}
+}
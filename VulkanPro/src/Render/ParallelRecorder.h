@@ -0,0 +1,161 @@
+﻿#ifndef PARALLELRECORDER_H_
+#define PARALLELRECORDER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "vulkan/vulkan.h"
+
+/**
+ * @brief 多线程次级命令缓冲录制器。
+ *
+ * 持有一组常驻工作线程，每个线程在每个帧槽位上拥有独立的 VkCommandPool 与一个次级命令缓冲，
+ * 因此录制期间线程之间不需要任何同步。一帧的绘制列表按连续切片平均分给各线程，
+ * 主命令缓冲在以 VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS 开始的渲染通道中用 vkCmdExecuteCommands 执行。
+ *
+ * 用法：Begin() 唤醒工作线程后立即返回，调用线程可同时录制自己的次级命令缓冲（如 ImGui），
+ * 再调用 Wait() 取得按切片顺序排列的结果。
+ */
+class ParallelRecorder
+{
+public:
+	/**
+	 * @brief 录制回调：将绘制列表中 [first, first + count) 的条目写入次级命令缓冲。
+	 *
+	 * 会在多个工作线程上同时调用，只能读取共享状态。
+	 */
+	using RecordFunc = std::function<void(VkCommandBuffer commandBuffer, uint32_t first, uint32_t count)>;
+
+public:
+	ParallelRecorder();
+
+	~ParallelRecorder();
+
+	ParallelRecorder(const ParallelRecorder&) = delete;
+	ParallelRecorder& operator=(const ParallelRecorder&) = delete;
+
+public:
+	/**
+	 * @brief 创建命令池、次级命令缓冲并启动工作线程。
+	 *
+	 * @param device      逻辑设备。
+	 * @param queueFamily 主命令缓冲提交到的队列族索引。
+	 * @param frameCount  帧槽位数量（Frames in Flight）。
+	 * @param threadCount 工作线程数量，0 表示不启用并行录制。
+	 *
+	 * @throws std::runtime_error 创建命令池或分配命令缓冲失败时抛出。
+	 */
+	void Init(VkDevice device, uint32_t queueFamily, uint32_t frameCount, uint32_t threadCount);
+
+	/**
+	 * @brief 停止工作线程并销毁所有命令池。调用前 GPU 必须不再使用这些命令缓冲。
+	 */
+	void Destroy();
+
+	/**
+	 * @brief 是否启用了并行录制。
+	 */
+	bool IsEnabled() const { return !_threads.empty(); }
+
+	/**
+	 * @brief 工作线程数量。
+	 */
+	uint32_t ThreadCount() const { return static_cast<uint32_t>(_threads.size()); }
+
+	/**
+	 * @brief 开始并行录制一帧。帧槽位的栅栏必须已经触发。
+	 *
+	 * @param frame       帧槽位索引。
+	 * @param inheritance 次级命令缓冲继承的渲染通道、子通道与帧缓冲；pNext 链（动态渲染的附件格式）需在 Wait() 返回前保持有效。
+	 * @param itemCount   绘制列表的条目数。
+	 * @param record      录制回调。
+	 */
+	void Begin(uint32_t frame, const VkCommandBufferInheritanceInfo& inheritance, uint32_t itemCount, const RecordFunc& record);
+
+	/**
+	 * @brief 等待本帧所有工作线程录制完成。
+	 *
+	 * @return 非空切片对应的次级命令缓冲，按切片顺序排列。
+	 *
+	 * @throws std::runtime_error 任一工作线程录制失败时抛出。
+	 */
+	const std::vector<VkCommandBuffer>& Wait();
+
+	/**
+	 * @brief 为调用线程开始录制一个次级命令缓冲，用于不能在工作线程上录制的命令（如 ImGui）。
+	 *
+	 * 录制结束后由调用方执行 vkEndCommandBuffer。
+	 *
+	 * @throws std::runtime_error 开始录制失败时抛出。
+	 */
+	VkCommandBuffer BeginMainSecondary(uint32_t frame, const VkCommandBufferInheritanceInfo& inheritance);
+
+private:
+	/**
+	 * @brief 一个帧槽位上的命令池与次级命令缓冲：每个工作线程一份，另加调用线程一份。
+	 */
+	struct FrameResources {
+		std::vector<VkCommandPool> pools;
+		std::vector<VkCommandBuffer> buffers;
+
+		VkCommandPool mainPool = VK_NULL_HANDLE;
+		VkCommandBuffer mainBuffer = VK_NULL_HANDLE;
+	};
+
+	/**
+	 * @brief 工作线程主循环。
+	 */
+	void workerLoop(uint32_t worker);
+
+	/**
+	 * @brief 录制一个工作线程负责的切片。
+	 */
+	void recordSlice(uint32_t worker);
+
+	/**
+	 * @brief 创建命令池并分配一个次级命令缓冲。
+	 */
+	void createPool(VkCommandPool& pool, VkCommandBuffer& buffer);
+
+	/**
+	 * @brief 重置命令池并以继承信息开始录制次级命令缓冲。
+	 */
+	void beginSecondary(VkCommandPool pool, VkCommandBuffer buffer);
+
+private:
+	VkDevice _device = VK_NULL_HANDLE;
+
+	uint32_t _queueFamily = 0;
+
+	std::vector<FrameResources> _frames;
+
+	std::vector<std::thread> _threads;
+
+	// 当前帧的录制参数，在 Begin() 中写入，工作线程只读
+	uint32_t _frame = 0;
+	uint32_t _itemCount = 0;
+	VkCommandBufferInheritanceInfo _inheritance{};
+	RecordFunc _record;
+
+	// 启动与完成的同步：_generation 递增表示有新的一帧，_pending 为尚未完成的线程数
+	std::mutex _mutex;
+	std::condition_variable _startCondition;
+	std::condition_variable _doneCondition;
+	uint64_t _generation = 0;
+	uint32_t _pending = 0;
+	bool _stop = false;
+
+	// 每个工作线程是否录制了非空切片，以及录制中抛出的异常
+	std::vector<char> _recorded;
+	std::vector<std::exception_ptr> _errors;
+
+	// Wait() 的结果
+	std::vector<VkCommandBuffer> _results;
+};
+
+#endif    // !PARALLELRECORDER_H_
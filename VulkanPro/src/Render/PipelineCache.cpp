@@ -0,0 +1,185 @@
+﻿#include "PipelineCache.h"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace {
+	// 文件魔数 "GWPC"
+	constexpr uint32_t kCacheMagic = 0x43505747;
+
+	// 文件格式版本，修改 FileHeader 布局时递增
+	constexpr uint32_t kCacheVersion = 1;
+}
+
+PipelineCache::PipelineCache() {}
+
+PipelineCache::~PipelineCache() {}
+
+void PipelineCache::Init(VkPhysicalDevice physicalDevice, VkDevice device, const std::string& path)
+{
+	_device = device;
+	_path = path;
+	vkGetPhysicalDeviceProperties(physicalDevice, &_properties);
+
+	// 读取磁盘缓存，校验失败时为空，相当于冷启动
+	std::vector<char> initialData = loadFile();
+	_warm = !initialData.empty();
+
+	VkPipelineCacheCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	createInfo.initialDataSize = initialData.size();
+	createInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+	VkResult result = vkCreatePipelineCache(_device, &createInfo, nullptr, &_cache);
+	if (result != VK_SUCCESS && _warm) {
+		// 驱动拒绝了旧数据，退回空缓存
+		std::cerr << "管线缓存数据被驱动拒绝，使用空缓存: " << _path << std::endl;
+		_warm = false;
+		createInfo.initialDataSize = 0;
+		createInfo.pInitialData = nullptr;
+		result = vkCreatePipelineCache(_device, &createInfo, nullptr, &_cache);
+	}
+
+	if (result != VK_SUCCESS) {
+		throw std::runtime_error("failed to create pipeline cache!");
+	}
+}
+
+bool PipelineCache::Save()
+{
+	if (_cache == VK_NULL_HANDLE || _path.empty()) {
+		return false;
+	}
+
+	// 先查询大小再取数据
+	size_t dataSize = 0;
+	if (vkGetPipelineCacheData(_device, _cache, &dataSize, nullptr) != VK_SUCCESS || dataSize == 0) {
+		return false;
+	}
+
+	std::vector<char> data(dataSize);
+	if (vkGetPipelineCacheData(_device, _cache, &dataSize, data.data()) != VK_SUCCESS) {
+		return false;
+	}
+	data.resize(dataSize);
+
+	FileHeader header{};
+	header.magic = kCacheMagic;
+	header.version = kCacheVersion;
+	header.vendorID = _properties.vendorID;
+	header.deviceID = _properties.deviceID;
+	header.driverVersion = _properties.driverVersion;
+	memcpy(header.uuid, _properties.pipelineCacheUUID, VK_UUID_SIZE);
+	header.dataSize = data.size();
+	header.dataHash = hashData(data.data(), data.size());
+
+	// 写入临时文件，完成后再重命名，保证目标文件要么是旧的完整版本，要么是新的完整版本
+	const std::string tmpPath = _path + ".tmp";
+	{
+		std::ofstream file(tmpPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			std::cerr << "无法写入管线缓存临时文件: " << tmpPath << std::endl;
+			return false;
+		}
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(data.data(), static_cast<std::streamsize>(data.size()));
+		file.flush();
+		if (!file.good()) {
+			std::cerr << "写入管线缓存失败: " << tmpPath << std::endl;
+			return false;
+		}
+	}
+
+	std::error_code ec;
+	std::filesystem::rename(tmpPath, _path, ec);
+	if (ec) {
+		std::cerr << "替换管线缓存文件失败: " << ec.message() << std::endl;
+		std::filesystem::remove(tmpPath, ec);
+		return false;
+	}
+
+	return true;
+}
+
+void PipelineCache::Destroy()
+{
+	if (_cache != VK_NULL_HANDLE) {
+		vkDestroyPipelineCache(_device, _cache, nullptr);
+		_cache = VK_NULL_HANDLE;
+	}
+}
+
+std::vector<char> PipelineCache::loadFile() const
+{
+	std::ifstream file(_path, std::ios::ate | std::ios::binary);
+	if (!file.is_open()) {
+		return {};
+	}
+
+	size_t fileSize = static_cast<size_t>(file.tellg());
+	if (fileSize < sizeof(FileHeader)) {
+		return {};
+	}
+
+	FileHeader header{};
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+	// 逐项校验文件头，任何一项不匹配都视为无效缓存
+	if (header.magic != kCacheMagic || header.version != kCacheVersion) {
+		return {};
+	}
+	if (header.vendorID != _properties.vendorID || header.deviceID != _properties.deviceID
+		|| header.driverVersion != _properties.driverVersion
+		|| memcmp(header.uuid, _properties.pipelineCacheUUID, VK_UUID_SIZE) != 0)
+	{
+		std::cout << "管线缓存与当前设备或驱动不匹配，忽略: " << _path << std::endl;
+		return {};
+	}
+	if (header.dataSize != fileSize - sizeof(FileHeader)) {
+		return {};
+	}
+
+	std::vector<char> data(static_cast<size_t>(header.dataSize));
+	file.read(data.data(), static_cast<std::streamsize>(data.size()));
+	if (!file.good() || hashData(data.data(), data.size()) != header.dataHash) {
+		std::cerr << "管线缓存文件已损坏，忽略: " << _path << std::endl;
+		return {};
+	}
+
+	if (!validateVulkanHeader(data)) {
+		return {};
+	}
+
+	return data;
+}
+
+bool PipelineCache::validateVulkanHeader(const std::vector<char>& data) const
+{
+	if (data.size() < sizeof(VkPipelineCacheHeaderVersionOne)) {
+		return false;
+	}
+
+	VkPipelineCacheHeaderVersionOne vkHeader{};
+	memcpy(&vkHeader, data.data(), sizeof(vkHeader));
+
+	return vkHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+		&& vkHeader.headerSize >= sizeof(VkPipelineCacheHeaderVersionOne)
+		&& vkHeader.vendorID == _properties.vendorID
+		&& vkHeader.deviceID == _properties.deviceID
+		&& memcmp(vkHeader.pipelineCacheUUID, _properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+}
+
+uint64_t PipelineCache::hashData(const char* data, size_t size)
+{
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= static_cast<uint8_t>(data[i]);
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
@@ -0,0 +1,110 @@
+﻿#ifndef PIPELINECACHE_H_
+#define PIPELINECACHE_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "vulkan/vulkan.h"
+
+/**
+ * @brief 持久化的 Vulkan 管线缓存（VkPipelineCache）。
+ *
+ * 启动时从磁盘加载上次保存的缓存数据，并按设备 UUID、厂商 ID、设备 ID 与驱动版本校验，
+ * 不匹配或损坏时丢弃并以空缓存启动（冷启动）。
+ * 程序内所有管线（包括 ImGui 的管线）都应使用同一个缓存对象，退出时原子地写回磁盘。
+ */
+class PipelineCache
+{
+public:
+	PipelineCache();
+
+	~PipelineCache();
+
+public:
+	/**
+	 * @brief 创建管线缓存，若磁盘上存在有效的缓存文件则用其内容初始化。
+	 *
+	 * @param physicalDevice 物理设备，用于读取缓存校验所需的设备属性。
+	 * @param device         逻辑设备。
+	 * @param path           缓存文件路径。
+	 *
+	 * @throws std::runtime_error 如果创建 VkPipelineCache 失败。
+	 */
+	void Init(VkPhysicalDevice physicalDevice, VkDevice device, const std::string& path);
+
+	/**
+	 * @brief 将当前缓存内容写回磁盘。
+	 *
+	 * 先写入同目录下的临时文件，再整体重命名覆盖目标文件，
+	 * 避免程序中途崩溃时留下半截的缓存文件。
+	 *
+	 * @return true 写入成功；false 写入失败（仅打印警告，不抛出异常）。
+	 */
+	bool Save();
+
+	/**
+	 * @brief 销毁 VkPipelineCache 对象（不会自动保存）。
+	 */
+	void Destroy();
+
+	/**
+	 * @brief 获取缓存句柄，用于 vkCreateGraphicsPipelines / ImGui 初始化。
+	 */
+	VkPipelineCache Get() const { return _cache; }
+
+	/**
+	 * @brief 本次启动是否成功加载了磁盘缓存（热启动）。
+	 */
+	bool IsWarm() const { return _warm; }
+
+private:
+	/**
+	 * @brief 缓存文件头，位于 Vulkan 缓存数据之前。
+	 *
+	 * Vulkan 自带的缓存头不包含驱动版本，因此额外记录一份，驱动升级后旧缓存自动失效。
+	 */
+	struct FileHeader {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t vendorID;
+		uint32_t deviceID;
+		uint32_t driverVersion;
+		uint8_t uuid[VK_UUID_SIZE];
+		uint64_t dataSize;
+		uint64_t dataHash;
+	};
+
+	/**
+	 * @brief 读取并校验缓存文件，返回可直接传给 vkCreatePipelineCache 的数据。
+	 *
+	 * @return std::vector<char> 校验通过的缓存数据；任何校验失败返回空数组。
+	 */
+	std::vector<char> loadFile() const;
+
+	/**
+	 * @brief 校验 Vulkan 缓存数据自带的头（VkPipelineCacheHeaderVersionOne）。
+	 */
+	bool validateVulkanHeader(const std::vector<char>& data) const;
+
+	/**
+	 * @brief 计算缓存数据的 FNV-1a 64 位哈希，用于检测文件损坏。
+	 */
+	static uint64_t hashData(const char* data, size_t size);
+
+private:
+	VkDevice _device = VK_NULL_HANDLE;
+
+	VkPipelineCache _cache = VK_NULL_HANDLE;
+
+	// 当前物理设备属性，用于校验与写入缓存文件头
+	VkPhysicalDeviceProperties _properties{};
+
+	// 缓存文件路径
+	std::string _path;
+
+	// 是否命中磁盘缓存
+	bool _warm = false;
+};
+
+#endif    // !PIPELINECACHE_H_
@@ -0,0 +1,236 @@
+﻿#include "PipelineManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+
+PipelineManager::PipelineManager() {}
+
+PipelineManager::~PipelineManager()
+{
+	// 保证线程在对象销毁前退出；管线与缓存应已由 Destroy() 释放
+	if (!_threads.empty()) {
+		Destroy();
+	}
+}
+
+void PipelineManager::Init(VkDevice device, VkPipelineCache mainCache, uint32_t threadCount, CreateFunc create)
+{
+	_device = device;
+	_mainCache = mainCache;
+	_create = std::move(create);
+	_stats = Stats{};
+	_stop = false;
+	_busy = 0;
+
+	if (threadCount == 0) {
+		return;
+	}
+
+	// 工作线程的缓存以主缓存的内容初始化，热启动时同样能命中
+	std::vector<char> initialData;
+	if (_mainCache != VK_NULL_HANDLE) {
+		size_t size = 0;
+		if (vkGetPipelineCacheData(_device, _mainCache, &size, nullptr) == VK_SUCCESS && size > 0) {
+			initialData.resize(size);
+			if (vkGetPipelineCacheData(_device, _mainCache, &size, initialData.data()) != VK_SUCCESS) {
+				initialData.clear();
+			}
+			initialData.resize(std::min(size, initialData.size()));
+		}
+	}
+
+	VkPipelineCacheCreateInfo cacheInfo{};
+	cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+	cacheInfo.initialDataSize = initialData.size();
+	cacheInfo.pInitialData = initialData.empty() ? nullptr : initialData.data();
+
+	_threadCaches.resize(threadCount, VK_NULL_HANDLE);
+	for (auto& cache : _threadCaches) {
+		if (vkCreatePipelineCache(_device, &cacheInfo, nullptr, &cache) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create worker pipeline cache!");
+		}
+	}
+
+	for (uint32_t i = 0; i < threadCount; i++) {
+		_threads.emplace_back(&PipelineManager::workerLoop, this, i);
+	}
+}
+
+void PipelineManager::Destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+		_queue.clear();
+	}
+	_workCondition.notify_all();
+
+	for (auto& thread : _threads) {
+		thread.join();
+	}
+	_threads.clear();
+
+	// 清空的队列不会再有线程完成，计数归零，之后以串行方式重新 Init() 时 PendingCount() 为 0
+	_busy = 0;
+
+	MergeCaches();
+	for (auto cache : _threadCaches) {
+		vkDestroyPipelineCache(_device, cache, nullptr);
+	}
+	_threadCaches.clear();
+
+	for (const auto& entry : _entries) {
+		if (entry.second.pipeline != VK_NULL_HANDLE) {
+			vkDestroyPipeline(_device, entry.second.pipeline, nullptr);
+		}
+	}
+	_entries.clear();
+}
+
+void PipelineManager::Request(uint64_t key)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (!_entries.emplace(key, Entry{}).second) {
+			return;
+		}
+		_stats.requested++;
+
+		if (!_threads.empty()) {
+			_queue.push_back(key);
+			_busy++;
+		}
+	}
+
+	// 没有工作线程时同步编译
+	if (_threads.empty()) {
+		compile(key, _mainCache);
+		return;
+	}
+	_workCondition.notify_one();
+}
+
+VkPipeline PipelineManager::Get(uint64_t key, VkPipeline fallback)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto it = _entries.find(key);
+		if (it != _entries.end()) {
+			return it->second.state == State::Ready ? it->second.pipeline : fallback;
+		}
+	}
+
+	Request(key);
+
+	// 同步编译时 Request() 返回后已经完成
+	std::lock_guard<std::mutex> lock(_mutex);
+	const Entry& entry = _entries[key];
+	return entry.state == State::Ready ? entry.pipeline : fallback;
+}
+
+void PipelineManager::WaitIdle()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	_idleCondition.wait(lock, [this]() { return _busy == 0; });
+}
+
+void PipelineManager::MergeCaches()
+{
+	if (_mainCache == VK_NULL_HANDLE || _threadCaches.empty()) {
+		return;
+	}
+
+	if (vkMergePipelineCaches(_device, _mainCache, static_cast<uint32_t>(_threadCaches.size()), _threadCaches.data()) != VK_SUCCESS) {
+		std::cerr << "合并工作线程的管线缓存失败" << std::endl;
+	}
+}
+
+std::vector<VkPipeline> PipelineManager::Reset()
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	// 排队的请求直接丢弃，只等待正在编译的变体
+	_busy -= static_cast<uint32_t>(_queue.size());
+	_queue.clear();
+	_idleCondition.wait(lock, [this]() { return _busy == 0; });
+
+	std::vector<VkPipeline> pipelines;
+	for (const auto& entry : _entries) {
+		if (entry.second.pipeline != VK_NULL_HANDLE) {
+			pipelines.push_back(entry.second.pipeline);
+		}
+	}
+	_entries.clear();
+	return pipelines;
+}
+
+size_t PipelineManager::PendingCount()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _busy;
+}
+
+PipelineManager::Stats PipelineManager::GetStats()
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	return _stats;
+}
+
+void PipelineManager::workerLoop(uint32_t worker)
+{
+	while (true) {
+		uint64_t key = 0;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_workCondition.wait(lock, [this]() { return _stop || !_queue.empty(); });
+			if (_stop) {
+				return;
+			}
+			key = _queue.front();
+			_queue.pop_front();
+		}
+
+		// 编译期间不持有锁，每个线程使用自己的管线缓存
+		compile(key, _threadCaches[worker]);
+	}
+}
+
+void PipelineManager::compile(uint64_t key, VkPipelineCache cache)
+{
+	auto start = std::chrono::steady_clock::now();
+
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	try {
+		pipeline = _create(key, cache);
+	}
+	catch (const std::exception& e) {
+		std::cerr << "管线变体编译失败 (" << key << "): " << e.what() << std::endl;
+	}
+
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	bool idle = false;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		Entry& entry = _entries[key];
+		entry.pipeline = pipeline;
+		entry.state = pipeline != VK_NULL_HANDLE ? State::Ready : State::Failed;
+		if (pipeline != VK_NULL_HANDLE) {
+			_stats.ready++;
+		}
+		else {
+			_stats.failed++;
+		}
+		_stats.compileMs += ms;
+
+		if (!_threads.empty()) {
+			idle = --_busy == 0;
+		}
+	}
+	if (idle) {
+		_idleCondition.notify_all();
+	}
+}
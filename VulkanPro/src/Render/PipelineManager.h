@@ -0,0 +1,159 @@
+﻿#ifndef PIPELINEMANAGER_H_
+#define PIPELINEMANAGER_H_
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "vulkan/vulkan.h"
+
+/**
+ * @brief 在工作线程池上异步编译管线变体。
+ *
+ * 变体由调用方定义的 64 位键标识，CreateFunc 负责按键创建管线。Request() 只把键放入队列，
+ * Get() 在变体尚未编译完成时返回调用方给出的通用管线，绘制不会因为编译而卡顿。
+ *
+ * 每个工作线程使用自己的 VkPipelineCache（以主缓存的内容初始化），线程之间不争用缓存内部的锁；
+ * MergeCaches() 用 vkMergePipelineCaches 把它们合并回主缓存，随主缓存一起写回磁盘。
+ *
+ * 线程数为 0 时 Request() 在调用线程上同步编译，直接使用主缓存，用于对比。
+ */
+class PipelineManager
+{
+public:
+	/**
+	 * @brief 按键创建管线，失败时返回 VK_NULL_HANDLE 或抛出异常。
+	 *
+	 * 会在多个工作线程上同时调用，只能读取共享状态。
+	 */
+	using CreateFunc = std::function<VkPipeline(uint64_t key, VkPipelineCache cache)>;
+
+	/**
+	 * @brief 编译统计。
+	 */
+	struct Stats {
+		uint32_t requested = 0;    // 请求过的变体数
+		uint32_t ready = 0;        // 编译完成的变体数
+		uint32_t failed = 0;       // 编译失败的变体数
+		double compileMs = 0.0;    // 各线程编译耗时之和
+	};
+
+public:
+	PipelineManager();
+
+	~PipelineManager();
+
+	PipelineManager(const PipelineManager&) = delete;
+	PipelineManager& operator=(const PipelineManager&) = delete;
+
+public:
+	/**
+	 * @brief 创建各工作线程的管线缓存并启动线程。
+	 *
+	 * @param device      逻辑设备。
+	 * @param mainCache   主管线缓存，工作线程的缓存以其内容初始化，MergeCaches() 合并到这里。
+	 * @param threadCount 工作线程数，0 表示在调用线程上同步编译。
+	 * @param create      管线创建回调。
+	 *
+	 * @throws std::runtime_error 创建管线缓存失败时抛出。
+	 */
+	void Init(VkDevice device, VkPipelineCache mainCache, uint32_t threadCount, CreateFunc create);
+
+	/**
+	 * @brief 停止工作线程（丢弃尚未开始的编译），合并缓存并销毁所有变体管线。调用前 GPU 必须不再使用它们。
+	 */
+	void Destroy();
+
+	/**
+	 * @brief 请求编译一个变体，已请求过的键直接返回。
+	 */
+	void Request(uint64_t key);
+
+	/**
+	 * @brief 变体已编译完成时返回其管线，否则请求编译并返回 fallback。
+	 */
+	VkPipeline Get(uint64_t key, VkPipeline fallback);
+
+	/**
+	 * @brief 阻塞等待所有已请求的变体编译完成。
+	 */
+	void WaitIdle();
+
+	/**
+	 * @brief 将工作线程的管线缓存合并到主缓存。主缓存不能同时被其他线程使用。
+	 */
+	void MergeCaches();
+
+	/**
+	 * @brief 等待正在编译的变体完成、丢弃排队的请求，并交出所有已编译的管线由调用方延迟销毁。
+	 *
+	 * 用于着色器重载：之后创建回调看到的是新的着色器，新请求会重新编译。
+	 */
+	std::vector<VkPipeline> Reset();
+
+	/**
+	 * @brief 排队或正在编译的变体数。
+	 */
+	size_t PendingCount();
+
+	/**
+	 * @brief 工作线程数。
+	 */
+	uint32_t ThreadCount() const { return static_cast<uint32_t>(_threads.size()); }
+
+	/**
+	 * @brief 编译统计。
+	 */
+	Stats GetStats();
+
+private:
+	/**
+	 * @brief 变体状态。
+	 */
+	enum class State {
+		Queued,
+		Ready,
+		Failed,
+	};
+
+	struct Entry {
+		State state = State::Queued;
+		VkPipeline pipeline = VK_NULL_HANDLE;
+	};
+
+	/**
+	 * @brief 工作线程主循环。
+	 */
+	void workerLoop(uint32_t worker);
+
+	/**
+	 * @brief 调用创建回调并记录结果。不持有锁时调用。
+	 */
+	void compile(uint64_t key, VkPipelineCache cache);
+
+private:
+	VkDevice _device = VK_NULL_HANDLE;
+	VkPipelineCache _mainCache = VK_NULL_HANDLE;
+	CreateFunc _create;
+
+	std::vector<std::thread> _threads;
+	std::vector<VkPipelineCache> _threadCaches;
+
+	std::mutex _mutex;
+	std::condition_variable _workCondition;
+	std::condition_variable _idleCondition;
+	bool _stop = false;
+
+	// 以下成员受 _mutex 保护
+	std::deque<uint64_t> _queue;
+	uint32_t _busy = 0;
+	std::unordered_map<uint64_t, Entry> _entries;
+	Stats _stats;
+};
+
+#endif    // !PIPELINEMANAGER_H_
@@ -0,0 +1,225 @@
+﻿#include "PresentPacer.h"
+#include "../Helper/FrameStats.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+	// 与 PresentPacer::Policy 顺序一致
+	const char* kPolicyNames[PresentPacer::PolicyCount] = {
+		"low-latency",
+		"power-saver",
+		"uncapped",
+	};
+}
+
+PresentPacer::PresentPacer() {}
+
+PresentPacer::~PresentPacer() {}
+
+const char* PresentPacer::PolicyName(Policy policy)
+{
+	return policy < PolicyCount ? kPolicyNames[policy] : "unknown";
+}
+
+PresentPacer::Policy PresentPacer::ParsePolicy(const std::string& name)
+{
+	for (uint32_t i = 0; i < PolicyCount; i++) {
+		if (name == PolicyName(static_cast<Policy>(i))) {
+			return static_cast<Policy>(i);
+		}
+	}
+	throw std::runtime_error("未知的呈现策略: " + name);
+}
+
+VkPresentModeKHR PresentPacer::ChooseMode(Policy policy, const std::vector<VkPresentModeKHR>& availableModes)
+{
+	auto available = [&](VkPresentModeKHR mode) {
+		return std::find(availableModes.begin(), availableModes.end(), mode) != availableModes.end();
+	};
+
+	switch (policy) {
+	case LowLatency:
+		// 不撕裂的前提下延迟最低：新帧直接替换队列中等待的旧帧
+		if (available(VK_PRESENT_MODE_MAILBOX_KHR)) {
+			return VK_PRESENT_MODE_MAILBOX_KHR;
+		}
+		break;
+	case Uncapped:
+		// 不等待垂直同步，帧率只受 CPU/GPU 限制
+		if (available(VK_PRESENT_MODE_IMMEDIATE_KHR)) {
+			return VK_PRESENT_MODE_IMMEDIATE_KHR;
+		}
+		if (available(VK_PRESENT_MODE_MAILBOX_KHR)) {
+			return VK_PRESENT_MODE_MAILBOX_KHR;
+		}
+		break;
+	default:
+		break;
+	}
+
+	// 所有 Vulkan 设备都必须支持 FIFO 模式
+	return VK_PRESENT_MODE_FIFO_KHR;
+}
+
+const char* PresentPacer::ModeName(VkPresentModeKHR mode)
+{
+	switch (mode) {
+	case VK_PRESENT_MODE_IMMEDIATE_KHR:
+		return "immediate";
+	case VK_PRESENT_MODE_MAILBOX_KHR:
+		return "mailbox";
+	case VK_PRESENT_MODE_FIFO_KHR:
+		return "fifo";
+	case VK_PRESENT_MODE_FIFO_RELAXED_KHR:
+		return "fifo-relaxed";
+	default:
+		return "unknown";
+	}
+}
+
+void PresentPacer::Init(VkDevice device, bool presentWait, Policy policy, uint32_t latencyFrames)
+{
+	_device = device;
+	_policy = policy;
+	SetLatencyFrames(latencyFrames);
+
+	_waitForPresent = nullptr;
+	if (presentWait) {
+		_waitForPresent = (PFN_vkWaitForPresentKHR)vkGetDeviceProcAddr(device, "vkWaitForPresentKHR");
+		if (_waitForPresent == nullptr) {
+			throw std::runtime_error("failed to load vkWaitForPresentKHR!");
+		}
+	}
+
+	for (auto& stats : _stats) {
+		stats.frameMs.reserve(kMaxSamples);
+		if (presentWait) {
+			stats.latencyMs.reserve(kMaxSamples);
+		}
+	}
+	ResetSwapchain();
+}
+
+void PresentPacer::SetPolicy(Policy policy)
+{
+	_policy = policy;
+
+	// 切换期间的交换链重建不计入新策略的帧间隔
+	_lastFrameStart = {};
+}
+
+void PresentPacer::SetLatencyFrames(uint32_t frames)
+{
+	_latencyFrames = std::clamp(frames, 1u, kMaxLatencyFrames);
+}
+
+void PresentPacer::ResetSwapchain()
+{
+	_presentId = 0;
+	_completedId = 0;
+}
+
+void PresentPacer::BeginFrame(VkSwapchainKHR swapChain)
+{
+	PolicyStats& stats = _stats[_policy];
+
+	// 即将开始第 _presentId + 1 帧，先等第 _presentId + 1 - latencyFrames 帧显示
+	if (IsPacing() && _presentId >= _latencyFrames) {
+		uint64_t target = _presentId + 1 - _latencyFrames;
+		if (target > _completedId) {
+			VkResult result = _waitForPresent(_device, swapChain, target, kWaitTimeoutNs);
+			if (result == VK_SUCCESS) {
+				// 之前未确认的帧一并视为在此刻显示，延迟是上限
+				auto presented = std::chrono::steady_clock::now();
+				for (uint64_t id = _completedId + 1; id <= target; id++) {
+					double ms = std::chrono::duration<double, std::milli>(presented - _frameStarts[id % kStartRing]).count();
+					addSample(stats.latencyMs, stats.latencySum, stats.latencyCount, ms);
+				}
+				_completedId = target;
+			}
+			// 超时或交换链过期时不阻塞，照常开始本帧
+		}
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	if (_lastFrameStart != std::chrono::steady_clock::time_point{}) {
+		double ms = std::chrono::duration<double, std::milli>(start - _lastFrameStart).count();
+		addSample(stats.frameMs, stats.frameSum, stats.frameCount, ms);
+	}
+	_lastFrameStart = start;
+	_frameStarts[(_presentId + 1) % kStartRing] = start;
+}
+
+const VkPresentIdKHR* PresentPacer::NextPresentId()
+{
+	if (!IsPacing()) {
+		return nullptr;
+	}
+
+	_presentId++;
+	_presentIdInfo = {};
+	_presentIdInfo.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR;
+	_presentIdInfo.swapchainCount = 1;
+	_presentIdInfo.pPresentIds = &_presentId;
+	return &_presentIdInfo;
+}
+
+double PresentPacer::AverageFrameMs(Policy policy) const
+{
+	const PolicyStats& stats = _stats[policy];
+	return stats.frameCount > 0 ? stats.frameSum / static_cast<double>(stats.frameCount) : -1.0;
+}
+
+double PresentPacer::AverageLatencyMs(Policy policy) const
+{
+	const PolicyStats& stats = _stats[policy];
+	return stats.latencyCount > 0 ? stats.latencySum / static_cast<double>(stats.latencyCount) : -1.0;
+}
+
+std::vector<std::string> PresentPacer::ReportJson(const std::array<VkPresentModeKHR, PolicyCount>& presentModes) const
+{
+	std::vector<std::string> reports;
+	for (uint32_t i = 0; i < PolicyCount; i++) {
+		const PolicyStats& stats = _stats[i];
+		if (stats.frameCount == 0) {
+			continue;
+		}
+
+		std::ostringstream out;
+		out << "{\"name\":\"present/" << PolicyName(static_cast<Policy>(i)) << "\""
+			<< ",\"present_mode\":\"" << ModeName(presentModes[i]) << "\""
+			<< ",\"pacing\":" << (IsPacing() ? "true" : "false")
+			<< ",\"latency_frames\":" << _latencyFrames
+			<< ",\"frames\":" << stats.frameCount
+			<< ",\"frame_ms\":" << percentilesJson(stats.frameMs)
+			<< ",\"latency_ms\":" << percentilesJson(stats.latencyMs)
+			<< "}";
+		reports.push_back(out.str());
+	}
+	return reports;
+}
+
+void PresentPacer::addSample(std::vector<double>& samples, double& sum, uint64_t& count, double ms)
+{
+	if (samples.size() < kMaxSamples) {
+		samples.push_back(ms);
+	}
+	sum += ms;
+	count++;
+}
+
+std::string PresentPacer::percentilesJson(const std::vector<double>& samples)
+{
+	if (samples.empty()) {
+		return "null";
+	}
+
+	std::ostringstream out;
+	out << "{\"p50\":" << FrameStats::Percentile(samples, 0.50)
+		<< ",\"p99\":" << FrameStats::Percentile(samples, 0.99)
+		<< ",\"max\":" << *std::max_element(samples.begin(), samples.end())
+		<< "}";
+	return out.str();
+}
@@ -0,0 +1,203 @@
+﻿#ifndef PRESENTPACER_H_
+#define PRESENTPACER_H_
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "vulkan/vulkan.h"
+
+/**
+ * @brief 呈现策略与基于 VK_KHR_present_wait 的帧节奏控制。
+ *
+ * 策略决定交换链的呈现模式（见 ChooseMode()），运行时切换后需要重建交换链。
+ *
+ * 设备支持 VK_KHR_present_id 与 VK_KHR_present_wait 时，每次呈现附带递增的 presentId，
+ * BeginFrame() 在开始第 N 帧前等待第 N - latencyFrames 帧真正显示，CPU 最多领先显示 latencyFrames 帧，
+ * 不再靠阻塞在帧栅栏上限速，输入采样到显示的延迟也随之降低。不支持时 BeginFrame() 只统计帧间隔。
+ *
+ * 每种策略分别统计帧间隔与延迟（本帧开始到呈现完成，等待返回时才观测到，因此是上限）。
+ */
+class PresentPacer
+{
+public:
+	/**
+	 * @brief 呈现策略。
+	 */
+	enum Policy : uint32_t {
+		LowLatency,    // MAILBOX 优先，不撕裂的最低延迟
+		PowerSaver,    // FIFO，垂直同步，帧率不超过刷新率
+		Uncapped,      // IMMEDIATE 优先，不限帧率，用于基准测试
+		PolicyCount
+	};
+
+	/**
+	 * @brief 每种策略保留的最大样本数，超出后只累计平均值。
+	 */
+	static constexpr size_t kMaxSamples = 100000;
+
+	/**
+	 * @brief latencyFrames 的上限。
+	 */
+	static constexpr uint32_t kMaxLatencyFrames = 8;
+
+public:
+	PresentPacer();
+
+	~PresentPacer();
+
+public:
+	/**
+	 * @brief 策略名称（同时也是命令行参数取值）。
+	 */
+	static const char* PolicyName(Policy policy);
+
+	/**
+	 * @brief 按名称解析策略。
+	 *
+	 * @throws std::runtime_error 名称未知时抛出。
+	 */
+	static Policy ParsePolicy(const std::string& name);
+
+	/**
+	 * @brief 按策略从 Surface 支持的模式中选择呈现模式，FIFO 一定可用，作为最后的回退。
+	 */
+	static VkPresentModeKHR ChooseMode(Policy policy, const std::vector<VkPresentModeKHR>& availableModes);
+
+	/**
+	 * @brief 呈现模式名称，用于界面显示与报告。
+	 */
+	static const char* ModeName(VkPresentModeKHR mode);
+
+	/**
+	 * @brief 初始化。
+	 *
+	 * @param device        逻辑设备。
+	 * @param presentWait   设备是否启用了 presentId 与 presentWait 特性。
+	 * @param policy        初始策略。
+	 * @param latencyFrames CPU 最多领先显示的帧数（1 ~ kMaxLatencyFrames）。
+	 *
+	 * @throws std::runtime_error 获取 vkWaitForPresentKHR 失败时抛出。
+	 */
+	void Init(VkDevice device, bool presentWait, Policy policy, uint32_t latencyFrames);
+
+	/**
+	 * @brief 是否按呈现完成控制帧节奏。
+	 */
+	bool IsPacing() const { return _waitForPresent != nullptr; }
+
+	/**
+	 * @brief 当前策略。
+	 */
+	Policy CurrentPolicy() const { return _policy; }
+
+	/**
+	 * @brief 切换策略，之后的样本计入新策略。调用者负责重建交换链。
+	 */
+	void SetPolicy(Policy policy);
+
+	/**
+	 * @brief CPU 最多领先显示的帧数。
+	 */
+	uint32_t LatencyFrames() const { return _latencyFrames; }
+
+	/**
+	 * @brief 设置 CPU 最多领先显示的帧数，限制在 1 ~ kMaxLatencyFrames。
+	 */
+	void SetLatencyFrames(uint32_t frames);
+
+	/**
+	 * @brief 交换链已重建：presentId 按交换链计数，从头开始。
+	 */
+	void ResetSwapchain();
+
+	/**
+	 * @brief 开始一帧：等待第 N - latencyFrames 帧显示（支持时），并记录帧间隔。
+	 *
+	 * @param swapChain 当前交换链。
+	 */
+	void BeginFrame(VkSwapchainKHR swapChain);
+
+	/**
+	 * @brief 空闲（按需渲染没有新内容或窗口最小化）后恢复渲染：下一帧不记录帧间隔，避免空闲时长混入统计。
+	 */
+	void Resume() { _lastFrameStart = {}; }
+
+	/**
+	 * @brief 为本帧的呈现分配 presentId，返回需要挂到 VkPresentInfoKHR::pNext 的结构；不支持时返回 nullptr。
+	 *
+	 * 返回的指针在下一次调用前有效。
+	 */
+	const VkPresentIdKHR* NextPresentId();
+
+	/**
+	 * @brief 某策略的平均帧间隔（毫秒），没有样本时为 -1。
+	 */
+	double AverageFrameMs(Policy policy) const;
+
+	/**
+	 * @brief 某策略的平均延迟（毫秒），没有样本（不支持 present_wait）时为 -1。
+	 */
+	double AverageLatencyMs(Policy policy) const;
+
+	/**
+	 * @brief 每个有样本的策略一行 JSON：帧间隔与延迟的分位数。
+	 *
+	 * @param presentModes 每种策略实际使用的呈现模式。
+	 */
+	std::vector<std::string> ReportJson(const std::array<VkPresentModeKHR, PolicyCount>& presentModes) const;
+
+private:
+	/**
+	 * @brief 记录一个样本：保留到 kMaxSamples 个，平均值始终累计。
+	 */
+	static void addSample(std::vector<double>& samples, double& sum, uint64_t& count, double ms);
+
+	/**
+	 * @brief 一组样本的分位数 JSON，样本为空时为 null。
+	 */
+	static std::string percentilesJson(const std::vector<double>& samples);
+
+private:
+	struct PolicyStats {
+		std::vector<double> frameMs;
+		std::vector<double> latencyMs;
+		double frameSum = 0.0;
+		uint64_t frameCount = 0;
+		double latencySum = 0.0;
+		uint64_t latencyCount = 0;
+	};
+
+	// 按 presentId 记录帧开始时间的环，长度需大于 kMaxLatencyFrames
+	static constexpr uint32_t kStartRing = 16;
+
+	// 等待呈现的超时（纳秒）：窗口被遮挡时呈现可能迟迟不完成，超时后照常开始下一帧
+	static constexpr uint64_t kWaitTimeoutNs = 100000000;
+
+private:
+	VkDevice _device = VK_NULL_HANDLE;
+
+	PFN_vkWaitForPresentKHR _waitForPresent = nullptr;
+
+	Policy _policy = LowLatency;
+
+	uint32_t _latencyFrames = 1;
+
+	// 当前交换链上最近一次分配的 presentId，0 表示尚未呈现
+	uint64_t _presentId = 0;
+
+	// 已确认显示的最大 presentId
+	uint64_t _completedId = 0;
+
+	VkPresentIdKHR _presentIdInfo{};
+
+	std::array<std::chrono::steady_clock::time_point, kStartRing> _frameStarts{};
+
+	std::chrono::steady_clock::time_point _lastFrameStart{};
+
+	std::array<PolicyStats, PolicyCount> _stats;
+};
+
+#endif    // !PRESENTPACER_H_
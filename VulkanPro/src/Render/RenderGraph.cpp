@@ -0,0 +1,763 @@
+﻿#include "RenderGraph.h"
+
+#include <algorithm>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+
+namespace {
+	// 一种访问方式对应的同步参数与瞬态图像用途
+	struct AccessInfo {
+		VkPipelineStageFlags2KHR stages = 0;
+		VkAccessFlags2KHR access = 0;
+		VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkImageUsageFlags usage = 0;
+	};
+
+	// 写入类访问，只有它们需要在屏障中刷新
+	constexpr VkAccessFlags2KHR kWriteAccess = VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR | VK_ACCESS_2_SHADER_WRITE_BIT_KHR
+		| VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR;
+
+	// 只使用与 vkCmdPipelineBarrier 数值相同的阶段与访问位，没有 synchronization2 时可以直接截断
+	AccessInfo accessInfo(RenderGraph::Access access, bool write)
+	{
+		AccessInfo info;
+		switch (access) {
+		case RenderGraph::Access::ColorAttachment:
+			info = { VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR,
+				VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT_KHR | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT_KHR,
+				VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT };
+			break;
+		case RenderGraph::Access::ShaderRead:
+			info = { VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT_KHR, VK_ACCESS_2_SHADER_READ_BIT_KHR,
+				VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, VK_IMAGE_USAGE_SAMPLED_BIT };
+			break;
+		case RenderGraph::Access::ComputeRead:
+			info = { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR, VK_ACCESS_2_SHADER_READ_BIT_KHR,
+				VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT };
+			break;
+		case RenderGraph::Access::ComputeWrite:
+			info = { VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT_KHR, VK_ACCESS_2_SHADER_READ_BIT_KHR | VK_ACCESS_2_SHADER_WRITE_BIT_KHR,
+				VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_USAGE_STORAGE_BIT };
+			break;
+		case RenderGraph::Access::TransferSrc:
+			info = { VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR, VK_ACCESS_2_TRANSFER_READ_BIT_KHR,
+				VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_SRC_BIT };
+			break;
+		case RenderGraph::Access::TransferDst:
+			info = { VK_PIPELINE_STAGE_2_TRANSFER_BIT_KHR, VK_ACCESS_2_TRANSFER_WRITE_BIT_KHR,
+				VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_USAGE_TRANSFER_DST_BIT };
+			break;
+		case RenderGraph::Access::IndirectRead:
+			info = { VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT_KHR, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT_KHR,
+				VK_IMAGE_LAYOUT_UNDEFINED, 0 };
+			break;
+		case RenderGraph::Access::VertexRead:
+			info = { VK_PIPELINE_STAGE_2_VERTEX_INPUT_BIT_KHR, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT_KHR,
+				VK_IMAGE_LAYOUT_UNDEFINED, 0 };
+			break;
+		}
+
+		// 以读取方式声明时不刷新写入
+		if (!write) {
+			info.access &= ~kWriteAccess;
+		}
+		return info;
+	}
+
+	// 一个通道对同一物理资源的所有访问合并后的需求
+	struct Need {
+		uint32_t physical = 0;
+		VkPipelineStageFlags2KHR stages = 0;
+		VkAccessFlags2KHR access = 0;
+		VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		bool write = false;
+	};
+
+	// 编译时模拟的资源状态
+	struct State {
+		VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		// 最后一次写入（含布局转换）的阶段与需要刷新的访问
+		VkPipelineStageFlags2KHR writeStages = 0;
+		VkAccessFlags2KHR writeAccess = 0;
+
+		// 最后一次写入之后读取过的阶段，写入已对这些阶段可见
+		VkPipelineStageFlags2KHR readStages = 0;
+	};
+
+	void mergeMemoryBarrier(VkMemoryBarrier2KHR& barrier, VkPipelineStageFlags2KHR srcStages, VkAccessFlags2KHR srcAccess,
+		VkPipelineStageFlags2KHR dstStages, VkAccessFlags2KHR dstAccess)
+	{
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2_KHR;
+		barrier.srcStageMask |= srcStages;
+		barrier.srcAccessMask |= srcAccess;
+		barrier.dstStageMask |= dstStages;
+		barrier.dstAccessMask |= dstAccess;
+	}
+
+	VkImageMemoryBarrier2KHR imageBarrier(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+		VkPipelineStageFlags2KHR srcStages, VkAccessFlags2KHR srcAccess, VkPipelineStageFlags2KHR dstStages, VkAccessFlags2KHR dstAccess)
+	{
+		VkImageMemoryBarrier2KHR barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2_KHR;
+		barrier.srcStageMask = srcStages;
+		barrier.srcAccessMask = srcAccess;
+		barrier.dstStageMask = dstStages;
+		barrier.dstAccessMask = dstAccess;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.baseMipLevel = 0;
+		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = 1;
+		return barrier;
+	}
+}
+
+RenderGraph::RenderGraph() {}
+
+RenderGraph::~RenderGraph() {}
+
+void RenderGraph::Init(VkDevice device, GpuAllocator& allocator, DeletionQueue& deletionQueue, PFN_vkCmdPipelineBarrier2KHR pipelineBarrier2)
+{
+	_device = device;
+	_allocator = &allocator;
+	_deletionQueue = &deletionQueue;
+	_pipelineBarrier2 = pipelineBarrier2;
+}
+
+void RenderGraph::Destroy()
+{
+	if (_device == VK_NULL_HANDLE) {
+		return;
+	}
+
+	destroyTransients(_transients, _slots);
+	_signature.clear();
+	Reset();
+
+	_device = VK_NULL_HANDLE;
+	_allocator = nullptr;
+	_deletionQueue = nullptr;
+	_pipelineBarrier2 = nullptr;
+}
+
+void RenderGraph::Reset()
+{
+	_physicals.clear();
+	_versions.clear();
+	_passes.clear();
+	_order.clear();
+	_batches.clear();
+	_finalBatch = Batch();
+}
+
+RenderGraph::Resource RenderGraph::CreateImage(const std::string& name, VkFormat format, VkExtent2D extent)
+{
+	Physical physical;
+	physical.name = name;
+	physical.format = format;
+	physical.extent = extent;
+	_physicals.push_back(physical);
+
+	Version version;
+	version.physical = static_cast<uint32_t>(_physicals.size() - 1);
+	_versions.push_back(version);
+	return static_cast<Resource>(_versions.size() - 1);
+}
+
+RenderGraph::Resource RenderGraph::ImportImage(const std::string& name, VkImage image, VkImageView view, VkFormat format,
+	VkExtent2D extent, const ExternalState& initial, const ExternalState& final)
+{
+	Resource resource = CreateImage(name, format, extent);
+	Physical& physical = _physicals.back();
+	physical.imported = true;
+	physical.vkImage = image;
+	physical.view = view;
+	physical.initial = initial;
+	physical.final = final;
+	return resource;
+}
+
+RenderGraph::Resource RenderGraph::ImportBuffer(const std::string& name, VkBuffer buffer, const ExternalState& initial,
+	const ExternalState& final)
+{
+	Resource resource = CreateImage(name, VK_FORMAT_UNDEFINED, { 0, 0 });
+	Physical& physical = _physicals.back();
+	physical.image = false;
+	physical.imported = true;
+	physical.buffer = buffer;
+	physical.initial = initial;
+	physical.final = final;
+	return resource;
+}
+
+RenderGraph::Pass RenderGraph::AddPass(const std::string& name, ExecuteFunc execute)
+{
+	PassInfo pass;
+	pass.name = name;
+	pass.execute = std::move(execute);
+	_passes.push_back(std::move(pass));
+	return static_cast<Pass>(_passes.size() - 1);
+}
+
+void RenderGraph::Read(Pass pass, Resource resource, Access access)
+{
+	_versions[resource].readers.push_back(pass);
+
+	Usage usage;
+	usage.version = resource;
+	usage.access = access;
+	_passes[pass].usages.push_back(usage);
+}
+
+RenderGraph::Resource RenderGraph::Write(Pass pass, Resource resource, Access access)
+{
+	// 版本不可变：每个版本只能被覆盖一次，之后的写入必须基于新版本
+	if (_versions[resource].overwritten) {
+		throw std::runtime_error("render graph resource '" + physicalOf(resource).name + "' version is written twice!");
+	}
+	_versions[resource].overwritten = true;
+
+	Usage usage;
+	usage.version = resource;
+	usage.access = access;
+	usage.write = true;
+	_passes[pass].usages.push_back(usage);
+
+	Version next;
+	next.physical = _versions[resource].physical;
+	next.writer = pass;
+	_versions.push_back(next);
+	return static_cast<Resource>(_versions.size() - 1);
+}
+
+void RenderGraph::Output(Resource resource)
+{
+	_versions[resource].output = true;
+}
+
+void RenderGraph::Compile(uint64_t retireSerial)
+{
+	cull();
+	sortPasses();
+	computeLifetimes();
+	allocateTransients(retireSerial);
+	buildBarriers();
+}
+
+void RenderGraph::Execute(VkCommandBuffer commandBuffer)
+{
+	for (size_t i = 0; i < _order.size(); i++) {
+		recordBatch(commandBuffer, _batches[i]);
+
+		const PassInfo& pass = _passes[_order[i]];
+		if (pass.execute) {
+			pass.execute(commandBuffer);
+		}
+	}
+	recordBatch(commandBuffer, _finalBatch);
+}
+
+VkImage RenderGraph::Image(Resource resource) const
+{
+	return physicalOf(resource).vkImage;
+}
+
+VkImageView RenderGraph::View(Resource resource) const
+{
+	return physicalOf(resource).view;
+}
+
+VkBuffer RenderGraph::Buffer(Resource resource) const
+{
+	return physicalOf(resource).buffer;
+}
+
+VkFormat RenderGraph::Format(Resource resource) const
+{
+	return physicalOf(resource).format;
+}
+
+VkExtent2D RenderGraph::Extent(Resource resource) const
+{
+	return physicalOf(resource).extent;
+}
+
+std::vector<std::string> RenderGraph::ExecutionOrder() const
+{
+	std::vector<std::string> names;
+	names.reserve(_order.size());
+	for (Pass pass : _order) {
+		names.push_back(_passes[pass].name);
+	}
+	return names;
+}
+
+void RenderGraph::cull()
+{
+	for (auto& pass : _passes) {
+		pass.culled = true;
+	}
+
+	// 从输出版本的写入者出发，沿读取与覆盖的版本反向追溯
+	std::vector<Pass> stack;
+	for (const auto& version : _versions) {
+		if (version.output && version.writer != UINT32_MAX) {
+			stack.push_back(version.writer);
+		}
+	}
+
+	while (!stack.empty()) {
+		Pass pass = stack.back();
+		stack.pop_back();
+		if (!_passes[pass].culled) {
+			continue;
+		}
+		_passes[pass].culled = false;
+
+		for (const Usage& usage : _passes[pass].usages) {
+			uint32_t writer = _versions[usage.version].writer;
+			if (writer != UINT32_MAX && _passes[writer].culled) {
+				stack.push_back(writer);
+			}
+		}
+	}
+
+	_stats.passes = static_cast<uint32_t>(_passes.size());
+	_stats.culledPasses = static_cast<uint32_t>(std::count_if(_passes.begin(), _passes.end(),
+		[](const PassInfo& pass) { return pass.culled; }));
+}
+
+void RenderGraph::sortPasses()
+{
+	size_t count = _passes.size();
+	std::vector<std::vector<Pass>> successors(count);
+	std::vector<uint32_t> indegree(count, 0);
+
+	auto addEdge = [&](uint32_t from, Pass to) {
+		if (from == UINT32_MAX || from == to || _passes[from].culled) {
+			return;
+		}
+		successors[from].push_back(to);
+		indegree[to]++;
+	};
+
+	// 读取或覆盖一个版本的通道依赖写出它的通道；覆盖一个版本的通道还要等所有读取它的通道（读后写）
+	for (Pass pass = 0; pass < count; pass++) {
+		if (_passes[pass].culled) {
+			continue;
+		}
+		for (const Usage& usage : _passes[pass].usages) {
+			const Version& version = _versions[usage.version];
+			addEdge(version.writer, pass);
+			if (usage.write) {
+				for (Pass reader : version.readers) {
+					addEdge(reader, pass);
+				}
+			}
+		}
+	}
+
+	// Kahn 算法，每次取声明顺序最靠前的就绪通道，没有依赖关系的通道保持声明顺序
+	std::set<Pass> ready;
+	size_t kept = 0;
+	for (Pass pass = 0; pass < count; pass++) {
+		if (!_passes[pass].culled) {
+			kept++;
+			if (indegree[pass] == 0) {
+				ready.insert(pass);
+			}
+		}
+	}
+
+	_order.clear();
+	while (!ready.empty()) {
+		Pass pass = *ready.begin();
+		ready.erase(ready.begin());
+		_order.push_back(pass);
+
+		for (Pass next : successors[pass]) {
+			if (--indegree[next] == 0) {
+				ready.insert(next);
+			}
+		}
+	}
+
+	if (_order.size() != kept) {
+		throw std::runtime_error("render graph contains a dependency cycle!");
+	}
+}
+
+void RenderGraph::computeLifetimes()
+{
+	for (uint32_t i = 0; i < _order.size(); i++) {
+		for (const Usage& usage : _passes[_order[i]].usages) {
+			Physical& physical = _physicals[_versions[usage.version].physical];
+			AccessInfo info = accessInfo(usage.access, usage.write);
+			physical.usage |= info.usage;
+			physical.stages |= info.stages;
+			physical.first = std::min(physical.first, i);
+			physical.last = std::max(physical.last, i);
+		}
+	}
+}
+
+void RenderGraph::allocateTransients(uint64_t retireSerial)
+{
+	// 被保留的通道使用到的瞬态图像，按声明顺序
+	std::vector<uint32_t> indices;
+	std::string signature = _aliasing ? "alias" : "separate";
+	for (uint32_t i = 0; i < _physicals.size(); i++) {
+		const Physical& physical = _physicals[i];
+		if (physical.imported || physical.first == UINT32_MAX) {
+			continue;
+		}
+		indices.push_back(i);
+		signature += ";" + std::to_string(physical.format) + "," + std::to_string(physical.extent.width) + "x"
+			+ std::to_string(physical.extent.height) + "," + std::to_string(physical.usage) + ","
+			+ std::to_string(physical.first) + "-" + std::to_string(physical.last);
+	}
+
+	// 描述与生命周期都不变，复用上一次创建的图像与显存块分配
+	if (signature == _signature) {
+		for (size_t i = 0; i < indices.size(); i++) {
+			Physical& physical = _physicals[indices[i]];
+			physical.vkImage = _transients[i].image;
+			physical.view = _transients[i].view;
+			physical.slot = _transients[i].slot;
+		}
+		return;
+	}
+
+	retireTransients(retireSerial);
+
+	std::vector<VkMemoryRequirements> requirements(indices.size());
+	for (size_t i = 0; i < indices.size(); i++) {
+		const Physical& physical = _physicals[indices[i]];
+
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = physical.format;
+		imageInfo.extent = { physical.extent.width, physical.extent.height, 1 };
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.usage = physical.usage;
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+		Transient transient;
+		if (vkCreateImage(_device, &imageInfo, nullptr, &transient.image) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create render graph image '" + physical.name + "'!");
+		}
+		_transients.push_back(transient);
+		vkGetImageMemoryRequirements(_device, transient.image, &requirements[i]);
+	}
+
+	// 从大到小放入显存块：块内所有图像的生命周期互不重叠且内存类型兼容，块大小与对齐取其中的最大值
+	std::vector<size_t> bySize(indices.size());
+	std::iota(bySize.begin(), bySize.end(), 0);
+	std::stable_sort(bySize.begin(), bySize.end(), [&](size_t a, size_t b) {
+		return requirements[a].size > requirements[b].size;
+	});
+
+	std::vector<VkMemoryRequirements> slotRequirements;
+	std::vector<std::vector<size_t>> slotMembers;
+	for (size_t index : bySize) {
+		const Physical& physical = _physicals[indices[index]];
+		const VkMemoryRequirements& required = requirements[index];
+
+		uint32_t slot = UINT32_MAX;
+		for (uint32_t s = 0; _aliasing && s < slotRequirements.size() && slot == UINT32_MAX; s++) {
+			if ((slotRequirements[s].memoryTypeBits & required.memoryTypeBits) == 0) {
+				continue;
+			}
+			bool overlaps = std::any_of(slotMembers[s].begin(), slotMembers[s].end(), [&](size_t member) {
+				const Physical& other = _physicals[indices[member]];
+				return other.first <= physical.last && physical.first <= other.last;
+			});
+			if (!overlaps) {
+				slot = s;
+			}
+		}
+
+		if (slot == UINT32_MAX) {
+			slot = static_cast<uint32_t>(slotRequirements.size());
+			slotRequirements.push_back(required);
+			slotMembers.emplace_back();
+		}
+		else {
+			VkMemoryRequirements& merged = slotRequirements[slot];
+			merged.size = std::max(merged.size, required.size);
+			merged.alignment = std::max(merged.alignment, required.alignment);
+			merged.memoryTypeBits &= required.memoryTypeBits;
+		}
+		slotMembers[slot].push_back(index);
+		_transients[index].slot = slot;
+	}
+
+	_stats.transientBytes = 0;
+	_stats.unaliasedBytes = 0;
+	for (const auto& required : slotRequirements) {
+		_slots.push_back(_allocator->Allocate(required, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, false));
+		_stats.transientBytes += required.size;
+	}
+
+	for (size_t i = 0; i < indices.size(); i++) {
+		Physical& physical = _physicals[indices[i]];
+		Transient& transient = _transients[i];
+		const GpuAllocation& allocation = _slots[transient.slot];
+		if (vkBindImageMemory(_device, transient.image, allocation.memory, allocation.offset) != VK_SUCCESS) {
+			throw std::runtime_error("failed to bind render graph image memory!");
+		}
+		_stats.unaliasedBytes += requirements[i].size;
+
+		// 只有附件、采样与存储图像需要视图，仅用于复制的图像没有
+		if ((physical.usage & (VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_STORAGE_BIT)) != 0) {
+			VkImageViewCreateInfo viewInfo{};
+			viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+			viewInfo.image = transient.image;
+			viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+			viewInfo.format = physical.format;
+			viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			viewInfo.subresourceRange.baseMipLevel = 0;
+			viewInfo.subresourceRange.levelCount = 1;
+			viewInfo.subresourceRange.baseArrayLayer = 0;
+			viewInfo.subresourceRange.layerCount = 1;
+
+			if (vkCreateImageView(_device, &viewInfo, nullptr, &transient.view) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create render graph image view!");
+			}
+		}
+
+		physical.vkImage = transient.image;
+		physical.view = transient.view;
+		physical.slot = transient.slot;
+	}
+
+	_signature = signature;
+	_stats.transientImages = static_cast<uint32_t>(indices.size());
+	_stats.memorySlots = static_cast<uint32_t>(slotRequirements.size());
+	_stats.rebuilds++;
+}
+
+void RenderGraph::retireTransients(uint64_t retireSerial)
+{
+	_signature.clear();
+	if (_transients.empty() && _slots.empty()) {
+		return;
+	}
+
+	// 已提交的帧可能仍在使用旧图像，完成后再销毁
+	std::vector<Transient> transients;
+	std::vector<GpuAllocation> slots;
+	transients.swap(_transients);
+	slots.swap(_slots);
+	_deletionQueue->Push(retireSerial, [this, transients, slots]() mutable {
+		destroyTransients(transients, slots);
+	});
+}
+
+void RenderGraph::destroyTransients(std::vector<Transient>& transients, std::vector<GpuAllocation>& slots)
+{
+	for (auto& transient : transients) {
+		if (transient.view != VK_NULL_HANDLE) {
+			vkDestroyImageView(_device, transient.view, nullptr);
+		}
+		vkDestroyImage(_device, transient.image, nullptr);
+	}
+	transients.clear();
+
+	for (auto& slot : slots) {
+		_allocator->Free(slot);
+	}
+	slots.clear();
+}
+
+void RenderGraph::buildBarriers()
+{
+	// 瞬态图像的初始状态：等待同一显存块中其他图像（以及上一帧的自己）的所有使用阶段，读后写只需要执行依赖
+	std::vector<VkPipelineStageFlags2KHR> slotStages(_slots.size(), 0);
+	for (const auto& physical : _physicals) {
+		if (!physical.imported && physical.slot != UINT32_MAX) {
+			slotStages[physical.slot] |= physical.stages;
+		}
+	}
+
+	std::vector<State> states(_physicals.size());
+	for (size_t i = 0; i < _physicals.size(); i++) {
+		const Physical& physical = _physicals[i];
+		if (physical.imported) {
+			states[i].layout = physical.image ? physical.initial.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+			states[i].writeStages = physical.initial.stages;
+			states[i].writeAccess = physical.initial.access;
+		}
+		else if (physical.slot != UINT32_MAX) {
+			states[i].writeStages = slotStages[physical.slot];
+		}
+	}
+
+	_stats.imageBarriers = 0;
+	_stats.memoryBarriers = 0;
+	_stats.barrierBatches = 0;
+	_batches.assign(_order.size(), Batch());
+
+	std::vector<Need> needs;
+	for (size_t i = 0; i < _order.size(); i++) {
+		const PassInfo& pass = _passes[_order[i]];
+
+		// 合并通道内对同一物理资源的多次访问
+		needs.clear();
+		for (const Usage& usage : pass.usages) {
+			uint32_t index = _versions[usage.version].physical;
+			const Physical& physical = _physicals[index];
+			AccessInfo info = accessInfo(usage.access, usage.write);
+			VkImageLayout layout = physical.image ? info.layout : VK_IMAGE_LAYOUT_UNDEFINED;
+
+			auto it = std::find_if(needs.begin(), needs.end(), [index](const Need& need) { return need.physical == index; });
+			if (it == needs.end()) {
+				Need need;
+				need.physical = index;
+				need.layout = layout;
+				needs.push_back(need);
+				it = needs.end() - 1;
+			}
+			else if (it->layout != layout) {
+				throw std::runtime_error("render graph pass '" + pass.name + "' uses image '" + physical.name + "' in two layouts!");
+			}
+			it->stages |= info.stages;
+			it->access |= info.access;
+			it->write = it->write || usage.write;
+		}
+
+		Batch& batch = _batches[i];
+		for (const Need& need : needs) {
+			const Physical& physical = _physicals[need.physical];
+			State& state = states[need.physical];
+
+			// 写入需要等待之前的写入与读取；读取只在写入尚未对本阶段可见时才需要屏障；布局转换本身也是写入
+			bool transition = physical.image && state.layout != need.layout;
+			bool hazard = need.write
+				? (transition || state.writeStages != 0 || state.readStages != 0)
+				: (transition || (state.writeStages != 0 && (need.stages & ~state.readStages) != 0));
+			if (hazard) {
+				VkPipelineStageFlags2KHR srcStages = state.writeStages | (need.write || transition ? state.readStages : 0);
+				if (physical.image) {
+					batch.images.push_back(imageBarrier(physical.vkImage, state.layout, need.layout, srcStages, state.writeAccess,
+						need.stages, need.access));
+				}
+				else {
+					mergeMemoryBarrier(batch.memory, srcStages, state.writeAccess, need.stages, need.access);
+					batch.hasMemory = true;
+				}
+			}
+
+			if (need.write || transition) {
+				state.writeStages = need.stages;
+				state.writeAccess = need.access & kWriteAccess;
+				state.readStages = need.write ? 0 : need.stages;
+			}
+			else {
+				state.readStages |= need.stages;
+			}
+			state.layout = need.layout;
+		}
+	}
+
+	// 执行结束后把导入的资源转换到最终状态
+	_finalBatch = Batch();
+	for (size_t i = 0; i < _physicals.size(); i++) {
+		const Physical& physical = _physicals[i];
+		const State& state = states[i];
+		if (!physical.imported || physical.first == UINT32_MAX || physical.final.stages == 0) {
+			continue;
+		}
+
+		VkPipelineStageFlags2KHR srcStages = state.writeStages | state.readStages;
+		if (physical.image) {
+			VkImageLayout layout = physical.final.layout != VK_IMAGE_LAYOUT_UNDEFINED ? physical.final.layout : state.layout;
+			_finalBatch.images.push_back(imageBarrier(physical.vkImage, state.layout, layout, srcStages, state.writeAccess,
+				physical.final.stages, physical.final.access));
+		}
+		else {
+			mergeMemoryBarrier(_finalBatch.memory, srcStages, state.writeAccess, physical.final.stages, physical.final.access);
+			_finalBatch.hasMemory = true;
+		}
+	}
+
+	auto count = [this](const Batch& batch) {
+		_stats.imageBarriers += static_cast<uint32_t>(batch.images.size());
+		_stats.memoryBarriers += batch.hasMemory ? 1 : 0;
+		_stats.barrierBatches += !batch.images.empty() || batch.hasMemory ? 1 : 0;
+	};
+	for (const auto& batch : _batches) {
+		count(batch);
+	}
+	count(_finalBatch);
+}
+
+void RenderGraph::recordBatch(VkCommandBuffer commandBuffer, const Batch& batch) const
+{
+	if (batch.images.empty() && !batch.hasMemory) {
+		return;
+	}
+
+	if (_pipelineBarrier2 != nullptr) {
+		VkDependencyInfoKHR dependency{};
+		dependency.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO_KHR;
+		dependency.memoryBarrierCount = batch.hasMemory ? 1 : 0;
+		dependency.pMemoryBarriers = &batch.memory;
+		dependency.imageMemoryBarrierCount = static_cast<uint32_t>(batch.images.size());
+		dependency.pImageMemoryBarriers = batch.images.data();
+		_pipelineBarrier2(commandBuffer, &dependency);
+		return;
+	}
+
+	// 没有 synchronization2：合并所有屏障的阶段，访问位与旧版数值相同，直接截断
+	VkPipelineStageFlags srcStages = 0;
+	VkPipelineStageFlags dstStages = 0;
+	std::vector<VkImageMemoryBarrier> images(batch.images.size());
+	for (size_t i = 0; i < batch.images.size(); i++) {
+		const VkImageMemoryBarrier2KHR& source = batch.images[i];
+		srcStages |= static_cast<VkPipelineStageFlags>(source.srcStageMask);
+		dstStages |= static_cast<VkPipelineStageFlags>(source.dstStageMask);
+
+		VkImageMemoryBarrier& barrier = images[i];
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcAccessMask = static_cast<VkAccessFlags>(source.srcAccessMask);
+		barrier.dstAccessMask = static_cast<VkAccessFlags>(source.dstAccessMask);
+		barrier.oldLayout = source.oldLayout;
+		barrier.newLayout = source.newLayout;
+		barrier.srcQueueFamilyIndex = source.srcQueueFamilyIndex;
+		barrier.dstQueueFamilyIndex = source.dstQueueFamilyIndex;
+		barrier.image = source.image;
+		barrier.subresourceRange = source.subresourceRange;
+	}
+
+	VkMemoryBarrier memory{};
+	memory.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	if (batch.hasMemory) {
+		srcStages |= static_cast<VkPipelineStageFlags>(batch.memory.srcStageMask);
+		dstStages |= static_cast<VkPipelineStageFlags>(batch.memory.dstStageMask);
+		memory.srcAccessMask = static_cast<VkAccessFlags>(batch.memory.srcAccessMask);
+		memory.dstAccessMask = static_cast<VkAccessFlags>(batch.memory.dstAccessMask);
+	}
+
+	// 旧版屏障的阶段不能为 0
+	vkCmdPipelineBarrier(commandBuffer, srcStages != 0 ? srcStages : VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+		dstStages != 0 ? dstStages : VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0, batch.hasMemory ? 1 : 0, &memory, 0, nullptr,
+		static_cast<uint32_t>(images.size()), images.data());
+}
+
+const RenderGraph::Physical& RenderGraph::physicalOf(Resource resource) const
+{
+	return _physicals[_versions[resource].physical];
+}
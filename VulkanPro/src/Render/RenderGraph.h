@@ -0,0 +1,353 @@
+﻿#ifndef RENDERGRAPH_H_
+#define RENDERGRAPH_H_
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "DeletionQueue.h"
+#include "GpuAllocator.h"
+
+/**
+ * @brief 帧渲染图：通道声明对图像与缓冲的读写，由图负责执行顺序、剔除、屏障与瞬态图像的显存。
+ *
+ * 每帧 Reset() 后重新声明资源与通道，然后 Compile()、Execute()：
+ * - 资源按版本区分：Write() 返回同一资源的新版本。读取某个版本的通道排在写出该版本的通道之后，
+ *   覆盖某个版本的通道排在所有读取该版本的通道之后。依赖完全由版本决定，与声明顺序无关，
+ *   编译时按拓扑排序执行，没有依赖关系的通道保持声明顺序。
+ * - 从 Output() 标记的资源版本反向追溯，对任何输出都没有贡献的通道被剔除，只被它们使用的瞬态图像也不会创建。
+ * - 屏障按每个资源的布局、最后一次写入与之后的读取推导：读后读不插屏障，同一通道内对同一资源的多次访问合并为一个屏障，
+ *   缓冲之间的依赖合并为一个全局内存屏障，每个通道之前的所有屏障一次提交。设备支持 VK_KHR_synchronization2 时
+ *   使用 vkCmdPipelineBarrier2，否则退回 vkCmdPipelineBarrier。
+ * - 瞬态图像的用途由通道的访问方式汇总得出。生命周期（第一次到最后一次使用它的通道）互不重叠、内存类型兼容的图像
+ *   绑定到同一块显存。资源描述与生命周期都不变时复用上一次编译创建的图像，变化时（如窗口尺寸改变）旧图像延迟销毁。
+ *
+ * 瞬态图像的内容不跨帧保留，每帧第一次使用时从 UNDEFINED 转换。只支持单层、单 mip 级别的颜色图像。
+ * 只能在渲染线程使用。
+ */
+class RenderGraph
+{
+public:
+	/**
+	 * @brief 资源版本句柄，只在下一次 Reset() 之前有效。
+	 */
+	using Resource = uint32_t;
+
+	/**
+	 * @brief 通道句柄，只在下一次 Reset() 之前有效。
+	 */
+	using Pass = uint32_t;
+
+	/**
+	 * @brief 通道的录制回调，在 Execute() 中按执行顺序调用，调用前该通道需要的屏障已经录制。
+	 */
+	using ExecuteFunc = std::function<void(VkCommandBuffer)>;
+
+	/**
+	 * @brief 通道访问资源的方式，决定屏障的管线阶段、访问掩码与图像布局，以及瞬态图像的用途。
+	 */
+	enum class Access {
+		ColorAttachment,    // 颜色附件
+		ShaderRead,         // 片段着色器采样
+		ComputeRead,        // 计算着色器读取（存储缓冲 / 存储图像）
+		ComputeWrite,       // 计算着色器写入
+		TransferSrc,        // 复制 / blit 源
+		TransferDst,        // 复制 / blit 目标
+		IndirectRead,       // 间接绘制参数
+		VertexRead          // 顶点 / 实例属性
+	};
+
+	/**
+	 * @brief 资源在图外的同步状态：导入时的初始状态，或执行结束时要转换到的最终状态。
+	 *
+	 * 最终状态的 stages 为 0 时执行结束后不再插入屏障。
+	 */
+	struct ExternalState {
+		VkImageLayout layout = VK_IMAGE_LAYOUT_UNDEFINED;
+		VkPipelineStageFlags2KHR stages = 0;
+		VkAccessFlags2KHR access = 0;
+	};
+
+	/**
+	 * @brief 最近一次 Compile() 的统计，rebuilds 为累计值。
+	 */
+	struct Stats {
+		// 声明的通道数与其中被剔除的通道数
+		uint32_t passes = 0;
+		uint32_t culledPasses = 0;
+
+		// 图像屏障数与全局内存屏障数（缓冲依赖合并后）
+		uint32_t imageBarriers = 0;
+		uint32_t memoryBarriers = 0;
+
+		// 屏障命令数：每批一次 vkCmdPipelineBarrier2
+		uint32_t barrierBatches = 0;
+
+		// 创建的瞬态图像数与它们共用的显存块数
+		uint32_t transientImages = 0;
+		uint32_t memorySlots = 0;
+
+		// 瞬态图像实际占用的显存，以及每个图像单独分配时需要的显存
+		VkDeviceSize transientBytes = 0;
+		VkDeviceSize unaliasedBytes = 0;
+
+		// 重新创建瞬态图像的次数
+		uint64_t rebuilds = 0;
+	};
+
+public:
+	RenderGraph();
+
+	~RenderGraph();
+
+public:
+	/**
+	 * @brief 初始化。
+	 *
+	 * @param device          逻辑设备。
+	 * @param allocator       显存分配器，瞬态图像的显存从中分配。
+	 * @param deletionQueue   延迟销毁队列，重建时旧的瞬态图像在其最后一次提交完成后销毁。
+	 * @param pipelineBarrier2 vkCmdPipelineBarrier2KHR，设备不支持 VK_KHR_synchronization2 时为 nullptr。
+	 */
+	void Init(VkDevice device, GpuAllocator& allocator, DeletionQueue& deletionQueue, PFN_vkCmdPipelineBarrier2KHR pipelineBarrier2);
+
+	/**
+	 * @brief 立即销毁所有瞬态图像。调用前 GPU 必须已经空闲。
+	 */
+	void Destroy();
+
+	/**
+	 * @brief 是否已初始化。
+	 */
+	bool IsValid() const { return _device != VK_NULL_HANDLE; }
+
+	/**
+	 * @brief 是否使用 vkCmdPipelineBarrier2 录制屏障。
+	 */
+	bool UsesSynchronization2() const { return _pipelineBarrier2 != nullptr; }
+
+	/**
+	 * @brief 是否让生命周期不重叠的瞬态图像共用显存，默认开启。下一次 Compile() 时生效。
+	 */
+	void SetAliasing(bool enabled) { _aliasing = enabled; }
+	bool Aliasing() const { return _aliasing; }
+
+	/**
+	 * @brief 清空上一帧声明的资源与通道，开始声明新的一帧。已创建的瞬态图像保留到 Compile() 决定是否复用。
+	 */
+	void Reset();
+
+	/**
+	 * @brief 声明瞬态颜色图像，由图创建并管理显存。
+	 */
+	Resource CreateImage(const std::string& name, VkFormat format, VkExtent2D extent);
+
+	/**
+	 * @brief 导入外部图像（如交换链图像）。
+	 *
+	 * @param initial 执行前的布局，以及图像可用之前必须等待的阶段（如获取图像信号量的等待阶段）。
+	 * @param final   执行结束后要转换到的布局与之后使用它的阶段。
+	 */
+	Resource ImportImage(const std::string& name, VkImage image, VkImageView view, VkFormat format, VkExtent2D extent,
+		const ExternalState& initial, const ExternalState& final);
+
+	/**
+	 * @brief 导入外部缓冲。布局字段被忽略。
+	 */
+	Resource ImportBuffer(const std::string& name, VkBuffer buffer, const ExternalState& initial, const ExternalState& final);
+
+	/**
+	 * @brief 添加通道，随后用 Read() / Write() 声明它访问的资源。
+	 */
+	Pass AddPass(const std::string& name, ExecuteFunc execute);
+
+	/**
+	 * @brief 声明通道读取资源的某个版本。
+	 */
+	void Read(Pass pass, Resource resource, Access access);
+
+	/**
+	 * @brief 声明通道写入资源：通道在 resource 版本的内容上写入（附件 LOAD 时可见原内容），产生并返回新版本。
+	 *
+	 * @throws std::runtime_error 同一版本被写入两次时抛出。
+	 */
+	Resource Write(Pass pass, Resource resource, Access access);
+
+	/**
+	 * @brief 标记资源版本为图的输出，写出它的通道及其依赖不会被剔除。
+	 */
+	void Output(Resource resource);
+
+	/**
+	 * @brief 排序、剔除、分配瞬态图像并推导屏障。
+	 *
+	 * @param retireSerial 需要重建瞬态图像时，旧图像在该序号的提交完成后销毁（通常为最后一次提交的序号）。
+	 *
+	 * @throws std::runtime_error 通道之间存在循环依赖、同一通道以不同布局访问同一图像或创建图像失败时抛出。
+	 */
+	void Compile(uint64_t retireSerial);
+
+	/**
+	 * @brief 按执行顺序录制每个通道之前的屏障与通道本身，最后把导入的资源转换到最终状态。
+	 */
+	void Execute(VkCommandBuffer commandBuffer);
+
+	/**
+	 * @brief 资源对应的 Vulkan 对象与属性，图像与视图在 Compile() 之后有效。
+	 */
+	VkImage Image(Resource resource) const;
+	VkImageView View(Resource resource) const;
+	VkBuffer Buffer(Resource resource) const;
+	VkFormat Format(Resource resource) const;
+	VkExtent2D Extent(Resource resource) const;
+
+	/**
+	 * @brief 通道的执行顺序（按名称），被剔除的通道不在其中。Compile() 之后有效。
+	 */
+	std::vector<std::string> ExecutionOrder() const;
+
+	/**
+	 * @brief 最近一次编译的统计。
+	 */
+	const Stats& GetStats() const { return _stats; }
+
+private:
+	/**
+	 * @brief 物理资源：一个图像或缓冲的所有版本共用。
+	 */
+	struct Physical {
+		std::string name;
+		bool image = true;
+		bool imported = false;
+
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		VkExtent2D extent = { 0, 0 };
+		VkImage vkImage = VK_NULL_HANDLE;
+		VkImageView view = VK_NULL_HANDLE;
+		VkBuffer buffer = VK_NULL_HANDLE;
+
+		ExternalState initial;
+		ExternalState final;
+
+		// 编译结果：汇总的用途、使用过的阶段、生命周期（执行顺序中的区间）与显存块
+		VkImageUsageFlags usage = 0;
+		VkPipelineStageFlags2KHR stages = 0;
+		uint32_t first = UINT32_MAX;
+		uint32_t last = 0;
+		uint32_t slot = UINT32_MAX;
+	};
+
+	/**
+	 * @brief 资源版本：由一个通道写出（导入或新建的初始版本没有写入者），可被多个通道读取。
+	 */
+	struct Version {
+		uint32_t physical = 0;
+		uint32_t writer = UINT32_MAX;
+		std::vector<Pass> readers;
+		bool overwritten = false;
+		bool output = false;
+	};
+
+	/**
+	 * @brief 通道对资源的一次访问；写入时 version 为被覆盖的版本。
+	 */
+	struct Usage {
+		Resource version = 0;
+		Access access = Access::ColorAttachment;
+		bool write = false;
+	};
+
+	struct PassInfo {
+		std::string name;
+		ExecuteFunc execute;
+		std::vector<Usage> usages;
+		bool culled = false;
+	};
+
+	/**
+	 * @brief 一次屏障命令：同一位置的图像屏障与合并后的全局内存屏障。
+	 */
+	struct Batch {
+		std::vector<VkImageMemoryBarrier2KHR> images;
+		VkMemoryBarrier2KHR memory{};
+		bool hasMemory = false;
+	};
+
+	/**
+	 * @brief 已创建的瞬态图像，按声明顺序与 Physical 对应，签名相同时复用。
+	 */
+	struct Transient {
+		VkImage image = VK_NULL_HANDLE;
+		VkImageView view = VK_NULL_HANDLE;
+		uint32_t slot = UINT32_MAX;
+	};
+
+	/**
+	 * @brief 剔除对输出没有贡献的通道。
+	 */
+	void cull();
+
+	/**
+	 * @brief 按版本依赖对保留的通道做拓扑排序，结果写入 _order。
+	 */
+	void sortPasses();
+
+	/**
+	 * @brief 汇总每个物理资源的用途、阶段与生命周期。
+	 */
+	void computeLifetimes();
+
+	/**
+	 * @brief 瞬态图像的描述或生命周期变化时重新创建并分配显存，否则复用已有的图像。
+	 */
+	void allocateTransients(uint64_t retireSerial);
+
+	/**
+	 * @brief 延迟销毁当前的瞬态图像与显存。
+	 */
+	void retireTransients(uint64_t retireSerial);
+
+	/**
+	 * @brief 销毁瞬态图像、视图并归还显存。
+	 */
+	void destroyTransients(std::vector<Transient>& transients, std::vector<GpuAllocation>& slots);
+
+	/**
+	 * @brief 按执行顺序模拟每个资源的状态，推导每个通道之前与执行结束后的屏障。
+	 */
+	void buildBarriers();
+
+	/**
+	 * @brief 录制一批屏障。
+	 */
+	void recordBatch(VkCommandBuffer commandBuffer, const Batch& batch) const;
+
+	const Physical& physicalOf(Resource resource) const;
+
+private:
+	VkDevice _device = VK_NULL_HANDLE;
+	GpuAllocator* _allocator = nullptr;
+	DeletionQueue* _deletionQueue = nullptr;
+	PFN_vkCmdPipelineBarrier2KHR _pipelineBarrier2 = nullptr;
+	bool _aliasing = true;
+
+	// 当前帧的声明
+	std::vector<Physical> _physicals;
+	std::vector<Version> _versions;
+	std::vector<PassInfo> _passes;
+
+	// 编译结果：执行顺序、每个通道之前的屏障（与 _order 对应）与执行结束后的屏障
+	std::vector<Pass> _order;
+	std::vector<Batch> _batches;
+	Batch _finalBatch;
+
+	// 已创建的瞬态图像、它们的显存块与对应的签名
+	std::vector<Transient> _transients;
+	std::vector<GpuAllocation> _slots;
+	std::string _signature;
+
+	Stats _stats;
+};
+
+#endif    // !RENDERGRAPH_H_
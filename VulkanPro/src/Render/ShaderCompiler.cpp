@@ -0,0 +1,243 @@
+﻿#include "ShaderCompiler.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef VULKANPRO_HAS_GLSLANG
+#include "SPIRV/GlslangToSpv.h"
+#include "glslang/Public/ResourceLimits.h"
+#include "glslang/Public/ShaderLang.h"
+#endif
+
+#include "ShaderLibrary.h"
+
+namespace {
+	// 编译选项或输出格式变化时修改，使旧缓存失效
+	constexpr const char* kCacheTag = "glslang/vulkan1.0/spirv1.0/v1";
+
+	// 着色器阶段，按扩展名区分
+	enum class Stage {
+		Unknown,
+		Vertex,
+		Fragment,
+		Compute,
+	};
+
+	Stage stageFromPath(const std::string& path)
+	{
+		std::string extension = std::filesystem::path(path).extension().string();
+		if (extension == ".vert") {
+			return Stage::Vertex;
+		}
+		if (extension == ".frag") {
+			return Stage::Fragment;
+		}
+		if (extension == ".comp") {
+			return Stage::Compute;
+		}
+		return Stage::Unknown;
+	}
+
+	void hashBytes(uint64_t& hash, const void* data, size_t size)
+	{
+		const unsigned char* bytes = static_cast<const unsigned char*>(data);
+		for (size_t i = 0; i < size; i++) {
+			hash ^= bytes[i];
+			hash *= 1099511628211ull;
+		}
+	}
+
+	// 各部分之间加入分隔符，避免 "AB" + "C" 与 "A" + "BC" 得到相同的哈希
+	void hashString(uint64_t& hash, const std::string& text)
+	{
+		hashBytes(hash, text.data(), text.size());
+		hashBytes(hash, "\0", 1);
+	}
+
+#ifdef VULKANPRO_HAS_GLSLANG
+	EShLanguage toLanguage(Stage stage)
+	{
+		switch (stage) {
+		case Stage::Fragment:
+			return EShLangFragment;
+		case Stage::Compute:
+			return EShLangCompute;
+		default:
+			return EShLangVertex;
+		}
+	}
+#endif
+}
+
+ShaderCompiler::ShaderCompiler() {}
+
+ShaderCompiler::~ShaderCompiler() {}
+
+bool ShaderCompiler::IsAvailable()
+{
+#ifdef VULKANPRO_HAS_GLSLANG
+	return true;
+#else
+	return false;
+#endif
+}
+
+void ShaderCompiler::Init(const std::string& cacheDir)
+{
+	_cacheDir = cacheDir;
+
+#ifdef VULKANPRO_HAS_GLSLANG
+	if (!_initialized) {
+		glslang::InitializeProcess();
+		_initialized = true;
+	}
+#endif
+}
+
+void ShaderCompiler::Destroy()
+{
+#ifdef VULKANPRO_HAS_GLSLANG
+	if (_initialized) {
+		glslang::FinalizeProcess();
+		_initialized = false;
+	}
+#endif
+}
+
+bool ShaderCompiler::Compile(const std::string& sourcePath, const std::vector<std::string>& defines, Output& output)
+{
+	output = Output{};
+
+	Stage stage = stageFromPath(sourcePath);
+	if (stage == Stage::Unknown) {
+		output.log = "unknown shader stage: " + sourcePath;
+		return false;
+	}
+
+	std::ifstream file(sourcePath, std::ios::binary);
+	if (!file.is_open()) {
+		output.log = "failed to open shader source: " + sourcePath;
+		return false;
+	}
+	std::stringstream text;
+	text << file.rdbuf();
+	std::string source = text.str();
+
+	// 宏定义转换为源码前的 #define 行，同时参与缓存键
+	std::string preamble;
+	for (const std::string& define : defines) {
+		std::string line = define;
+		size_t equals = line.find('=');
+		if (equals != std::string::npos) {
+			line[equals] = ' ';
+		}
+		preamble += "#define " + line + "\n";
+	}
+
+	uint64_t key = 14695981039346656037ull;
+	hashString(key, kCacheTag);
+	hashString(key, std::to_string(static_cast<int>(stage)));
+	hashString(key, preamble);
+	hashString(key, source);
+
+	if (readCache(key, output.spirv)) {
+		output.cached = true;
+		return true;
+	}
+
+#ifdef VULKANPRO_HAS_GLSLANG
+	EShLanguage language = toLanguage(stage);
+	EShMessages messages = static_cast<EShMessages>(EShMsgSpvRules | EShMsgVulkanRules);
+
+	glslang::TShader shader(language);
+	const char* sourceText = source.c_str();
+	const char* sourceName = sourcePath.c_str();
+	shader.setStringsWithLengthsAndNames(&sourceText, nullptr, &sourceName, 1);
+	shader.setPreamble(preamble.c_str());
+	shader.setEnvInput(glslang::EShSourceGlsl, language, glslang::EShClientVulkan, 100);
+	shader.setEnvClient(glslang::EShClientVulkan, glslang::EShTargetVulkan_1_0);
+	shader.setEnvTarget(glslang::EShTargetSpv, glslang::EShTargetSpv_1_0);
+
+	if (!shader.parse(GetDefaultResources(), 100, false, messages)) {
+		output.log = shader.getInfoLog();
+		return false;
+	}
+
+	glslang::TProgram program;
+	program.addShader(&shader);
+	if (!program.link(messages)) {
+		output.log = program.getInfoLog();
+		return false;
+	}
+
+	glslang::GlslangToSpv(*program.getIntermediate(language), output.spirv);
+	writeCache(key, output.spirv);
+	return true;
+#else
+	output.log = "built without glslang, cannot compile " + sourcePath;
+	return false;
+#endif
+}
+
+std::string ShaderCompiler::cachePath(uint64_t key) const
+{
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.spv", static_cast<unsigned long long>(key));
+	return (std::filesystem::path(_cacheDir) / name).string();
+}
+
+bool ShaderCompiler::readCache(uint64_t key, std::vector<uint32_t>& spirv) const
+{
+	if (_cacheDir.empty()) {
+		return false;
+	}
+
+	std::ifstream file(cachePath(key), std::ios::ate | std::ios::binary);
+	if (!file.is_open()) {
+		return false;
+	}
+
+	size_t size = static_cast<size_t>(file.tellg());
+	if (size == 0 || size % sizeof(uint32_t) != 0) {
+		return false;
+	}
+
+	spirv.resize(size / sizeof(uint32_t));
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(spirv.data()), size);
+	if (!file || spirv[0] != ShaderLibrary::kSpirvMagic) {
+		spirv.clear();
+		return false;
+	}
+	return true;
+}
+
+void ShaderCompiler::writeCache(uint64_t key, const std::vector<uint32_t>& spirv) const
+{
+	if (_cacheDir.empty()) {
+		return;
+	}
+
+	std::error_code error;
+	std::filesystem::create_directories(_cacheDir, error);
+
+	std::string path = cachePath(key);
+	std::string tempPath = path + ".tmp";
+	{
+		std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+		if (!file.is_open()) {
+			std::cerr << "无法写入着色器缓存临时文件: " << tempPath << std::endl;
+			return;
+		}
+		file.write(reinterpret_cast<const char*>(spirv.data()), spirv.size() * sizeof(uint32_t));
+	}
+
+	std::filesystem::rename(tempPath, path, error);
+	if (error) {
+		std::cerr << "替换着色器缓存文件失败: " << error.message() << std::endl;
+		std::filesystem::remove(tempPath, error);
+	}
+}
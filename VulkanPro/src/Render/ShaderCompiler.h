@@ -0,0 +1,85 @@
+﻿#ifndef SHADERCOMPILER_H_
+#define SHADERCOMPILER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief 进程内 GLSL → SPIR-V 编译器，带按内容哈希的磁盘缓存。
+ *
+ * 编译使用随工程构建的 glslang（3rd/glslang，构建时定义 VULKANPRO_HAS_GLSLANG），
+ * 目标环境为 Vulkan 1.0 / SPIR-V 1.0，与 glslc 的默认值一致。着色器阶段由扩展名决定（.vert / .frag / .comp）。
+ *
+ * 缓存键为 源码内容 + 阶段 + 宏定义 + 缓存格式版本 的 FNV-1a 64 位哈希，命中时直接读取
+ * "<缓存目录>/<哈希>.spv"，不调用编译器；没有 glslang 时仍可使用已有的缓存。
+ *
+ * 不支持 #include。Compile() 不可在多个线程上同时调用。
+ */
+class ShaderCompiler
+{
+public:
+	/**
+	 * @brief 一次编译的结果。
+	 */
+	struct Output {
+		std::vector<uint32_t> spirv;    // SPIR-V 字节码，失败时为空
+		bool cached = false;            // 是否来自磁盘缓存
+		std::string log;                // 失败时的编译 / 链接日志
+	};
+
+public:
+	ShaderCompiler();
+
+	~ShaderCompiler();
+
+public:
+	/**
+	 * @brief 构建时是否带有 glslang。
+	 */
+	static bool IsAvailable();
+
+	/**
+	 * @brief 初始化编译器进程状态并指定缓存目录（不存在时在首次写入时创建）。
+	 *
+	 * @param cacheDir 缓存目录，为空时不使用缓存。
+	 */
+	void Init(const std::string& cacheDir);
+
+	/**
+	 * @brief 释放编译器进程状态。
+	 */
+	void Destroy();
+
+	/**
+	 * @brief 编译一个 GLSL 源文件。
+	 *
+	 * @param sourcePath 源文件路径，扩展名决定着色器阶段。
+	 * @param defines    预处理宏，"NAME" 或 "NAME=VALUE"。
+	 * @param output     编译结果。
+	 * @return 成功返回 true；源文件无法读取、扩展名未知或编译失败时返回 false，原因写入 output.log。
+	 */
+	bool Compile(const std::string& sourcePath, const std::vector<std::string>& defines, Output& output);
+
+private:
+	/**
+	 * @brief 缓存文件路径。
+	 */
+	std::string cachePath(uint64_t key) const;
+
+	/**
+	 * @brief 读取缓存的 SPIR-V，文件不存在或不是合法的 SPIR-V 时返回 false。
+	 */
+	bool readCache(uint64_t key, std::vector<uint32_t>& spirv) const;
+
+	/**
+	 * @brief 先写入临时文件再重命名，写入失败只打印警告。
+	 */
+	void writeCache(uint64_t key, const std::vector<uint32_t>& spirv) const;
+
+private:
+	std::string _cacheDir;
+	bool _initialized = false;
+};
+
+#endif    // !SHADERCOMPILER_H_
@@ -0,0 +1,142 @@
+﻿#include "ShaderLibrary.h"
+#include "../Helper/MappedFile.h"
+
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+ShaderLibrary::ShaderLibrary() {}
+
+ShaderLibrary::~ShaderLibrary() {}
+
+void ShaderLibrary::Init(VkDevice device, const std::string& directory)
+{
+	_device = device;
+	_directory = directory;
+	_stats = Stats{};
+}
+
+void ShaderLibrary::Destroy()
+{
+	for (const auto& entry : _modules) {
+		vkDestroyShaderModule(_device, entry.second.module, nullptr);
+	}
+	for (VkShaderModule shaderModule : _superseded) {
+		vkDestroyShaderModule(_device, shaderModule, nullptr);
+	}
+	_modules.clear();
+	_pathModules.clear();
+	_superseded.clear();
+}
+
+VkShaderModule ShaderLibrary::Load(const std::string& name)
+{
+	std::string path = _directory.empty() ? name : _directory + "/" + name;
+
+	// 同一路径已加载过，不再读文件
+	auto pathIt = _pathModules.find(path);
+	if (pathIt != _pathModules.end()) {
+		_stats.pathHits++;
+		return pathIt->second;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	MappedFile file;
+	if (!file.Open(path) || file.Data() == nullptr) {
+		throw std::runtime_error("failed to map shader file: " + path);
+	}
+	_stats.filesMapped++;
+
+	// 映射地址按页对齐，可直接作为 pCode，不经过中间缓冲
+	VkShaderModule shaderModule = findOrCreate(static_cast<const uint32_t*>(file.Data()), file.Size(), path);
+
+	_pathModules.emplace(path, shaderModule);
+	_stats.loadMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	return shaderModule;
+}
+
+VkShaderModule ShaderLibrary::Reload(const std::string& name, const std::vector<uint32_t>& spirv)
+{
+	std::string path = _directory.empty() ? name : _directory + "/" + name;
+
+	VkShaderModule shaderModule = findOrCreate(spirv.data(), spirv.size() * sizeof(uint32_t), path);
+
+	auto pathIt = _pathModules.find(path);
+	VkShaderModule previous = pathIt != _pathModules.end() ? pathIt->second : VK_NULL_HANDLE;
+	_pathModules[path] = shaderModule;
+	if (previous != VK_NULL_HANDLE && previous != shaderModule) {
+		supersede(previous);
+	}
+	return shaderModule;
+}
+
+std::vector<VkShaderModule> ShaderLibrary::TakeSuperseded()
+{
+	std::vector<VkShaderModule> modules;
+	modules.swap(_superseded);
+	return modules;
+}
+
+void ShaderLibrary::supersede(VkShaderModule shaderModule)
+{
+	// 内容相同的其他文件仍在使用该模块
+	for (const auto& entry : _pathModules) {
+		if (entry.second == shaderModule) {
+			return;
+		}
+	}
+
+	for (auto moduleIt = _modules.begin(); moduleIt != _modules.end(); ++moduleIt) {
+		if (moduleIt->second.module == shaderModule) {
+			_modules.erase(moduleIt);
+			_superseded.push_back(shaderModule);
+			return;
+		}
+	}
+}
+
+uint64_t ShaderLibrary::hashBytes(const void* data, size_t size)
+{
+	const uint8_t* bytes = static_cast<const uint8_t*>(data);
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+VkShaderModule ShaderLibrary::findOrCreate(const uint32_t* words, size_t size, const std::string& path)
+{
+	// 大小必须是 4 的倍数、至少包含文件头，且以魔数开头
+	if (size % sizeof(uint32_t) != 0 || size < 5 * sizeof(uint32_t) || words[0] != kSpirvMagic) {
+		throw std::runtime_error("invalid SPIR-V file: " + path);
+	}
+
+	// 哈希只用于查找，命中后逐字节比较，碰撞时不会返回其他着色器的模块
+	std::pair<uint64_t, size_t> key(hashBytes(words, size), size);
+	auto range = _modules.equal_range(key);
+	for (auto moduleIt = range.first; moduleIt != range.second; ++moduleIt) {
+		if (std::memcmp(moduleIt->second.code.data(), words, size) == 0) {
+			_stats.contentHits++;
+			return moduleIt->second.module;
+		}
+	}
+
+	VkShaderModuleCreateInfo createInfo{};
+	createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	createInfo.codeSize = size;
+	createInfo.pCode = words;
+
+	VkShaderModule shaderModule;
+	if (vkCreateShaderModule(_device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create shader module: " + path);
+	}
+	Module entry;
+	entry.code.assign(words, words + size / sizeof(uint32_t));
+	entry.module = shaderModule;
+	_modules.emplace(key, std::move(entry));
+	_stats.modulesCreated++;
+	return shaderModule;
+}
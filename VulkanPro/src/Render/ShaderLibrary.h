@@ -0,0 +1,142 @@
+﻿#ifndef SHADERLIBRARY_H_
+#define SHADERLIBRARY_H_
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "vulkan/vulkan.h"
+
+/**
+ * @brief SPIR-V 着色器模块库。
+ *
+ * .spv 文件通过内存映射零拷贝读取：映射起始地址按页对齐，一定满足 pCode 要求的 4 字节对齐，
+ * 创建模块前校验文件大小与 SPIR-V 魔数。
+ *
+ * 模块按内容去重：FNV-1a 64 位哈希与字节数相同时再逐字节比较，同一份字节码无论来自哪个文件只创建一次。
+ * 为此库中保留每个模块的字节码副本（着色器通常只有几 KB）。同一路径第二次加载时直接返回，不再读文件。
+ * 除热重载替换下来的模块（见 TakeSuperseded()）外，所有模块保留到 Destroy()，可在多次管线构建之间复用，调用方不要自行销毁。
+ */
+class ShaderLibrary
+{
+public:
+	/**
+	 * @brief 加载统计，用于对比启动耗时。
+	 */
+	struct Stats {
+		uint32_t filesMapped = 0;       // 实际映射的文件数
+		uint32_t modulesCreated = 0;    // 实际创建的模块数
+		uint32_t pathHits = 0;          // 按路径命中（未读文件）
+		uint32_t contentHits = 0;       // 读了文件但按内容命中（未创建模块）
+		double loadMs = 0.0;            // Load() 总耗时
+	};
+
+	/**
+	 * @brief SPIR-V 魔数（主机字节序）。
+	 */
+	static constexpr uint32_t kSpirvMagic = 0x07230203;
+
+public:
+	ShaderLibrary();
+
+	~ShaderLibrary();
+
+public:
+	/**
+	 * @brief 初始化。
+	 *
+	 * @param device    逻辑设备。
+	 * @param directory 着色器目录，Load() 的名称相对于它；为空时名称即路径。
+	 */
+	void Init(VkDevice device, const std::string& directory);
+
+	/**
+	 * @brief 销毁所有模块。调用前所有使用它们的管线必须已创建完成（管线创建后不再引用模块）。
+	 */
+	void Destroy();
+
+	/**
+	 * @brief 加载着色器模块。
+	 *
+	 * @param name 相对于着色器目录的文件名，如 "vert.spv"。
+	 * @return 库持有的模块，Destroy() 前一直有效。
+	 *
+	 * @throws std::runtime_error 文件无法打开或映射、不是合法的 SPIR-V、或模块创建失败时抛出。
+	 */
+	VkShaderModule Load(const std::string& name);
+
+	/**
+	 * @brief 用新的字节码替换某个名称对应的模块（热重载），之后 Load(name) 返回新模块。
+	 *
+	 * 旧模块不再被任何名称引用时移出库，调用方用新模块重建管线后通过 TakeSuperseded() 取走并销毁。
+	 *
+	 * @param name  相对于着色器目录的文件名，与 Load() 一致。
+	 * @param spirv 新的 SPIR-V 字节码。
+	 * @return 新字节码对应的模块。
+	 *
+	 * @throws std::runtime_error 不是合法的 SPIR-V 或模块创建失败时抛出。
+	 */
+	VkShaderModule Reload(const std::string& name, const std::vector<uint32_t>& spirv);
+
+	/**
+	 * @brief 交出被 Reload() 替换下来、不再被任何名称引用的模块，所有权转给调用方。
+	 *
+	 * 只应在用新模块重建管线成功之后调用；重建失败时旧模块仍在使用，留在库中直到下次调用或 Destroy()。
+	 */
+	std::vector<VkShaderModule> TakeSuperseded();
+
+	/**
+	 * @brief 当前持有的模块数量。
+	 */
+	size_t ModuleCount() const { return _modules.size(); }
+
+	/**
+	 * @brief 加载统计。
+	 */
+	const Stats& GetStats() const { return _stats; }
+
+private:
+	/**
+	 * @brief 库中的一个模块及其字节码副本，哈希命中后用于逐字节比较。
+	 */
+	struct Module {
+		std::vector<uint32_t> code;
+		VkShaderModule module = VK_NULL_HANDLE;
+	};
+
+	/**
+	 * @brief 按字节计算 FNV-1a 64 位哈希。
+	 */
+	static uint64_t hashBytes(const void* data, size_t size);
+
+	/**
+	 * @brief 返回内容相同的已有模块，没有时创建。
+	 *
+	 * @throws std::runtime_error 大小或魔数不合法、或模块创建失败时抛出，消息中带 path。
+	 */
+	VkShaderModule findOrCreate(const uint32_t* words, size_t size, const std::string& path);
+
+	/**
+	 * @brief 模块不再被任何路径引用时移出 _modules，放入 _superseded。
+	 */
+	void supersede(VkShaderModule shaderModule);
+
+private:
+	VkDevice _device = VK_NULL_HANDLE;
+	std::string _directory;
+
+	// (内容哈希, 字节数) -> 模块；哈希碰撞时同一个键下有多个模块，字节码相同才视为同一份
+	std::multimap<std::pair<uint64_t, size_t>, Module> _modules;
+
+	// 路径 -> 模块，重复加载同一路径时不再映射文件
+	std::map<std::string, VkShaderModule> _pathModules;
+
+	// 热重载替换下来、等待调用方销毁的模块
+	std::vector<VkShaderModule> _superseded;
+
+	Stats _stats;
+};
+
+#endif    // !SHADERLIBRARY_H_
@@ -0,0 +1,112 @@
+﻿#include "ShaderWatcher.h"
+
+#include <algorithm>
+
+ShaderWatcher::ShaderWatcher() {}
+
+ShaderWatcher::~ShaderWatcher()
+{
+	Stop();
+}
+
+void ShaderWatcher::Start(const std::string& directory, const std::vector<std::string>& extensions, ShaderCompiler* compiler,
+	const std::vector<std::string>& defines, std::chrono::milliseconds interval)
+{
+	Stop();
+
+	_directory = directory;
+	_extensions = extensions;
+	_compiler = compiler;
+	_defines = defines;
+	_interval = interval;
+	_timestamps.clear();
+
+	// 在调用线程上记录初始修改时间，Start() 返回后的修改一定会被发现
+	scan(true);
+
+	_stop = false;
+	_thread = std::thread(&ShaderWatcher::watchLoop, this);
+}
+
+void ShaderWatcher::Stop()
+{
+	if (!_thread.joinable()) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_stopCondition.notify_all();
+	_thread.join();
+
+	_results.clear();
+}
+
+std::vector<ShaderWatcher::Result> ShaderWatcher::Poll()
+{
+	std::vector<Result> results;
+	std::lock_guard<std::mutex> lock(_mutex);
+	results.swap(_results);
+	return results;
+}
+
+void ShaderWatcher::watchLoop()
+{
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			if (_stopCondition.wait_for(lock, _interval, [this]() { return _stop; })) {
+				return;
+			}
+		}
+
+		// 编译在锁外进行，Poll() 不会等待编译
+		for (const auto& path : scan(false)) {
+			Result result;
+			result.source = path.filename().string();
+			result.ok = _compiler->Compile(path.string(), _defines, result.output);
+
+			std::lock_guard<std::mutex> lock(_mutex);
+			_results.push_back(std::move(result));
+		}
+	}
+}
+
+std::vector<std::filesystem::path> ShaderWatcher::scan(bool initial)
+{
+	std::vector<std::filesystem::path> changed;
+
+	// 目录暂时不可访问时跳过本轮
+	std::error_code error;
+	std::filesystem::directory_iterator it(_directory, error);
+	if (error) {
+		return changed;
+	}
+
+	for (const auto& entry : it) {
+		if (!entry.is_regular_file(error)) {
+			continue;
+		}
+		std::string extension = entry.path().extension().string();
+		if (std::find(_extensions.begin(), _extensions.end(), extension) == _extensions.end()) {
+			continue;
+		}
+
+		auto time = entry.last_write_time(error);
+		if (error) {
+			continue;
+		}
+
+		std::string key = entry.path().string();
+		auto found = _timestamps.find(key);
+		if (found == _timestamps.end() || found->second != time) {
+			_timestamps[key] = time;
+			if (!initial) {
+				changed.push_back(entry.path());
+			}
+		}
+	}
+	return changed;
+}
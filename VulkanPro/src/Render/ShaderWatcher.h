@@ -0,0 +1,102 @@
+﻿#ifndef SHADERWATCHER_H_
+#define SHADERWATCHER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ShaderCompiler.h"
+
+/**
+ * @brief 着色器源文件监视与后台重新编译。
+ *
+ * 后台线程按固定间隔检查目录中指定扩展名文件的修改时间，发现变化后在该线程上用 ShaderCompiler 编译，
+ * 结果放入队列。渲染线程在帧边界调用 Poll() 取走结果并替换受影响的管线，编译不会阻塞渲染。
+ *
+ * 启动时记录已有文件的修改时间，不会重新编译它们。编辑器分多次写入时可能先编译到不完整的文件，
+ * 失败的结果同样会报告，文件写完后会再次触发编译。
+ */
+class ShaderWatcher
+{
+public:
+	/**
+	 * @brief 一个源文件的编译结果。
+	 */
+	struct Result {
+		std::string source;             // 源文件名（不含目录），如 "shader.vert"
+		bool ok = false;
+		ShaderCompiler::Output output;
+	};
+
+public:
+	ShaderWatcher();
+
+	~ShaderWatcher();
+
+	ShaderWatcher(const ShaderWatcher&) = delete;
+	ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+public:
+	/**
+	 * @brief 开始监视。compiler 在 Stop() 前只由监视线程使用。
+	 *
+	 * @param directory  源文件目录。
+	 * @param extensions 需要监视的扩展名，如 { ".vert", ".frag" }。
+	 * @param compiler   编译器，必须已初始化。
+	 * @param defines    编译时的预处理宏。
+	 * @param interval   检查间隔。
+	 */
+	void Start(const std::string& directory, const std::vector<std::string>& extensions, ShaderCompiler* compiler,
+		const std::vector<std::string>& defines, std::chrono::milliseconds interval = std::chrono::milliseconds(250));
+
+	/**
+	 * @brief 停止监视线程，丢弃尚未取走的结果。
+	 */
+	void Stop();
+
+	/**
+	 * @brief 是否正在监视。
+	 */
+	bool IsRunning() const { return _thread.joinable(); }
+
+	/**
+	 * @brief 取走已完成的编译结果，不阻塞。
+	 */
+	std::vector<Result> Poll();
+
+private:
+	/**
+	 * @brief 监视线程主循环。
+	 */
+	void watchLoop();
+
+	/**
+	 * @brief 检查一遍目录，返回修改时间发生变化的文件；initial 为 true 时只记录时间。
+	 */
+	std::vector<std::filesystem::path> scan(bool initial);
+
+private:
+	std::string _directory;
+	std::vector<std::string> _extensions;
+	ShaderCompiler* _compiler = nullptr;
+	std::vector<std::string> _defines;
+	std::chrono::milliseconds _interval{ 250 };
+
+	// 只由监视线程访问
+	std::map<std::string, std::filesystem::file_time_type> _timestamps;
+
+	std::thread _thread;
+	std::mutex _mutex;
+	std::condition_variable _stopCondition;
+	bool _stop = false;
+
+	// 已完成、尚未被 Poll() 取走的结果，受 _mutex 保护
+	std::vector<Result> _results;
+};
+
+#endif    // !SHADERWATCHER_H_
@@ -0,0 +1,573 @@
+﻿#include "TextureContainer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <stdexcept>
+
+namespace {
+	// KTX2 文件标识「«KTX 20»\r\n\x1A\n」、文件头（含索引）大小与每个级别索引项的大小
+	constexpr uint8_t kKtx2Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+	constexpr size_t kKtx2HeaderSize = 80;
+	constexpr size_t kKtx2LevelIndexSize = 24;
+
+	constexpr uint32_t makeFourCC(char a, char b, char c, char d)
+	{
+		return static_cast<uint32_t>(static_cast<uint8_t>(a)) | (static_cast<uint32_t>(static_cast<uint8_t>(b)) << 8)
+			| (static_cast<uint32_t>(static_cast<uint8_t>(c)) << 16) | (static_cast<uint32_t>(static_cast<uint8_t>(d)) << 24);
+	}
+
+	// DDS 魔数、文件头大小（含魔数）与 DX10 扩展头大小
+	constexpr uint32_t kDdsMagic = makeFourCC('D', 'D', 'S', ' ');
+	constexpr size_t kDdsHeaderSize = 128;
+	constexpr size_t kDdsDx10HeaderSize = 20;
+
+	// DDS 文件头与像素格式中用到的标志
+	constexpr uint32_t kDdsdMipMapCount = 0x20000;
+	constexpr uint32_t kDdpfAlphaPixels = 0x1;
+	constexpr uint32_t kDdpfFourCC = 0x4;
+	constexpr uint32_t kDdpfRgb = 0x40;
+	constexpr uint32_t kDdsCaps2Cubemap = 0x200;
+	constexpr uint32_t kDdsCaps2Volume = 0x200000;
+	constexpr uint32_t kDx10Texture2D = 3;
+	constexpr uint32_t kDx10MiscCube = 0x4;
+
+	struct FormatBlock {
+		VkFormat format;
+		uint32_t width;
+		uint32_t height;
+		uint32_t bytes;
+	};
+
+	// 支持上传的格式及其块尺寸
+	constexpr FormatBlock kFormatBlocks[] = {
+		{ VK_FORMAT_R8G8B8A8_UNORM, 1, 1, 4 },
+		{ VK_FORMAT_R8G8B8A8_SRGB, 1, 1, 4 },
+		{ VK_FORMAT_B8G8R8A8_UNORM, 1, 1, 4 },
+		{ VK_FORMAT_B8G8R8A8_SRGB, 1, 1, 4 },
+		{ VK_FORMAT_BC1_RGB_UNORM_BLOCK, 4, 4, 8 },
+		{ VK_FORMAT_BC1_RGB_SRGB_BLOCK, 4, 4, 8 },
+		{ VK_FORMAT_BC1_RGBA_UNORM_BLOCK, 4, 4, 8 },
+		{ VK_FORMAT_BC1_RGBA_SRGB_BLOCK, 4, 4, 8 },
+		{ VK_FORMAT_BC2_UNORM_BLOCK, 4, 4, 16 },
+		{ VK_FORMAT_BC2_SRGB_BLOCK, 4, 4, 16 },
+		{ VK_FORMAT_BC3_UNORM_BLOCK, 4, 4, 16 },
+		{ VK_FORMAT_BC3_SRGB_BLOCK, 4, 4, 16 },
+		{ VK_FORMAT_BC4_UNORM_BLOCK, 4, 4, 8 },
+		{ VK_FORMAT_BC4_SNORM_BLOCK, 4, 4, 8 },
+		{ VK_FORMAT_BC5_UNORM_BLOCK, 4, 4, 16 },
+		{ VK_FORMAT_BC5_SNORM_BLOCK, 4, 4, 16 },
+		{ VK_FORMAT_BC6H_UFLOAT_BLOCK, 4, 4, 16 },
+		{ VK_FORMAT_BC6H_SFLOAT_BLOCK, 4, 4, 16 },
+		{ VK_FORMAT_BC7_UNORM_BLOCK, 4, 4, 16 },
+		{ VK_FORMAT_BC7_SRGB_BLOCK, 4, 4, 16 },
+		{ VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK, 4, 4, 8 },
+		{ VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK, 4, 4, 8 },
+		{ VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK, 4, 4, 8 },
+		{ VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK, 4, 4, 8 },
+		{ VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK, 4, 4, 16 },
+		{ VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK, 4, 4, 16 },
+		{ VK_FORMAT_EAC_R11_UNORM_BLOCK, 4, 4, 8 },
+		{ VK_FORMAT_EAC_R11_SNORM_BLOCK, 4, 4, 8 },
+		{ VK_FORMAT_EAC_R11G11_UNORM_BLOCK, 4, 4, 16 },
+		{ VK_FORMAT_EAC_R11G11_SNORM_BLOCK, 4, 4, 16 },
+		{ VK_FORMAT_ASTC_4x4_UNORM_BLOCK, 4, 4, 16 },
+		{ VK_FORMAT_ASTC_4x4_SRGB_BLOCK, 4, 4, 16 },
+		{ VK_FORMAT_ASTC_5x4_UNORM_BLOCK, 5, 4, 16 },
+		{ VK_FORMAT_ASTC_5x4_SRGB_BLOCK, 5, 4, 16 },
+		{ VK_FORMAT_ASTC_5x5_UNORM_BLOCK, 5, 5, 16 },
+		{ VK_FORMAT_ASTC_5x5_SRGB_BLOCK, 5, 5, 16 },
+		{ VK_FORMAT_ASTC_6x5_UNORM_BLOCK, 6, 5, 16 },
+		{ VK_FORMAT_ASTC_6x5_SRGB_BLOCK, 6, 5, 16 },
+		{ VK_FORMAT_ASTC_6x6_UNORM_BLOCK, 6, 6, 16 },
+		{ VK_FORMAT_ASTC_6x6_SRGB_BLOCK, 6, 6, 16 },
+		{ VK_FORMAT_ASTC_8x5_UNORM_BLOCK, 8, 5, 16 },
+		{ VK_FORMAT_ASTC_8x5_SRGB_BLOCK, 8, 5, 16 },
+		{ VK_FORMAT_ASTC_8x6_UNORM_BLOCK, 8, 6, 16 },
+		{ VK_FORMAT_ASTC_8x6_SRGB_BLOCK, 8, 6, 16 },
+		{ VK_FORMAT_ASTC_8x8_UNORM_BLOCK, 8, 8, 16 },
+		{ VK_FORMAT_ASTC_8x8_SRGB_BLOCK, 8, 8, 16 },
+		{ VK_FORMAT_ASTC_10x5_UNORM_BLOCK, 10, 5, 16 },
+		{ VK_FORMAT_ASTC_10x5_SRGB_BLOCK, 10, 5, 16 },
+		{ VK_FORMAT_ASTC_10x6_UNORM_BLOCK, 10, 6, 16 },
+		{ VK_FORMAT_ASTC_10x6_SRGB_BLOCK, 10, 6, 16 },
+		{ VK_FORMAT_ASTC_10x8_UNORM_BLOCK, 10, 8, 16 },
+		{ VK_FORMAT_ASTC_10x8_SRGB_BLOCK, 10, 8, 16 },
+		{ VK_FORMAT_ASTC_10x10_UNORM_BLOCK, 10, 10, 16 },
+		{ VK_FORMAT_ASTC_10x10_SRGB_BLOCK, 10, 10, 16 },
+		{ VK_FORMAT_ASTC_12x10_UNORM_BLOCK, 12, 10, 16 },
+		{ VK_FORMAT_ASTC_12x10_SRGB_BLOCK, 12, 10, 16 },
+		{ VK_FORMAT_ASTC_12x12_UNORM_BLOCK, 12, 12, 16 },
+		{ VK_FORMAT_ASTC_12x12_SRGB_BLOCK, 12, 12, 16 },
+	};
+
+	// 可在 CPU 上转码的 BC 编号（1 ~ 5），其他格式为 0
+	uint32_t bcNumber(VkFormat format)
+	{
+		switch (format) {
+		case VK_FORMAT_BC1_RGB_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+		case VK_FORMAT_BC1_RGBA_UNORM_BLOCK:
+		case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+			return 1;
+		case VK_FORMAT_BC2_UNORM_BLOCK:
+		case VK_FORMAT_BC2_SRGB_BLOCK:
+			return 2;
+		case VK_FORMAT_BC3_UNORM_BLOCK:
+		case VK_FORMAT_BC3_SRGB_BLOCK:
+			return 3;
+		case VK_FORMAT_BC4_UNORM_BLOCK:
+			return 4;
+		case VK_FORMAT_BC5_UNORM_BLOCK:
+			return 5;
+		default:
+			return 0;
+		}
+	}
+
+	// DXGI_FORMAT 到 VkFormat，只包含 kFormatBlocks 中的格式
+	VkFormat dxgiToVkFormat(uint32_t dxgiFormat)
+	{
+		switch (dxgiFormat) {
+		case 28: return VK_FORMAT_R8G8B8A8_UNORM;
+		case 29: return VK_FORMAT_R8G8B8A8_SRGB;
+		case 71: return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+		case 72: return VK_FORMAT_BC1_RGBA_SRGB_BLOCK;
+		case 74: return VK_FORMAT_BC2_UNORM_BLOCK;
+		case 75: return VK_FORMAT_BC2_SRGB_BLOCK;
+		case 77: return VK_FORMAT_BC3_UNORM_BLOCK;
+		case 78: return VK_FORMAT_BC3_SRGB_BLOCK;
+		case 80: return VK_FORMAT_BC4_UNORM_BLOCK;
+		case 81: return VK_FORMAT_BC4_SNORM_BLOCK;
+		case 83: return VK_FORMAT_BC5_UNORM_BLOCK;
+		case 84: return VK_FORMAT_BC5_SNORM_BLOCK;
+		case 87: return VK_FORMAT_B8G8R8A8_UNORM;
+		case 91: return VK_FORMAT_B8G8R8A8_SRGB;
+		case 95: return VK_FORMAT_BC6H_UFLOAT_BLOCK;
+		case 96: return VK_FORMAT_BC6H_SFLOAT_BLOCK;
+		case 98: return VK_FORMAT_BC7_UNORM_BLOCK;
+		case 99: return VK_FORMAT_BC7_SRGB_BLOCK;
+		default: return VK_FORMAT_UNDEFINED;
+		}
+	}
+
+	// 旧式 DDS 的 FourCC 到 VkFormat
+	VkFormat fourCCToVkFormat(uint32_t fourCC)
+	{
+		switch (fourCC) {
+		case makeFourCC('D', 'X', 'T', '1'): return VK_FORMAT_BC1_RGBA_UNORM_BLOCK;
+		case makeFourCC('D', 'X', 'T', '2'):
+		case makeFourCC('D', 'X', 'T', '3'): return VK_FORMAT_BC2_UNORM_BLOCK;
+		case makeFourCC('D', 'X', 'T', '4'):
+		case makeFourCC('D', 'X', 'T', '5'): return VK_FORMAT_BC3_UNORM_BLOCK;
+		case makeFourCC('A', 'T', 'I', '1'):
+		case makeFourCC('B', 'C', '4', 'U'): return VK_FORMAT_BC4_UNORM_BLOCK;
+		case makeFourCC('B', 'C', '4', 'S'): return VK_FORMAT_BC4_SNORM_BLOCK;
+		case makeFourCC('A', 'T', 'I', '2'):
+		case makeFourCC('B', 'C', '5', 'U'): return VK_FORMAT_BC5_UNORM_BLOCK;
+		case makeFourCC('B', 'C', '5', 'S'): return VK_FORMAT_BC5_SNORM_BLOCK;
+		default: return VK_FORMAT_UNDEFINED;
+		}
+	}
+
+	uint32_t readU32(const uint8_t* data)
+	{
+		uint32_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	uint64_t readU64(const uint8_t* data)
+	{
+		uint64_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	uint32_t maxMipLevels(uint32_t width, uint32_t height)
+	{
+		uint32_t levels = 1;
+		for (uint32_t size = std::max(width, height); size > 1; size >>= 1) {
+			levels++;
+		}
+		return levels;
+	}
+
+	// 在 VkDeviceSize 中计算，文件头中接近 UINT32_MAX 的宽高不会回绕为 0
+	VkDeviceSize levelSize(const TextureContainer::BlockInfo& block, uint32_t width, uint32_t height)
+	{
+		VkDeviceSize blocksX = (static_cast<VkDeviceSize>(width) + block.width - 1) / block.width;
+		VkDeviceSize blocksY = (static_cast<VkDeviceSize>(height) + block.height - 1) / block.height;
+		return blocksX * blocksY * block.bytes;
+	}
+
+	// RGB565 展开为 RGB888
+	void unpack565(uint16_t color, uint8_t* rgb)
+	{
+		uint32_t r = (color >> 11) & 31;
+		uint32_t g = (color >> 5) & 63;
+		uint32_t b = color & 31;
+		rgb[0] = static_cast<uint8_t>((r << 3) | (r >> 2));
+		rgb[1] = static_cast<uint8_t>((g << 2) | (g >> 4));
+		rgb[2] = static_cast<uint8_t>((b << 3) | (b >> 2));
+	}
+
+	// BC1 颜色块（也是 BC2 / BC3 的颜色部分）；BC2 / BC3 的颜色部分总是四色模式。
+	// BC1_RGB 同样按 c0 <= c1 使用三色模式，只是第四种颜色的 alpha 为 1（opaque）
+	void decodeColorBlock(const uint8_t* block, uint8_t texels[16][4], bool bc1, bool opaque)
+	{
+		uint16_t c0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+		uint16_t c1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+
+		uint8_t palette[4][4];
+		unpack565(c0, palette[0]);
+		unpack565(c1, palette[1]);
+		palette[0][3] = 255;
+		palette[1][3] = 255;
+		palette[2][3] = 255;
+		palette[3][3] = 255;
+		if (!bc1 || c0 > c1) {
+			for (int i = 0; i < 3; i++) {
+				palette[2][i] = static_cast<uint8_t>((2 * palette[0][i] + palette[1][i]) / 3);
+				palette[3][i] = static_cast<uint8_t>((palette[0][i] + 2 * palette[1][i]) / 3);
+			}
+		}
+		else {
+			// 三色模式：第四种颜色为黑色，BC1_RGBA 中为透明黑
+			for (int i = 0; i < 3; i++) {
+				palette[2][i] = static_cast<uint8_t>((palette[0][i] + palette[1][i]) / 2);
+				palette[3][i] = 0;
+			}
+			palette[3][3] = opaque ? 255 : 0;
+		}
+
+		uint32_t indices = readU32(block + 4);
+		for (int i = 0; i < 16; i++) {
+			std::memcpy(texels[i], palette[(indices >> (2 * i)) & 3], 4);
+		}
+	}
+
+	// BC4 单通道块（也是 BC3 的 alpha 与 BC5 的两个通道），结果写入每个像素的 channel 分量
+	void decodeChannelBlock(const uint8_t* block, uint8_t texels[16][4], int channel)
+	{
+		uint32_t a0 = block[0];
+		uint32_t a1 = block[1];
+
+		uint8_t palette[8];
+		palette[0] = static_cast<uint8_t>(a0);
+		palette[1] = static_cast<uint8_t>(a1);
+		if (a0 > a1) {
+			for (uint32_t i = 1; i <= 6; i++) {
+				palette[i + 1] = static_cast<uint8_t>(((7 - i) * a0 + i * a1) / 7);
+			}
+		}
+		else {
+			for (uint32_t i = 1; i <= 4; i++) {
+				palette[i + 1] = static_cast<uint8_t>(((5 - i) * a0 + i * a1) / 5);
+			}
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+
+		uint64_t bits = 0;
+		for (int i = 0; i < 6; i++) {
+			bits |= static_cast<uint64_t>(block[2 + i]) << (8 * i);
+		}
+		for (int i = 0; i < 16; i++) {
+			texels[i][channel] = palette[(bits >> (3 * i)) & 7];
+		}
+	}
+
+	// BC2 的显式 4 位 alpha
+	void decodeExplicitAlpha(const uint8_t* block, uint8_t texels[16][4])
+	{
+		for (int i = 0; i < 16; i++) {
+			uint32_t alpha = (block[i / 2] >> ((i % 2) * 4)) & 15;
+			texels[i][3] = static_cast<uint8_t>(alpha * 17);
+		}
+	}
+}
+
+TextureContainer::TextureContainer() {}
+
+TextureContainer::~TextureContainer() {}
+
+bool TextureContainer::IsContainerPath(const std::string& path)
+{
+	std::string extension = std::filesystem::path(path).extension().string();
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+	return extension == ".ktx2" || extension == ".dds";
+}
+
+TextureContainer::BlockInfo TextureContainer::GetBlockInfo(VkFormat format)
+{
+	for (const FormatBlock& each : kFormatBlocks) {
+		if (each.format == format) {
+			return BlockInfo{ each.width, each.height, each.bytes };
+		}
+	}
+	return BlockInfo{};
+}
+
+bool TextureContainer::CanTranscode(VkFormat format)
+{
+	return bcNumber(format) != 0;
+}
+
+VkFormat TextureContainer::TranscodeFormat(VkFormat format)
+{
+	switch (format) {
+	case VK_FORMAT_BC1_RGB_SRGB_BLOCK:
+	case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+	case VK_FORMAT_BC2_SRGB_BLOCK:
+	case VK_FORMAT_BC3_SRGB_BLOCK:
+		return VK_FORMAT_R8G8B8A8_SRGB;
+	default:
+		return VK_FORMAT_R8G8B8A8_UNORM;
+	}
+}
+
+void TextureContainer::Open(const std::string& path)
+{
+	_format = VK_FORMAT_UNDEFINED;
+	_levels.clear();
+
+	if (!_file.Open(path) || _file.Data() == nullptr) {
+		throw std::runtime_error("failed to map texture file: " + path);
+	}
+
+	if (_file.Size() >= sizeof(kKtx2Identifier) && std::memcmp(Data(), kKtx2Identifier, sizeof(kKtx2Identifier)) == 0) {
+		parseKtx2(path);
+	}
+	else if (_file.Size() >= sizeof(uint32_t) && readU32(Data()) == kDdsMagic) {
+		parseDds(path);
+	}
+	else {
+		throw std::runtime_error("not a KTX2 or DDS file: " + path);
+	}
+
+	validateLevels(path);
+}
+
+std::vector<uint8_t> TextureContainer::Transcode(std::vector<Level>& levels) const
+{
+	uint32_t bc = bcNumber(_format);
+	if (bc == 0) {
+		throw std::runtime_error("texture format cannot be transcoded on the CPU: " + std::to_string(_format));
+	}
+
+	// 转码结果各级别紧密排列
+	levels.clear();
+	VkDeviceSize total = 0;
+	for (const Level& source : _levels) {
+		Level level = source;
+		level.offset = total;
+		level.size = static_cast<VkDeviceSize>(source.width) * source.height * 4;
+		levels.push_back(level);
+		total += level.size;
+	}
+	std::vector<uint8_t> pixels(static_cast<size_t>(total));
+
+	BlockInfo block = GetBlockInfo(_format);
+	bool opaque = _format == VK_FORMAT_BC1_RGB_UNORM_BLOCK || _format == VK_FORMAT_BC1_RGB_SRGB_BLOCK;
+
+	for (size_t index = 0; index < _levels.size(); index++) {
+		const Level& source = _levels[index];
+		const uint8_t* blocks = Data() + source.offset;
+		uint8_t* out = pixels.data() + levels[index].offset;
+		uint32_t blocksX = (source.width + 3) / 4;
+		uint32_t blocksY = (source.height + 3) / 4;
+
+		for (uint32_t by = 0; by < blocksY; by++) {
+			for (uint32_t bx = 0; bx < blocksX; bx++) {
+				const uint8_t* data = blocks + (static_cast<size_t>(by) * blocksX + bx) * block.bytes;
+
+				// BC4 / BC5 没有的分量为 0，alpha 为 1
+				uint8_t texels[16][4];
+				for (auto& texel : texels) {
+					texel[0] = 0;
+					texel[1] = 0;
+					texel[2] = 0;
+					texel[3] = 255;
+				}
+
+				switch (bc) {
+				case 1:
+					decodeColorBlock(data, texels, true, opaque);
+					break;
+				case 2:
+					decodeColorBlock(data + 8, texels, false, true);
+					decodeExplicitAlpha(data, texels);
+					break;
+				case 3:
+					decodeColorBlock(data + 8, texels, false, true);
+					decodeChannelBlock(data, texels, 3);
+					break;
+				case 4:
+					decodeChannelBlock(data, texels, 0);
+					break;
+				default:
+					decodeChannelBlock(data, texels, 0);
+					decodeChannelBlock(data + 8, texels, 1);
+					break;
+				}
+
+				// 边缘的块只写入图像内的像素
+				for (uint32_t y = 0; y < 4; y++) {
+					uint32_t py = by * 4 + y;
+					if (py >= source.height) {
+						break;
+					}
+					for (uint32_t x = 0; x < 4; x++) {
+						uint32_t px = bx * 4 + x;
+						if (px >= source.width) {
+							break;
+						}
+						std::memcpy(out + (static_cast<size_t>(py) * source.width + px) * 4, texels[y * 4 + x], 4);
+					}
+				}
+			}
+		}
+	}
+
+	return pixels;
+}
+
+void TextureContainer::parseKtx2(const std::string& path)
+{
+	if (_file.Size() < kKtx2HeaderSize) {
+		throw std::runtime_error("invalid KTX2 file: " + path);
+	}
+
+	const uint8_t* header = Data();
+	uint32_t vkFormat = readU32(header + 12);
+	uint32_t width = readU32(header + 20);
+	uint32_t height = readU32(header + 24);
+	uint32_t depth = readU32(header + 28);
+	uint32_t layerCount = readU32(header + 32);
+	uint32_t faceCount = readU32(header + 36);
+	uint32_t levelCount = readU32(header + 40);
+	uint32_t supercompression = readU32(header + 44);
+
+	// vkFormat 为 0 表示 Basis Universal，需要专门的转码器
+	if (vkFormat == 0) {
+		throw std::runtime_error("Basis Universal KTX2 is not supported: " + path);
+	}
+	if (supercompression != 0) {
+		throw std::runtime_error("supercompressed KTX2 is not supported: " + path);
+	}
+	if (width == 0 || height == 0 || depth > 1 || layerCount > 1 || faceCount != 1) {
+		throw std::runtime_error("only single 2D KTX2 textures are supported: " + path);
+	}
+
+	_format = static_cast<VkFormat>(vkFormat);
+	if (GetBlockInfo(_format).bytes == 0) {
+		throw std::runtime_error("unsupported KTX2 format " + std::to_string(vkFormat) + ": " + path);
+	}
+
+	// levelCount 为 0 表示只有基础级别，由使用方生成 mipmap
+	uint32_t count = std::max(levelCount, 1u);
+	if (count > maxMipLevels(width, height) || kKtx2HeaderSize + count * kKtx2LevelIndexSize > _file.Size()) {
+		throw std::runtime_error("invalid KTX2 level index: " + path);
+	}
+
+	for (uint32_t i = 0; i < count; i++) {
+		const uint8_t* entry = header + kKtx2HeaderSize + i * kKtx2LevelIndexSize;
+		Level level;
+		level.width = std::max(width >> i, 1u);
+		level.height = std::max(height >> i, 1u);
+		level.offset = readU64(entry);
+		level.size = readU64(entry + 8);
+		_levels.push_back(level);
+	}
+}
+
+void TextureContainer::parseDds(const std::string& path)
+{
+	if (_file.Size() < kDdsHeaderSize || readU32(Data() + 4) != kDdsHeaderSize - sizeof(uint32_t)) {
+		throw std::runtime_error("invalid DDS file: " + path);
+	}
+
+	const uint8_t* header = Data();
+	uint32_t flags = readU32(header + 8);
+	uint32_t height = readU32(header + 12);
+	uint32_t width = readU32(header + 16);
+	uint32_t mipMapCount = readU32(header + 28);
+	uint32_t pixelFlags = readU32(header + 80);
+	uint32_t fourCC = readU32(header + 84);
+	uint32_t bitCount = readU32(header + 88);
+	uint32_t redMask = readU32(header + 92);
+	uint32_t greenMask = readU32(header + 96);
+	uint32_t blueMask = readU32(header + 100);
+	uint32_t alphaMask = readU32(header + 104);
+	uint32_t caps2 = readU32(header + 112);
+
+	if (width == 0 || height == 0 || (caps2 & (kDdsCaps2Cubemap | kDdsCaps2Volume)) != 0) {
+		throw std::runtime_error("only single 2D DDS textures are supported: " + path);
+	}
+
+	VkDeviceSize dataOffset = kDdsHeaderSize;
+	if ((pixelFlags & kDdpfFourCC) != 0 && fourCC == makeFourCC('D', 'X', '1', '0')) {
+		if (_file.Size() < kDdsHeaderSize + kDdsDx10HeaderSize) {
+			throw std::runtime_error("invalid DDS file: " + path);
+		}
+		const uint8_t* dx10 = header + kDdsHeaderSize;
+		uint32_t dimension = readU32(dx10 + 4);
+		uint32_t miscFlags = readU32(dx10 + 8);
+		uint32_t arraySize = readU32(dx10 + 12);
+		if (dimension != kDx10Texture2D || arraySize > 1 || (miscFlags & kDx10MiscCube) != 0) {
+			throw std::runtime_error("only single 2D DDS textures are supported: " + path);
+		}
+		_format = dxgiToVkFormat(readU32(dx10));
+		dataOffset += kDdsDx10HeaderSize;
+	}
+	else if ((pixelFlags & kDdpfFourCC) != 0) {
+		_format = fourCCToVkFormat(fourCC);
+	}
+	else if ((pixelFlags & kDdpfRgb) != 0 && (pixelFlags & kDdpfAlphaPixels) != 0 && bitCount == 32) {
+		// 非压缩的 32 位 RGBA / BGRA
+		if (redMask == 0x000000FF && greenMask == 0x0000FF00 && blueMask == 0x00FF0000 && alphaMask == 0xFF000000) {
+			_format = VK_FORMAT_R8G8B8A8_UNORM;
+		}
+		else if (redMask == 0x00FF0000 && greenMask == 0x0000FF00 && blueMask == 0x000000FF && alphaMask == 0xFF000000) {
+			_format = VK_FORMAT_B8G8R8A8_UNORM;
+		}
+	}
+	if (_format == VK_FORMAT_UNDEFINED) {
+		throw std::runtime_error("unsupported DDS pixel format: " + path);
+	}
+
+	uint32_t count = (flags & kDdsdMipMapCount) != 0 && mipMapCount > 0 ? mipMapCount : 1;
+	if (count > maxMipLevels(width, height)) {
+		throw std::runtime_error("invalid DDS mip count: " + path);
+	}
+
+	// 各级别从数据区开头依次紧密排列
+	BlockInfo block = GetBlockInfo(_format);
+	for (uint32_t i = 0; i < count; i++) {
+		Level level;
+		level.width = std::max(width >> i, 1u);
+		level.height = std::max(height >> i, 1u);
+		level.offset = dataOffset;
+		level.size = levelSize(block, level.width, level.height);
+		_levels.push_back(level);
+		dataOffset += level.size;
+	}
+}
+
+void TextureContainer::validateLevels(const std::string& path)
+{
+	BlockInfo block = GetBlockInfo(_format);
+	VkDeviceSize fileSize = _file.Size();
+
+	for (Level& level : _levels) {
+		VkDeviceSize expected = levelSize(block, level.width, level.height);
+		if (level.offset > fileSize || level.size > fileSize - level.offset || level.size < expected) {
+			throw std::runtime_error("texture level out of range: " + path);
+		}
+
+		// 上传时只复制按格式计算的大小
+		level.size = expected;
+	}
+}
@@ -0,0 +1,119 @@
+﻿#ifndef TEXTURECONTAINER_H_
+#define TEXTURECONTAINER_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "vulkan/vulkan.h"
+
+#include "../Helper/MappedFile.h"
+
+/**
+ * @brief KTX2 / DDS 纹理容器读取器：内存映射文件，解析格式与各 mip 级别在文件中的位置，不解码像素。
+ *
+ * 块压缩格式（BC1 ~ BC7、ETC2 / EAC、ASTC LDR）保持压缩状态，由调用方把各级别直接复制进暂存缓冲上传，
+ * 显存占用与带宽只有 RGBA8 的 1/4 ~ 1/8。设备不支持容器中的格式时，BC1 ~ BC5 可用 Transcode()
+ * 在 CPU 上转码为 RGBA8；其他格式（BC6H、BC7、ETC2、ASTC）没有 CPU 转码。
+ *
+ * 只支持单层、非立方体的 2D 纹理；KTX2 不支持超压缩（BasisLZ、Zstandard、ZLIB）与 Basis Universal。
+ */
+class TextureContainer
+{
+public:
+	/**
+	 * @brief 一个 mip 级别，offset 相对 Data() 或转码结果的开头，级别 0 为最大的一级。
+	 */
+	struct Level {
+		uint32_t width = 0;
+		uint32_t height = 0;
+		VkDeviceSize offset = 0;
+		VkDeviceSize size = 0;
+	};
+
+	/**
+	 * @brief 格式的块尺寸（像素）与每块字节数；非压缩格式为 1×1 块。未知格式全部为 0。
+	 */
+	struct BlockInfo {
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t bytes = 0;
+	};
+
+public:
+	TextureContainer();
+
+	~TextureContainer();
+
+	TextureContainer(const TextureContainer&) = delete;
+	TextureContainer& operator=(const TextureContainer&) = delete;
+
+public:
+	/**
+	 * @brief 路径的扩展名是否为 .ktx2 或 .dds（不区分大小写）。
+	 */
+	static bool IsContainerPath(const std::string& path);
+
+	/**
+	 * @brief 查询格式的块尺寸。
+	 */
+	static BlockInfo GetBlockInfo(VkFormat format);
+
+	/**
+	 * @brief 是否可以在 CPU 上转码为 RGBA8（BC1 ~ BC5 的 UNORM / SRGB 格式）。
+	 */
+	static bool CanTranscode(VkFormat format);
+
+	/**
+	 * @brief 转码结果的格式：SRGB 格式转为 R8G8B8A8_SRGB，其他转为 R8G8B8A8_UNORM。
+	 */
+	static VkFormat TranscodeFormat(VkFormat format);
+
+	/**
+	 * @brief 映射并解析文件。
+	 *
+	 * @throws std::runtime_error 文件无法打开、容器无效或格式不支持时抛出。
+	 */
+	void Open(const std::string& path);
+
+	VkFormat Format() const { return _format; }
+
+	uint32_t Width() const { return _levels.empty() ? 0 : _levels[0].width; }
+
+	uint32_t Height() const { return _levels.empty() ? 0 : _levels[0].height; }
+
+	/**
+	 * @brief 各 mip 级别在映射文件中的位置。
+	 */
+	const std::vector<Level>& Levels() const { return _levels; }
+
+	/**
+	 * @brief 映射文件的起始地址。
+	 */
+	const uint8_t* Data() const { return static_cast<const uint8_t*>(_file.Data()); }
+
+	/**
+	 * @brief 在 CPU 上把所有级别转码为 RGBA8，各级别紧密排列。
+	 *
+	 * @param levels 输出：转码结果中各级别的位置。
+	 *
+	 * @throws std::runtime_error 格式不能转码时抛出。
+	 */
+	std::vector<uint8_t> Transcode(std::vector<Level>& levels) const;
+
+private:
+	// 解析 KTX2 文件头与级别索引
+	void parseKtx2(const std::string& path);
+
+	// 解析 DDS 文件头（含 DX10 扩展头），级别从数据区开头依次排列
+	void parseDds(const std::string& path);
+
+	// 校验各级别不越出文件且大小不小于按格式计算的大小，并把大小修正为该值
+	void validateLevels(const std::string& path);
+
+	MappedFile _file;
+	VkFormat _format = VK_FORMAT_UNDEFINED;
+	std::vector<Level> _levels;
+};
+
+#endif    // !TEXTURECONTAINER_H_
@@ -0,0 +1,803 @@
+﻿#include "TextureStreamer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+namespace {
+	// 图像文件解码为 RGBA8，不支持的压缩格式也转码为 RGBA8
+	constexpr VkFormat kTextureFormat = VK_FORMAT_R8G8B8A8_UNORM;
+	constexpr VkDeviceSize kTexelSize = 4;
+
+	// 暂存环中每段像素的对齐
+	constexpr VkDeviceSize kStagingAlignment = 16;
+
+	// 占位棋盘格的边长与格子大小（像素）
+	constexpr uint32_t kPlaceholderSize = 8;
+	constexpr uint32_t kPlaceholderCell = 2;
+
+	uint32_t mipLevelCount(uint32_t width, uint32_t height)
+	{
+		uint32_t levels = 1;
+		for (uint32_t size = std::max(width, height); size > 1; size >>= 1) {
+			levels++;
+		}
+		return levels;
+	}
+}
+
+VkDeviceSize TextureStreamer::TextureData::Size() const
+{
+	VkDeviceSize size = 0;
+	for (const auto& level : levels) {
+		size += level.size;
+	}
+	return size;
+}
+
+TextureStreamer::TextureStreamer() {}
+
+TextureStreamer::~TextureStreamer()
+{
+	// 保证解码线程在对象销毁前退出；GPU 资源应已由 Destroy() 释放
+	if (!_threads.empty()) {
+		Destroy();
+	}
+}
+
+void TextureStreamer::Init(VkPhysicalDevice physicalDevice, VkDevice device, GpuAllocator& allocator, DeletionQueue& deletionQueue,
+	uint32_t graphicsFamily, VkQueue graphicsQueue, const Settings& settings)
+{
+	_physicalDevice = physicalDevice;
+	_device = device;
+	_allocator = &allocator;
+	_deletionQueue = &deletionQueue;
+	_graphicsQueue = graphicsQueue;
+	_settings = settings;
+	_stats = Stats{};
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+	_maxDimension = properties.limits.maxImageDimension2D;
+
+	// 每帧至少能上传最宽图像的一行（压缩格式的一行块不会更大），否则该图像永远无法完成
+	_settings.uploadBudget = std::max(_settings.uploadBudget, _maxDimension * kTexelSize + kStagingAlignment);
+
+	// RGBA8 必然支持 blit，但不一定支持线性过滤，不支持时生成 mipmap 与采样都退回最近点
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties(physicalDevice, kTextureFormat, &formatProperties);
+	_mipFilter = (formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT) != 0
+		? VK_FILTER_LINEAR : VK_FILTER_NEAREST;
+
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = graphicsFamily;
+
+	if (vkCreateCommandPool(_device, &poolInfo, nullptr, &_commandPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create texture streaming command pool!");
+	}
+
+	VkCommandBufferAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.commandPool = _commandPool;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandBufferCount = 1;
+
+	VkFenceCreateInfo fenceInfo{};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+	for (Slot& slot : _slots) {
+		if (vkAllocateCommandBuffers(_device, &allocInfo, &slot.commands) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate texture streaming command buffer!");
+		}
+		if (vkCreateFence(_device, &fenceInfo, nullptr, &slot.fence) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create texture streaming fence!");
+		}
+		slot.pending = false;
+	}
+
+	// 每个槽位一个暂存分区，大小即每帧上传预算
+	_staging.Init(physicalDevice, allocator, _settings.uploadBudget, kSlots, VK_BUFFER_USAGE_TRANSFER_SRC_BIT);
+
+	VkSamplerCreateInfo samplerInfo{};
+	samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+	samplerInfo.magFilter = _mipFilter;
+	samplerInfo.minFilter = _mipFilter;
+	samplerInfo.mipmapMode = _mipFilter == VK_FILTER_LINEAR ? VK_SAMPLER_MIPMAP_MODE_LINEAR : VK_SAMPLER_MIPMAP_MODE_NEAREST;
+	samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+	samplerInfo.minLod = 0.0f;
+	samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+	samplerInfo.borderColor = VK_BORDER_COLOR_INT_OPAQUE_BLACK;
+
+	if (vkCreateSampler(_device, &samplerInfo, nullptr, &_sampler) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create texture sampler!");
+	}
+
+	createPlaceholder();
+
+	uint32_t threadCount = _settings.threadCount;
+	if (threadCount == 0) {
+		// hardware_concurrency() 无法确定时返回 0
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		threadCount = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+
+	_stop = false;
+	for (uint32_t i = 0; i < threadCount; i++) {
+		_threads.emplace_back(&TextureStreamer::workerLoop, this);
+	}
+}
+
+void TextureStreamer::Destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+		_decodeQueue.clear();
+	}
+	_workCondition.notify_all();
+
+	for (auto& thread : _threads) {
+		thread.join();
+	}
+	_threads.clear();
+
+	if (_device == VK_NULL_HANDLE) {
+		return;
+	}
+
+	// GPU 已空闲，驻留与上传中的图像直接销毁
+	for (Texture& texture : _textures) {
+		if (texture.image != VK_NULL_HANDLE) {
+			vkDestroyImageView(_device, texture.view, nullptr);
+			_allocator->DestroyImage(texture.image, texture.allocation);
+		}
+	}
+	_textures.clear();
+	_handles.clear();
+	_uploadOrder.clear();
+	_decoded.clear();
+	_decodedBytes = 0;
+	_pendingCount = 0;
+	_residentBytes = 0;
+
+	vkDestroyImageView(_device, _placeholder.view, nullptr);
+	_allocator->DestroyImage(_placeholder.image, _placeholder.allocation);
+	_placeholder = Texture{};
+
+	vkDestroySampler(_device, _sampler, nullptr);
+	_sampler = VK_NULL_HANDLE;
+	_staging.Destroy();
+
+	for (Slot& slot : _slots) {
+		vkDestroyFence(_device, slot.fence, nullptr);
+		slot = Slot{};
+	}
+	vkDestroyCommandPool(_device, _commandPool, nullptr);
+	_commandPool = VK_NULL_HANDLE;
+
+	_device = VK_NULL_HANDLE;
+}
+
+TextureStreamer::Handle TextureStreamer::Request(const std::string& path)
+{
+	auto it = _handles.find(path);
+	if (it != _handles.end()) {
+		return it->second;
+	}
+
+	Handle handle = static_cast<Handle>(_textures.size());
+	_textures.emplace_back();
+	_textures.back().path = path;
+	_handles.emplace(path, handle);
+	return handle;
+}
+
+void TextureStreamer::Prefetch(Handle handle)
+{
+	if (_textures[handle].state == State::Unloaded) {
+		queueDecode(handle);
+	}
+}
+
+VkImageView TextureStreamer::View(Handle handle)
+{
+	Texture& texture = _textures[handle];
+	texture.lastUsed = _updateCount;
+
+	if (texture.state == State::Resident) {
+		return texture.view;
+	}
+	if (texture.state == State::Unloaded) {
+		queueDecode(handle);
+	}
+	return _placeholder.view;
+}
+
+void TextureStreamer::Update(uint64_t serial)
+{
+	_updateCount++;
+	collectDecoded();
+
+	// 预算调小后，把超出的部分逐出
+	if (_residentBytes > _settings.memoryBudget) {
+		makeRoom(0, serial);
+	}
+
+	if (_uploadOrder.empty()) {
+		return;
+	}
+
+	// 槽位的上一次上传还在执行时本帧不上传，绝不阻塞渲染线程
+	uint32_t slotIndex = static_cast<uint32_t>(_updateCount % kSlots);
+	Slot& slot = _slots[slotIndex];
+	if (slot.pending) {
+		if (vkGetFenceStatus(_device, slot.fence) != VK_SUCCESS) {
+			_stats.busyFrames++;
+			return;
+		}
+		slot.pending = false;
+	}
+
+	_staging.BeginFrame(slotIndex);
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	if (vkBeginCommandBuffer(slot.commands, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("failed to begin texture streaming command buffer!");
+	}
+
+	VkDeviceSize budget = _settings.uploadBudget;
+	bool recorded = false;
+
+	// 按解码完成的顺序上传；队首的纹理在预算内放不下时，后面的纹理也等待
+	while (!_uploadOrder.empty()) {
+		Handle handle = _uploadOrder.front();
+		Texture& texture = _textures[handle];
+
+		if (texture.state == State::Decoded) {
+			// 显存占用估计：自带 mip 链时即各级别之和，生成 mip 链时约为基础级别的 4/3
+			VkDeviceSize bytes = texture.data.generateMips ? texture.data.Size() * 4 / 3 : texture.data.Size();
+			if (bytes > _settings.memoryBudget) {
+				std::cerr << "纹理超出显存预算，放弃加载: " << texture.path << std::endl;
+				releaseData(texture);
+				texture.state = State::Failed;
+				_pendingCount--;
+				_uploadOrder.pop_front();
+				continue;
+			}
+			if (!makeRoom(bytes, serial)) {
+				break;
+			}
+
+			createImage(texture, slot.commands);
+			recorded = true;
+			_residentBytes += texture.allocation.size;
+			_stats.peakResidentBytes = std::max(_stats.peakResidentBytes, _residentBytes);
+			texture.state = State::Uploading;
+			texture.uploadLevel = 0;
+			texture.uploadedRows = 0;
+		}
+
+		// 本帧预算内能写入当前级别的整行数，压缩格式以块行为单位，大图像跨多帧分段上传
+		const TextureContainer::Level& level = texture.data.levels[texture.uploadLevel];
+		TextureContainer::BlockInfo block = TextureContainer::GetBlockInfo(texture.format);
+		uint32_t blockRows = (level.height + block.height - 1) / block.height;
+		VkDeviceSize rowBytes = static_cast<VkDeviceSize>((level.width + block.width - 1) / block.width) * block.bytes;
+		uint32_t rows = static_cast<uint32_t>(std::min<VkDeviceSize>(blockRows - texture.uploadedRows, budget / rowBytes));
+		if (rows == 0) {
+			break;
+		}
+
+		// 直接从映射文件或解码结果复制进暂存环，压缩数据不经过 CPU 解码
+		VkDeviceSize bytes = rows * rowBytes;
+		FrameRingBuffer::Slice slice = _staging.Push(texture.data.Bytes() + level.offset + texture.uploadedRows * rowBytes, bytes,
+			kStagingAlignment);
+
+		uint32_t y = texture.uploadedRows * block.height;
+		VkBufferImageCopy region{};
+		region.bufferOffset = slice.offset;
+		region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		region.imageSubresource.mipLevel = texture.uploadLevel;
+		region.imageSubresource.baseArrayLayer = 0;
+		region.imageSubresource.layerCount = 1;
+		region.imageOffset = { 0, static_cast<int32_t>(y), 0 };
+		region.imageExtent = { level.width, std::min(rows * block.height, level.height - y), 1 };
+
+		vkCmdCopyBufferToImage(slot.commands, slice.buffer, texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+		recorded = true;
+
+		budget -= std::min(budget, (bytes + kStagingAlignment - 1) & ~(kStagingAlignment - 1));
+		texture.uploadedRows += rows;
+		_stats.uploadedBytes += bytes;
+
+		if (texture.uploadedRows < blockRows) {
+			break;
+		}
+
+		// 当前级别写完，预算有余时在本帧继续下一级
+		texture.uploadLevel++;
+		texture.uploadedRows = 0;
+		if (texture.uploadLevel < texture.data.levels.size()) {
+			continue;
+		}
+
+		// 所有级别写完，数据已在暂存环中，主机内存与文件映射可以释放
+		if (texture.data.generateMips) {
+			generateMipmaps(texture, slot.commands);
+		}
+		else {
+			finishLevels(texture, slot.commands);
+		}
+		if (block.width > 1) {
+			_stats.compressedUploads++;
+		}
+		releaseData(texture);
+		texture.state = State::Resident;
+		texture.lastUsed = _updateCount;
+		texture.generation++;
+		_stats.uploads++;
+		_pendingCount--;
+		_uploadOrder.pop_front();
+	}
+
+	if (vkEndCommandBuffer(slot.commands) != VK_SUCCESS) {
+		throw std::runtime_error("failed to record texture streaming command buffer!");
+	}
+	if (!recorded) {
+		return;
+	}
+
+	// 与帧提交在同一队列上，之后的帧按提交顺序位于最后的屏障之后，可直接采样
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &slot.commands;
+
+	vkResetFences(_device, 1, &slot.fence);
+	if (vkQueueSubmit(_graphicsQueue, 1, &submitInfo, slot.fence) != VK_SUCCESS) {
+		throw std::runtime_error("failed to submit texture streaming command buffer!");
+	}
+	slot.pending = true;
+}
+
+TextureStreamer::Stats TextureStreamer::GetStats()
+{
+	Stats stats = _stats;
+	stats.textures = Count();
+	stats.pending = _pendingCount;
+	stats.residentBytes = _residentBytes;
+	for (const Texture& texture : _textures) {
+		if (texture.state == State::Resident) {
+			stats.resident++;
+		}
+		else if (texture.state == State::Failed) {
+			stats.failed++;
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	stats.decodes = _decodeCount;
+	stats.decodeMs = _decodeMs;
+	return stats;
+}
+
+void TextureStreamer::ResetStats()
+{
+	_stats = Stats{};
+	_stats.peakResidentBytes = _residentBytes;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	_decodeCount = 0;
+	_decodeMs = 0.0;
+}
+
+void TextureStreamer::queueDecode(Handle handle)
+{
+	_textures[handle].state = State::Decoding;
+	_pendingCount++;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_decodeQueue.emplace_back(handle, _textures[handle].path);
+	}
+	_workCondition.notify_one();
+}
+
+void TextureStreamer::workerLoop()
+{
+	while (true) {
+		std::pair<Handle, std::string> job;
+		{
+			// 已解码未上传的像素超过上限时暂停，等渲染线程写入暂存环后释放
+			std::unique_lock<std::mutex> lock(_mutex);
+			_workCondition.wait(lock, [this]() {
+				return _stop || (!_decodeQueue.empty() && _decodedBytes < _settings.decodedBudget);
+			});
+			if (_stop) {
+				return;
+			}
+			job = std::move(_decodeQueue.front());
+			_decodeQueue.pop_front();
+		}
+
+		// 解码期间不持有锁
+		auto start = std::chrono::steady_clock::now();
+
+		DecodeResult result;
+		result.handle = job.first;
+		try {
+			load(job.second, result.data);
+		}
+		catch (const std::exception& e) {
+			result.error = e.what();
+			result.data = TextureData{};
+		}
+
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		std::lock_guard<std::mutex> lock(_mutex);
+		_decodedBytes += result.data.Size();
+		_decodeCount++;
+		_decodeMs += ms;
+		_decoded.push_back(std::move(result));
+	}
+}
+
+void TextureStreamer::load(const std::string& path, TextureData& data) const
+{
+	if (TextureContainer::IsContainerPath(path)) {
+		loadContainer(path, data);
+		return;
+	}
+
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+	stbi_uc* pixels = stbi_load(path.c_str(), &width, &height, &channels, STBI_rgb_alpha);
+	if (pixels == nullptr) {
+		const char* reason = stbi_failure_reason();
+		throw std::runtime_error(reason != nullptr ? reason : "unknown error");
+	}
+
+	TextureContainer::Level level;
+	level.width = static_cast<uint32_t>(width);
+	level.height = static_cast<uint32_t>(height);
+	level.size = static_cast<VkDeviceSize>(width) * height * kTexelSize;
+
+	data.format = kTextureFormat;
+	data.levels.assign(1, level);
+	data.pixels.assign(pixels, pixels + level.size);
+	data.generateMips = true;
+	stbi_image_free(pixels);
+}
+
+void TextureStreamer::loadContainer(const std::string& path, TextureData& data) const
+{
+	auto container = std::make_unique<TextureContainer>();
+	container->Open(path);
+	VkFormat format = container->Format();
+
+	// 在读取像素或转码（按宽高分配 RGBA8 内存）之前拒绝设备无法创建的尺寸
+	const TextureContainer::Level& base = container->Levels().front();
+	if (base.width > _maxDimension || base.height > _maxDimension) {
+		throw std::runtime_error("image too large");
+	}
+
+	// 设备能采样容器中的格式时直接上传，否则在 CPU 上转码为 RGBA8
+	VkFormatProperties properties;
+	vkGetPhysicalDeviceFormatProperties(_physicalDevice, format, &properties);
+	if ((properties.optimalTilingFeatures & VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT) != 0) {
+		data.format = format;
+		data.levels = container->Levels();
+		data.container = std::move(container);
+	}
+	else if (TextureContainer::CanTranscode(format)) {
+		data.format = TextureContainer::TranscodeFormat(format);
+		data.pixels = container->Transcode(data.levels);
+		data.transcoded = true;
+	}
+	else {
+		throw std::runtime_error("device cannot sample texture format " + std::to_string(format) + " and it cannot be transcoded");
+	}
+
+	// 只有基础级别的非压缩纹理在 GPU 上生成 mipmap，压缩格式不能作为 blit 目标
+	data.generateMips = data.levels.size() == 1 && TextureContainer::GetBlockInfo(data.format).width == 1;
+}
+
+void TextureStreamer::collectDecoded()
+{
+	std::vector<DecodeResult> results;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		results.swap(_decoded);
+	}
+
+	for (DecodeResult& result : results) {
+		Texture& texture = _textures[result.handle];
+		texture.data = std::move(result.data);
+		if (!texture.data.levels.empty()) {
+			texture.width = texture.data.levels[0].width;
+			texture.height = texture.data.levels[0].height;
+		}
+
+		if (!result.error.empty() || texture.width > _maxDimension || texture.height > _maxDimension) {
+			std::cerr << "纹理加载失败 (" << texture.path << "): "
+				<< (result.error.empty() ? "image too large" : result.error) << std::endl;
+			releaseData(texture);
+			texture.state = State::Failed;
+			_pendingCount--;
+			continue;
+		}
+
+		texture.format = texture.data.format;
+		texture.mipLevels = texture.data.generateMips ? mipLevelCount(texture.width, texture.height)
+			: static_cast<uint32_t>(texture.data.levels.size());
+		if (texture.data.transcoded) {
+			_stats.transcodes++;
+		}
+		texture.state = State::Decoded;
+		_uploadOrder.push_back(result.handle);
+	}
+}
+
+bool TextureStreamer::makeRoom(VkDeviceSize bytes, uint64_t serial)
+{
+	while (_residentBytes + bytes > _settings.memoryBudget) {
+		// 最近两次 Update() 之间用过的纹理还在屏幕上，不逐出
+		Texture* victim = nullptr;
+		for (Texture& texture : _textures) {
+			if (texture.state == State::Resident && texture.lastUsed + 2 <= _updateCount
+				&& (victim == nullptr || texture.lastUsed < victim->lastUsed)) {
+				victim = &texture;
+			}
+		}
+		if (victim == nullptr) {
+			return false;
+		}
+		evict(*victim, serial);
+	}
+	return true;
+}
+
+void TextureStreamer::evict(Texture& texture, uint64_t serial)
+{
+	// 在途的帧可能还在采样该图像，推迟到本帧完成后销毁
+	VkDevice device = _device;
+	GpuAllocator* allocator = _allocator;
+	VkImage image = texture.image;
+	VkImageView view = texture.view;
+	GpuAllocation allocation = texture.allocation;
+	_deletionQueue->Push(serial, [device, allocator, image, view, allocation]() mutable {
+		vkDestroyImageView(device, view, nullptr);
+		allocator->DestroyImage(image, allocation);
+	});
+
+	_residentBytes -= texture.allocation.size;
+	texture.image = VK_NULL_HANDLE;
+	texture.view = VK_NULL_HANDLE;
+	texture.allocation = GpuAllocation{};
+	texture.state = State::Unloaded;
+	_stats.evictions++;
+}
+
+void TextureStreamer::createImage(Texture& texture, VkCommandBuffer cmd)
+{
+	VkImageCreateInfo imageInfo{};
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.format = texture.format;
+	imageInfo.extent = { texture.width, texture.height, 1 };
+	imageInfo.mipLevels = texture.mipLevels;
+	imageInfo.arrayLayers = 1;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+	if (texture.data.generateMips) {
+		imageInfo.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	}
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+	_allocator->CreateImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture.image, texture.allocation);
+
+	VkImageViewCreateInfo viewInfo{};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = texture.image;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format = texture.format;
+	viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	viewInfo.subresourceRange.baseMipLevel = 0;
+	viewInfo.subresourceRange.levelCount = texture.mipLevels;
+	viewInfo.subresourceRange.baseArrayLayer = 0;
+	viewInfo.subresourceRange.layerCount = 1;
+
+	if (vkCreateImageView(_device, &viewInfo, nullptr, &texture.view) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create texture image view!");
+	}
+
+	// 所有级别转到 TRANSFER_DST，接收复制或 blit
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = texture.image;
+	barrier.subresourceRange = viewInfo.subresourceRange;
+
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void TextureStreamer::generateMipmaps(const Texture& texture, VkCommandBuffer cmd)
+{
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = texture.image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+	barrier.subresourceRange.levelCount = 1;
+
+	int32_t width = static_cast<int32_t>(texture.width);
+	int32_t height = static_cast<int32_t>(texture.height);
+
+	for (uint32_t level = 1; level < texture.mipLevels; level++) {
+		// 上一级写入完成后作为 blit 源
+		barrier.subresourceRange.baseMipLevel = level - 1;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+			0, nullptr, 0, nullptr, 1, &barrier);
+
+		int32_t nextWidth = std::max(width / 2, 1);
+		int32_t nextHeight = std::max(height / 2, 1);
+
+		VkImageBlit blit{};
+		blit.srcOffsets[1] = { width, height, 1 };
+		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.srcSubresource.mipLevel = level - 1;
+		blit.srcSubresource.baseArrayLayer = 0;
+		blit.srcSubresource.layerCount = 1;
+		blit.dstOffsets[1] = { nextWidth, nextHeight, 1 };
+		blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.dstSubresource.mipLevel = level;
+		blit.dstSubresource.baseArrayLayer = 0;
+		blit.dstSubresource.layerCount = 1;
+
+		vkCmdBlitImage(cmd, texture.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, _mipFilter);
+
+		// 上一级不再被读取，转为着色器只读
+		barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
+		barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+		barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+		vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+			0, nullptr, 0, nullptr, 1, &barrier);
+
+		width = nextWidth;
+		height = nextHeight;
+	}
+
+	// 最后一级只被写入过
+	barrier.subresourceRange.baseMipLevel = texture.mipLevels - 1;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void TextureStreamer::finishLevels(const Texture& texture, VkCommandBuffer cmd)
+{
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+	barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = texture.image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = texture.mipLevels;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+
+	vkCmdPipelineBarrier(cmd, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void TextureStreamer::releaseData(Texture& texture)
+{
+	VkDeviceSize bytes = texture.data.Size();
+	texture.data = TextureData{};
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_decodedBytes -= bytes;
+	}
+	_workCondition.notify_all();
+}
+
+void TextureStreamer::createPlaceholder()
+{
+	// 灰白棋盘格，未驻留的纹理显示为它
+	_placeholder.format = kTextureFormat;
+	_placeholder.width = kPlaceholderSize;
+	_placeholder.height = kPlaceholderSize;
+	_placeholder.data.generateMips = true;
+	_placeholder.mipLevels = mipLevelCount(kPlaceholderSize, kPlaceholderSize);
+
+	Slot& slot = _slots[0];
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	if (vkBeginCommandBuffer(slot.commands, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("failed to begin texture streaming command buffer!");
+	}
+
+	createImage(_placeholder, slot.commands);
+
+	_staging.BeginFrame(0);
+	FrameRingBuffer::Slice slice = _staging.Allocate(kPlaceholderSize * kPlaceholderSize * kTexelSize, kStagingAlignment);
+	uint8_t* texel = static_cast<uint8_t*>(slice.data);
+	for (uint32_t y = 0; y < kPlaceholderSize; y++) {
+		for (uint32_t x = 0; x < kPlaceholderSize; x++) {
+			uint8_t value = ((x / kPlaceholderCell + y / kPlaceholderCell) % 2) != 0 ? 0xC0 : 0x60;
+			texel[0] = value;
+			texel[1] = value;
+			texel[2] = value;
+			texel[3] = 0xFF;
+			texel += kTexelSize;
+		}
+	}
+
+	VkBufferImageCopy region{};
+	region.bufferOffset = slice.offset;
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent = { kPlaceholderSize, kPlaceholderSize, 1 };
+	vkCmdCopyBufferToImage(slot.commands, slice.buffer, _placeholder.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+	generateMipmaps(_placeholder, slot.commands);
+
+	if (vkEndCommandBuffer(slot.commands) != VK_SUCCESS) {
+		throw std::runtime_error("failed to record texture streaming command buffer!");
+	}
+
+	// 只在初始化时同步等待一次
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &slot.commands;
+
+	if (vkQueueSubmit(_graphicsQueue, 1, &submitInfo, slot.fence) != VK_SUCCESS) {
+		throw std::runtime_error("failed to submit placeholder texture upload!");
+	}
+	vkWaitForFences(_device, 1, &slot.fence, VK_TRUE, UINT64_MAX);
+
+	_placeholder.state = State::Resident;
+}
@@ -0,0 +1,362 @@
+﻿#ifndef TEXTURESTREAMER_H_
+#define TEXTURESTREAMER_H_
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "DeletionQueue.h"
+#include "FrameRingBuffer.h"
+#include "GpuAllocator.h"
+#include "TextureContainer.h"
+
+/**
+ * @brief 多线程纹理流送：工作线程解码图像文件，渲染线程按每帧预算分段上传并生成 mipmap，显存超出预算时按 LRU 逐出。
+ *
+ * Request() 只登记文件并返回句柄；Prefetch() 或 View() 才把解码放入工作线程队列。工作线程用 stb_image
+ * 解码普通图像为 RGBA8；KTX2 / DDS 容器只做内存映射与解析（TextureContainer），设备支持其中的块压缩格式时
+ * 保持压缩、直接上传整条 mip 链，不支持时才在 CPU 上转码为 RGBA8。已解码（或已映射）未上传的数据
+ * 总量超过上限时暂停解码，避免主机内存随文件数量增长。
+ *
+ * Update() 每帧在渲染线程调用一次：取走解码结果，在显存预算内创建图像，把各 mip 级别按行（压缩格式按块行）
+ * 分段写入暂存环，每帧写入的字节数不超过 uploadBudget，大图像跨多帧上传。只有基础级别的非压缩图像在
+ * 最后一段写完后用 vkCmdBlitImage 逐级生成 mipmap，最后图像转为 SHADER_READ_ONLY 布局。复制与 blit 需要图形队列，
+ * 因此流送使用自己的图形队列命令池与 kSlots 个槽位，而不是 UploadQueue 的传输队列；
+ * 槽位的上一次提交尚未完成时本帧跳过上传（计入 busyFrames），绝不阻塞渲染线程。
+ *
+ * View() 在纹理驻留前返回占位纹理（棋盘格），并记录使用时间。为新纹理腾出显存时，只逐出最近两次
+ * Update() 都没有用到的驻留纹理，其图像经 DeletionQueue 延迟到引用它的帧完成后销毁；被逐出的纹理
+ * 下次 View() 时重新解码上传。可逐出的纹理不够时新纹理排队等待，不会超出预算。
+ *
+ * 除工作线程内部外，只能在渲染线程使用。
+ */
+class TextureStreamer
+{
+public:
+	/**
+	 * @brief 纹理句柄，Request() 返回的下标，在 Destroy() 前一直有效。
+	 */
+	using Handle = uint32_t;
+
+	/**
+	 * @brief 上传命令缓冲的槽位数，同时在 GPU 上执行的上传提交最多这么多个。
+	 */
+	static constexpr uint32_t kSlots = 3;
+
+	/**
+	 * @brief 纹理状态。
+	 */
+	enum class State {
+		Unloaded,     // 已登记，未解码（或已被逐出）
+		Decoding,     // 在工作线程队列中或正在解码
+		Decoded,      // 像素已解码，等待显存预算
+		Uploading,    // 图像已创建，正在分段上传
+		Resident,     // 已驻留，可以采样
+		Failed        // 解码失败或超出预算，View() 一直返回占位纹理
+	};
+
+	/**
+	 * @brief 等待上传的纹理数据：stb_image 解码或 CPU 转码的像素，或直接上传的映射容器文件。
+	 */
+	struct TextureData {
+		VkFormat format = VK_FORMAT_UNDEFINED;
+
+		// 各 mip 级别，offset 相对 Bytes()
+		std::vector<TextureContainer::Level> levels;
+
+		std::vector<uint8_t> pixels;
+		std::unique_ptr<TextureContainer> container;
+
+		// 只有基础级别，上传后用 blit 生成其余级别
+		bool generateMips = false;
+
+		// 块压缩容器因设备不支持而转码
+		bool transcoded = false;
+
+		const uint8_t* Bytes() const { return container ? container->Data() : pixels.data(); }
+
+		// 待上传的字节数
+		VkDeviceSize Size() const;
+	};
+
+	/**
+	 * @brief 流送参数。
+	 */
+	struct Settings {
+		// 驻留纹理（含上传中的图像）的显存上限
+		VkDeviceSize memoryBudget = 256ull * 1024 * 1024;
+
+		// 每次 Update() 最多写入暂存环的字节数
+		VkDeviceSize uploadBudget = 8ull * 1024 * 1024;
+
+		// 已解码（或已映射）、尚未写入暂存环的数据上限（主机内存）
+		VkDeviceSize decodedBudget = 256ull * 1024 * 1024;
+
+		// 解码线程数，0 表示硬件线程数 - 1（至少 1 个）
+		uint32_t threadCount = 0;
+	};
+
+	/**
+	 * @brief 累计统计。
+	 */
+	struct Stats {
+		// 按状态统计的纹理数
+		uint32_t textures = 0;
+		uint32_t resident = 0;
+		uint32_t pending = 0;     // 解码中、等待预算或上传中
+		uint32_t failed = 0;
+
+		// 完成的解码、上传与逐出次数
+		uint64_t decodes = 0;
+		uint64_t uploads = 0;
+		uint64_t evictions = 0;
+
+		// 以块压缩格式驻留的上传次数，与因设备不支持而在 CPU 上转码的次数
+		uint64_t compressedUploads = 0;
+		uint64_t transcodes = 0;
+
+		// 当前与峰值显存占用，累计上传字节数
+		VkDeviceSize residentBytes = 0;
+		VkDeviceSize peakResidentBytes = 0;
+		VkDeviceSize uploadedBytes = 0;
+
+		// 各线程解码耗时之和
+		double decodeMs = 0.0;
+
+		// 因槽位的上一次上传尚未完成而跳过上传的帧数
+		uint64_t busyFrames = 0;
+	};
+
+public:
+	TextureStreamer();
+
+	~TextureStreamer();
+
+	TextureStreamer(const TextureStreamer&) = delete;
+	TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+public:
+	/**
+	 * @brief 创建命令池、暂存环、采样器与占位纹理，并启动解码线程。
+	 *
+	 * @param physicalDevice 物理设备，用于查询格式特性与图像尺寸上限。
+	 * @param device         逻辑设备。
+	 * @param allocator      显存分配器，纹理图像与暂存环从中分配。
+	 * @param deletionQueue  延迟销毁队列，被逐出的纹理经它销毁。
+	 * @param graphicsFamily 图形队列族索引。
+	 * @param graphicsQueue  图形队列，上传与 mipmap 生成提交到这里。
+	 * @param settings       流送参数。
+	 *
+	 * @throws std::runtime_error 创建失败时抛出。
+	 */
+	void Init(VkPhysicalDevice physicalDevice, VkDevice device, GpuAllocator& allocator, DeletionQueue& deletionQueue,
+		uint32_t graphicsFamily, VkQueue graphicsQueue, const Settings& settings);
+
+	/**
+	 * @brief 停止解码线程并销毁所有纹理与资源。调用前 GPU 必须空闲。
+	 */
+	void Destroy();
+
+	/**
+	 * @brief 是否已初始化。
+	 */
+	bool IsValid() const { return _device != VK_NULL_HANDLE; }
+
+	/**
+	 * @brief 登记图像文件并返回句柄，同一路径返回同一句柄。不会开始解码。
+	 */
+	Handle Request(const std::string& path);
+
+	/**
+	 * @brief 未驻留且未在流送中的纹理开始解码，不记录使用时间。
+	 */
+	void Prefetch(Handle handle);
+
+	/**
+	 * @brief 返回可采样的图像视图并记录使用时间；未驻留时返回占位纹理，未加载的纹理开始解码。
+	 */
+	VkImageView View(Handle handle);
+
+	/**
+	 * @brief 纹理每次变为驻留时加一，调用方据此判断按视图缓存的描述符是否过期。
+	 */
+	uint32_t Generation(Handle handle) const { return _textures[handle].generation; }
+
+	/**
+	 * @brief 纹理当前状态。
+	 */
+	State GetState(Handle handle) const { return _textures[handle].state; }
+
+	/**
+	 * @brief 纹理文件路径。
+	 */
+	const std::string& Path(Handle handle) const { return _textures[handle].path; }
+
+	/**
+	 * @brief 已登记的纹理数。
+	 */
+	uint32_t Count() const { return static_cast<uint32_t>(_textures.size()); }
+
+	/**
+	 * @brief 是否还有解码或上传中的纹理，有时需要继续绘制新帧。
+	 */
+	bool IsBusy() const { return _pendingCount > 0; }
+
+	/**
+	 * @brief 所有纹理共用的采样器（线性过滤、三线性 mipmap）。
+	 */
+	VkSampler Sampler() const { return _sampler; }
+
+	/**
+	 * @brief 占位纹理的图像视图。
+	 */
+	VkImageView PlaceholderView() const { return _placeholder.view; }
+
+	/**
+	 * @brief 每帧调用一次：取走解码结果，逐出并创建图像，录制并提交本帧预算内的上传。
+	 *
+	 * @param serial 本帧提交的序号，被逐出纹理的销毁推迟到该序号完成之后。
+	 *
+	 * @throws std::runtime_error 录制或提交失败时抛出。
+	 */
+	void Update(uint64_t serial);
+
+	/**
+	 * @brief 修改显存预算，超出部分在之后的 Update() 中逐出。
+	 */
+	void SetMemoryBudget(VkDeviceSize budget) { _settings.memoryBudget = budget; }
+
+	/**
+	 * @brief 当前流送参数。
+	 */
+	const Settings& GetSettings() const { return _settings; }
+
+	/**
+	 * @brief 获取统计信息快照。
+	 */
+	Stats GetStats();
+
+	/**
+	 * @brief 清零累计统计（不影响纹理状态与当前显存占用）。
+	 */
+	void ResetStats();
+
+private:
+	struct Texture {
+		std::string path;
+		State state = State::Unloaded;
+
+		VkImage image = VK_NULL_HANDLE;
+		GpuAllocation allocation;
+		VkImageView view = VK_NULL_HANDLE;
+
+		VkFormat format = VK_FORMAT_UNDEFINED;
+		uint32_t width = 0;
+		uint32_t height = 0;
+		uint32_t mipLevels = 1;
+
+		// 待上传的数据，与当前上传的级别、该级别已写入暂存环的行数（压缩格式为块行数）（Decoded / Uploading）
+		TextureData data;
+		uint32_t uploadLevel = 0;
+		uint32_t uploadedRows = 0;
+
+		// 最近一次 View() 时的 Update() 计数
+		uint64_t lastUsed = 0;
+
+		uint32_t generation = 0;
+	};
+
+	struct DecodeResult {
+		Handle handle = 0;
+		TextureData data;
+		std::string error;
+	};
+
+	struct Slot {
+		VkCommandBuffer commands = VK_NULL_HANDLE;
+		VkFence fence = VK_NULL_HANDLE;
+		bool pending = false;
+	};
+
+	// 纹理进入解码队列
+	void queueDecode(Handle handle);
+
+	// 工作线程：取出路径解码，结果放入结果队列
+	void workerLoop();
+
+	// 按扩展名解码图像或读取容器，失败时抛出异常；在工作线程上调用
+	void load(const std::string& path, TextureData& data) const;
+
+	// 映射 KTX2 / DDS 容器；设备不能采样其格式时在 CPU 上转码
+	void loadContainer(const std::string& path, TextureData& data) const;
+
+	// 取走解码结果，更新纹理状态
+	void collectDecoded();
+
+	// 逐出最久未使用的驻留纹理，直到能再容纳 bytes 字节；做不到时返回 false
+	bool makeRoom(VkDeviceSize bytes, uint64_t serial);
+
+	// 逐出一个驻留纹理，图像在 serial 完成后销毁
+	void evict(Texture& texture, uint64_t serial);
+
+	// 创建图像与视图，并录制所有 mip 级别转到 TRANSFER_DST 的屏障
+	void createImage(Texture& texture, VkCommandBuffer cmd);
+
+	// 逐级 blit 生成 mipmap，所有级别转到 SHADER_READ_ONLY
+	void generateMipmaps(const Texture& texture, VkCommandBuffer cmd);
+
+	// 所有级别都已上传，一次转到 SHADER_READ_ONLY
+	void finishLevels(const Texture& texture, VkCommandBuffer cmd);
+
+	// 释放纹理的待上传数据（像素或映射），唤醒等待内存的解码线程
+	void releaseData(Texture& texture);
+
+	// 创建并同步上传占位纹理
+	void createPlaceholder();
+
+	VkPhysicalDevice _physicalDevice = VK_NULL_HANDLE;
+	VkDevice _device = VK_NULL_HANDLE;
+	GpuAllocator* _allocator = nullptr;
+	DeletionQueue* _deletionQueue = nullptr;
+	VkQueue _graphicsQueue = VK_NULL_HANDLE;
+	Settings _settings;
+
+	VkCommandPool _commandPool = VK_NULL_HANDLE;
+	std::array<Slot, kSlots> _slots{};
+	FrameRingBuffer _staging;
+	VkSampler _sampler = VK_NULL_HANDLE;
+	VkFilter _mipFilter = VK_FILTER_LINEAR;
+	uint32_t _maxDimension = 0;
+
+	Texture _placeholder;
+
+	// 只由渲染线程访问
+	std::vector<Texture> _textures;
+	std::unordered_map<std::string, Handle> _handles;
+	std::deque<Handle> _uploadOrder;
+	uint64_t _updateCount = 0;
+	uint32_t _pendingCount = 0;
+	VkDeviceSize _residentBytes = 0;
+	Stats _stats;
+
+	// 以下由 _mutex 保护
+	std::mutex _mutex;
+	std::condition_variable _workCondition;
+	std::deque<std::pair<Handle, std::string>> _decodeQueue;
+	std::vector<DecodeResult> _decoded;
+	VkDeviceSize _decodedBytes = 0;
+	uint64_t _decodeCount = 0;
+	double _decodeMs = 0.0;
+	bool _stop = false;
+
+	std::vector<std::thread> _threads;
+};
+
+#endif    // !TEXTURESTREAMER_H_
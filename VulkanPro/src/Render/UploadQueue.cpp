@@ -0,0 +1,375 @@
+﻿#include "UploadQueue.h"
+
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+	// 暂存环内每次上传的对齐，满足常见格式的 optimalBufferCopyOffsetAlignment
+	constexpr VkDeviceSize kStagingAlignment = 16;
+}
+
+UploadQueue::UploadQueue() {}
+
+UploadQueue::~UploadQueue() {}
+
+void UploadQueue::Init(VkDevice device, GpuAllocator& allocator, uint32_t transferFamily, VkQueue transferQueue,
+	uint32_t graphicsFamily, VkQueue graphicsQueue, VkDeviceSize stagingSize)
+{
+	_device = device;
+	_allocator = &allocator;
+	_transferFamily = transferFamily;
+	_graphicsFamily = graphicsFamily;
+	_transferQueue = transferQueue;
+	_graphicsQueue = graphicsQueue;
+
+	// 暂存环在分配器中持久映射
+	_stagingSize = (stagingSize + kStagingAlignment - 1) & ~(kStagingAlignment - 1);
+	_allocator->CreateBuffer(_stagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, _stagingBuffer, _stagingAlloc);
+
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = _transferFamily;
+
+	if (vkCreateCommandPool(_device, &poolInfo, nullptr, &_transferPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create upload command pool!");
+	}
+
+	// 专用传输队列时，获取所有权的命令在图形队列族的命令池中分配
+	if (IsDedicated()) {
+		poolInfo.queueFamilyIndex = _graphicsFamily;
+		if (vkCreateCommandPool(_device, &poolInfo, nullptr, &_graphicsPool) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create upload acquire command pool!");
+		}
+	}
+
+	VkCommandBufferAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandBufferCount = 1;
+
+	VkFenceCreateInfo fenceInfo{};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+	for (Batch& batch : _batches) {
+		allocInfo.commandPool = _transferPool;
+		if (vkAllocateCommandBuffers(_device, &allocInfo, &batch.transferCommands) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate upload command buffer!");
+		}
+		if (vkCreateFence(_device, &fenceInfo, nullptr, &batch.fence) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create upload fence!");
+		}
+
+		if (IsDedicated()) {
+			allocInfo.commandPool = _graphicsPool;
+			if (vkAllocateCommandBuffers(_device, &allocInfo, &batch.acquireCommands) != VK_SUCCESS) {
+				throw std::runtime_error("failed to allocate upload acquire command buffer!");
+			}
+			if (vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &batch.transferDone) != VK_SUCCESS) {
+				throw std::runtime_error("failed to create upload semaphore!");
+			}
+		}
+	}
+
+	_head = 0;
+	_tail = 0;
+	_recording = 1;
+	_recordingOpen = false;
+	_submitted = 0;
+	_completed = 0;
+	ResetStats();
+}
+
+void UploadQueue::Destroy()
+{
+	if (!IsValid()) {
+		return;
+	}
+
+	// 已提交的批次必须先完成；正在录制的批次直接丢弃
+	waitSubmitted(_submitted);
+
+	Batch& recording = batchFor(_recording);
+	for (size_t i = 0; i < recording.oversizedBuffers.size(); i++) {
+		_allocator->DestroyBuffer(recording.oversizedBuffers[i], recording.oversizedAllocations[i]);
+	}
+
+	for (Batch& batch : _batches) {
+		vkDestroyFence(_device, batch.fence, nullptr);
+		if (batch.transferDone != VK_NULL_HANDLE) {
+			vkDestroySemaphore(_device, batch.transferDone, nullptr);
+		}
+		batch = Batch();
+	}
+
+	// 销毁命令池会一并释放其中的命令缓冲
+	vkDestroyCommandPool(_device, _transferPool, nullptr);
+	if (_graphicsPool != VK_NULL_HANDLE) {
+		vkDestroyCommandPool(_device, _graphicsPool, nullptr);
+	}
+	_transferPool = VK_NULL_HANDLE;
+	_graphicsPool = VK_NULL_HANDLE;
+
+	_allocator->DestroyBuffer(_stagingBuffer, _stagingAlloc);
+	_device = VK_NULL_HANDLE;
+}
+
+UploadQueue::Ticket UploadQueue::UploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size)
+{
+	if (size == 0) {
+		return 0;
+	}
+
+	VkBuffer source = _stagingBuffer;
+	VkDeviceSize sourceOffset = 0;
+	if (size > _stagingSize / 4) {
+		// 大块数据单独分配临时暂存缓冲，避免一次上传占满暂存环
+		beginBatch();
+		Batch& batch = batchFor(_recording);
+
+		VkBuffer oversized;
+		GpuAllocation oversizedAlloc;
+		_allocator->CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, oversized, oversizedAlloc);
+		memcpy(oversizedAlloc.mapped, data, static_cast<size_t>(size));
+
+		batch.oversizedBuffers.push_back(oversized);
+		batch.oversizedAllocations.push_back(oversizedAlloc);
+		source = oversized;
+		_stats.oversized++;
+	}
+	else {
+		// 分配可能提交当前批次，之后再开始（新的）批次
+		sourceOffset = allocateStaging(size);
+		beginBatch();
+		memcpy(static_cast<char*>(_stagingAlloc.mapped) + sourceOffset, data, static_cast<size_t>(size));
+	}
+
+	Batch& batch = batchFor(_recording);
+
+	VkBufferCopy region{};
+	region.srcOffset = sourceOffset;
+	region.dstOffset = offset;
+	region.size = size;
+	vkCmdCopyBuffer(batch.transferCommands, source, buffer, 1, &region);
+
+	// 同一缓冲的连续上传只转移一次所有权
+	if (IsDedicated() && (batch.buffers.empty() || batch.buffers.back() != buffer)) {
+		batch.buffers.push_back(buffer);
+	}
+
+	_stats.uploads++;
+	_stats.bytes += size;
+	return _recording;
+}
+
+UploadQueue::Ticket UploadQueue::Flush()
+{
+	if (!_recordingOpen) {
+		return _submitted;
+	}
+
+	Batch& batch = batchFor(_recording);
+	vkResetFences(_device, 1, &batch.fence);
+
+	if (IsDedicated()) {
+		// 传输端释放所有权：dstStage / dstAccess 在释放端被忽略
+		std::vector<VkBufferMemoryBarrier> barriers(batch.buffers.size());
+		for (size_t i = 0; i < batch.buffers.size(); i++) {
+			barriers[i].sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+			barriers[i].srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			barriers[i].dstAccessMask = 0;
+			barriers[i].srcQueueFamilyIndex = _transferFamily;
+			barriers[i].dstQueueFamilyIndex = _graphicsFamily;
+			barriers[i].buffer = batch.buffers[i];
+			barriers[i].offset = 0;
+			barriers[i].size = VK_WHOLE_SIZE;
+		}
+		vkCmdPipelineBarrier(batch.transferCommands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+			0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data(), 0, nullptr);
+		vkEndCommandBuffer(batch.transferCommands);
+
+		VkSubmitInfo transferSubmit{};
+		transferSubmit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		transferSubmit.commandBufferCount = 1;
+		transferSubmit.pCommandBuffers = &batch.transferCommands;
+		transferSubmit.signalSemaphoreCount = 1;
+		transferSubmit.pSignalSemaphores = &batch.transferDone;
+
+		if (vkQueueSubmit(_transferQueue, 1, &transferSubmit, VK_NULL_HANDLE) != VK_SUCCESS) {
+			throw std::runtime_error("failed to submit upload batch!");
+		}
+
+		// 图形端获取所有权：srcAccess 在获取端被忽略，之后的任何读取都能看到上传的数据
+		for (auto& barrier : barriers) {
+			barrier.srcAccessMask = 0;
+			barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		}
+
+		VkCommandBufferBeginInfo beginInfo{};
+		beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+		vkBeginCommandBuffer(batch.acquireCommands, &beginInfo);
+		vkCmdPipelineBarrier(batch.acquireCommands, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+			0, nullptr, static_cast<uint32_t>(barriers.size()), barriers.data(), 0, nullptr);
+		vkEndCommandBuffer(batch.acquireCommands);
+
+		VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+		VkSubmitInfo acquireSubmit{};
+		acquireSubmit.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		acquireSubmit.waitSemaphoreCount = 1;
+		acquireSubmit.pWaitSemaphores = &batch.transferDone;
+		acquireSubmit.pWaitDstStageMask = &waitStage;
+		acquireSubmit.commandBufferCount = 1;
+		acquireSubmit.pCommandBuffers = &batch.acquireCommands;
+
+		if (vkQueueSubmit(_graphicsQueue, 1, &acquireSubmit, batch.fence) != VK_SUCCESS) {
+			throw std::runtime_error("failed to submit upload acquire!");
+		}
+	}
+	else {
+		// 同一队列：一个内存屏障让本批次的写入对之后提交的任何读取可见
+		VkMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT;
+		vkCmdPipelineBarrier(batch.transferCommands, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT, 0,
+			1, &barrier, 0, nullptr, 0, nullptr);
+		vkEndCommandBuffer(batch.transferCommands);
+
+		VkSubmitInfo submitInfo{};
+		submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		submitInfo.commandBufferCount = 1;
+		submitInfo.pCommandBuffers = &batch.transferCommands;
+
+		if (vkQueueSubmit(_graphicsQueue, 1, &submitInfo, batch.fence) != VK_SUCCESS) {
+			throw std::runtime_error("failed to submit upload batch!");
+		}
+	}
+
+	batch.stagingEnd = _head;
+	_submitted = _recording;
+	_recording++;
+	_recordingOpen = false;
+	_stats.submits++;
+	return _submitted;
+}
+
+bool UploadQueue::IsComplete(Ticket ticket)
+{
+	if (ticket <= _completed) {
+		return true;
+	}
+	collect();
+	return ticket <= _completed;
+}
+
+void UploadQueue::Wait(Ticket ticket)
+{
+	if (ticket <= _completed) {
+		return;
+	}
+	if (ticket > _submitted) {
+		Flush();
+	}
+	waitSubmitted(ticket);
+}
+
+void UploadQueue::WaitIdle()
+{
+	Flush();
+	waitSubmitted(_submitted);
+}
+
+void UploadQueue::beginBatch()
+{
+	if (_recordingOpen) {
+		return;
+	}
+
+	// 槽位上一次使用的批次必须已完成
+	if (_recording > kMaxBatches && _completed < _recording - kMaxBatches) {
+		_stats.stalls++;
+		waitSubmitted(_recording - kMaxBatches);
+	}
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+
+	if (vkBeginCommandBuffer(batchFor(_recording).transferCommands, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("failed to begin upload command buffer!");
+	}
+	_recordingOpen = true;
+}
+
+VkDeviceSize UploadQueue::allocateStaging(VkDeviceSize size)
+{
+	VkDeviceSize aligned = (size + kStagingAlignment - 1) & ~(kStagingAlignment - 1);
+	for (;;) {
+		// 不跨越环的末尾：放不下时跳到环的开头，跳过的部分随本批次一起回收
+		VkDeviceSize start = _head;
+		VkDeviceSize offset = start % _stagingSize;
+		if (offset + aligned > _stagingSize) {
+			start += _stagingSize - offset;
+		}
+		if (start + aligned - _tail <= _stagingSize) {
+			_head = start + aligned;
+			return start % _stagingSize;
+		}
+
+		collect();
+		if (start + aligned - _tail <= _stagingSize) {
+			continue;
+		}
+
+		// 仍然不足：没有在途批次时空间都被当前批次占用，先提交它，再等待最早的批次完成
+		if (_completed == _submitted) {
+			Flush();
+		}
+		_stats.stalls++;
+		waitSubmitted(_completed + 1);
+	}
+}
+
+void UploadQueue::collect()
+{
+	while (_completed < _submitted) {
+		Batch& batch = batchFor(_completed + 1);
+		if (vkGetFenceStatus(_device, batch.fence) != VK_SUCCESS) {
+			break;
+		}
+		retire(batch);
+	}
+}
+
+void UploadQueue::retire(Batch& batch)
+{
+	_tail = batch.stagingEnd;
+	for (size_t i = 0; i < batch.oversizedBuffers.size(); i++) {
+		_allocator->DestroyBuffer(batch.oversizedBuffers[i], batch.oversizedAllocations[i]);
+	}
+	batch.oversizedBuffers.clear();
+	batch.oversizedAllocations.clear();
+	batch.buffers.clear();
+	_completed++;
+}
+
+void UploadQueue::waitSubmitted(Ticket ticket)
+{
+	if (ticket > _submitted) {
+		ticket = _submitted;
+	}
+	while (_completed < ticket) {
+		Batch& batch = batchFor(_completed + 1);
+		if (vkWaitForFences(_device, 1, &batch.fence, VK_TRUE, UINT64_MAX) != VK_SUCCESS) {
+			throw std::runtime_error("failed to wait for upload batch!");
+		}
+		retire(batch);
+	}
+}
@@ -0,0 +1,236 @@
+﻿#ifndef UPLOADQUEUE_H_
+#define UPLOADQUEUE_H_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "GpuAllocator.h"
+
+/**
+ * @brief 批量异步上传队列：暂存环 + 按批提交的复制命令，取代“每次上传提交一次并 vkQueueWaitIdle”。
+ *
+ * UploadBuffer() 把数据拷贝进持久映射的暂存环，并把 vkCmdCopyBuffer 录制到当前批次的命令缓冲中；
+ * Flush() 才提交整批，CPU 不等待。每个批次有一个栅栏，返回的票据（Ticket）可用 IsComplete() 查询、
+ * Wait() 等待。批次按提交顺序完成后回收其占用的暂存环空间；暂存环写满时先提交当前批次，
+ * 再等待最早的批次完成（计入 stalls）。超过暂存环四分之一的上传使用单独的临时暂存缓冲，随批次完成销毁。
+ *
+ * 设备有专用传输队列族（只支持传输的 DMA 引擎）时，复制在传输队列上执行，与图形工作并行：
+ * 传输端释放目标缓冲的所有权并触发信号量，图形队列上紧接着提交一个只含获取屏障的命令缓冲，
+ * 栅栏挂在这次图形提交上。之后提交到图形队列的帧在顺序上位于获取屏障之后，无需额外同步即可读取上传的数据。
+ * 没有专用传输队列族时直接在图形队列上复制，批次末尾用一个内存屏障让写入对后续读取可见。
+ *
+ * 只能在渲染线程使用。
+ */
+class UploadQueue
+{
+public:
+	/**
+	 * @brief 上传票据：批次序号，从 1 开始递增；0 表示没有需要等待的上传。
+	 */
+	using Ticket = uint64_t;
+
+	/**
+	 * @brief 同时在途的最大批次数，超出时等待最早的批次完成。
+	 */
+	static constexpr uint32_t kMaxBatches = 8;
+
+	/**
+	 * @brief 累计统计。
+	 */
+	struct Stats {
+		// 上传次数与字节数
+		uint64_t uploads = 0;
+		uint64_t bytes = 0;
+
+		// 提交的批次数
+		uint64_t submits = 0;
+
+		// 因暂存环或批次用尽而阻塞等待的次数
+		uint64_t stalls = 0;
+
+		// 使用临时暂存缓冲的大块上传次数
+		uint64_t oversized = 0;
+	};
+
+public:
+	UploadQueue();
+
+	~UploadQueue();
+
+public:
+	/**
+	 * @brief 创建暂存环、命令池、每个批次的命令缓冲与同步对象。
+	 *
+	 * @param device         逻辑设备。
+	 * @param allocator      显存分配器，暂存环与临时暂存缓冲从中分配。
+	 * @param transferFamily 传输队列族索引；与 graphicsFamily 相同表示没有专用传输队列。
+	 * @param transferQueue  传输队列。
+	 * @param graphicsFamily 图形队列族索引。
+	 * @param graphicsQueue  图形队列。
+	 * @param stagingSize    暂存环大小（字节）。
+	 *
+	 * @throws std::runtime_error 创建失败时抛出。
+	 */
+	void Init(VkDevice device, GpuAllocator& allocator, uint32_t transferFamily, VkQueue transferQueue,
+		uint32_t graphicsFamily, VkQueue graphicsQueue, VkDeviceSize stagingSize);
+
+	/**
+	 * @brief 等待所有已提交的批次完成并销毁所有资源。未提交的复制被丢弃。
+	 */
+	void Destroy();
+
+	/**
+	 * @brief 是否已创建。
+	 */
+	bool IsValid() const { return _device != VK_NULL_HANDLE; }
+
+	/**
+	 * @brief 是否在专用传输队列上复制。
+	 */
+	bool IsDedicated() const { return _transferFamily != _graphicsFamily; }
+
+	/**
+	 * @brief 把 data 复制到 buffer 的 [offset, offset + size)，录制到当前批次。
+	 *
+	 * buffer 必须带 TRANSFER_DST 用途、以 EXCLUSIVE 共享模式创建，并且在返回的票据完成前不能销毁。
+	 * data 在函数返回后即可释放。
+	 *
+	 * @return 当前批次的票据，Flush() 之前不会完成。
+	 *
+	 * @throws std::runtime_error 录制或提交失败时抛出。
+	 */
+	Ticket UploadBuffer(VkBuffer buffer, VkDeviceSize offset, const void* data, VkDeviceSize size);
+
+	/**
+	 * @brief 提交当前批次。没有待提交的复制时什么也不做。
+	 *
+	 * @return 刚提交的批次的票据；没有待提交的复制时为最近一次提交的票据。
+	 *
+	 * @throws std::runtime_error 提交失败时抛出。
+	 */
+	Ticket Flush();
+
+	/**
+	 * @brief 票据对应的批次是否已完成。会回收所有已完成的批次。
+	 */
+	bool IsComplete(Ticket ticket);
+
+	/**
+	 * @brief 阻塞等待票据对应的批次完成；该批次尚未提交时先提交。
+	 *
+	 * @throws std::runtime_error 等待失败（如设备丢失）时抛出。
+	 */
+	void Wait(Ticket ticket);
+
+	/**
+	 * @brief 提交当前批次并等待所有批次完成。
+	 */
+	void WaitIdle();
+
+	/**
+	 * @brief 暂存环大小与当前占用（已写入但所在批次未完成）的字节数。
+	 */
+	VkDeviceSize StagingSize() const { return _stagingSize; }
+	VkDeviceSize StagingUsed() const { return _head - _tail; }
+
+	/**
+	 * @brief 累计统计。
+	 */
+	const Stats& GetStats() const { return _stats; }
+
+	/**
+	 * @brief 清空累计统计。
+	 */
+	void ResetStats() { _stats = Stats(); }
+
+private:
+	/**
+	 * @brief 一个批次：传输队列上的复制命令，专用传输队列时另有图形队列上的获取命令。
+	 */
+	struct Batch {
+		VkCommandBuffer transferCommands = VK_NULL_HANDLE;
+		VkCommandBuffer acquireCommands = VK_NULL_HANDLE;
+
+		// 传输提交触发、获取提交等待（仅专用传输队列）
+		VkSemaphore transferDone = VK_NULL_HANDLE;
+
+		// 批次最后一次提交触发
+		VkFence fence = VK_NULL_HANDLE;
+
+		// 提交时暂存环的写入位置，批次完成后回收到这里
+		VkDeviceSize stagingEnd = 0;
+
+		// 需要转移所有权的目标缓冲（仅专用传输队列）
+		std::vector<VkBuffer> buffers;
+
+		// 大块上传使用的临时暂存缓冲
+		std::vector<VkBuffer> oversizedBuffers;
+		std::vector<GpuAllocation> oversizedAllocations;
+	};
+
+	/**
+	 * @brief 票据对应的批次槽位。
+	 */
+	Batch& batchFor(Ticket ticket) { return _batches[ticket % kMaxBatches]; }
+
+	/**
+	 * @brief 确保当前批次处于录制状态：必要时等待槽位上一个批次完成，并开始录制。
+	 */
+	void beginBatch();
+
+	/**
+	 * @brief 在暂存环中分配 size 字节，空间不足时提交当前批次并等待较早的批次完成。
+	 *
+	 * @return 暂存环内的偏移。
+	 */
+	VkDeviceSize allocateStaging(VkDeviceSize size);
+
+	/**
+	 * @brief 按提交顺序回收所有已完成的批次。
+	 */
+	void collect();
+
+	/**
+	 * @brief 回收最早的未完成批次（其栅栏已触发）：推进 _completed 与暂存环尾部，销毁临时暂存缓冲。
+	 */
+	void retire(Batch& batch);
+
+	/**
+	 * @brief 阻塞等待票据对应的（已提交的）批次完成并回收。
+	 */
+	void waitSubmitted(Ticket ticket);
+
+private:
+	VkDevice _device = VK_NULL_HANDLE;
+	GpuAllocator* _allocator = nullptr;
+
+	uint32_t _transferFamily = 0;
+	uint32_t _graphicsFamily = 0;
+	VkQueue _transferQueue = VK_NULL_HANDLE;
+	VkQueue _graphicsQueue = VK_NULL_HANDLE;
+
+	VkCommandPool _transferPool = VK_NULL_HANDLE;
+	VkCommandPool _graphicsPool = VK_NULL_HANDLE;
+
+	std::array<Batch, kMaxBatches> _batches;
+
+	// 暂存环：持久映射的 HOST_VISIBLE 缓冲，_head / _tail 为单调递增的逻辑位置，对 _stagingSize 取模得到偏移
+	VkBuffer _stagingBuffer = VK_NULL_HANDLE;
+	GpuAllocation _stagingAlloc;
+	VkDeviceSize _stagingSize = 0;
+	VkDeviceSize _head = 0;
+	VkDeviceSize _tail = 0;
+
+	// 正在录制的批次票据（= 已提交的票据 + 1），以及其中是否已有复制
+	Ticket _recording = 1;
+	bool _recordingOpen = false;
+
+	// 已提交与已完成的最大票据
+	Ticket _submitted = 0;
+	Ticket _completed = 0;
+
+	Stats _stats;
+};
+
+#endif    // !UPLOADQUEUE_H_
@@ -1,21 +1,147 @@
 ﻿#include "TriangleFunc.h"
 #include "Helper/Print.h"
 
-TriangleFunc::TriangleFunc()
-	: _width(800)
-	, _height(600)
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <filesystem>
+#include <random>
+#include <thread>
+
+namespace {
+	// 每帧数据环形缓冲中每个帧槽位的容量
+	constexpr VkDeviceSize kFrameRingSize = 256 * 1024;
+
+	// 上传队列暂存环的容量，超过其四分之一的上传单独分配临时暂存缓冲
+	constexpr VkDeviceSize kUploadStagingSize = 16 * 1024 * 1024;
+
+	// 按需渲染空闲时等待事件的超时：超时后检查后台重新编译的着色器等不产生窗口事件的变化
+	constexpr double kIdleWakeSeconds = 0.25;
+
+	// 每次输入事件后按需渲染至少绘制的帧数，覆盖 ImGui 悬停、布局滞后一帧的情况
+	constexpr uint32_t kInputRedrawFrames = 3;
+
+	// 纹理目录中登记的图像扩展名（stb_image 支持的常见格式，小写比较）
+	const char* const kTextureExtensions[] = { ".png", ".jpg", ".jpeg", ".tga", ".bmp", ".ktx2", ".dds" };
+
+	// 纹理浏览器每页的缩略图数、每行列数与缩略图边长（像素）
+	constexpr uint32_t kTexturePageSize = 16;
+	constexpr uint32_t kTextureBrowserColumns = 4;
+	constexpr float kThumbnailSize = 96.0f;
+
+	// GLSL 源文件与 SPIR-V 文件名的对应关系，与 Res/shader.bat 一致
+	struct ShaderSource {
+		const char* source;
+		const char* spirv;
+	};
+
+	constexpr ShaderSource kShaderSources[] = {
+		{ "shader.vert", "vert.spv" },
+		{ "shader.frag", "frag.spv" },
+		{ "instanced.vert", "vert_instanced.spv" },
+		{ "cull.comp", "comp_cull.spv" },
+		{ "simulate.comp", "comp_simulate.spv" },
+	};
+
+	// 源文件对应的 SPIR-V 文件名，未知时为空
+	const char* spirvNameFor(const std::string& source)
+	{
+		for (const auto& shader : kShaderSources) {
+			if (source == shader.source) {
+				return shader.spirv;
+			}
+		}
+		return nullptr;
+	}
+}
+
+TriangleFunc::TriangleFunc(const AppConfig& config)
+	: _config(config)
+	, _width(static_cast<int>(config.width))
+	, _height(static_cast<int>(config.height))
 	, _window(nullptr)
+	, _recordThreads(config.recordThreads)
+	, _framesInFlight(std::clamp(config.framesInFlight, 1, AppConfig::kMaxFramesInFlight))
 {
+	// 无头模式不呈现图像，不需要交换链扩展
+	if (!_config.headless) {
+		_deviceExtensions.push_back(VK_KHR_SWAPCHAIN_EXTENSION_NAME);
+	}
+
+	// 实例化基准测试默认绘制 20 万份
+	_instanceCount = _config.instances;
+	if (_instanceCount == 0 && _config.bench == "instancing") {
+		_instanceCount = 200000;
+	}
+	_instanceUpdatesPerFrame = _config.instanceUpdates;
+
+	// GPU 驱动基准测试默认 100 万个对象，铺在 4 倍视口面积上，剔除后约四分之一可见
+	if (_config.bench == "gpu-driven") {
+		if (_instanceCount == 0) {
+			_instanceCount = 1000000;
+		}
+		_instanceExtent = 2.0f;
+	}
+	_gpuDriven = _config.gpuDriven;
+	_cacheCommands = _config.cacheCommands;
+	_onDemand = _config.onDemand;
+	_frameLimiter.SetTargetFps(_config.maxFps);
+
+	// 异步计算基准测试默认模拟 20 万个实例
+	_simulate = _config.asyncCompute || _config.bench == "async-compute";
+	if (_config.bench == "async-compute" && _instanceCount == 0) {
+		_instanceCount = 200000;
+	}
+	_simSubsteps = _config.simSubsteps;
+	if (_simulate && _gpuDriven) {
+		throw std::runtime_error("GPU 剔除读取的是实例缓冲，不能与实例模拟同时使用!");
+	}
 }
 
 TriangleFunc::~TriangleFunc() {}
 
 void TriangleFunc::Run()
 {
-	initWindow();
+	_startTime = std::chrono::steady_clock::now();
+
+	// 只编译着色器，不需要窗口与设备
+	if (_config.compileShaders) {
+		compileShaders();
+		return;
+	}
+
+	// 无头模式不创建窗口，也不初始化 ImGui
+	if (!_config.headless) {
+		initWindow();
+	}
 	initVulkan();
-	initImgui();
-	mainLoop();
+	if (!_config.headless) {
+		initImgui();
+	}
+
+	// 输出启动耗时，对比冷/热管线缓存的效果
+	double startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - _startTime).count();
+	std::cout << "管线缓存: " << (_pipelineCache.IsWarm() ? "warm" : "cold")
+		<< ", 管线创建耗时: " << _pipelineBuildMs << " ms"
+		<< ", 启动耗时: " << startupMs << " ms" << std::endl;
+
+	const ShaderLibrary::Stats& shaderStats = _shaderLibrary.GetStats();
+	std::cout << "着色器: 映射 " << shaderStats.filesMapped << " 个文件, 创建 " << shaderStats.modulesCreated << " 个模块"
+		<< ", 路径命中 " << shaderStats.pathHits << ", 内容命中 " << shaderStats.contentHits
+		<< ", 加载耗时: " << shaderStats.loadMs << " ms" << std::endl;
+
+	if (_config.headless) {
+		headlessLoop();
+	}
+	else if (_config.bench == "resize-storm") {
+		writeReports({ benchResizeStorm() });
+	}
+	else if (_config.bench == "idle") {
+		writeReports(benchIdle());
+	}
+	else {
+		mainLoop();
+	}
 	cleanup();
 }
 
@@ -38,6 +164,16 @@ void TriangleFunc::initWindow()
 
 	// 设置窗口大小改变时的回调函数，负责标记交换链需要重新创建
 	glfwSetFramebufferSizeCallback(_window, framebufferResizeCallback);
+
+	// 按需渲染由输入与窗口事件唤醒；ImGui 初始化时会保存并链式调用这些回调
+	glfwSetCursorPosCallback(_window, [](GLFWwindow* window, double, double) { inputEventCallback(window); });
+	glfwSetMouseButtonCallback(_window, [](GLFWwindow* window, int, int, int) { inputEventCallback(window); });
+	glfwSetScrollCallback(_window, [](GLFWwindow* window, double, double) { inputEventCallback(window); });
+	glfwSetKeyCallback(_window, [](GLFWwindow* window, int, int, int, int) { inputEventCallback(window); });
+	glfwSetCharCallback(_window, [](GLFWwindow* window, unsigned int) { inputEventCallback(window); });
+	glfwSetCursorEnterCallback(_window, [](GLFWwindow* window, int) { inputEventCallback(window); });
+	glfwSetWindowFocusCallback(_window, [](GLFWwindow* window, int) { inputEventCallback(window); });
+	glfwSetWindowRefreshCallback(_window, [](GLFWwindow* window) { inputEventCallback(window); });
 }
 
 void TriangleFunc::initImgui()
@@ -65,8 +201,11 @@ void TriangleFunc::initImgui()
 	ImGui_ImplGlfw_InitForVulkan(_window, true);
 
 	// 加载中文字体，设置字号18，支持完整的中文字符范围（GlyphRangesChineseFull）
-	io.Fonts->AddFontFromFileTTF("C:\\Windows\\Fonts\\STXINWEI.TTF", 18.0f, nullptr,
-		io.Fonts->GetGlyphRangesChineseFull());
+	// 非 Windows 平台没有该字体时使用 ImGui 默认字体
+	const char* fontPath = "C:\\Windows\\Fonts\\STXINWEI.TTF";
+	if (std::filesystem::exists(fontPath)) {
+		io.Fonts->AddFontFromFileTTF(fontPath, 18.0f, nullptr, io.Fonts->GetGlyphRangesChineseFull());
+	}
 	IM_ASSERT(io.Fonts != nullptr);
 
 	// 创建 ImGui 需要的 Vulkan 描述符池（Descriptor Pool），用于分配资源
@@ -79,18 +218,28 @@ void TriangleFunc::initImgui()
 	init_info.Device = _device;                                               // 逻辑设备句柄
 	init_info.QueueFamily = _graphicsQueueFamily;                             // 图形队列族索引
 	init_info.Queue = _graphicsQueue;                                         // 图形队列句柄
-	init_info.PipelineCache = VK_NULL_HANDLE;                                 // Pipeline 缓存，一般为 null
+	init_info.PipelineCache = _pipelineCache.Get();                           // 共享的持久化 Pipeline 缓存
 	init_info.DescriptorPool = _imguiDescriptorPool;                          // ImGui 使用的描述符池
-	init_info.RenderPass = _renderPass;                                       // 渲染通道句柄
+	init_info.RenderPass = _renderPass;                                       // 渲染通道句柄（动态渲染模式下为空）
 	init_info.Subpass = 0;                                                    // 渲染通道子通道索引
 	init_info.Allocator = nullptr;                                            // 分配器，默认空
-	init_info.MinImageCount = _MAX_FRAMES_IN_FLIGHT;                          // 最小图像数量（用于多帧同时绘制）
+	init_info.MinImageCount = std::max(2u, _swapChainMinImageCount);          // Surface 要求的最小图像数量（ImGui 要求至少为 2）
 	init_info.ImageCount = static_cast<uint32_t>(_swapChainImages.size());    // 交换链图像数量
 	init_info.MSAASamples = VK_SAMPLE_COUNT_1_BIT;                            // 多重采样数量，当前设置为1（无多重采样）
 	init_info.CheckVkResultFn = check_vk_result;                              // 错误检查回调函数（自定义）
 
-	// 初始化 ImGui Vulkan 后端，完成 Vulkan 相关的绑定设置
+	// 动态渲染模式：ImGui 管线按颜色附件格式创建，不引用渲染通道
+	if (_dynamicRendering) {
+		init_info.UseDynamicRendering = true;
+		init_info.PipelineRenderingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+		init_info.PipelineRenderingCreateInfo.colorAttachmentCount = 1;
+		init_info.PipelineRenderingCreateInfo.pColorAttachmentFormats = &_swapChainImageFormat;
+	}
+
+	// 初始化 ImGui Vulkan 后端，完成 Vulkan 相关的绑定设置（内部会创建 ImGui 管线）
+	auto pipelineStart = std::chrono::steady_clock::now();
 	ImGui_ImplVulkan_Init(&init_info);
+	_pipelineBuildMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pipelineStart).count();
 
 	// 上传字体纹理到GPU（可选步骤，注释了，需要时取消注释）
 	// VkCommandBuffer commandBuffer = beginSingleTimeCommands();
@@ -107,8 +256,10 @@ void TriangleFunc::initVulkan()
 	// 设置调试信息回调
 	setupDebugMessenger();
 
-	// 创建窗口表面
-	createSurface();
+	// 创建窗口表面（无头模式不需要）
+	if (!_config.headless) {
+		createSurface();
+	}
 
 	// 选择合适的物理设备
 	pickPhysicalDevice();
@@ -116,71 +267,466 @@ void TriangleFunc::initVulkan()
 	// 创建逻辑设备及队列
 	createLogicalDevice();
 
-	// 创建交换链
-	createSwapChain();
+	// 呈现策略与帧节奏（无头模式不呈现）
+	if (!_config.headless) {
+		_presentPacer.Init(_device, _presentWaitEnabled, PresentPacer::ParsePolicy(_config.presentPolicy), _config.presentLatencyFrames);
+	}
+
+	// 创建（加载）管线缓存
+	createPipelineCache();
+
+	// 着色器模块库，模块在所有管线构建之间复用
+	_shaderLibrary.Init(_device, _config.shaderDir);
+
+	// 着色器热重载：后台监视顶点 / 片段着色器源文件（无头模式不需要）
+	if (_config.hotReload && !_config.headless) {
+		if (!ShaderCompiler::IsAvailable()) {
+			std::cerr << "构建时未包含 glslang，着色器热重载不可用" << std::endl;
+		}
+		else {
+			_shaderCompiler.Init(_config.shaderCacheDir);
+			_shaderWatcher.Start(_config.shaderSourceDir, { ".vert", ".frag" }, &_shaderCompiler, _config.shaderDefines);
+		}
+	}
+
+	// 创建显存分配器
+	createAllocator();
+
+	// 批量异步上传队列
+	createUploadQueue();
+
+	// 纹理流送（指定了 --texture-dir 时）
+	createTextureStreamer();
 
-	// 创建交换链图像视图
+	// 每帧数据的环形缓冲与场景 uniform 描述符（管线布局依赖其描述符集布局）
+	createFrameRing();
+
+	// 创建交换链（无头模式下改为创建离屏渲染目标）
+	if (_config.headless) {
+		createOffscreenTargets();
+	}
+	else {
+		createSwapChain();
+	}
+
+	// 创建交换链（或离屏）图像视图
 	createImageViews();
 
+	// 渲染图（--render-graph 且设备支持动态渲染时）
+	createRenderGraph();
+
 	// 创建渲染通道
 	createRenderPass();
 
 	// 创建图形管线
 	createGraphicsPipeline();
 
+	// 启动管线变体的后台编译线程，0 表示保留一个核心给渲染线程
+	uint32_t pipelineThreads = _config.pipelineThreads;
+	if (pipelineThreads == 0) {
+		uint32_t hardwareThreads = std::thread::hardware_concurrency();
+		pipelineThreads = hardwareThreads > 1 ? hardwareThreads - 1 : 1;
+	}
+	createPipelineManager(_pipelineCache.Get(), pipelineThreads);
+
 	// 创建帧缓冲
 	createFramebuffers();
 
 	// 创建命令池
 	createCommandPool();
 
+	// 生成场景网格并上传到设备本地内存
+	buildSceneMesh();
 	createVertexBuffer();
 
+	// 实例化场景的实例数据
+	buildInstances();
+	createInstanceBuffer();
+
+	// GPU 剔除与间接绘制
+	createGpuCuller();
+
+	// 异步计算队列上的实例模拟
+	createAsyncCompute();
+	createInstanceSimulation();
+
 	// 分配命令缓冲区
 	createCommandBuffers();
 
+	// 并行录制的工作线程与各自的命令池
+	createParallelRecorder();
+
 	// 创建用于帧同步的信号量和栅栏
 	createSyncObjects();
+
+	// 渲染完成信号量按交换链图像创建
+	if (!_config.headless) {
+		createPresentSemaphores();
+	}
+
+	// 测量每帧各阶段的 GPU 耗时
+	createGpuProfiler();
 }
 
 void TriangleFunc::mainLoop()
 {
+	// 指定了报告文件时记录帧耗时与阻塞时间，退出时写入报告
+	bool recordStats = !_config.reportPath.empty();
+	if (recordStats) {
+		_frameStats.Clear();
+		_frameStats.AddField("frames_in_flight", _framesInFlight);
+		_frameStats.AddField("swapchain_images", static_cast<int64_t>(_swapChainImages.size()));
+		_frameStats.AddField("timeline_sync", _timelineSync ? 1 : 0);
+	}
+
+	auto begin = std::chrono::steady_clock::now();
+	auto frameStart = begin;
 	while (!glfwWindowShouldClose(_window)) {
-		glfwPollEvents();
-		drawFrame();
+		if (!pumpFrame()) {
+			// 空闲与最小化等待不计入帧耗时
+			frameStart = std::chrono::steady_clock::now();
+			continue;
+		}
+
+		if (recordStats) {
+			auto now = std::chrono::steady_clock::now();
+			_frameStats.AddCpuTime(std::chrono::duration<double, std::milli>(now - frameStart).count());
+			frameStart = now;
+		}
 	}
 
 	// 等待 GPU 完成所有操作
 	vkDeviceWaitIdle(_device);
+
+	if (recordStats) {
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+		_frameStats.AddField("on_demand", _onDemand ? 1 : 0);
+		_frameStats.AddField("max_fps", std::llround(_frameLimiter.TargetFps()));
+		_frameStats.AddField("idle_wakeups", static_cast<int64_t>(_idleWakeups));
+		_frameStats.AddField("idle_ms", std::llround(std::chrono::duration<double, std::milli>(_idleTime).count()));
+		std::vector<std::string> reports = { _frameStats.ToJson("windowed", elapsed) };
+
+		// 每种用过的呈现策略一行统计，便于按显示器选择策略
+		std::vector<std::string> presentReports = _presentPacer.ReportJson(_policyPresentModes);
+		reports.insert(reports.end(), presentReports.begin(), presentReports.end());
+		writeReports(reports);
+	}
+}
+
+bool TriangleFunc::pumpFrame()
+{
+	if (waitWhileMinimized()) {
+		return false;
+	}
+
+	// 没有待绘制内容时阻塞到有事件或超时，否则只轮询
+	auto pollStart = std::chrono::steady_clock::now();
+	if (_onDemand && !redrawRequired()) {
+		glfwWaitEventsTimeout(kIdleWakeSeconds);
+		_idleTime += std::chrono::steady_clock::now() - pollStart;
+	}
+	else {
+		glfwPollEvents();
+		_phaseProfiler.Add(FramePhaseProfiler::PollEvents, std::chrono::steady_clock::now() - pollStart);
+	}
+
+	// 帧边界：换入后台重新编译的着色器
+	if (_shaderWatcher.IsRunning()) {
+		applyShaderReloads();
+	}
+
+	// 超时唤醒或事件没有带来新内容
+	if (_onDemand && !redrawRequired()) {
+		_idleWakeups++;
+		_idle = true;
+		return false;
+	}
+	if (_redrawFrames > 0) {
+		_redrawFrames--;
+	}
+
+	// 从空闲恢复：空闲时长不计入帧间隔统计，帧率上限从现在重新计时
+	if (_idle) {
+		_idle = false;
+		_presentPacer.Resume();
+		_frameLimiter.Reset();
+	}
+
+	auto limitStart = std::chrono::steady_clock::now();
+	_frameLimiter.Wait();
+	_phaseProfiler.Add(FramePhaseProfiler::Limit, std::chrono::steady_clock::now() - limitStart);
+
+	drawFrame();
+	_phaseProfiler.EndFrame();
+	_framesDrawn++;
+	return true;
+}
+
+bool TriangleFunc::windowMinimized() const
+{
+	int width = 0, height = 0;
+	glfwGetFramebufferSize(_window, &width, &height);
+	return width == 0 || height == 0 || glfwGetWindowAttrib(_window, GLFW_ICONIFIED) != 0;
+}
+
+bool TriangleFunc::waitWhileMinimized()
+{
+	if (!windowMinimized()) {
+		return false;
+	}
+
+	// glfwWaitEvents 阻塞到有事件，最小化期间不占用 CPU 与 GPU
+	auto parkStart = std::chrono::steady_clock::now();
+	while (windowMinimized() && !glfwWindowShouldClose(_window)) {
+		glfwWaitEvents();
+	}
+	_idleTime += std::chrono::steady_clock::now() - parkStart;
+
+	_idle = true;
+	requestRedraw(kInputRedrawFrames);
+	return true;
+}
+
+bool TriangleFunc::redrawRequired() const
+{
+	return _redrawFrames > 0 || _imguiActive || _simulation.IsValid() || _instanceUpdatesPerFrame > 0 || pipelineVariantPending()
+		|| (_textureStreamer.IsValid() && _textureStreamer.IsBusy());
+}
+
+void TriangleFunc::requestRedraw(uint32_t frames)
+{
+	_redrawFrames = std::max(_redrawFrames, frames);
+}
+
+bool TriangleFunc::pipelineVariantPending() const
+{
+	PipelineVariant defaultVariant;
+	defaultVariant.instanced = _pipelineVariant.instanced;
+	bool generic = _scenePipeline == _graphicsPipeline || _scenePipeline == _instancedPipeline;
+	return generic && _pipelineVariant.Key() != defaultVariant.Key();
+}
+
+void TriangleFunc::headlessLoop()
+{
+	std::vector<std::string> reports;
+	if (_config.bench.empty()) {
+		reports.push_back(runHeadlessPass("headless"));
+	}
+	else if (_config.bench == "vertex-memory") {
+		reports = benchVertexMemory();
+	}
+	else if (_config.bench == "allocator-stress") {
+		reports = benchAllocatorStress();
+	}
+	else if (_config.bench == "frames-in-flight") {
+		reports = benchFramesInFlight();
+	}
+	else if (_config.bench == "parallel-record") {
+		reports = benchParallelRecord();
+	}
+	else if (_config.bench == "instancing") {
+		reports = benchInstancing();
+	}
+	else if (_config.bench == "gpu-driven") {
+		reports = benchGpuDriven();
+	}
+	else if (_config.bench == "async-compute") {
+		reports = benchAsyncCompute();
+	}
+	else if (_config.bench == "pipeline-variants") {
+		reports = benchPipelineVariants();
+	}
+	else if (_config.bench == "command-cache") {
+		reports = benchCommandCache();
+	}
+	else if (_config.bench == "upload-batch") {
+		reports = benchUploadBatch();
+	}
+	else if (_config.bench == "render-graph") {
+		reports = benchRenderGraph();
+	}
+	else if (_config.bench == "texture-streaming") {
+		reports.push_back(benchTextureStreaming());
+	}
+	else if (_config.bench == "resize-storm" || _config.bench == "idle") {
+		throw std::runtime_error(_config.bench + " 需要窗口模式，不能与 --headless 同时使用!");
+	}
+	else {
+		throw std::runtime_error("未知的基准测试: " + _config.bench);
+	}
+
+	writeReports(reports);
+}
+
+void TriangleFunc::writeReports(const std::vector<std::string>& reports)
+{
+	// 每轮测量输出单行 JSON 报告，便于脚本解析
+	for (const auto& report : reports) {
+		std::cout << report << std::endl;
+	}
+
+	if (!_config.reportPath.empty()) {
+		std::ofstream file(_config.reportPath, std::ios::trunc);
+		if (!file.is_open()) {
+			throw std::runtime_error("无法写入基准测试报告: " + _config.reportPath);
+		}
+		for (const auto& report : reports) {
+			file << report << std::endl;
+		}
+	}
+}
+
+std::string TriangleFunc::runHeadlessPass(const std::string& name)
+{
+	// 未指定帧数和时长时默认渲染 1000 帧
+	uint32_t maxFrames = _config.benchFrames;
+	double maxSeconds = _config.benchSeconds;
+	if (maxFrames == 0 && maxSeconds <= 0.0) {
+		maxFrames = 1000;
+	}
+
+	// 预留样本空间，测量期间不做内存分配
+	_frameStats.Clear();
+	_frameStats.Reserve(maxFrames > 0 ? maxFrames : 100000);
+	_frameStats.AddField("frames_in_flight", _framesInFlight);
+	_frameStats.AddField("draws", static_cast<int64_t>(_drawList.size()));
+	_frameStats.AddField("record_threads", _recordThreads);
+	_frameStats.AddField("timeline_sync", _timelineSync ? 1 : 0);
+	_frameStats.AddField("cache_commands", commandCacheUsable() ? 1 : 0);
+	_phaseProfiler.Reset();
+
+	// 基准测试在两轮之间直接修改场景状态，每轮从重新录制开始
+	invalidateCommandCache();
+
+	auto begin = std::chrono::steady_clock::now();
+	auto frameStart = begin;
+	uint32_t frames = 0;
+	while (true) {
+		drawOffscreenFrame();
+		_phaseProfiler.EndFrame();
+
+		auto now = std::chrono::steady_clock::now();
+		_frameStats.AddCpuTime(std::chrono::duration<double, std::milli>(now - frameStart).count());
+		frameStart = now;
+		frames++;
+
+		if (maxFrames > 0 && frames >= maxFrames) {
+			break;
+		}
+		if (maxSeconds > 0.0 && std::chrono::duration<double>(now - begin).count() >= maxSeconds) {
+			break;
+		}
+	}
+
+	// 等待所有帧完成，并回读剩余帧槽位的时间戳
+	vkDeviceWaitIdle(_device);
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+	for (int i = 0; i < _framesInFlight; i++) {
+		collectGpuTime(static_cast<uint32_t>(i));
+	}
+	_lastPassFrameMs = elapsed * 1000.0 / frames;
+
+	// 命令录制耗时单独列出，不受 GPU 是否为瓶颈的影响
+	FramePhaseProfiler::PhaseSummary record = _phaseProfiler.Summary(FramePhaseProfiler::Record);
+	_frameStats.AddField("record_p50_us", std::llround(record.p50 * 1000.0));
+	_frameStats.AddField("record_p99_us", std::llround(record.p99 * 1000.0));
+
+	// 渲染图最后一帧的编译结果
+	if (_renderGraphEnabled) {
+		const RenderGraph::Stats& graph = _renderGraph.GetStats();
+		_frameStats.AddField("blur_levels", _blurLevels);
+		_frameStats.AddField("graph_passes", graph.passes - graph.culledPasses);
+		_frameStats.AddField("graph_culled_passes", graph.culledPasses);
+		_frameStats.AddField("graph_image_barriers", graph.imageBarriers);
+		_frameStats.AddField("graph_memory_barriers", graph.memoryBarriers);
+		_frameStats.AddField("graph_barrier_batches", graph.barrierBatches);
+		_frameStats.AddField("graph_synchronization2", _renderGraph.UsesSynchronization2() ? 1 : 0);
+		_frameStats.AddField("transient_images", graph.transientImages);
+		_frameStats.AddField("transient_slots", graph.memorySlots);
+		_frameStats.AddField("transient_kb", static_cast<int64_t>(graph.transientBytes / 1024));
+		_frameStats.AddField("transient_unaliased_kb", static_cast<int64_t>(graph.unaliasedBytes / 1024));
+	}
+
+	return _frameStats.ToJson(name, elapsed);
 }
 
 void TriangleFunc::cleanup()
 {
-	// 清理交换链相关的资源，包括帧缓冲、图像视图和交换链本身
-	cleanupSwapChain();
+	// 设备已空闲，先销毁重建交换链时退役的对象
+	_deletionQueue.Flush();
+
+	// 清理交换链相关的资源，包括帧缓冲、图像视图和交换链本身（无头模式为离屏渲染目标）
+	if (_config.headless) {
+		cleanupOffscreenTargets();
+	}
+	else {
+		cleanupSwapChain();
+	}
+
+	// 销毁场景网格的顶点/索引缓冲与实例缓冲
+	destroyMeshBuffers(_mesh);
+	_gpuCuller.Destroy();
+	_simulation.Destroy();
+	_instanceBuffer.Destroy();
 
-	vkDestroyBuffer(_device, _vertexBuffer, nullptr);
-	vkFreeMemory(_device, _vertexBufferMemory, nullptr);
+	// 停止变体编译线程，销毁变体管线，并把各线程的管线缓存合并到主缓存
+	_pipelineManager.Destroy();
 
 	// 销毁图形管线对象
 	vkDestroyPipeline(_device, _graphicsPipeline, nullptr);
+	if (_instancedPipeline != VK_NULL_HANDLE) {
+		vkDestroyPipeline(_device, _instancedPipeline, nullptr);
+	}
 	// 销毁管线布局对象
 	vkDestroyPipelineLayout(_device, _pipelineLayout, nullptr);
 
 	// 销毁渲染通道（Render Pass）
 	vkDestroyRenderPass(_device, _renderPass, nullptr);
+	vkDestroyRenderPass(_device, _overlayRenderPass, nullptr);
 
-	// 销毁用于同步的信号量和栅栏资源
-	for (size_t i = 0; i < _MAX_FRAMES_IN_FLIGHT; i++) {
-		vkDestroySemaphore(_device, _renderFinishedSemaphores[i], nullptr);    // 渲染完成信号量
-		vkDestroySemaphore(_device, _imageAvailableSemaphores[i], nullptr);    // 图像可用信号量
-		vkDestroyFence(_device, _inFlightFences[i], nullptr);                  // 同步帧完成栅栏
-	}
+	// 停止着色器监视线程，所有管线已创建完成，销毁着色器模块
+	_shaderWatcher.Stop();
+	_shaderCompiler.Destroy();
+	_shaderLibrary.Destroy();
+
+	// 将管线缓存写回磁盘后销毁
+	_pipelineCache.Save();
+	_pipelineCache.Destroy();
+
+	// 销毁每帧数据的环形缓冲与场景 uniform 描述符
+	_frameRing.Destroy();
+	vkDestroyDescriptorPool(_device, _sceneDescriptorPool, nullptr);
+	vkDestroyDescriptorSetLayout(_device, _sceneSetLayout, nullptr);
+
+	// 停止解码线程，销毁流送的纹理、暂存环与占位纹理
+	_textureStreamer.Destroy();
+
+	// 销毁渲染图的瞬态图像并归还显存
+	_renderGraph.Destroy();
+
+	// 销毁上传队列的暂存环与命令池
+	_uploadQueue.Destroy();
+
+	// 所有缓冲与图像已销毁，归还分配器持有的内存块
+	_allocator.Destroy();
+
+	// 销毁用于同步的信号量和栅栏资源（渲染完成信号量已随交换链销毁）
+	destroySyncObjects();
+
+	// 销毁 GPU 计时器的时间戳查询池
+	_gpuProfiler.Destroy();
+
+	// 停止并行录制线程，销毁其命令池
+	_parallelRecorder.Destroy();
+
+	// 销毁计算队列的命令池与信号量
+	_asyncCompute.Destroy();
 
 	// 销毁 ImGui 使用的描述符池
 	vkDestroyDescriptorPool(_device, _imguiDescriptorPool, nullptr);
 
-	// 释放所有命令缓冲
+	// 释放所有命令缓冲（含缓存的场景命令缓冲）
+	releaseCommandCache(false);
 	vkFreeCommandBuffers(_device, _commandPool, static_cast<uint32_t>(_commandBuffers.size()), _commandBuffers.data());
 
 	// 销毁命令池，同时会释放所有命令缓冲区
@@ -195,10 +741,17 @@ void TriangleFunc::cleanup()
 	}
 
 	// 销毁与窗口系统交互的表面对象
-	vkDestroySurfaceKHR(_instance, _surface, nullptr);
+	if (_surface != VK_NULL_HANDLE) {
+		vkDestroySurfaceKHR(_instance, _surface, nullptr);
+	}
 	// 销毁 Vulkan 实例，释放 Vulkan 运行时资源
 	vkDestroyInstance(_instance, nullptr);
 
+	// 无头模式没有初始化 GLFW
+	if (_config.headless) {
+		return;
+	}
+
 	// 销毁 GLFW 窗口，释放窗口资源
 	glfwDestroyWindow(_window);
 
@@ -310,8 +863,15 @@ void TriangleFunc::createLogicalDevice()
 	// Imgui使用
 	_graphicsQueueFamily = indices.graphicsFamily.value();
 
+	// 没有独立的计算队列族时，计算工作提交到图形队列
+	_computeQueueFamily = indices.computeFamily.value_or(_graphicsQueueFamily);
+
+	// 没有专用传输队列族时，上传提交到图形队列
+	_transferQueueFamily = indices.transferFamily.value_or(_graphicsQueueFamily);
+
 	// 使用 std::set 去重，确保不会重复创建相同队列族
-	std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily.value(), indices.presentFamily.value() };
+	std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily.value(), indices.presentFamily.value(), _computeQueueFamily,
+		_transferQueueFamily };
 
 	// 为每个唯一队列族创建一个 VkDeviceQueueCreateInfo
 	float queuePriority = 1.0f;
@@ -326,19 +886,134 @@ void TriangleFunc::createLogicalDevice()
 		queueCreateInfos.push_back(queueCreateInfo);
 	}
 
-	// 设置要启用的物理设备特性（此处暂未启用任何特性）
+	// 设置要启用的物理设备特性：GPU 驱动渲染在支持时使用 multiDrawIndirect 一次提交所有间接绘制
+	VkPhysicalDeviceFeatures supportedFeatures;
+	vkGetPhysicalDeviceFeatures(_physicalDevice, &supportedFeatures);
+
 	VkPhysicalDeviceFeatures deviceFeatures{};
+	deviceFeatures.multiDrawIndirect = supportedFeatures.multiDrawIndirect;
+	_multiDrawIndirectEnabled = supportedFeatures.multiDrawIndirect == VK_TRUE;
+
+	// 可选扩展：间接绘制数量由 GPU 写入的计数缓冲决定
+	std::vector<const char*> deviceExtensions = _deviceExtensions;
+	_drawIndirectCountEnabled = isDeviceExtensionAvailable(_physicalDevice, VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+	if (_drawIndirectCountEnabled) {
+		deviceExtensions.push_back(VK_KHR_DRAW_INDIRECT_COUNT_EXTENSION_NAME);
+	}
+
+	// 可选扩展：动态渲染，实例为 Vulkan 1.0，需要同时启用它依赖的设备扩展；不支持时退回渲染通道
+	const char* dynamicRenderingExtensions[] = {
+		VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME,
+		VK_KHR_DEPTH_STENCIL_RESOLVE_EXTENSION_NAME,
+		VK_KHR_CREATE_RENDERPASS_2_EXTENSION_NAME,
+		VK_KHR_MULTIVIEW_EXTENSION_NAME,
+		VK_KHR_MAINTENANCE_2_EXTENSION_NAME
+	};
+	// 渲染图在通道内直接开始渲染，同样需要动态渲染
+	bool requestDynamicRendering = _config.dynamicRendering || _config.renderGraph;
+	_dynamicRendering = requestDynamicRendering && _properties2Enabled;
+	for (const char* extension : dynamicRenderingExtensions) {
+		_dynamicRendering = _dynamicRendering && isDeviceExtensionAvailable(_physicalDevice, extension);
+	}
+	if (requestDynamicRendering && !_dynamicRendering) {
+		std::cerr << "设备不支持 VK_KHR_dynamic_rendering，使用渲染通道" << std::endl;
+	}
+	_renderGraphEnabled = _config.renderGraph && _dynamicRendering;
+	if (_config.renderGraph && !_renderGraphEnabled) {
+		std::cerr << "渲染图需要 VK_KHR_dynamic_rendering，使用原有的渲染路径" << std::endl;
+	}
+
+	// 扩展特性通过 pNext 链启用
+	void* featureChain = nullptr;
+
+	VkPhysicalDeviceDynamicRenderingFeaturesKHR dynamicRenderingFeatures{};
+	dynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES_KHR;
+	dynamicRenderingFeatures.dynamicRendering = VK_TRUE;
+	if (_dynamicRendering) {
+		deviceExtensions.insert(deviceExtensions.end(), std::begin(dynamicRenderingExtensions), std::end(dynamicRenderingExtensions));
+		dynamicRenderingFeatures.pNext = featureChain;
+		featureChain = &dynamicRenderingFeatures;
+	}
+
+	// 扩展特性需要通过 vkGetPhysicalDeviceFeatures2KHR 查询，扩展存在时特性仍可能不支持
+	auto getFeatures2 = _properties2Enabled
+		? (PFN_vkGetPhysicalDeviceFeatures2KHR)vkGetInstanceProcAddr(_instance, "vkGetPhysicalDeviceFeatures2KHR")
+		: nullptr;
+
+	// 可选扩展：时间线信号量代替每帧栅栏；不支持时退回栅栏
+	VkPhysicalDeviceTimelineSemaphoreFeaturesKHR timelineFeatures{};
+	timelineFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_TIMELINE_SEMAPHORE_FEATURES_KHR;
+	_timelineSync = false;
+	if (_config.timelineSync && getFeatures2 != nullptr
+		&& isDeviceExtensionAvailable(_physicalDevice, VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME)) {
+		VkPhysicalDeviceFeatures2KHR features2{};
+		features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+		features2.pNext = &timelineFeatures;
+		getFeatures2(_physicalDevice, &features2);
+		_timelineSync = timelineFeatures.timelineSemaphore == VK_TRUE;
+	}
+	if (_config.timelineSync && !_timelineSync) {
+		std::cerr << "设备不支持 VK_KHR_timeline_semaphore，使用栅栏" << std::endl;
+	}
+	if (_timelineSync) {
+		deviceExtensions.push_back(VK_KHR_TIMELINE_SEMAPHORE_EXTENSION_NAME);
+		timelineFeatures.pNext = featureChain;
+		featureChain = &timelineFeatures;
+	}
+
+	// 可选扩展：渲染图用 vkCmdPipelineBarrier2 录制屏障；不支持时退回 vkCmdPipelineBarrier
+	VkPhysicalDeviceSynchronization2FeaturesKHR synchronization2Features{};
+	synchronization2Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SYNCHRONIZATION_2_FEATURES_KHR;
+	bool synchronization2 = false;
+	if (_renderGraphEnabled && getFeatures2 != nullptr
+		&& isDeviceExtensionAvailable(_physicalDevice, VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME)) {
+		VkPhysicalDeviceFeatures2KHR features2{};
+		features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+		features2.pNext = &synchronization2Features;
+		getFeatures2(_physicalDevice, &features2);
+		synchronization2 = synchronization2Features.synchronization2 == VK_TRUE;
+	}
+	if (synchronization2) {
+		deviceExtensions.push_back(VK_KHR_SYNCHRONIZATION_2_EXTENSION_NAME);
+		synchronization2Features.pNext = featureChain;
+		featureChain = &synchronization2Features;
+	}
+
+	// 可选扩展：按呈现完成控制帧节奏
+	VkPhysicalDevicePresentIdFeaturesKHR presentIdFeatures{};
+	presentIdFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR;
+	VkPhysicalDevicePresentWaitFeaturesKHR presentWaitFeatures{};
+	presentWaitFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR;
+	_presentWaitEnabled = false;
+	if (!_config.headless && getFeatures2 != nullptr
+		&& isDeviceExtensionAvailable(_physicalDevice, VK_KHR_PRESENT_ID_EXTENSION_NAME)
+		&& isDeviceExtensionAvailable(_physicalDevice, VK_KHR_PRESENT_WAIT_EXTENSION_NAME)) {
+		presentIdFeatures.pNext = &presentWaitFeatures;
+		VkPhysicalDeviceFeatures2KHR features2{};
+		features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2_KHR;
+		features2.pNext = &presentIdFeatures;
+		getFeatures2(_physicalDevice, &features2);
+		_presentWaitEnabled = presentIdFeatures.presentId == VK_TRUE && presentWaitFeatures.presentWait == VK_TRUE;
+	}
+	if (_presentWaitEnabled) {
+		deviceExtensions.push_back(VK_KHR_PRESENT_ID_EXTENSION_NAME);
+		deviceExtensions.push_back(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+		presentWaitFeatures.pNext = featureChain;
+		presentIdFeatures.pNext = &presentWaitFeatures;
+		featureChain = &presentIdFeatures;
+	}
 
 	// 逻辑设备创建信息
 	VkDeviceCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	createInfo.pNext = featureChain;
 	createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 	createInfo.pQueueCreateInfos = queueCreateInfos.data();
 	createInfo.pEnabledFeatures = &deviceFeatures;
 
 	// 启用设备扩展（如 swapchain 可在此启用）
-	createInfo.enabledExtensionCount = static_cast<uint32_t>(_deviceExtensions.size());
-	createInfo.ppEnabledExtensionNames = _deviceExtensions.data();
+	createInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
+	createInfo.ppEnabledExtensionNames = deviceExtensions.data();
 
 	// 如启用了验证层，则附加层名称
 	if (_enableValidationLayers) {
@@ -358,6 +1033,165 @@ void TriangleFunc::createLogicalDevice()
 
 	// 获取呈现队列句柄
 	vkGetDeviceQueue(_device, indices.presentFamily.value(), 0, &_presentQueue);
+
+	// 获取计算队列句柄
+	vkGetDeviceQueue(_device, _computeQueueFamily, 0, &_computeQueue);
+
+	// 获取传输队列句柄
+	vkGetDeviceQueue(_device, _transferQueueFamily, 0, &_transferQueue);
+
+	if (_dynamicRendering) {
+		_cmdBeginRendering = (PFN_vkCmdBeginRenderingKHR)vkGetDeviceProcAddr(_device, "vkCmdBeginRenderingKHR");
+		_cmdEndRendering = (PFN_vkCmdEndRenderingKHR)vkGetDeviceProcAddr(_device, "vkCmdEndRenderingKHR");
+		if (_cmdBeginRendering == nullptr || _cmdEndRendering == nullptr) {
+			throw std::runtime_error("未能获取 vkCmdBeginRenderingKHR!");
+		}
+	}
+
+	if (synchronization2) {
+		_cmdPipelineBarrier2 = (PFN_vkCmdPipelineBarrier2KHR)vkGetDeviceProcAddr(_device, "vkCmdPipelineBarrier2KHR");
+	}
+}
+
+void TriangleFunc::createPipelineCache()
+{
+	_pipelineCache.Init(_physicalDevice, _device, _pipelineCachePath);
+}
+
+void TriangleFunc::createAllocator()
+{
+	_allocator.Init(_physicalDevice, _device);
+}
+
+void TriangleFunc::createFrameRing()
+{
+	// 按最大帧数分区，切换 Frames in Flight 时缓冲与描述符都不需要重建
+	_frameRing.Init(_physicalDevice, _allocator, kFrameRingSize, AppConfig::kMaxFramesInFlight,
+		VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+
+	VkDescriptorSetLayoutBinding binding{};
+	binding.binding = 0;
+	binding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	binding.descriptorCount = 1;
+	binding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo{};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.bindingCount = 1;
+	layoutInfo.pBindings = &binding;
+
+	if (vkCreateDescriptorSetLayout(_device, &layoutInfo, nullptr, &_sceneSetLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create scene descriptor set layout!");
+	}
+
+	VkDescriptorPoolSize poolSize{};
+	poolSize.type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	poolSize.descriptorCount = 1;
+
+	VkDescriptorPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.maxSets = 1;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &poolSize;
+
+	if (vkCreateDescriptorPool(_device, &poolInfo, nullptr, &_sceneDescriptorPool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create scene descriptor pool!");
+	}
+
+	VkDescriptorSetAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocInfo.descriptorPool = _sceneDescriptorPool;
+	allocInfo.descriptorSetCount = 1;
+	allocInfo.pSetLayouts = &_sceneSetLayout;
+
+	if (vkAllocateDescriptorSets(_device, &allocInfo, &_sceneDescriptorSet) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate scene descriptor set!");
+	}
+
+	// 描述符只记录缓冲起点与范围，每帧的切片位置由绑定时的动态偏移给出
+	VkDescriptorBufferInfo bufferInfo{ _frameRing.Buffer(), 0, sizeof(SceneUniforms) };
+
+	VkWriteDescriptorSet write{};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = _sceneDescriptorSet;
+	write.dstBinding = 0;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	write.pBufferInfo = &bufferInfo;
+	vkUpdateDescriptorSets(_device, 1, &write, 0, nullptr);
+}
+
+void TriangleFunc::createUploadQueue()
+{
+	_uploadQueue.Init(_device, _allocator, _transferQueueFamily, _transferQueue, _graphicsQueueFamily, _graphicsQueue, kUploadStagingSize);
+}
+
+void TriangleFunc::createTextureStreamer()
+{
+	if (_config.textureDir.empty()) {
+		return;
+	}
+
+	TextureStreamer::Settings settings;
+	settings.memoryBudget = static_cast<VkDeviceSize>(_config.textureBudgetMB) * 1024 * 1024;
+	settings.uploadBudget = static_cast<VkDeviceSize>(_config.textureUploadKB) * 1024;
+	settings.threadCount = _config.textureThreads;
+	_textureStreamer.Init(_physicalDevice, _device, _allocator, _deletionQueue, _graphicsQueueFamily, _graphicsQueue, settings);
+
+	// 按文件名排序登记，浏览器中的顺序与目录一致
+	std::vector<std::string> paths;
+	std::error_code error;
+	for (const auto& entry : std::filesystem::directory_iterator(_config.textureDir, error)) {
+		if (!entry.is_regular_file()) {
+			continue;
+		}
+		std::string extension = entry.path().extension().string();
+		std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		if (std::any_of(std::begin(kTextureExtensions), std::end(kTextureExtensions), [&](const char* each) { return extension == each; })) {
+			paths.push_back(entry.path().string());
+		}
+	}
+	if (error) {
+		throw std::runtime_error("无法读取纹理目录 " + _config.textureDir + ": " + error.message());
+	}
+
+	std::sort(paths.begin(), paths.end());
+	for (const auto& path : paths) {
+		_textureStreamer.Request(path);
+	}
+}
+
+void TriangleFunc::createRenderGraph()
+{
+	if (!_renderGraphEnabled) {
+		return;
+	}
+
+	_renderGraph.Init(_device, _allocator, _deletionQueue, _cmdPipelineBarrier2);
+
+	// 模糊链在交换链格式的图像之间线性 blit，最后一级写入交换链图像
+	VkFormatProperties properties;
+	vkGetPhysicalDeviceFormatProperties(_physicalDevice, _swapChainImageFormat, &properties);
+	VkFormatFeatureFlags required = VK_FORMAT_FEATURE_BLIT_SRC_BIT | VK_FORMAT_FEATURE_BLIT_DST_BIT
+		| VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT;
+	bool transferDst = _config.headless
+		|| (querySwapChainSupport(_physicalDevice).capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) != 0;
+	_blurSupported = (properties.optimalTilingFeatures & required) == required && transferDst;
+
+	if (_config.blurLevels > 0 && !_blurSupported) {
+		std::cerr << "交换链格式不支持线性 blit，模糊链不可用" << std::endl;
+	}
+	_blurLevels = _blurSupported ? static_cast<int>(_config.blurLevels) : 0;
+}
+
+void TriangleFunc::writeSceneUniforms()
+{
+	// 调用时当前帧槽位的上一次提交已经完成，其分区可以覆盖
+	_frameRing.BeginFrame(_currentFrame);
+
+	SceneUniforms uniforms{};
+	uniforms.tint = _sceneTint;
+	_sceneUniformOffset = _frameRing.Push(&uniforms, sizeof(uniforms), _frameRing.UniformAlignment()).DynamicOffset();
 }
 
 void TriangleFunc::createSurface()
@@ -381,8 +1215,12 @@ void TriangleFunc::createSwapChain()
 	// 选择交换链图像尺寸（分辨率）
 	VkExtent2D extent = chooseSwapExtent(swapChainSupport.capabilities);
 
-	// 期望的图像数量（至少为最小数量 + 1，提升性能）
+	// 期望的图像数量：未配置时为最小数量 + 1，配置时不低于最小数量
 	uint32_t imageCount = swapChainSupport.capabilities.minImageCount + 1;
+	if (_config.swapchainImages > 0) {
+		imageCount = std::max(_config.swapchainImages, swapChainSupport.capabilities.minImageCount);
+	}
+	_swapChainMinImageCount = swapChainSupport.capabilities.minImageCount;
 
 	// 如果最大图像数量有限制，确保不超过该限制
 	if (swapChainSupport.capabilities.maxImageCount > 0 && imageCount > swapChainSupport.capabilities.maxImageCount) {
@@ -401,6 +1239,11 @@ void TriangleFunc::createSwapChain()
 	createInfo.imageArrayLayers = 1;    // 一般为1，除非是立体或多视图渲染
 	createInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
+	// 渲染图的模糊链最后一级 blit 到交换链图像
+	if (_renderGraphEnabled && (swapChainSupport.capabilities.supportedUsageFlags & VK_IMAGE_USAGE_TRANSFER_DST_BIT) != 0) {
+		createInfo.imageUsage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+	}
+
 	// 获取图形和呈现队列族索引
 	QueueFamilyIndices indices = findQueueFamilies(_physicalDevice);
 	uint32_t queueFamilyIndices[] = { indices.graphicsFamily.value(), indices.presentFamily.value() };
@@ -423,7 +1266,8 @@ void TriangleFunc::createSwapChain()
 	createInfo.presentMode = presentMode;                                        // 选择的呈现模式
 	createInfo.clipped = VK_TRUE;                                                // 剔除不可见像素，提升性能
 
-	createInfo.oldSwapchain = VK_NULL_HANDLE;    // 旧交换链（窗口大小变更时用）
+	// 重建时传入旧交换链，驱动可以复用其资源，旧交换链退役后不能再获取图像，但已获取的图像仍可呈现
+	createInfo.oldSwapchain = _swapChain;
 
 	// 创建交换链
 	if (vkCreateSwapchainKHR(_device, &createInfo, nullptr, &_swapChain) != VK_SUCCESS) {
@@ -440,6 +1284,11 @@ void TriangleFunc::createSwapChain()
 	// 记录交换链图像格式和尺寸，后续创建图像视图时使用
 	_swapChainImageFormat = surfaceFormat.format;
 	_swapChainExtent = extent;
+
+	// presentId 按交换链计数，新交换链从头开始
+	_presentMode = presentMode;
+	_policyPresentModes[_presentPacer.CurrentPolicy()] = presentMode;
+	_presentPacer.ResetSwapchain();
 }
 
 void TriangleFunc::createImageViews()
@@ -475,27 +1324,212 @@ void TriangleFunc::createImageViews()
 	}
 }
 
-void TriangleFunc::createGraphicsPipeline()
+void TriangleFunc::createOffscreenTargets()
 {
-	auto vertShaderCode = readFile("spv/vert.spv");
-	auto fragShaderCode = readFile("spv/frag.spv");
+	// 离屏目标直接使用 UNORM 格式与配置的分辨率
+	_swapChainImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+	_swapChainExtent = { _config.width, _config.height };
 
-	VkShaderModule vertShaderModule = createShaderModule(vertShaderCode);
-	VkShaderModule fragShaderModule = createShaderModule(fragShaderCode);
+	// 每个 Frame in Flight 一张离屏图像，避免 CPU 录制与 GPU 写入冲突
+	size_t imageCount = static_cast<size_t>(_framesInFlight);
+	_swapChainImages.resize(imageCount);
+	_offscreenImageAllocations.resize(imageCount);
+
+	for (size_t i = 0; i < imageCount; i++) {
+		VkImageCreateInfo imageInfo{};
+		imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		imageInfo.imageType = VK_IMAGE_TYPE_2D;
+		imageInfo.format = _swapChainImageFormat;
+		imageInfo.extent = { _swapChainExtent.width, _swapChainExtent.height, 1 };
+		imageInfo.mipLevels = 1;
+		imageInfo.arrayLayers = 1;
+		imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;    // 可回读
+		if (_renderGraphEnabled) {
+			imageInfo.usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;    // 模糊链的最后一级 blit
+		}
+		imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
 
-	VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-	vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-	vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-	vertShaderStageInfo.module = vertShaderModule;
-	vertShaderStageInfo.pName = "main";
+		_allocator.CreateImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, _swapChainImages[i], _offscreenImageAllocations[i]);
+	}
+}
 
-	VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-	fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-	fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-	fragShaderStageInfo.module = fragShaderModule;
-	fragShaderStageInfo.pName = "main";
+void TriangleFunc::cleanupOffscreenTargets()
+{
+	for (auto framebuffer : _swapChainFramebuffers) {
+		vkDestroyFramebuffer(_device, framebuffer, nullptr);
+	}
+	_swapChainFramebuffers.clear();
 
-	VkPipelineShaderStageCreateInfo shaderStages[] = { vertShaderStageInfo, fragShaderStageInfo };
+	for (auto imageView : _swapChainImageViews) {
+		vkDestroyImageView(_device, imageView, nullptr);
+	}
+	_swapChainImageViews.clear();
+
+	// 离屏图像由程序自己创建，需要手动销毁并归还显存
+	for (size_t i = 0; i < _swapChainImages.size(); i++) {
+		_allocator.DestroyImage(_swapChainImages[i], _offscreenImageAllocations[i]);
+	}
+	_swapChainImages.clear();
+	_offscreenImageAllocations.clear();
+}
+
+void TriangleFunc::createGpuProfiler()
+{
+	_gpuProfiler.Init(_physicalDevice, _device, _graphicsQueueFamily, static_cast<uint32_t>(_framesInFlight));
+}
+
+void TriangleFunc::createParallelRecorder()
+{
+	_parallelRecorder.Init(_device, _graphicsQueueFamily, static_cast<uint32_t>(_framesInFlight), _recordThreads);
+}
+
+void TriangleFunc::createGpuCuller()
+{
+	if (_instanceCount == 0) {
+		if (_gpuDriven) {
+			throw std::runtime_error("GPU 驱动渲染需要实例化场景（--instances）!");
+		}
+		return;
+	}
+
+	// 剔除在图形队列上派发，队列族需要同时支持计算
+	uint32_t queueFamilyCount = 0;
+	vkGetPhysicalDeviceQueueFamilyProperties(_physicalDevice, &queueFamilyCount, nullptr);
+	std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+	vkGetPhysicalDeviceQueueFamilyProperties(_physicalDevice, &queueFamilyCount, queueFamilies.data());
+
+	if (!(queueFamilies[_graphicsQueueFamily].queueFlags & VK_QUEUE_COMPUTE_BIT)) {
+		if (_gpuDriven) {
+			throw std::runtime_error("图形队列族不支持计算，无法使用 GPU 剔除!");
+		}
+		return;
+	}
+
+	_gpuCuller.Init(_physicalDevice, _device, _allocator, _pipelineCache.Get(), _shaderLibrary.Load("comp_cull.spv"), _instanceCount,
+		_drawIndirectCountEnabled, _multiDrawIndirectEnabled);
+
+	_gpuCuller.SetObjects(_instanceBuffer.Buffer(), _instanceBuffer.Count());
+}
+
+void TriangleFunc::createAsyncCompute()
+{
+	if (!_simulate) {
+		return;
+	}
+
+	_asyncCompute.Init(_physicalDevice, _device, _computeQueueFamily, _computeQueue, _graphicsQueueFamily,
+		static_cast<uint32_t>(_framesInFlight));
+}
+
+void TriangleFunc::createInstanceSimulation()
+{
+	if (!_simulate) {
+		return;
+	}
+	if (_instanceCount == 0) {
+		throw std::runtime_error("实例模拟需要实例化场景（--instances）!");
+	}
+
+	_simulation.Init(_device, _allocator, _pipelineCache.Get(), _shaderLibrary.Load("comp_simulate.spv"), _instanceCount, sizeof(InstanceData));
+
+	// 初始状态在计算队列上写入，状态缓冲始终归计算队列族所有，不需要所有权转移
+	VkBuffer stagingBuffer;
+	GpuAllocation stagingAlloc;
+	VkDeviceSize size = sizeof(InstanceData) * _instances.size();
+	_allocator.CreateBuffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+		VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingAlloc);
+	memcpy(stagingAlloc.mapped, _instances.data(), static_cast<size_t>(size));
+
+	_asyncCompute.SubmitImmediate([&](VkCommandBuffer commandBuffer) {
+		_simulation.RecordSeed(commandBuffer, stagingBuffer);
+	});
+
+	_allocator.DestroyBuffer(stagingBuffer, stagingAlloc);
+}
+
+void TriangleFunc::submitSimulation()
+{
+	// 固定步长，与实际帧间隔无关，便于基准测试复现
+	const float dt = 1.0f / 60.0f;
+	uint32_t output = _simOutput;
+
+	_asyncCompute.Submit(_currentFrame, [this, output, dt](VkCommandBuffer commandBuffer) {
+		_simulation.RecordStep(commandBuffer, output, _simSubsteps, dt);
+		_asyncCompute.RecordRelease(commandBuffer, _simulation.Output(output));
+	});
+}
+
+void TriangleFunc::setRecordThreads(uint32_t count)
+{
+	if (count == _recordThreads) {
+		return;
+	}
+
+	// 等待所有次级命令缓冲执行完毕后再销毁其命令池
+	vkDeviceWaitIdle(_device);
+	_parallelRecorder.Destroy();
+
+	_recordThreads = count;
+	createParallelRecorder();
+}
+
+void TriangleFunc::createGraphicsPipeline()
+{
+	// 模块归着色器库所有，管线创建后不需要销毁；变体在工作线程上编译时只读取这些成员
+	_vertShaderModule = _shaderLibrary.Load("vert.spv");
+	_fragShaderModule = _shaderLibrary.Load("frag.spv");
+	if (_instanceCount > 0) {
+		_instancedShaderModule = _shaderLibrary.Load("vert_instanced.spv");
+	}
+
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = 1;
+	pipelineLayoutInfo.pSetLayouts = &_sceneSetLayout;
+	pipelineLayoutInfo.pushConstantRangeCount = 0;
+
+	// 热重载重建管线时布局不变，直接复用
+	if (_pipelineLayout == VK_NULL_HANDLE
+		&& vkCreatePipelineLayout(_device, &pipelineLayoutInfo, nullptr, &_pipelineLayout) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create pipeline layout!");
+	}
+
+	// 实例化管线只有顶点着色器与顶点输入不同，与普通管线一次批量创建
+	std::vector<PipelineVariant> variants(1);
+	if (_instanceCount > 0) {
+		PipelineVariant instanced;
+		instanced.instanced = true;
+		variants.push_back(instanced);
+	}
+
+	std::vector<VkPipeline> pipelines;
+
+	auto pipelineStart = std::chrono::steady_clock::now();
+	createScenePipelines(variants, _pipelineCache.Get(), pipelines);
+	_pipelineBuildMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pipelineStart).count();
+
+	_graphicsPipeline = pipelines[0];
+	if (pipelines.size() > 1) {
+		_instancedPipeline = pipelines[1];
+	}
+}
+
+void TriangleFunc::createScenePipelines(const std::vector<PipelineVariant> &variants, VkPipelineCache cache, std::vector<VkPipeline> &pipelines) const
+{
+	VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
+	vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
+	vertShaderStageInfo.module = _vertShaderModule;
+	vertShaderStageInfo.pName = "main";
+
+	VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
+	fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	fragShaderStageInfo.module = _fragShaderModule;
+	fragShaderStageInfo.pName = "main";
 
 	VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
 	vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
@@ -557,41 +1591,196 @@ void TriangleFunc::createGraphicsPipeline()
 	dynamicState.dynamicStateCount = static_cast<uint32_t>(dynamicStates.size());
 	dynamicState.pDynamicStates = dynamicStates.data();
 
-	VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-	pipelineLayoutInfo.setLayoutCount = 0;
-	pipelineLayoutInfo.pushConstantRangeCount = 0;
+	VkVertexInputBindingDescription instancedBindings[] = { bindingDescription, InstanceData::getBindingDescription() };
+	auto instanceAttributes = InstanceData::getAttributeDescriptions();
+	std::vector<VkVertexInputAttributeDescription> instancedAttributes(attributeDescriptions.begin(), attributeDescriptions.end());
+	instancedAttributes.insert(instancedAttributes.end(), instanceAttributes.begin(), instanceAttributes.end());
 
-	if (vkCreatePipelineLayout(_device, &pipelineLayoutInfo, nullptr, &_pipelineLayout) != VK_SUCCESS) {
-		throw std::runtime_error("failed to create pipeline layout!");
-	}
+	VkPipelineVertexInputStateCreateInfo instancedVertexInput = vertexInputInfo;
+	instancedVertexInput.vertexBindingDescriptionCount = 2;
+	instancedVertexInput.pVertexBindingDescriptions = instancedBindings;
+	instancedVertexInput.vertexAttributeDescriptionCount = static_cast<uint32_t>(instancedAttributes.size());
+	instancedVertexInput.pVertexAttributeDescriptions = instancedAttributes.data();
 
 	VkGraphicsPipelineCreateInfo pipelineInfo{};
 	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
 	pipelineInfo.stageCount = 2;
-	pipelineInfo.pStages = shaderStages;
-	pipelineInfo.pVertexInputState = &vertexInputInfo;
 	pipelineInfo.pInputAssemblyState = &inputAssembly;
 	pipelineInfo.pViewportState = &viewportState;
-	pipelineInfo.pRasterizationState = &rasterizer;
 	pipelineInfo.pMultisampleState = &multisampling;
-	pipelineInfo.pColorBlendState = &colorBlending;
 	pipelineInfo.pDynamicState = &dynamicState;
 	pipelineInfo.layout = _pipelineLayout;
 	pipelineInfo.renderPass = _renderPass;
 	pipelineInfo.subpass = 0;
 	pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
 
-	if (vkCreateGraphicsPipelines(_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &_graphicsPipeline) != VK_SUCCESS) {
+	// 动态渲染模式下 renderPass 为空，改由附件格式描述管线的输出
+	VkPipelineRenderingCreateInfoKHR renderingInfo{};
+	renderingInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO_KHR;
+	renderingInfo.colorAttachmentCount = 1;
+	renderingInfo.pColorAttachmentFormats = &_swapChainImageFormat;
+	if (_dynamicRendering) {
+		pipelineInfo.pNext = &renderingInfo;
+	}
+
+	// 每个变体的可变状态单独保存，批量创建时各自的指针保持有效
+	size_t count = variants.size();
+	std::vector<VkPipelineShaderStageCreateInfo> stages(count * 2);
+	std::vector<VkPipelineRasterizationStateCreateInfo> rasterizers(count, rasterizer);
+	std::vector<VkPipelineColorBlendAttachmentState> blendAttachments(count, colorBlendAttachment);
+	std::vector<VkPipelineColorBlendStateCreateInfo> blendStates(count, colorBlending);
+	std::vector<VkGraphicsPipelineCreateInfo> pipelineInfos(count, pipelineInfo);
+
+	for (size_t i = 0; i < count; i++) {
+		const PipelineVariant &variant = variants[i];
+		if (variant.instanced && _instancedShaderModule == VK_NULL_HANDLE) {
+			throw std::runtime_error("instanced pipeline variant requires instancing!");
+		}
+
+		stages[i * 2] = vertShaderStageInfo;
+		stages[i * 2].module = variant.instanced ? _instancedShaderModule : _vertShaderModule;
+		stages[i * 2 + 1] = fragShaderStageInfo;
+
+		rasterizers[i].cullMode = variant.cullMode;
+		rasterizers[i].frontFace = variant.frontFace;
+
+		// 混合变体使用常规的 alpha 混合
+		VkPipelineColorBlendAttachmentState &blend = blendAttachments[i];
+		blend.colorWriteMask = variant.writeMask;
+		blend.blendEnable = variant.blend ? VK_TRUE : VK_FALSE;
+		blend.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+		blend.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+		blend.colorBlendOp = VK_BLEND_OP_ADD;
+		blend.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+		blend.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+		blend.alphaBlendOp = VK_BLEND_OP_ADD;
+		blendStates[i].pAttachments = &blend;
+
+		pipelineInfos[i].pStages = &stages[i * 2];
+		pipelineInfos[i].pVertexInputState = variant.instanced ? &instancedVertexInput : &vertexInputInfo;
+		pipelineInfos[i].pRasterizationState = &rasterizers[i];
+		pipelineInfos[i].pColorBlendState = &blendStates[i];
+	}
+
+	pipelines.assign(count, VK_NULL_HANDLE);
+	if (vkCreateGraphicsPipelines(_device, cache, static_cast<uint32_t>(count), pipelineInfos.data(),
+		nullptr, pipelines.data()) != VK_SUCCESS) {
 		throw std::runtime_error("failed to create graphics pipeline!");
 	}
+}
 
-	vkDestroyShaderModule(_device, fragShaderModule, nullptr);
-	vkDestroyShaderModule(_device, vertShaderModule, nullptr);
+void TriangleFunc::createPipelineManager(VkPipelineCache cache, uint32_t threadCount)
+{
+	_pipelineManager.Init(_device, cache, threadCount, [this](uint64_t key, VkPipelineCache threadCache) {
+		std::vector<VkPipeline> pipelines;
+		createScenePipelines({ PipelineVariant::FromKey(key) }, threadCache, pipelines);
+		return pipelines[0];
+	});
+}
+
+void TriangleFunc::compileShaders()
+{
+	_shaderCompiler.Init(_config.shaderCacheDir);
+
+	std::error_code error;
+	std::filesystem::create_directories(_config.shaderDir, error);
+
+	uint32_t failed = 0;
+	for (const auto& shader : kShaderSources) {
+		std::string sourcePath = _config.shaderSourceDir + "/" + shader.source;
+		ShaderCompiler::Output output;
+		if (!_shaderCompiler.Compile(sourcePath, _config.shaderDefines, output)) {
+			std::cerr << "着色器编译失败: " << sourcePath << "\n" << output.log << std::endl;
+			failed++;
+			continue;
+		}
+
+		std::string spirvPath = _config.shaderDir + "/" + shader.spirv;
+		std::ofstream file(spirvPath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(output.spirv.data()), output.spirv.size() * sizeof(uint32_t));
+		if (!file) {
+			std::cerr << "无法写入: " << spirvPath << std::endl;
+			failed++;
+			continue;
+		}
+		std::cout << sourcePath << " -> " << spirvPath << (output.cached ? "（缓存）" : "") << std::endl;
+	}
+
+	_shaderCompiler.Destroy();
+	if (failed > 0) {
+		throw std::runtime_error(std::to_string(failed) + " 个着色器编译失败!");
+	}
+}
+
+void TriangleFunc::applyShaderReloads()
+{
+	bool changed = false;
+	for (const auto& result : _shaderWatcher.Poll()) {
+		if (!result.ok) {
+			std::cerr << "着色器编译失败: " << result.source << "\n" << result.output.log << std::endl;
+			continue;
+		}
+
+		const char* spirvName = spirvNameFor(result.source);
+		if (spirvName == nullptr) {
+			continue;
+		}
+
+		try {
+			_shaderLibrary.Reload(spirvName, result.output.spirv);
+			changed = true;
+			std::cout << "着色器已重新编译: " << result.source << (result.output.cached ? "（缓存）" : "") << std::endl;
+		}
+		catch (const std::exception& e) {
+			std::cerr << e.what() << std::endl;
+		}
+	}
+	if (!changed) {
+		return;
+	}
+
+	// 已编译的变体基于旧着色器，交出后重新请求；等待正在编译的变体完成后才能替换模块成员
+	std::vector<VkPipeline> oldVariants = _pipelineManager.Reset();
+
+	// 管线创建成功后才会覆盖成员，失败时旧管线保持不变
+	VkPipeline oldGraphicsPipeline = _graphicsPipeline;
+	VkPipeline oldInstancedPipeline = _instancedPipeline;
+	try {
+		createGraphicsPipeline();
+	}
+	catch (const std::exception& e) {
+		std::cerr << "重建图形管线失败，保留旧管线: " << e.what() << std::endl;
+		return;
+	}
+
+	// 缓存的命令缓冲绑定的是旧管线；按需渲染模式下画面需要更新
+	invalidateCommandCache();
+	requestRedraw(1);
+
+	// 管线已用新模块重建，被替换的旧模块不再被引用，随旧管线一起退役
+	std::vector<VkShaderModule> oldModules = _shaderLibrary.TakeSuperseded();
+
+	// 已提交的帧可能仍在使用旧管线，全部完成后再销毁
+	_deletionQueue.Push(_submitSerial, [this, oldGraphicsPipeline, oldInstancedPipeline, oldVariants, oldModules]() {
+		vkDestroyPipeline(_device, oldGraphicsPipeline, nullptr);
+		if (oldInstancedPipeline != VK_NULL_HANDLE) {
+			vkDestroyPipeline(_device, oldInstancedPipeline, nullptr);
+		}
+		for (VkPipeline pipeline : oldVariants) {
+			vkDestroyPipeline(_device, pipeline, nullptr);
+		}
+		for (VkShaderModule shaderModule : oldModules) {
+			vkDestroyShaderModule(_device, shaderModule, nullptr);
+		}
+	});
 }
 
 void TriangleFunc::createRenderPass()
 {
+	if (_dynamicRendering) {
+		return;
+	}
+
 	// 1. 附件描述（交换链图像）
 	VkAttachmentDescription colorAttachment{};
 	colorAttachment.format = _swapChainImageFormat;                     // 与交换链格式一致
@@ -601,7 +1790,8 @@ void TriangleFunc::createRenderPass()
 	colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;    // 不使用 stencil
 	colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
 	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;        // 开始时不关心图像内容
-	colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;    // 呈现到屏幕
+	// 呈现到屏幕；无头模式下转换为传输源布局，便于回读
+	colorAttachment.finalLayout = _config.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
 	// 2. 附件引用（用于 subpass）
 	VkAttachmentReference colorAttachmentRef{};
@@ -626,10 +1816,37 @@ void TriangleFunc::createRenderPass()
 	if (vkCreateRenderPass(_device, &renderPassInfo, nullptr, &_renderPass) != VK_SUCCESS) {
 		throw std::runtime_error("failed to create render pass!");
 	}
+
+	// 缓存场景命令时 ImGui 单独录制：叠加层渲染通道保留场景内容，并等待场景的颜色写入完成。
+	// 附件格式与采样数相同，两个渲染通道兼容，共用同一组帧缓冲与 ImGui 管线
+	if (_config.headless) {
+		return;
+	}
+
+	colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+	colorAttachment.initialLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+
+	VkSubpassDependency dependency{};
+	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependency.dstSubpass = 0;
+	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	renderPassInfo.dependencyCount = 1;
+	renderPassInfo.pDependencies = &dependency;
+
+	if (vkCreateRenderPass(_device, &renderPassInfo, nullptr, &_overlayRenderPass) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create overlay render pass!");
+	}
 }
 
 void TriangleFunc::createFramebuffers()
 {
+	if (_dynamicRendering) {
+		return;
+	}
+
 	// 调整帧缓冲容器大小，与图像视图数量一致
 	_swapChainFramebuffers.resize(_swapChainImageViews.size());
 
@@ -670,42 +1887,170 @@ void TriangleFunc::createCommandPool()
 	}
 }
 
-void TriangleFunc::createVertexBuffer()
+void TriangleFunc::buildSceneMesh()
+{
+	// 顶点内存基准测试需要足够大的网格才能体现差异
+	uint32_t grid = _config.meshGrid;
+	if (grid == 0 && _config.bench == "vertex-memory") {
+		grid = 512;
+	}
+
+	// 并行录制基准测试需要数千次绘制，每次至少几个三角形
+	if (grid == 0 && _config.bench == "parallel-record") {
+		grid = 128;
+	}
+
+	if (grid > 0) {
+		generateGridMesh(grid, _meshVertices, _meshIndices);
+	}
+	else {
+		_meshVertices = vertices;
+		_meshIndices = vertexIndices;
+	}
+
+	// 剔除使用的包围圆半径（网格以原点为中心）
+	_meshRadius = 0.0f;
+	for (const auto& vertex : _meshVertices) {
+		_meshRadius = std::max(_meshRadius, glm::length(vertex.pos));
+	}
+
+	buildDrawList();
+}
+
+void TriangleFunc::buildInstances()
 {
-	VkBufferCreateInfo bufferInfo{};
-	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-	bufferInfo.size = sizeof(vertices[0]) * vertices.size();
-	bufferInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
-	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	_instances.clear();
+	if (_instanceCount == 0) {
+		return;
+	}
+
+	// 实例排成 side × side 的网格铺满 [-_instanceExtent, _instanceExtent]，每个实例缩放到一个格子大小
+	uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(_instanceCount))));
+	float cell = 2.0f * _instanceExtent / static_cast<float>(side);
+
+	std::mt19937 rng(4321);
+	std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+	std::uniform_real_distribution<float> channel(0.3f, 1.0f);
 
-	if (vkCreateBuffer(_device, &bufferInfo, nullptr, &_vertexBuffer) != VK_SUCCESS) {
-		throw std::runtime_error("failed to create vertex buffer!");
+	_instances.resize(_instanceCount);
+	for (uint32_t i = 0; i < _instanceCount; i++) {
+		float x = -_instanceExtent + cell * (static_cast<float>(i % side) + 0.5f);
+		float y = -_instanceExtent + cell * (static_cast<float>(i / side) + 0.5f);
+
+		_instances[i].transform = glm::vec4(x, y, cell, angle(rng));
+		_instances[i].color = glm::vec4(channel(rng), channel(rng), channel(rng), 1.0f);
 	}
+}
 
-	VkMemoryRequirements memRequirements;
-	vkGetBufferMemoryRequirements(_device, _vertexBuffer, &memRequirements);
+void TriangleFunc::createInstanceBuffer()
+{
+	if (_instanceCount == 0) {
+		return;
+	}
 
-	VkMemoryAllocateInfo allocInfo{};
-	allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-	allocInfo.allocationSize = memRequirements.size;
-	allocInfo.memoryTypeIndex = findMemoryType(memRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+	_instanceBuffer.Init(_allocator, sizeof(InstanceData), _instanceCount, static_cast<uint32_t>(_framesInFlight));
+	_instanceBuffer.Update(0, _instanceCount, _instances.data());
+	_instanceBuffer.SetCount(_instanceCount);
 
-	if (vkAllocateMemory(_device, &allocInfo, nullptr, &_vertexBufferMemory) != VK_SUCCESS) {
-		throw std::runtime_error("failed to allocate vertex buffer memory!");
+	// 实例缓冲重建后，剔除的对象列表需要重新指向它
+	if (_gpuCuller.IsValid()) {
+		_gpuCuller.SetObjects(_instanceBuffer.Buffer(), _instanceBuffer.Count());
 	}
+}
 
-	vkBindBufferMemory(_device, _vertexBuffer, _vertexBufferMemory, 0);
+void TriangleFunc::animateInstances()
+{
+	uint32_t count = std::min(_instanceUpdatesPerFrame, _instanceCount);
+	if (count == 0) {
+		return;
+	}
 
-	void* data;
-	vkMapMemory(_device, _vertexBufferMemory, 0, bufferInfo.size, 0, &data);
-	memcpy(data, vertices.data(), (size_t)bufferInfo.size);
-	vkUnmapMemory(_device, _vertexBufferMemory);
+	// 滑动窗口：每帧旋转接下来的 count 个实例，到末尾后回绕，分两段更新
+	uint32_t first = _instanceUpdateCursor;
+	for (uint32_t i = 0; i < count; i++) {
+		_instances[(first + i) % _instanceCount].transform.w += 0.05f;
+	}
+
+	uint32_t head = std::min(count, _instanceCount - first);
+	_instanceBuffer.Update(first, head, &_instances[first]);
+	_instanceBuffer.Update(0, count - head, _instances.data());
+
+	_instanceUpdateCursor = (first + count) % _instanceCount;
+}
+
+uint32_t TriangleFunc::sceneItemCount() const
+{
+	if (_instanceCount > 0) {
+		return _instancePerObject && !_gpuDriven ? _instanceBuffer.Count() : 1;
+	}
+	return static_cast<uint32_t>(_drawList.size());
+}
+
+bool TriangleFunc::isInstanceVisible(uint32_t index) const
+{
+	const glm::vec4& transform = _instances[index].transform;
+	float radius = transform.z * _meshRadius;
+
+	return transform.x + radius >= _cullRect[0] && transform.x - radius <= _cullRect[2] &&
+		transform.y + radius >= _cullRect[1] && transform.y - radius <= _cullRect[3];
+}
+
+void TriangleFunc::buildDrawList()
+{
+	uint32_t draws = _config.sceneDraws;
+	if (draws == 0 && _config.bench == "parallel-record") {
+		draws = 4096;
+	}
+
+	// 每次绘制至少一个三角形
+	uint32_t triangles = static_cast<uint32_t>(_meshIndices.size() / 3);
+	draws = std::clamp(draws, 1u, std::max(triangles, 1u));
+
+	// 三角形均匀分配，前 triangles % draws 次绘制多分一个
+	uint32_t base = triangles / draws;
+	uint32_t extra = triangles % draws;
+
+	_drawList.clear();
+	_drawList.reserve(draws);
+	uint32_t firstTriangle = 0;
+	for (uint32_t i = 0; i < draws; i++) {
+		uint32_t count = base + (i < extra ? 1 : 0);
+
+		DrawItem item;
+		item.firstIndex = firstTriangle * 3;
+		item.indexCount = count * 3;
+		_drawList.push_back(item);
+
+		firstTriangle += count;
+	}
+}
+
+void TriangleFunc::createVertexBuffer()
+{
+	// 顶点与索引数据在同一次提交中上传
+	std::vector<BufferUpload> uploads(2);
+
+	uploads[0].data = _meshVertices.data();
+	uploads[0].size = sizeof(_meshVertices[0]) * _meshVertices.size();
+	uploads[0].usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT;
+	uploads[0].buffer = &_mesh.vertexBuffer;
+	uploads[0].allocation = &_mesh.vertexAlloc;
+
+	uploads[1].data = _meshIndices.data();
+	uploads[1].size = sizeof(_meshIndices[0]) * _meshIndices.size();
+	uploads[1].usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT;
+	uploads[1].buffer = &_mesh.indexBuffer;
+	uploads[1].allocation = &_mesh.indexAlloc;
+
+	uploadDeviceLocalBuffers(uploads);
+
+	_mesh.indexCount = static_cast<uint32_t>(_meshIndices.size());
 }
 
 void TriangleFunc::createCommandBuffers()
 {
 	// 为每帧预留一个命令缓冲
-	_commandBuffers.resize(_MAX_FRAMES_IN_FLIGHT);
+	_commandBuffers.resize(_framesInFlight);
 
 	VkCommandBufferAllocateInfo allocInfo{};
 	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -722,9 +2067,7 @@ void TriangleFunc::createCommandBuffers()
 void TriangleFunc::createSyncObjects()
 {
 	// 预分配每帧所需的同步对象
-	_imageAvailableSemaphores.resize(_MAX_FRAMES_IN_FLIGHT);
-	_renderFinishedSemaphores.resize(_MAX_FRAMES_IN_FLIGHT);
-	_inFlightFences.resize(_MAX_FRAMES_IN_FLIGHT);
+	_imageAvailableSemaphores.resize(_framesInFlight);
 
 	// 创建信号量的配置信息
 	VkSemaphoreCreateInfo semaphoreInfo{};
@@ -735,26 +2078,123 @@ void TriangleFunc::createSyncObjects()
 	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
 	fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
+	// 新栅栏处于已触发状态，对应之前的提交都已完成
+	_frameSerials.assign(_framesInFlight, _submitSerial);
+
 	// 为每一帧创建一组同步对象
-	for (size_t i = 0; i < _MAX_FRAMES_IN_FLIGHT; i++) {
-		if (vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &_imageAvailableSemaphores[i]) != VK_SUCCESS
-			|| vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &_renderFinishedSemaphores[i]) != VK_SUCCESS
-			|| vkCreateFence(_device, &fenceInfo, nullptr, &_inFlightFences[i]) != VK_SUCCESS)
-		{
+	for (int i = 0; i < _framesInFlight; i++) {
+		if (vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &_imageAvailableSemaphores[i]) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create synchronization objects for a frame!");
+		}
+	}
+
+	// 时间线模式下所有帧槽位共用图形队列的时间线，初始值为最后一次提交的序号，时钟保持连续
+	if (_timelineSync) {
+		_graphicsTimeline.Init(_device, _submitSerial);
+		return;
+	}
+
+	_inFlightFences.resize(_framesInFlight);
+	for (auto& fence : _inFlightFences) {
+		if (vkCreateFence(_device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
 			throw std::runtime_error("failed to create synchronization objects for a frame!");
 		}
 	}
 }
 
+void TriangleFunc::destroySyncObjects()
+{
+	for (auto semaphore : _imageAvailableSemaphores) {
+		vkDestroySemaphore(_device, semaphore, nullptr);    // 图像可用信号量
+	}
+	for (auto fence : _inFlightFences) {
+		vkDestroyFence(_device, fence, nullptr);            // 同步帧完成栅栏
+	}
+	_imageAvailableSemaphores.clear();
+	_inFlightFences.clear();
+	_graphicsTimeline.Destroy();                            // 图形队列时间线
+}
+
+void TriangleFunc::createPresentSemaphores()
+{
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+
+	_renderFinishedSemaphores.resize(_swapChainImages.size());
+	for (auto& semaphore : _renderFinishedSemaphores) {
+		if (vkCreateSemaphore(_device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create present semaphore!");
+		}
+	}
+}
+
+void TriangleFunc::setFramesInFlight(int count)
+{
+	count = std::clamp(count, 1, AppConfig::kMaxFramesInFlight);
+	if (count == _framesInFlight) {
+		return;
+	}
+
+	vkDeviceWaitIdle(_device);
+
+	// 销毁所有按帧槽位创建的资源
+	destroySyncObjects();
+	vkFreeCommandBuffers(_device, _commandPool, static_cast<uint32_t>(_commandBuffers.size()), _commandBuffers.data());
+	_commandBuffers.clear();
+	releaseCommandCache(false);
+	_gpuProfiler.Destroy();
+	_parallelRecorder.Destroy();
+	_asyncCompute.Destroy();
+	_instanceBuffer.Destroy();
+	cleanupOffscreenTargets();
+
+	_framesInFlight = count;
+	_currentFrame = 0;
+
+	// 按新的帧数重建
+	createOffscreenTargets();
+	createImageViews();
+	createFramebuffers();
+	createCommandBuffers();
+	createSyncObjects();
+	createGpuProfiler();
+	createParallelRecorder();
+	createAsyncCompute();
+	createInstanceBuffer();
+}
+
 void TriangleFunc::drawFrame()
 {
-	// 等待当前帧对应的 Fence，确保上一帧的渲染完成
-	vkWaitForFences(_device, 1, &_inFlightFences[_currentFrame], VK_TRUE, UINT64_MAX);
+	// 支持 present_wait 时先等待较早的帧显示，CPU 不会领先显示太多帧，后面的栅栏等待通常立即返回
+	auto paceStart = std::chrono::steady_clock::now();
+	_presentPacer.BeginFrame(_swapChain);
+	_phaseProfiler.Add(FramePhaseProfiler::Pace, std::chrono::steady_clock::now() - paceStart);
+
+	// 等待当前帧槽位上一次的提交完成，确保上一帧的渲染完成
+	auto waitStart = std::chrono::steady_clock::now();
+	waitForFrame(_currentFrame);
+	auto waitEnd = std::chrono::steady_clock::now();
 
 	// 获取下一张可用于渲染的交换链图像索引
 	uint32_t imageIndex;
 	VkResult result = vkAcquireNextImageKHR(_device, _swapChain, UINT64_MAX, _imageAvailableSemaphores[_currentFrame],
 		VK_NULL_HANDLE, &imageIndex);
+	auto acquireEnd = std::chrono::steady_clock::now();
+
+	_phaseProfiler.Add(FramePhaseProfiler::FenceWait, waitEnd - waitStart);
+	_phaseProfiler.Add(FramePhaseProfiler::Acquire, acquireEnd - waitEnd);
+
+	// 记录 CPU 在栅栏与图像获取上的阻塞时间
+	if (!_config.reportPath.empty()) {
+		_frameStats.AddFenceWait(std::chrono::duration<double, std::milli>(waitEnd - waitStart).count());
+		_frameStats.AddAcquireWait(std::chrono::duration<double, std::milli>(acquireEnd - waitEnd).count());
+	}
+
+	// 栅栏已触发，回读该帧槽位上一次的 GPU 时间戳
+	collectGpuTime(_currentFrame);
+
+	// 该槽位上一次提交及更早的提交都已完成，销毁它们用过的退役交换链对象
+	_deletionQueue.Collect(_frameSerials[_currentFrame]);
 
 	// 如果交换链已过期（窗口大小改变等原因），重新创建交换链并返回
 	if (result == VK_ERROR_OUT_OF_DATE_KHR) {
@@ -765,41 +2205,61 @@ void TriangleFunc::drawFrame()
 		throw std::runtime_error("failed to acquire swap chain image!");
 	}
 
-	// 重置当前帧的 Fence，准备提交新的命令缓冲
-	vkResetFences(_device, 1, &_inFlightFences[_currentFrame]);
+	// 纹理上传先于本帧提交，本帧即可采样刚驻留的纹理
+	if (_textureStreamer.IsValid()) {
+		auto streamStart = std::chrono::steady_clock::now();
+		_textureStreamer.Update(_submitSerial + 1);
+		_phaseProfiler.Add(FramePhaseProfiler::Stream, std::chrono::steady_clock::now() - streamStart);
+	}
 
-	// 重置当前帧对应的命令缓冲区，准备记录新命令
-	vkResetCommandBuffer(_commandBuffers[_currentFrame], 0);
+	// 录制当前渲染目标图像的命令缓冲区，或复用缓存的场景命令缓冲区（只重新录制 ImGui）
+	auto recordStart = std::chrono::steady_clock::now();
+	prepareFrameCommands(imageIndex);
+	auto recordEnd = std::chrono::steady_clock::now();
+	_phaseProfiler.Add(FramePhaseProfiler::Record, recordEnd - recordStart);
 
-	// 记录命令缓冲区，指定当前渲染目标图像索引
-	recordCommandBuffer(_commandBuffers[_currentFrame], imageIndex);
+	// 本帧的模拟先提交到计算队列
+	if (_simulation.IsValid()) {
+		submitSimulation();
+	}
 
-	// 准备提交信息，等待图像可用信号量，保证图像可写
+	// 准备提交信息，等待图像可用信号量，保证图像可写；模拟时还要在顶点输入阶段等待本帧的计算结果
 	VkSubmitInfo submitInfo{};
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-	VkSemaphore waitSemaphores[] = { _imageAvailableSemaphores[_currentFrame] };
-	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
+	VkSemaphore waitSemaphores[] = { _imageAvailableSemaphores[_currentFrame], VK_NULL_HANDLE };
+	VkPipelineStageFlags waitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT };
 	submitInfo.waitSemaphoreCount = 1;
 	submitInfo.pWaitSemaphores = waitSemaphores;
 	submitInfo.pWaitDstStageMask = waitStages;
+	if (_simulation.IsValid()) {
+		waitSemaphores[1] = _asyncCompute.WaitSemaphore();
+		submitInfo.waitSemaphoreCount = 2;
+	}
 
 	// 指定提交的命令缓冲区
-	submitInfo.commandBufferCount = 1;
-	submitInfo.pCommandBuffers = &_commandBuffers[_currentFrame];
+	submitInfo.commandBufferCount = static_cast<uint32_t>(_frameCommandBuffers.size());
+	submitInfo.pCommandBuffers = _frameCommandBuffers.data();
 
-	// 指定信号量，在渲染完成后发出，通知可以呈现
-	VkSemaphore signalSemaphores[] = { _renderFinishedSemaphores[_currentFrame] };
+	// 指定信号量，在渲染完成后发出，通知可以呈现（按图像索引选取，呈现完成前该图像不会再被获取）
+	// 模拟时另外通知计算队列：本帧已读完模拟输出
+	VkSemaphore signalSemaphores[] = { _renderFinishedSemaphores[imageIndex], VK_NULL_HANDLE };
 	submitInfo.signalSemaphoreCount = 1;
 	submitInfo.pSignalSemaphores = signalSemaphores;
+	if (_simulation.IsValid()) {
+		signalSemaphores[1] = _asyncCompute.SignalSemaphore();
+		submitInfo.signalSemaphoreCount = 2;
+	}
 
-	// 提交命令缓冲区到图形队列，并绑定 Fence 以便同步
-	if (vkQueueSubmit(_graphicsQueue, 1, &submitInfo, _inFlightFences[_currentFrame]) != VK_SUCCESS) {
+	// 提交命令缓冲区到图形队列，并触发帧栅栏或时间线
+	if (submitFrame(submitInfo) != VK_SUCCESS) {
 		throw std::runtime_error("failed to submit draw command buffer!");
 	}
+	_phaseProfiler.Add(FramePhaseProfiler::Submit, std::chrono::steady_clock::now() - recordEnd);
 
 	// 准备呈现信息，等待渲染完成信号量，保证图像可读
 	VkPresentInfoKHR presentInfo{};
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
+	presentInfo.pNext = _presentPacer.NextPresentId();    // 不支持 present_wait 时为空
 	presentInfo.waitSemaphoreCount = 1;
 	presentInfo.pWaitSemaphores = signalSemaphores;
 	VkSwapchainKHR swapChains[] = { _swapChain };
@@ -808,11 +2268,14 @@ void TriangleFunc::drawFrame()
 	presentInfo.pImageIndices = &imageIndex;
 
 	// 进行图像呈现操作
+	auto presentStart = std::chrono::steady_clock::now();
 	result = vkQueuePresentKHR(_presentQueue, &presentInfo);
+	_phaseProfiler.Add(FramePhaseProfiler::Present, std::chrono::steady_clock::now() - presentStart);
 
-	// 处理窗口大小改变或交换链子优化问题，重新创建交换链
-	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || _framebufferResized) {
+	// 处理窗口大小改变、交换链子优化或呈现策略切换，重新创建交换链
+	if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR || _framebufferResized || _presentPolicyChanged) {
 		_framebufferResized = false;
+		_presentPolicyChanged = false;
 		recreateSwapChain();
 	}
 	else if (result != VK_SUCCESS) {
@@ -820,7 +2283,143 @@ void TriangleFunc::drawFrame()
 	}
 
 	// 更新当前帧索引，循环使用多帧同步机制
-	_currentFrame = (_currentFrame + 1) % _MAX_FRAMES_IN_FLIGHT;
+	_currentFrame = (_currentFrame + 1) % _framesInFlight;
+}
+
+void TriangleFunc::drawOffscreenFrame()
+{
+	// 等待当前帧槽位上一次提交完成，并记录 CPU 阻塞时间
+	auto waitStart = std::chrono::steady_clock::now();
+	waitForFrame(_currentFrame);
+	auto waitEnd = std::chrono::steady_clock::now();
+	_frameStats.AddFenceWait(std::chrono::duration<double, std::milli>(waitEnd - waitStart).count());
+	_phaseProfiler.Add(FramePhaseProfiler::FenceWait, waitEnd - waitStart);
+
+	// 栅栏已触发，上一次的时间戳一定可读，不会阻塞
+	collectGpuTime(_currentFrame);
+
+	// 销毁该槽位上一次提交及更早的提交用过的对象（如被逐出的纹理）
+	_deletionQueue.Collect(_frameSerials[_currentFrame]);
+
+	auto recordStart = std::chrono::steady_clock::now();
+	if (_textureStreamer.IsValid()) {
+		_textureStreamer.Update(_submitSerial + 1);
+		recordStart = std::chrono::steady_clock::now();
+		_phaseProfiler.Add(FramePhaseProfiler::Stream, recordStart - waitEnd);
+	}
+
+	// 离屏图像与帧槽位一一对应
+	prepareFrameCommands(_currentFrame);
+	auto recordEnd = std::chrono::steady_clock::now();
+	_phaseProfiler.Add(FramePhaseProfiler::Record, recordEnd - recordStart);
+
+	// 没有交换链，只有模拟时需要与计算队列互相等待
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = static_cast<uint32_t>(_frameCommandBuffers.size());
+	submitInfo.pCommandBuffers = _frameCommandBuffers.data();
+
+	VkSemaphore computeDone = VK_NULL_HANDLE;
+	VkSemaphore graphicsDone = VK_NULL_HANDLE;
+	VkPipelineStageFlags computeWaitStage = VK_PIPELINE_STAGE_VERTEX_INPUT_BIT;
+	if (_simulation.IsValid()) {
+		submitSimulation();
+		computeDone = _asyncCompute.WaitSemaphore();
+		graphicsDone = _asyncCompute.SignalSemaphore();
+
+		submitInfo.waitSemaphoreCount = 1;
+		submitInfo.pWaitSemaphores = &computeDone;
+		submitInfo.pWaitDstStageMask = &computeWaitStage;
+		submitInfo.signalSemaphoreCount = 1;
+		submitInfo.pSignalSemaphores = &graphicsDone;
+	}
+
+	if (submitFrame(submitInfo) != VK_SUCCESS) {
+		throw std::runtime_error("failed to submit offscreen command buffer!");
+	}
+	_phaseProfiler.Add(FramePhaseProfiler::Submit, std::chrono::steady_clock::now() - recordEnd);
+
+	_currentFrame = (_currentFrame + 1) % _framesInFlight;
+}
+
+void TriangleFunc::waitForFrame(uint32_t frame)
+{
+	if (_timelineSync) {
+		_graphicsTimeline.Wait(_frameSerials[frame]);
+	}
+	else {
+		vkWaitForFences(_device, 1, &_inFlightFences[frame], VK_TRUE, UINT64_MAX);
+	}
+}
+
+VkResult TriangleFunc::submitFrame(VkSubmitInfo submitInfo)
+{
+	uint64_t serial = _submitSerial + 1;
+
+	if (!_timelineSync) {
+		// 获取图像失败时会提前返回，栅栏推迟到真正提交前才重置，否则下次等待永远不会返回
+		vkResetFences(_device, 1, &_inFlightFences[_currentFrame]);
+		VkResult result = vkQueueSubmit(_graphicsQueue, 1, &submitInfo, _inFlightFences[_currentFrame]);
+		if (result == VK_SUCCESS) {
+			_frameSerials[_currentFrame] = _submitSerial = serial;
+		}
+		return result;
+	}
+
+	// 在调用方的信号量之后追加时间线信号量，二值信号量对应的值被忽略
+	std::array<VkSemaphore, 4> signalSemaphores{};
+	std::array<uint64_t, 4> signalValues{};
+	if (submitInfo.signalSemaphoreCount >= signalSemaphores.size()) {
+		throw std::runtime_error("too many signal semaphores in frame submit!");
+	}
+	std::copy_n(submitInfo.pSignalSemaphores, submitInfo.signalSemaphoreCount, signalSemaphores.begin());
+	signalSemaphores[submitInfo.signalSemaphoreCount] = _graphicsTimeline.Semaphore();
+	signalValues[submitInfo.signalSemaphoreCount] = serial;
+	submitInfo.signalSemaphoreCount++;
+	submitInfo.pSignalSemaphores = signalSemaphores.data();
+
+	// 没有等待时间线信号量，等待值数量可以为 0
+	VkTimelineSemaphoreSubmitInfoKHR timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO_KHR;
+	timelineInfo.pNext = submitInfo.pNext;
+	timelineInfo.signalSemaphoreValueCount = submitInfo.signalSemaphoreCount;
+	timelineInfo.pSignalSemaphoreValues = signalValues.data();
+	submitInfo.pNext = &timelineInfo;
+
+	VkResult result = vkQueueSubmit(_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
+	if (result == VK_SUCCESS) {
+		_frameSerials[_currentFrame] = _submitSerial = serial;
+	}
+	return result;
+}
+
+uint64_t TriangleFunc::completedSerial()
+{
+	if (_timelineSync) {
+		return _graphicsTimeline.CompletedValue();
+	}
+
+	// 栅栏模式下逐个查询帧槽位，已触发的槽位中最大的序号及之前的提交都已完成
+	uint64_t completed = 0;
+	for (size_t i = 0; i < _inFlightFences.size(); i++) {
+		if (vkGetFenceStatus(_device, _inFlightFences[i]) == VK_SUCCESS) {
+			completed = std::max(completed, _frameSerials[i]);
+		}
+	}
+	return completed;
+}
+
+void TriangleFunc::collectGpuTime(uint32_t frame)
+{
+	// 整帧耗时为最外层作用域之和
+	if (_gpuProfiler.Collect(frame) && (_config.headless || !_config.reportPath.empty())) {
+		_frameStats.AddGpuTime(_gpuProfiler.LastFrameMs());
+	}
+
+	// 图形栅栏触发时同一帧的计算一定已完成（图形提交等待了它）
+	if (_simulation.IsValid()) {
+		_asyncCompute.Collect(frame);
+	}
 }
 
 std::vector<std::string> TriangleFunc::checkValidationInstanceExtensions()
@@ -853,15 +2452,32 @@ bool TriangleFunc::isDeviceSuitable(VkPhysicalDevice device)
 {
 	QueueFamilyIndices indices = findQueueFamilies(device);
 
-	bool extensionsSupported = checkDeviceExtensionSupport(device);
+	bool extensionsSupported = checkDeviceExtensionSupport(device);
+
+	// 无头模式不需要交换链
+	bool swapChainAdequate = _config.headless;
+	if (extensionsSupported && !_config.headless) {
+		SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
+		swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
+	}
+
+	return indices.isComplete() && extensionsSupported && swapChainAdequate;
+}
+
+bool TriangleFunc::isDeviceExtensionAvailable(VkPhysicalDevice device, const char* name)
+{
+	uint32_t extensionCount;
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, nullptr);
+
+	std::vector<VkExtensionProperties> availableExtensions(extensionCount);
+	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, availableExtensions.data());
 
-	bool swapChainAdequate = false;
-	if (extensionsSupported) {
-		SwapChainSupportDetails swapChainSupport = querySwapChainSupport(device);
-		swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
+	for (const auto& extension : availableExtensions) {
+		if (strcmp(extension.extensionName, name) == 0) {
+			return true;
+		}
 	}
-
-	return indices.isComplete() && extensionsSupported && swapChainAdequate;
+	return false;
 }
 
 bool TriangleFunc::checkDeviceExtensionSupport(VkPhysicalDevice device)
@@ -941,12 +2557,18 @@ QueueFamilyIndices TriangleFunc::findQueueFamilies(VkPhysicalDevice device)
 			indices.graphicsFamily = i;
 		}
 
-		// 检查是否支持将图像呈现到指定 surface
-		VkBool32 presentSupport = false;
-		vkGetPhysicalDeviceSurfaceSupportKHR(device, i, _surface, &presentSupport);
+		// 无头模式没有 surface，呈现队列族沿用图形队列族
+		if (_config.headless) {
+			indices.presentFamily = indices.graphicsFamily;
+		}
+		else {
+			// 检查是否支持将图像呈现到指定 surface
+			VkBool32 presentSupport = false;
+			vkGetPhysicalDeviceSurfaceSupportKHR(device, i, _surface, &presentSupport);
 
-		if (presentSupport) {
-			indices.presentFamily = i;
+			if (presentSupport) {
+				indices.presentFamily = i;
+			}
 		}
 
 		// 如果都找到了，提前结束搜索
@@ -956,6 +2578,30 @@ QueueFamilyIndices TriangleFunc::findQueueFamilies(VkPhysicalDevice device)
 
 		i++;
 	}
+
+	// 异步计算队列族：优先不支持图形的专用计算队列族，其次是图形队列族以外的任意计算队列族
+	for (uint32_t family = 0; family < queueFamilyCount; family++) {
+		VkQueueFlags flags = queueFamilies[family].queueFlags;
+		if (!(flags & VK_QUEUE_COMPUTE_BIT) || (indices.graphicsFamily.has_value() && family == indices.graphicsFamily.value())) {
+			continue;
+		}
+		if (!(flags & VK_QUEUE_GRAPHICS_BIT)) {
+			indices.computeFamily = family;
+			break;
+		}
+		if (!indices.computeFamily.has_value()) {
+			indices.computeFamily = family;
+		}
+	}
+
+	// 专用传输队列族：只支持传输（DMA 引擎），复制与图形、计算工作并行
+	for (uint32_t family = 0; family < queueFamilyCount; family++) {
+		VkQueueFlags flags = queueFamilies[family].queueFlags;
+		if ((flags & VK_QUEUE_TRANSFER_BIT) && !(flags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT))) {
+			indices.transferFamily = family;
+			break;
+		}
+	}
 	return indices;
 }
 
@@ -1005,14 +2651,7 @@ VkSurfaceFormatKHR TriangleFunc::chooseSwapSurfaceFormat(const std::vector<VkSur
 
 VkPresentModeKHR TriangleFunc::chooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes)
 {
-	for (const auto& availablePresentMode : availablePresentModes) {
-		if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
-			return availablePresentMode;
-		}
-	}
-
-	// 所有 Vulkan 设备都必须支持 FIFO 模式
-	return VK_PRESENT_MODE_FIFO_KHR;
+	return PresentPacer::ChooseMode(_presentPacer.CurrentPolicy(), availablePresentModes);
 }
 
 VkExtent2D TriangleFunc::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities)
@@ -1039,60 +2678,272 @@ VkExtent2D TriangleFunc::chooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabi
 	}
 }
 
-std::vector<char> TriangleFunc::readFile(const std::string& filename)
+UploadQueue::Ticket TriangleFunc::uploadDeviceLocalBuffers(const std::vector<BufferUpload>& uploads)
+{
+	// 创建设备本地的目标缓冲，数据经上传队列的暂存环复制
+	for (const auto& upload : uploads) {
+		_allocator.CreateBuffer(upload.size, upload.usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+			*upload.buffer, *upload.allocation);
+		_uploadQueue.UploadBuffer(*upload.buffer, 0, upload.data, upload.size);
+	}
+
+	// 整批提交一次，不等待；图形队列上之后的帧在获取屏障之后执行
+	return _uploadQueue.Flush();
+}
+
+MeshBuffers TriangleFunc::createHostVisibleMesh()
+{
+	MeshBuffers mesh;
+	VkMemoryPropertyFlags hostVisible = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+
+	VkDeviceSize vertexSize = sizeof(_meshVertices[0]) * _meshVertices.size();
+	_allocator.CreateBuffer(vertexSize, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, hostVisible, mesh.vertexBuffer, mesh.vertexAlloc);
+
+	VkDeviceSize indexSize = sizeof(_meshIndices[0]) * _meshIndices.size();
+	_allocator.CreateBuffer(indexSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, hostVisible, mesh.indexBuffer, mesh.indexAlloc);
+
+	// 直接写入持久映射的内存，不经过暂存缓冲
+	memcpy(mesh.vertexAlloc.mapped, _meshVertices.data(), static_cast<size_t>(vertexSize));
+	memcpy(mesh.indexAlloc.mapped, _meshIndices.data(), static_cast<size_t>(indexSize));
+
+	mesh.indexCount = static_cast<uint32_t>(_meshIndices.size());
+	return mesh;
+}
+
+void TriangleFunc::destroyMeshBuffers(MeshBuffers& mesh)
+{
+	_allocator.DestroyBuffer(mesh.vertexBuffer, mesh.vertexAlloc);
+	_allocator.DestroyBuffer(mesh.indexBuffer, mesh.indexAlloc);
+	mesh = MeshBuffers();
+}
+
+void TriangleFunc::generateGridMesh(uint32_t n, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices)
+{
+	vertices.clear();
+	indices.clear();
+	vertices.reserve(static_cast<size_t>(n + 1) * (n + 1));
+	indices.reserve(static_cast<size_t>(n) * n * 6);
+
+	// 顶点覆盖 NDC [-1, 1]，颜色随位置渐变
+	for (uint32_t y = 0; y <= n; y++) {
+		for (uint32_t x = 0; x <= n; x++) {
+			float u = static_cast<float>(x) / n;
+			float v = static_cast<float>(y) / n;
+			vertices.push_back({ {u * 2.0f - 1.0f, v * 2.0f - 1.0f}, {u, v, 1.0f - u} });
+		}
+	}
+
+	// 每个四边形两个三角形，屏幕空间顺时针（与管线 FRONT_FACE_CLOCKWISE 一致）
+	for (uint32_t y = 0; y < n; y++) {
+		for (uint32_t x = 0; x < n; x++) {
+			uint32_t topLeft = y * (n + 1) + x;
+			uint32_t topRight = topLeft + 1;
+			uint32_t bottomLeft = topLeft + n + 1;
+			uint32_t bottomRight = bottomLeft + 1;
+
+			indices.insert(indices.end(), { topLeft, topRight, bottomRight, topLeft, bottomRight, bottomLeft });
+		}
+	}
+}
+
+void TriangleFunc::prepareFrameCommands(uint32_t imageIndex)
 {
-	// 以二进制 + 光标定位到末尾（以便直接获取文件大小）
-	std::ifstream file(filename, std::ios::ate | std::ios::binary);
+	// 本帧的场景 uniform 与绑定偏移，录制线程只读取；每个帧槽位的第一个切片总在分区开头，
+	// 缓存的命令缓冲中记录的动态偏移保持有效，改变 uniform 内容不需要重新录制
+	writeSceneUniforms();
+
+	// 当前变体尚未编译完成时用通用管线绘制；在主线程确定，录制线程只读取结果
+	PipelineVariant generic;
+	generic.instanced = _instanceCount > 0;
+	_pipelineVariant.instanced = generic.instanced;
+	_scenePipeline = generic.instanced ? _instancedPipeline : _graphicsPipeline;
+	if (_pipelineVariant.Key() != generic.Key()) {
+		VkPipeline variantPipeline = _pipelineManager.Get(_pipelineVariant.Key(), VK_NULL_HANDLE);
+		if (variantPipeline != VK_NULL_HANDLE) {
+			_scenePipeline = variantPipeline;
+		}
+		else {
+			_pipelineFallbacks++;
+		}
+	}
+
+	_frameCommandBuffers.clear();
+	VkCommandBuffer frameBuffer = _commandBuffers[_currentFrame];
+
+	if (!commandCacheUsable()) {
+		vkResetCommandBuffer(frameBuffer, 0);
+		recordCommandBuffer(frameBuffer, imageIndex, false);
+		_frameCommandBuffers.push_back(frameBuffer);
+		return;
+	}
+
+	// 场景管线与背景色被直接修改时没有经过 invalidateCommandCache()，在这里比较
+	if (_scenePipeline != _cachedScenePipeline || _backColor != _cachedBackColor) {
+		_cachedScenePipeline = _scenePipeline;
+		_cachedBackColor = _backColor;
+		invalidateCommandCache();
+	}
+
+	// 首次使用时按当前的帧数与图像数分配；两者变化时缓存已被释放
+	uint32_t imageCount = static_cast<uint32_t>(_swapChainImages.size());
+	if (_commandCache.empty()) {
+		std::vector<VkCommandBuffer> buffers(static_cast<size_t>(_framesInFlight) * imageCount);
+
+		VkCommandBufferAllocateInfo allocInfo{};
+		allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocInfo.commandPool = _commandPool;
+		allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocInfo.commandBufferCount = static_cast<uint32_t>(buffers.size());
+
+		if (vkAllocateCommandBuffers(_device, &allocInfo, buffers.data()) != VK_SUCCESS) {
+			throw std::runtime_error("failed to allocate command buffers!");
+		}
+
+		_commandCache.resize(buffers.size());
+		for (size_t i = 0; i < buffers.size(); i++) {
+			_commandCache[i].buffer = buffers[i];
+		}
+	}
+
+	// 按帧槽位区分：该槽位的栅栏已触发，缓存的命令缓冲不会仍在执行，时间戳查询与环形缓冲分区也与槽位对应
+	CachedCommandBuffer& cached = _commandCache[static_cast<size_t>(_currentFrame) * imageCount + imageIndex];
+	if (cached.version == _commandVersion) {
+		_gpuProfiler.ReplayFrame(_currentFrame);
+		_commandCacheHits++;
+	}
+	else {
+		// 首次上传实例数据等一次性命令不能重复执行，录制后立即标记为过期
+		bool oneShot = _instanceBuffer.IsValid() && _instanceBuffer.HasPendingUpload();
 
-	if (!file.is_open()) {
-		throw std::runtime_error("shader文件打开失败!");
+		vkResetCommandBuffer(cached.buffer, 0);
+		recordCommandBuffer(cached.buffer, imageIndex, true);
+		cached.version = oneShot ? 0 : _commandVersion;
+		_commandCacheRecords++;
 	}
+	_frameCommandBuffers.push_back(cached.buffer);
 
-	// 获取文件大小（光标当前位置即为文件末尾）
-	size_t fileSize = static_cast<size_t>(file.tellg());
+	// ImGui 每帧都在变化，单独录制到该帧槽位的命令缓冲中，在场景之后提交
+	if (!_config.headless) {
+		vkResetCommandBuffer(frameBuffer, 0);
+		recordOverlay(frameBuffer, imageIndex);
+		_frameCommandBuffers.push_back(frameBuffer);
+	}
+}
+
+bool TriangleFunc::commandCacheUsable() const
+{
+	return _cacheCommands && commandCacheBlocker() == nullptr;
+}
 
-	// 分配缓冲区并读取文件内容
-	std::vector<char> buffer(fileSize);
-	file.seekg(0);                         // 重置读指针到文件开头
-	file.read(buffer.data(), fileSize);    // 读取所有内容到 buffer
+const char* TriangleFunc::commandCacheBlocker() const
+{
+	if (_renderGraphEnabled) {
+		return u8"渲染图每帧重新声明并录制";
+	}
+	if (_simulation.IsValid()) {
+		return u8"实例运动每帧模拟，逐帧录制";
+	}
+	if (_instanceUpdatesPerFrame > 0) {
+		return u8"实例数据每帧变化，逐帧录制";
+	}
+	return nullptr;
+}
 
-	file.close();
-	return buffer;
+void TriangleFunc::invalidateCommandCache()
+{
+	_commandVersion++;
 }
 
-VkShaderModule TriangleFunc::createShaderModule(const std::vector<char>& code)
+void TriangleFunc::releaseCommandCache(bool deferred)
 {
-	// 设置着色器模块创建信息
-	VkShaderModuleCreateInfo createInfo{};
-	createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-	createInfo.codeSize = code.size();                                     // 字节大小
-	createInfo.pCode = reinterpret_cast<const uint32_t*>(code.data());    // 注意对齐
+	if (_commandCache.empty()) {
+		return;
+	}
 
-	VkShaderModule shaderModule;
+	std::vector<VkCommandBuffer> buffers;
+	buffers.reserve(_commandCache.size());
+	for (const auto& cached : _commandCache) {
+		buffers.push_back(cached.buffer);
+	}
+	_commandCache.clear();
 
-	// 创建着色器模块
-	if (vkCreateShaderModule(_device, &createInfo, nullptr, &shaderModule) != VK_SUCCESS) {
-		throw std::runtime_error("failed to create shader module!");
+	if (!deferred) {
+		vkFreeCommandBuffers(_device, _commandPool, static_cast<uint32_t>(buffers.size()), buffers.data());
+		return;
 	}
 
-	return shaderModule;
+	// 已提交的帧可能仍在执行缓存的命令缓冲，全部完成后再释放
+	_deletionQueue.Push(_submitSerial, [this, buffers]() {
+		vkFreeCommandBuffers(_device, _commandPool, static_cast<uint32_t>(buffers.size()), buffers.data());
+	});
 }
 
-uint32_t TriangleFunc::findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
+void TriangleFunc::recordOverlay(VkCommandBuffer commandBuffer, uint32_t imageIndex)
 {
-	VkPhysicalDeviceMemoryProperties memProperties;
-	vkGetPhysicalDeviceMemoryProperties(_physicalDevice, &memProperties);
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 
-	for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-		if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-			return i;
-		}
+	if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+		throw std::runtime_error("failed to begin recording command buffer!");
 	}
 
-	throw std::runtime_error("failed to find suitable memory type!");
+	if (!_dynamicRendering) {
+		// 叠加层渲染通道以 LOAD 保留场景内容，不需要清除值
+		VkRenderPassBeginInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassInfo.renderPass = _overlayRenderPass;
+		renderPassInfo.framebuffer = _swapChainFramebuffers[imageIndex];
+		renderPassInfo.renderArea.offset = { 0, 0 };
+		renderPassInfo.renderArea.extent = _swapChainExtent;
+
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+	}
+	else {
+		// 场景命令已把图像转换到呈现布局，这里转换回来并保留内容；等待场景的颜色写入完成
+		VkImageMemoryBarrier barrier{};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		barrier.oldLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = _swapChainImages[imageIndex];
+		barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		barrier.subresourceRange.levelCount = 1;
+		barrier.subresourceRange.layerCount = 1;
+		vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0,
+			0, nullptr, 0, nullptr, 1, &barrier);
+
+		VkRenderingAttachmentInfoKHR colorAttachment{};
+		colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+		colorAttachment.imageView = _swapChainImageViews[imageIndex];
+		colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+		colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+
+		VkRenderingInfoKHR renderingInfo{};
+		renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+		renderingInfo.renderArea.offset = { 0, 0 };
+		renderingInfo.renderArea.extent = _swapChainExtent;
+		renderingInfo.layerCount = 1;
+		renderingInfo.colorAttachmentCount = 1;
+		renderingInfo.pColorAttachments = &colorAttachment;
+
+		_cmdBeginRendering(commandBuffer, &renderingInfo);
+	}
+
+	renderImGui(commandBuffer);
+
+	// 结束渲染并转换到呈现布局，与场景命令的结尾相同
+	endSceneRendering(commandBuffer, imageIndex);
+
+	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to record command buffer!");
+	}
 }
 
-void TriangleFunc::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+void TriangleFunc::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex, bool cacheable)
 {
 	VkCommandBufferBeginInfo beginInfo{};
 	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -1101,20 +2952,308 @@ void TriangleFunc::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t i
 		throw std::runtime_error("failed to begin recording command buffer!");
 	}
 
-	VkRenderPassBeginInfo renderPassInfo{};
-	renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-	renderPassInfo.renderPass = _renderPass;
-	renderPassInfo.framebuffer = _swapChainFramebuffers[imageIndex];
-	renderPassInfo.renderArea.offset = { 0, 0 };
-	renderPassInfo.renderArea.extent = _swapChainExtent;
+	// 重置当前帧槽位的时间戳查询（必须在渲染通道之外），并开始整帧计时
+	_gpuProfiler.BeginFrame(commandBuffer, _currentFrame);
+	_gpuProfiler.BeginScope(commandBuffer, "frame");
+
+	// 实例数据的增量上传（必须在渲染通道之外）；模拟时实例运动由计算着色器完成
+	if (_instanceBuffer.IsValid() && !_simulate) {
+		animateInstances();
+		_instanceBuffer.RecordUpload(commandBuffer, _currentFrame);
+	}
+
+	// 模拟时绘制本帧计算写入的输出缓冲，先从计算队列族获取其所有权
+	if (_simulation.IsValid()) {
+		_simOutput = static_cast<uint32_t>(_asyncCompute.NextSubmission() % InstanceSimulation::kOutputCount);
+		_asyncCompute.RecordAcquire(commandBuffer, _simulation.Output(_simOutput), VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+			VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT);
+	}
+
+	// GPU 驱动：计算着色器剔除并生成间接绘制命令（必须在渲染通道之外）
+	if (_gpuDriven) {
+		GpuProfiler::Scope scope(_gpuProfiler, commandBuffer, "cull");
+		_gpuCuller.RecordCull(commandBuffer, _cullRect, _mesh.indexCount, _meshRadius);
+	}
+
+	// 渲染图模式：场景、模糊链与 ImGui 都是图中的通道，屏障由渲染图推导；以上各模块的命令自带同步
+	if (_renderGraphEnabled) {
+		{
+			GpuProfiler::Scope scope(_gpuProfiler, commandBuffer, "render graph");
+			recordFrameGraph(commandBuffer, imageIndex);
+		}
+		_gpuProfiler.EndScope(commandBuffer);    // frame
+
+		if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+			throw std::runtime_error("failed to record command buffer!");
+		}
+		return;
+	}
+
+	_gpuProfiler.BeginScope(commandBuffer, "render pass");
+
+	if (_parallelRecorder.IsEnabled() && !cacheable) {
+		// 子通道内容全部来自次级命令缓冲，主命令缓冲中只能执行 vkCmdExecuteCommands，
+		// 因此这里没有 "scene draw" 与 "imgui" 计时作用域
+		beginSceneRendering(commandBuffer, imageIndex, true);
+
+		// 动态渲染模式下没有渲染通道与帧缓冲，次级命令缓冲改为继承附件格式
+		VkCommandBufferInheritanceRenderingInfoKHR inheritanceRendering{};
+		inheritanceRendering.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR;
+		inheritanceRendering.flags = VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR;
+		inheritanceRendering.colorAttachmentCount = 1;
+		inheritanceRendering.pColorAttachmentFormats = &_swapChainImageFormat;
+		inheritanceRendering.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+		VkCommandBufferInheritanceInfo inheritance{};
+		inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+		inheritance.pNext = _dynamicRendering ? &inheritanceRendering : nullptr;
+		inheritance.renderPass = _renderPass;
+		inheritance.subpass = 0;
+		inheritance.framebuffer = _dynamicRendering ? VK_NULL_HANDLE : _swapChainFramebuffers[imageIndex];
+
+		// 工作线程录制场景绘制的同时，主线程录制 ImGui（ImGui 不是线程安全的）
+		_parallelRecorder.Begin(_currentFrame, inheritance, sceneItemCount(),
+			[this](VkCommandBuffer secondary, uint32_t first, uint32_t count) {
+				recordSceneDraws(secondary, first, count);
+			});
+
+		VkCommandBuffer imguiBuffer = VK_NULL_HANDLE;
+		if (!_config.headless) {
+			imguiBuffer = _parallelRecorder.BeginMainSecondary(_currentFrame, inheritance);
+			renderImGui(imguiBuffer);
+			if (vkEndCommandBuffer(imguiBuffer) != VK_SUCCESS) {
+				throw std::runtime_error("failed to record secondary command buffer!");
+			}
+		}
+
+		const std::vector<VkCommandBuffer>& sceneBuffers = _parallelRecorder.Wait();
+		if (!sceneBuffers.empty()) {
+			vkCmdExecuteCommands(commandBuffer, static_cast<uint32_t>(sceneBuffers.size()), sceneBuffers.data());
+		}
+		if (imguiBuffer != VK_NULL_HANDLE) {
+			vkCmdExecuteCommands(commandBuffer, 1, &imguiBuffer);
+		}
+	}
+	else {
+		beginSceneRendering(commandBuffer, imageIndex, false);
+
+		{
+			GpuProfiler::Scope scope(_gpuProfiler, commandBuffer, "scene draw");
+			recordSceneDraws(commandBuffer, 0, sceneItemCount());
+		}
+
+		// 无头模式没有 ImGui；缓存的场景命令不含 ImGui，由 recordOverlay() 每帧单独录制
+		if (!_config.headless && !cacheable) {
+			GpuProfiler::Scope scope(_gpuProfiler, commandBuffer, "imgui");
+			renderImGui(commandBuffer);
+		}
+	}
+
+	endSceneRendering(commandBuffer, imageIndex);
+	_gpuProfiler.EndScope(commandBuffer);    // render pass
+	_gpuProfiler.EndScope(commandBuffer);    // frame
+
+	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to record command buffer!");
+	}
+}
 
+void TriangleFunc::beginSceneRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex, bool secondary)
+{
 	VkClearValue clearColor = { {{_backColor.x,_backColor.y,_backColor.z, 1.0f}} };
-	renderPassInfo.clearValueCount = 1;
-	renderPassInfo.pClearValues = &clearColor;
 
-	vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+	if (!_dynamicRendering) {
+		VkRenderPassBeginInfo renderPassInfo{};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassInfo.renderPass = _renderPass;
+		renderPassInfo.framebuffer = _swapChainFramebuffers[imageIndex];
+		renderPassInfo.renderArea.offset = { 0, 0 };
+		renderPassInfo.renderArea.extent = _swapChainExtent;
+		renderPassInfo.clearValueCount = 1;
+		renderPassInfo.pClearValues = &clearColor;
+
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, secondary ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE);
+		return;
+	}
+
+	// 渲染通道的 initialLayout = UNDEFINED 由屏障代替：内容被清除，不需要保留；
+	// 源阶段与获取图像信号量的等待阶段一致，保证在图像可用之后才转换布局
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = 0;
+	barrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	barrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = _swapChainImages[imageIndex];
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.layerCount = 1;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &barrier);
+
+	VkRenderingAttachmentInfoKHR colorAttachment{};
+	colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+	colorAttachment.imageView = _swapChainImageViews[imageIndex];
+	colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	colorAttachment.clearValue = clearColor;
+
+	VkRenderingInfoKHR renderingInfo{};
+	renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+	renderingInfo.flags = secondary ? VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT_KHR : 0;
+	renderingInfo.renderArea.offset = { 0, 0 };
+	renderingInfo.renderArea.extent = _swapChainExtent;
+	renderingInfo.layerCount = 1;
+	renderingInfo.colorAttachmentCount = 1;
+	renderingInfo.pColorAttachments = &colorAttachment;
+
+	_cmdBeginRendering(commandBuffer, &renderingInfo);
+}
+
+void TriangleFunc::endSceneRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
+	if (!_dynamicRendering) {
+		vkCmdEndRenderPass(commandBuffer);
+		return;
+	}
+
+	_cmdEndRendering(commandBuffer);
+
+	// 对应渲染通道的 finalLayout：呈现到屏幕；无头模式下转换为传输源布局，便于回读
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+	barrier.dstAccessMask = 0;
+	barrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	barrier.newLayout = _config.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = _swapChainImages[imageIndex];
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.layerCount = 1;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, 0,
+		0, nullptr, 0, nullptr, 1, &barrier);
+}
+
+void TriangleFunc::recordFrameGraph(VkCommandBuffer commandBuffer, uint32_t imageIndex)
+{
+	_renderGraph.Reset();
+
+	// 交换链图像在获取图像信号量的等待阶段之后可用，结束时转换到呈现布局；无头模式转换为传输源布局，便于回读
+	RenderGraph::ExternalState acquired;
+	acquired.layout = VK_IMAGE_LAYOUT_UNDEFINED;
+	acquired.stages = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT_KHR;
+
+	RenderGraph::ExternalState present;
+	present.layout = _config.headless ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+	present.stages = VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT_KHR;
+
+	RenderGraph::Resource backbuffer = _renderGraph.ImportImage("backbuffer", _swapChainImages[imageIndex], _swapChainImageViews[imageIndex],
+		_swapChainImageFormat, _swapChainExtent, acquired, present);
+
+	// 没有模糊时场景直接渲染到交换链图像，否则先渲染到瞬态图像
+	RenderGraph::Resource sceneColor = _blurLevels > 0
+		? _renderGraph.CreateImage("scene color", _swapChainImageFormat, _swapChainExtent)
+		: backbuffer;
+
+	RenderGraph::Pass scene = _renderGraph.AddPass("scene", [this, sceneColor](VkCommandBuffer cmd) {
+		beginGraphRendering(cmd, _renderGraph.View(sceneColor), _swapChainExtent, true);
+		{
+			GpuProfiler::Scope scope(_gpuProfiler, cmd, "scene draw");
+			recordSceneDraws(cmd, 0, sceneItemCount());
+		}
+		_cmdEndRendering(cmd);
+	});
+	RenderGraph::Resource color = _renderGraph.Write(scene, sceneColor, RenderGraph::Access::ColorAttachment);
+
+	// 模糊链：逐级减半，再逐级放大回上一级的尺寸，最后一级直接写入交换链图像。
+	// 每个中间图像只在相邻两个通道中使用，生命周期不重叠的图像由渲染图分配到同一块显存
+	std::vector<VkExtent2D> extents = { _swapChainExtent };
+	for (int level = 1; level <= _blurLevels; level++) {
+		VkExtent2D extent = { std::max(1u, extents.back().width / 2), std::max(1u, extents.back().height / 2) };
+		extents.push_back(extent);
+
+		RenderGraph::Resource target = _renderGraph.CreateImage("blur down " + std::to_string(level), _swapChainImageFormat, extent);
+		color = addBlitPass("downsample " + std::to_string(level), color, target);
+	}
+	for (int level = _blurLevels - 1; level >= 0; level--) {
+		RenderGraph::Resource target = level == 0
+			? backbuffer
+			: _renderGraph.CreateImage("blur up " + std::to_string(level), _swapChainImageFormat, extents[level]);
+		color = addBlitPass("upsample " + std::to_string(level), color, target);
+	}
+
+	// ImGui 保留下面的内容，绘制在最终图像之上（无头模式没有 ImGui）
+	if (!_config.headless) {
+		RenderGraph::Pass overlay = _renderGraph.AddPass("imgui", [this, backbuffer](VkCommandBuffer cmd) {
+			beginGraphRendering(cmd, _renderGraph.View(backbuffer), _swapChainExtent, false);
+			{
+				GpuProfiler::Scope scope(_gpuProfiler, cmd, "imgui");
+				renderImGui(cmd);
+			}
+			_cmdEndRendering(cmd);
+		});
+		color = _renderGraph.Write(overlay, color, RenderGraph::Access::ColorAttachment);
+	}
+
+	// 尺寸变化时旧的瞬态图像可能仍被已提交的帧使用，在最后一次提交完成后销毁
+	_renderGraph.Output(color);
+	_renderGraph.Compile(_submitSerial);
+	_renderGraph.Execute(commandBuffer);
+}
+
+void TriangleFunc::beginGraphRendering(VkCommandBuffer commandBuffer, VkImageView view, VkExtent2D extent, bool clear)
+{
+	VkRenderingAttachmentInfoKHR colorAttachment{};
+	colorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO_KHR;
+	colorAttachment.imageView = view;
+	colorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+	colorAttachment.loadOp = clear ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
+	colorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+	colorAttachment.clearValue = { {{_backColor.x, _backColor.y, _backColor.z, 1.0f}} };
+
+	VkRenderingInfoKHR renderingInfo{};
+	renderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO_KHR;
+	renderingInfo.renderArea.offset = { 0, 0 };
+	renderingInfo.renderArea.extent = extent;
+	renderingInfo.layerCount = 1;
+	renderingInfo.colorAttachmentCount = 1;
+	renderingInfo.pColorAttachments = &colorAttachment;
+
+	_cmdBeginRendering(commandBuffer, &renderingInfo);
+}
+
+RenderGraph::Resource TriangleFunc::addBlitPass(const std::string& name, RenderGraph::Resource source, RenderGraph::Resource target)
+{
+	RenderGraph::Pass pass = _renderGraph.AddPass(name, [this, source, target](VkCommandBuffer cmd) {
+		VkExtent2D srcExtent = _renderGraph.Extent(source);
+		VkExtent2D dstExtent = _renderGraph.Extent(target);
+
+		VkImageBlit blit{};
+		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.srcSubresource.layerCount = 1;
+		blit.srcOffsets[1] = { static_cast<int32_t>(srcExtent.width), static_cast<int32_t>(srcExtent.height), 1 };
+		blit.dstSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.dstSubresource.layerCount = 1;
+		blit.dstOffsets[1] = { static_cast<int32_t>(dstExtent.width), static_cast<int32_t>(dstExtent.height), 1 };
+
+		vkCmdBlitImage(cmd, _renderGraph.Image(source), VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, _renderGraph.Image(target),
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &blit, VK_FILTER_LINEAR);
+	});
+	_renderGraph.Read(pass, source, RenderGraph::Access::TransferSrc);
+	return _renderGraph.Write(pass, target, RenderGraph::Access::TransferDst);
+}
 
-	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _graphicsPipeline);
+void TriangleFunc::recordSceneDraws(VkCommandBuffer commandBuffer, uint32_t first, uint32_t count)
+{
+	bool instanced = _instanceCount > 0;
+	vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _scenePipeline);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, _pipelineLayout, 0, 1, &_sceneDescriptorSet,
+		1, &_sceneUniformOffset);
 
 	VkViewport viewport{};
 	viewport.x = 0.0f;
@@ -1130,18 +3269,36 @@ void TriangleFunc::recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t i
 	scissor.extent = _swapChainExtent;
 	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-	VkBuffer vertexBuffers[] = { _vertexBuffer };
+	VkBuffer vertexBuffers[] = { _mesh.vertexBuffer };
 	VkDeviceSize offsets[] = { 0 };
 	vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
+	vkCmdBindIndexBuffer(commandBuffer, _mesh.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
 
-	vkCmdDraw(commandBuffer, static_cast<uint32_t>(vertices.size()), 1, 0, 0);
-
-	renderImGui(commandBuffer);
+	if (!instanced) {
+		for (uint32_t i = first; i < first + count; i++) {
+			vkCmdDrawIndexed(commandBuffer, _drawList[i].indexCount, 1, _drawList[i].firstIndex, 0, 0);
+		}
+		return;
+	}
 
-	vkCmdEndRenderPass(commandBuffer);
+	// 实例数据作为绑定 1，按实例步进；模拟时改用计算着色器的输出
+	VkBuffer instanceBuffers[] = { _simulation.IsValid() ? _simulation.Output(_simOutput) : _instanceBuffer.Buffer() };
+	vkCmdBindVertexBuffers(commandBuffer, 1, 1, instanceBuffers, offsets);
 
-	if (vkEndCommandBuffer(commandBuffer) != VK_SUCCESS) {
-		throw std::runtime_error("failed to record command buffer!");
+	if (_gpuDriven) {
+		// 剔除结果驱动的间接绘制，CPU 开销与对象数量无关
+		_gpuCuller.RecordDraw(commandBuffer);
+	}
+	else if (_instancePerObject) {
+		// 逐对象绘制：CPU 逐个剔除，每次一个实例，由 firstInstance 选择实例数据
+		for (uint32_t i = first; i < first + count; i++) {
+			if (isInstanceVisible(i)) {
+				vkCmdDrawIndexed(commandBuffer, _mesh.indexCount, 1, 0, 0, i);
+			}
+		}
+	}
+	else {
+		vkCmdDrawIndexed(commandBuffer, _mesh.indexCount, _instanceBuffer.Count(), 0, 0, 0);
 	}
 }
 
@@ -1149,45 +3306,92 @@ void TriangleFunc::framebufferResizeCallback(GLFWwindow* window, int width, int
 {
 	auto app = reinterpret_cast<TriangleFunc*>(glfwGetWindowUserPointer(window));    // 获取绑定的应用实例指针
 	app->_framebufferResized = true;    // 标记帧缓冲已被调整大小，延迟处理重建交换链
+	app->requestRedraw(kInputRedrawFrames);
 }
 
-void TriangleFunc::recreateSwapChain()
+void TriangleFunc::inputEventCallback(GLFWwindow* window)
 {
-	int width = 0, height = 0;
-	glfwGetFramebufferSize(_window, &width, &height);
+	auto app = reinterpret_cast<TriangleFunc*>(glfwGetWindowUserPointer(window));
+	app->requestRedraw(kInputRedrawFrames);
+}
 
-	// 当窗口被最小化时（宽或高为0），等待直到用户恢复窗口
-	while (width == 0 || height == 0) {
-		glfwGetFramebufferSize(_window, &width, &height);
-		glfwWaitEvents();    // 等待事件（例如窗口恢复）
+void TriangleFunc::recreateSwapChain()
+{
+	// 当窗口被最小化时（宽或高为0），阻塞等待直到用户恢复窗口；等待期间窗口被关闭则不再重建，主循环随后退出
+	waitWhileMinimized();
+	if (windowMinimized()) {
+		return;
 	}
 
-	vkDeviceWaitIdle(_device);    // 确保 GPU 不再使用旧的交换链资源
+	// 最小化等待不计入重建耗时
+	auto recreateStart = std::chrono::steady_clock::now();
+
+	// 旧对象可能仍被在途帧使用，先取出，新交换链创建后再交给延迟销毁队列
+	VkSwapchainKHR oldSwapChain = _swapChain;
+	std::vector<VkImageView> oldImageViews;
+	std::vector<VkFramebuffer> oldFramebuffers;
+	std::vector<VkSemaphore> oldSemaphores;
+	oldImageViews.swap(_swapChainImageViews);
+	oldFramebuffers.swap(_swapChainFramebuffers);
+	oldSemaphores.swap(_renderFinishedSemaphores);
 
-	cleanupSwapChain();    // 销毁旧的交换链相关资源
+	createSwapChain();            // 以旧交换链为 oldSwapchain 重新创建交换链
+	createImageViews();           // 重新创建图像视图
+	createFramebuffers();         // 重新创建帧缓冲（动态渲染模式下没有帧缓冲）
+	createPresentSemaphores();    // 重新创建按图像的渲染完成信号量
+
+	// 缓存的命令缓冲引用旧的帧缓冲与图像，图像数也可能变化，随旧对象一起延迟释放
+	releaseCommandCache(true);
+
+	// 已提交的帧全部完成后再销毁，不需要 vkDeviceWaitIdle
+	_deletionQueue.Push(_submitSerial, [this, oldSwapChain, oldImageViews, oldFramebuffers, oldSemaphores]() {
+		destroySwapChainObjects(oldSwapChain, oldImageViews, oldFramebuffers, oldSemaphores);
+	});
+
+	_phaseProfiler.Add(FramePhaseProfiler::Recreate, std::chrono::steady_clock::now() - recreateStart);
+}
+
+void TriangleFunc::setPresentPolicy(PresentPacer::Policy policy)
+{
+	if (policy == _presentPacer.CurrentPolicy()) {
+		return;
+	}
 
-	createSwapChain();       // 重新创建交换链
-	createImageViews();      // 重新创建图像视图
-	createFramebuffers();    // 重新创建帧缓冲
+	// 重建不等待设备空闲，旧交换链交给延迟销毁队列，切换几乎没有卡顿
+	_presentPacer.SetPolicy(policy);
+	_presentPolicyChanged = true;
 }
 
 void TriangleFunc::cleanupSwapChain()
+{
+	destroySwapChainObjects(_swapChain, _swapChainImageViews, _swapChainFramebuffers, _renderFinishedSemaphores);
+
+	_swapChainFramebuffers.clear();       // 清空帧缓冲列表
+	_swapChainImageViews.clear();         // 清空图像视图列表
+	_swapChain = VK_NULL_HANDLE;          // 标记交换链为空，避免误用
+	_renderFinishedSemaphores.clear();
+}
+
+void TriangleFunc::destroySwapChainObjects(VkSwapchainKHR swapChain, const std::vector<VkImageView>& imageViews,
+	const std::vector<VkFramebuffer>& framebuffers, const std::vector<VkSemaphore>& semaphores)
 {
 	// 销毁交换链中所有的帧缓冲对象，释放相关显存资源
-	for (auto framebuffer : _swapChainFramebuffers) {
+	for (auto framebuffer : framebuffers) {
 		vkDestroyFramebuffer(_device, framebuffer, nullptr);
 	}
-	_swapChainFramebuffers.clear();    // 清空帧缓冲列表
 
 	// 销毁交换链中所有的图像视图，释放对应的图像资源引用
-	for (auto imageView : _swapChainImageViews) {
+	for (auto imageView : imageViews) {
 		vkDestroyImageView(_device, imageView, nullptr);
 	}
-	_swapChainImageViews.clear();    // 清空图像视图列表
 
 	// 销毁交换链对象本身，释放交换链占用的资源
-	vkDestroySwapchainKHR(_device, _swapChain, nullptr);
-	_swapChain = VK_NULL_HANDLE;    // 标记交换链为空，避免误用
+	vkDestroySwapchainKHR(_device, swapChain, nullptr);
+
+	// 销毁按图像创建的渲染完成信号量，交换链重建后图像数量可能变化
+	for (auto semaphore : semaphores) {
+		vkDestroySemaphore(_device, semaphore, nullptr);
+	}
 }
 
 bool TriangleFunc::checkValidationLayerSupport()
@@ -1227,18 +3431,29 @@ bool TriangleFunc::checkValidationLayerSupport()
 
 std::vector<const char*> TriangleFunc::getRequiredExtensions()
 {
-	// 获取glfw窗口扩展
-	const char** glfwExtensions;
-	uint32_t glfwExtensionCount = 0;
-	glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+	std::vector<const char*> extensions;
 
-	std::vector<const char*> extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	// 获取glfw窗口扩展（无头模式不需要窗口系统扩展）
+	if (!_config.headless) {
+		const char** glfwExtensions;
+		uint32_t glfwExtensionCount = 0;
+		glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+
+		extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	}
 
 	// 如果启用了验证层
 	if (_enableValidationLayers) {
 		extensions.push_back(VK_EXT_DEBUG_UTILS_EXTENSION_NAME);
 	}
 
+	// 动态渲染与 present_wait 在 Vulkan 1.0 实例上依赖该实例扩展（查询与启用扩展特性），可用时总是启用
+	std::vector<std::string> available = checkValidationInstanceExtensions();
+	_properties2Enabled = std::find(available.begin(), available.end(), VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME) != available.end();
+	if (_properties2Enabled) {
+		extensions.push_back(VK_KHR_GET_PHYSICAL_DEVICE_PROPERTIES_2_EXTENSION_NAME);
+	}
+
 	return extensions;
 }
 
@@ -1374,10 +3589,18 @@ void TriangleFunc::endSingleTimeCommands(VkCommandBuffer commandBuffer)
 	submitInfo.commandBufferCount = 1;
 	submitInfo.pCommandBuffers = &commandBuffer;
 
+	VkFenceCreateInfo fenceInfo{};
+	fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+	VkFence fence;
+	if (vkCreateFence(_device, &fenceInfo, nullptr, &fence) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create single time fence!");
+	}
+
 	// 将命令缓冲提交到图形队列执行
-	vkQueueSubmit(_graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-	// 阻塞等待队列执行完成，确保命令缓冲执行完毕
-	vkQueueWaitIdle(_graphicsQueue);
+	vkQueueSubmit(_graphicsQueue, 1, &submitInfo, fence);
+	// 只等待这一次提交完成，不等待整个队列空闲
+	vkWaitForFences(_device, 1, &fence, VK_TRUE, UINT64_MAX);
+	vkDestroyFence(_device, fence, nullptr);
 
 	// 释放命令缓冲，归还命令池
 	vkFreeCommandBuffers(_device, _commandPool, 1, &commandBuffer);
@@ -1393,12 +3616,257 @@ void TriangleFunc::renderImGui(VkCommandBuffer cmdBuf)
 	// 创建一个示例窗口和控件
 	ImGui::Begin(u8"控制窗口!");
 	ImGui::ColorEdit3(u8"背景色", (float*)&_backColor);    // 颜色编辑器，绑定自定义清屏颜色变量
+	ImGui::ColorEdit3(u8"场景色调", (float*)&_sceneTint);  // 每帧经环形缓冲写入场景 uniform
+	ImGui::Text(u8"帧环形缓冲: 本帧 %llu B  峰值 %llu / %llu B", static_cast<unsigned long long>(_frameRing.FrameUsed()),
+		static_cast<unsigned long long>(_frameRing.PeakUsed()), static_cast<unsigned long long>(_frameRing.FrameSize()));
+	const UploadQueue::Stats& uploadStats = _uploadQueue.GetStats();
+	ImGui::Text(u8"上传队列（%s）: %llu 次上传  %llu 批  阻塞 %llu", _uploadQueue.IsDedicated() ? u8"传输队列" : u8"图形队列",
+		static_cast<unsigned long long>(uploadStats.uploads), static_cast<unsigned long long>(uploadStats.submits),
+		static_cast<unsigned long long>(uploadStats.stalls));
+
+	// 呈现策略：切换后下一帧重建交换链
+	ImGui::Separator();
+	const char* policyNames[PresentPacer::PolicyCount];
+	for (uint32_t i = 0; i < PresentPacer::PolicyCount; i++) {
+		policyNames[i] = PresentPacer::PolicyName(static_cast<PresentPacer::Policy>(i));
+	}
+	int policy = static_cast<int>(_presentPacer.CurrentPolicy());
+	if (ImGui::Combo(u8"呈现策略", &policy, policyNames, PresentPacer::PolicyCount)) {
+		setPresentPolicy(static_cast<PresentPacer::Policy>(policy));
+	}
+	ImGui::Text(u8"呈现模式: %s", PresentPacer::ModeName(_presentMode));
+	if (_presentPacer.IsPacing()) {
+		int latencyFrames = static_cast<int>(_presentPacer.LatencyFrames());
+		if (ImGui::SliderInt(u8"领先显示帧数", &latencyFrames, 1, static_cast<int>(PresentPacer::kMaxLatencyFrames))) {
+			_presentPacer.SetLatencyFrames(static_cast<uint32_t>(latencyFrames));
+		}
+	}
+	else {
+		ImGui::TextUnformatted(u8"不支持 present_wait，由帧栅栏限速");
+	}
+	for (uint32_t i = 0; i < PresentPacer::PolicyCount; i++) {
+		auto each = static_cast<PresentPacer::Policy>(i);
+		double frameMs = _presentPacer.AverageFrameMs(each);
+		if (frameMs < 0.0) {
+			continue;
+		}
+		double latencyMs = _presentPacer.AverageLatencyMs(each);
+		ImGui::Text(u8"%-12s 帧间隔 %.3f ms  延迟 %.3f ms", PresentPacer::PolicyName(each), frameMs, latencyMs < 0.0 ? 0.0 : latencyMs);
+	}
+
+	// GPU 分段耗时（滑动平均），数据比当前帧晚 _framesInFlight 帧
+	ImGui::Separator();
+	if (!_gpuProfiler.IsSupported()) {
+		ImGui::TextUnformatted(u8"GPU 计时不可用（队列不支持时间戳）");
+	}
+	else {
+		for (const auto& result : _gpuProfiler.Results()) {
+			// 按嵌套深度缩进
+			ImGui::Text("%*s%s: %.3f ms", static_cast<int>(result.depth) * 2, "", result.name.c_str(), result.averageMs);
+		}
+		if (ImGui::Button(u8"导出 CSV")) {
+			_gpuProfiler.ExportCsv(_gpuProfileCsvPath);
+		}
+	}
+
+	// 实例模拟在计算队列上的耗时，独立于图形队列的计时
+	if (_simulation.IsValid()) {
+		double computeMs = _asyncCompute.AverageMs();
+		ImGui::Text(u8"模拟（%s）: %.3f ms", _asyncCompute.IsAsync() ? u8"异步计算队列" : u8"图形队列", computeMs < 0.0 ? 0.0 : computeMs);
+	}
+
+	// 命令缓冲缓存：命中时只重新录制 ImGui；关闭期间的状态变化没有记录，重新开启时全部重新录制
+	ImGui::Separator();
+	if (ImGui::Checkbox(u8"缓存命令缓冲", &_cacheCommands)) {
+		invalidateCommandCache();
+	}
+	const char* cacheBlocker = commandCacheBlocker();
+	if (_cacheCommands && cacheBlocker != nullptr) {
+		ImGui::TextUnformatted(cacheBlocker);
+	}
+	ImGui::Text(u8"命中 %llu  重新录制 %llu", static_cast<unsigned long long>(_commandCacheHits),
+		static_cast<unsigned long long>(_commandCacheRecords));
+
+	// 渲染图：修改模糊级数后下一帧重新声明，瞬态图像按新的描述与生命周期重建
+	if (_renderGraphEnabled) {
+		ImGui::Separator();
+		if (_blurSupported) {
+			ImGui::SliderInt(u8"模糊级数", &_blurLevels, 0, AppConfig::kMaxBlurLevels);
+		}
+		const RenderGraph::Stats& graphStats = _renderGraph.GetStats();
+		const double mb = 1.0 / (1024.0 * 1024.0);
+		ImGui::Text(u8"渲染图: 通道 %u（剔除 %u）  屏障 %u 图像 + %u 内存 / %u 批（%s）", graphStats.passes - graphStats.culledPasses,
+			graphStats.culledPasses, graphStats.imageBarriers, graphStats.memoryBarriers, graphStats.barrierBatches,
+			_renderGraph.UsesSynchronization2() ? "synchronization2" : u8"旧版屏障");
+		ImGui::Text(u8"瞬态图像 %u 个 / %u 块显存  %.2f MB（不复用 %.2f MB）  重建 %llu", graphStats.transientImages,
+			graphStats.memorySlots, graphStats.transientBytes * mb, graphStats.unaliasedBytes * mb,
+			static_cast<unsigned long long>(graphStats.rebuilds));
+	}
+
+	// 按需渲染与帧率上限：空闲期间界面不更新，统计停在最后一次绘制时
+	ImGui::Separator();
+	ImGui::Checkbox(u8"按需渲染", &_onDemand);
+	float maxFps = static_cast<float>(_frameLimiter.TargetFps());
+	if (ImGui::SliderFloat(u8"帧率上限（0 不限）", &maxFps, 0.0f, 240.0f)) {
+		_frameLimiter.SetTargetFps(maxFps);
+	}
+	ImGui::Text(u8"已绘制 %llu 帧  空闲唤醒 %llu  空闲 %.1f s  自旋阈值 %.2f ms", static_cast<unsigned long long>(_framesDrawn),
+		static_cast<unsigned long long>(_idleWakeups), std::chrono::duration<double>(_idleTime).count(), _frameLimiter.SpinThresholdMs());
+
+	// 帧同步方式与 GPU 进度（已完成 / 已提交的序号）
+	ImGui::Separator();
+	ImGui::Text(u8"帧同步: %s  GPU 进度 %llu / %llu", _timelineSync ? u8"时间线信号量" : u8"栅栏",
+		static_cast<unsigned long long>(completedSerial()), static_cast<unsigned long long>(_submitSerial));
+
+	// 场景管线变体：修改后在后台编译，就绪前仍用通用管线绘制，下一帧生效
+	ImGui::Separator();
+	const char* cullNames[] = { "none", "front", "back", "front+back" };
+	int cullMode = static_cast<int>(_pipelineVariant.cullMode & 3u);
+	if (ImGui::Combo(u8"剔除模式", &cullMode, cullNames, 4)) {
+		_pipelineVariant.cullMode = static_cast<VkCullModeFlags>(cullMode);
+	}
+	bool counterClockwise = _pipelineVariant.frontFace == VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	if (ImGui::Checkbox(u8"逆时针为正面", &counterClockwise)) {
+		_pipelineVariant.frontFace = counterClockwise ? VK_FRONT_FACE_COUNTER_CLOCKWISE : VK_FRONT_FACE_CLOCKWISE;
+	}
+	ImGui::Checkbox(u8"alpha 混合", &_pipelineVariant.blend);
+	unsigned int writeMask = _pipelineVariant.writeMask;
+	ImGui::CheckboxFlags("R", &writeMask, VK_COLOR_COMPONENT_R_BIT);
+	ImGui::SameLine();
+	ImGui::CheckboxFlags("G", &writeMask, VK_COLOR_COMPONENT_G_BIT);
+	ImGui::SameLine();
+	ImGui::CheckboxFlags("B", &writeMask, VK_COLOR_COMPONENT_B_BIT);
+	ImGui::SameLine();
+	ImGui::CheckboxFlags("A", &writeMask, VK_COLOR_COMPONENT_A_BIT);
+	_pipelineVariant.writeMask = static_cast<VkColorComponentFlags>(writeMask);
+
+	PipelineVariant defaultVariant;
+	defaultVariant.instanced = _pipelineVariant.instanced;
+	const char* variantState = _pipelineVariant.Key() == defaultVariant.Key() ? u8"通用管线"
+		: (pipelineVariantPending() ? u8"编译中，使用通用管线" : u8"已就绪");
+	PipelineManager::Stats pipelineStats = _pipelineManager.GetStats();
+	ImGui::Text(u8"管线变体: %s", variantState);
+	ImGui::Text(u8"已编译 %u / %u  失败 %u  编译线程 %u  回退帧 %llu", pipelineStats.ready, pipelineStats.requested, pipelineStats.failed,
+		_pipelineManager.ThreadCount(), static_cast<unsigned long long>(_pipelineFallbacks));
+
+	// CPU 各阶段耗时分布（自启动或上次重置以来）
+	ImGui::Separator();
+	for (uint32_t i = 0; i < FramePhaseProfiler::PhaseCount; i++) {
+		auto phase = static_cast<FramePhaseProfiler::Phase>(i);
+		FramePhaseProfiler::PhaseSummary summary = _phaseProfiler.Summary(phase);
+		ImGui::Text("%-12s p50 %.3f  p99 %.3f  max %.3f ms", FramePhaseProfiler::PhaseName(phase), summary.p50, summary.p99, summary.max);
+	}
+	if (ImGui::Button(u8"导出阶段耗时")) {
+		_phaseProfiler.DumpToFile(_phaseDumpPath);
+	}
+	ImGui::SameLine();
+	if (ImGui::Button(u8"重置")) {
+		_phaseProfiler.Reset();
+	}
+
 	ImGui::End();
 
+	if (_textureStreamer.IsValid()) {
+		renderTextureBrowser();
+	}
+
+	// 控件仍在交互（拖动、文本输入光标闪烁）时按需渲染模式继续绘制
+	_imguiActive = ImGui::IsAnyItemActive() || ImGui::GetIO().WantTextInput;
+
 	// 结束 ImGui 帧，并生成绘制数据
 	ImGui::Render();
 	ImDrawData* draw_data = ImGui::GetDrawData();
 
 	// 使用 Vulkan 命令缓冲执行 ImGui 绘制命令
 	ImGui_ImplVulkan_RenderDrawData(draw_data, cmdBuf);
+}
+
+void TriangleFunc::renderTextureBrowser()
+{
+	TextureStreamer::Stats stats = _textureStreamer.GetStats();
+	const double mb = 1.0 / (1024.0 * 1024.0);
+
+	ImGui::Begin(u8"纹理浏览");
+	ImGui::Text(u8"纹理 %u  驻留 %u  流送中 %u  失败 %u", stats.textures, stats.resident, stats.pending, stats.failed);
+	ImGui::Text(u8"显存 %.1f / %.1f MB  峰值 %.1f MB  逐出 %llu", stats.residentBytes * mb,
+		_textureStreamer.GetSettings().memoryBudget * mb, stats.peakResidentBytes * mb, static_cast<unsigned long long>(stats.evictions));
+	ImGui::Text(u8"解码 %llu 次 %.1f ms  上传 %.1f MB  槽位繁忙 %llu 帧", static_cast<unsigned long long>(stats.decodes), stats.decodeMs,
+		stats.uploadedBytes * mb, static_cast<unsigned long long>(stats.busyFrames));
+	ImGui::Text(u8"压缩上传 %llu  CPU 转码 %llu", static_cast<unsigned long long>(stats.compressedUploads),
+		static_cast<unsigned long long>(stats.transcodes));
+
+	// 预算调小后在之后的帧中逐出不在当前页的纹理
+	int budgetMB = static_cast<int>(_textureStreamer.GetSettings().memoryBudget / (1024 * 1024));
+	if (ImGui::SliderInt(u8"显存预算 (MB)", &budgetMB, 16, 4096)) {
+		_textureStreamer.SetMemoryBudget(static_cast<VkDeviceSize>(budgetMB) * 1024 * 1024);
+	}
+
+	int pageCount = static_cast<int>((_textureStreamer.Count() + kTexturePageSize - 1) / kTexturePageSize);
+	int page = std::min(_texturePage, std::max(pageCount - 1, 0));
+	if (pageCount > 1) {
+		ImGui::SliderInt(u8"页", &page, 0, pageCount - 1);
+	}
+	if (page != _texturePage) {
+		releaseTextureThumbnails();
+		_texturePage = page;
+	}
+
+	// 只请求当前页的纹理，其余纹理不再被使用，显存不足时优先逐出
+	ImGui::Separator();
+	uint32_t first = static_cast<uint32_t>(_texturePage) * kTexturePageSize;
+	uint32_t last = std::min(first + kTexturePageSize, _textureStreamer.Count());
+	for (uint32_t handle = first; handle < last; handle++) {
+		if ((handle - first) % kTextureBrowserColumns != 0) {
+			ImGui::SameLine();
+		}
+		ImGui::Image((ImTextureID)textureThumbnail(handle), ImVec2(kThumbnailSize, kThumbnailSize));
+		if (ImGui::IsItemHovered()) {
+			ImGui::SetTooltip("%s", _textureStreamer.Path(handle).c_str());
+		}
+	}
+	ImGui::End();
+}
+
+VkDescriptorSet TriangleFunc::textureThumbnail(TextureStreamer::Handle handle)
+{
+	VkImageView view = _textureStreamer.View(handle);
+	uint32_t generation = _textureStreamer.Generation(handle);
+
+	if (_textureThumbnails.size() <= handle) {
+		_textureThumbnails.resize(handle + 1);
+	}
+	TextureThumbnail& thumbnail = _textureThumbnails[handle];
+	if (thumbnail.set != VK_NULL_HANDLE && thumbnail.view == view && thumbnail.generation == generation) {
+		return thumbnail.set;
+	}
+
+	// 旧的描述符集可能还在被在途帧使用，延迟释放
+	if (thumbnail.set != VK_NULL_HANDLE) {
+		VkDescriptorSet oldSet = thumbnail.set;
+		_deletionQueue.Push(_submitSerial, [oldSet]() { ImGui_ImplVulkan_RemoveTexture(oldSet); });
+	}
+	thumbnail.set = ImGui_ImplVulkan_AddTexture(_textureStreamer.Sampler(), view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	thumbnail.view = view;
+	thumbnail.generation = generation;
+	return thumbnail.set;
+}
+
+void TriangleFunc::releaseTextureThumbnails()
+{
+	std::vector<VkDescriptorSet> sets;
+	for (TextureThumbnail& thumbnail : _textureThumbnails) {
+		if (thumbnail.set != VK_NULL_HANDLE) {
+			sets.push_back(thumbnail.set);
+		}
+		thumbnail = TextureThumbnail{};
+	}
+	if (sets.empty()) {
+		return;
+	}
+
+	_deletionQueue.Push(_submitSerial, [sets]() {
+		for (VkDescriptorSet set : sets) {
+			ImGui_ImplVulkan_RemoveTexture(set);
+		}
+	});
 }
\ No newline at end of file
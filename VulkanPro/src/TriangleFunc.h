@@ -2,6 +2,8 @@
 #define TRIANGLEFUNC_H_
 
 #include <algorithm>
+#include <array>
+#include <chrono>
 #include <cstdint>
 #include <cstdlib>
 #include <fstream>
@@ -11,11 +13,15 @@
 #include <vector>
 
 
+#ifdef _WIN32
 #define VK_USE_PLATFORM_WIN32_KHR
+#endif
 #define GLFW_INCLUDE_VULKAN
 #include "GLFW/glfw3.h"
+#ifdef _WIN32
 #define GLFW_EXPOSE_NATIVE_WIN32
 #include "GLFW/glfw3native.h"
+#endif
 
 #include "glm/glm.hpp"
 #include "vulkan/vulkan.h"
@@ -24,12 +30,34 @@
 #include "backends/imgui_impl_vulkan.h"
 #include "imgui.h"
 
+#include "AppConfig.h"
 #include "MacroHead.h"
+#include "Helper/FrameLimiter.h"
+#include "Helper/FramePhaseProfiler.h"
+#include "Helper/FrameStats.h"
+#include "Render/AsyncCompute.h"
+#include "Render/DeletionQueue.h"
+#include "Render/FrameRingBuffer.h"
+#include "Render/GpuTimeline.h"
+#include "Render/GpuCuller.h"
+#include "Render/GpuProfiler.h"
+#include "Render/InstanceBuffer.h"
+#include "Render/InstanceSimulation.h"
+#include "Render/ParallelRecorder.h"
+#include "Render/PipelineCache.h"
+#include "Render/PipelineManager.h"
+#include "Render/PresentPacer.h"
+#include "Render/RenderGraph.h"
+#include "Render/ShaderCompiler.h"
+#include "Render/ShaderLibrary.h"
+#include "Render/ShaderWatcher.h"
+#include "Render/TextureStreamer.h"
+#include "Render/UploadQueue.h"
 
 class TriangleFunc
 {
 public:
-	TriangleFunc();
+	explicit TriangleFunc(const AppConfig& config = AppConfig());
 
 	~TriangleFunc();
 
@@ -61,6 +89,197 @@ private:
 	 */
 	void mainLoop();
 
+	/**
+	 * @brief 主循环的一次迭代：处理事件，需要时按帧率上限等待后绘制一帧。
+	 *
+	 * 窗口最小化时阻塞到窗口恢复；按需渲染且没有待绘制内容时阻塞到有事件或 kIdleWakeSeconds 超时。
+	 *
+	 * @return true 本次绘制了一帧；false 本次处于空闲或最小化等待。
+	 */
+	bool pumpFrame();
+
+	/**
+	 * @brief 窗口是否最小化（或帧缓冲尺寸为 0），此时无法创建交换链也不需要绘制。
+	 */
+	bool windowMinimized() const;
+
+	/**
+	 * @brief 窗口最小化时阻塞等待事件直到窗口恢复或被关闭，不轮询也不绘制。
+	 *
+	 * @return true 发生了等待。
+	 */
+	bool waitWhileMinimized();
+
+	/**
+	 * @brief 按需渲染模式下是否有内容需要绘制：待绘制帧数未用完、ImGui 控件正在交互、
+	 *        实例每帧变化、管线变体正在编译（编译完成后需要换用），或纹理正在流送。
+	 */
+	bool redrawRequired() const;
+
+	/**
+	 * @brief 请求按需渲染模式至少再绘制 frames 帧。
+	 */
+	void requestRedraw(uint32_t frames);
+
+	/**
+	 * @brief 请求的管线变体是否仍在编译（正在用通用管线代替）。
+	 */
+	bool pipelineVariantPending() const;
+
+	/**
+	 * @brief 无头模式主循环（基准测试）。
+	 *
+	 * 按配置的帧数或秒数渲染离屏图像，结束后输出帧率、CPU/GPU 帧耗时分位数报告。
+	 */
+	void headlessLoop();
+
+	/**
+	 * @brief 将所有 GLSL 源文件编译为 SPIR-V 写入着色器目录（--compile-shaders），不创建窗口与设备。
+	 *
+	 * @throws std::runtime_error 有着色器编译或写入失败时抛出。
+	 */
+	void compileShaders();
+
+	/**
+	 * @brief 在帧边界取走后台重新编译的着色器，替换模块并重建图形管线。
+	 *
+	 * 旧管线可能仍被在途帧引用，交给 _deletionQueue 延迟销毁，不调用 vkDeviceWaitIdle。
+	 * 编译或管线创建失败时保留旧管线并打印错误。
+	 */
+	void applyShaderReloads();
+
+	/**
+	 * @brief 运行一轮无头渲染测量并返回 JSON 报告。
+	 *
+	 * 按配置的帧数或秒数渲染离屏图像，统计帧率与 CPU/GPU 帧耗时分位数。
+	 *
+	 * @param name 报告名称。
+	 * @return std::string 单行 JSON 报告。
+	 */
+	std::string runHeadlessPass(const std::string& name);
+
+	/**
+	 * @brief 顶点内存基准测试：同一网格分别放在 DEVICE_LOCAL 与 HOST_VISIBLE 内存中测量绘制吞吐量。
+	 *
+	 * @return std::vector<std::string> 两轮测量的 JSON 报告。
+	 */
+	std::vector<std::string> benchVertexMemory();
+
+	/**
+	 * @brief 打印报告，并在指定 --report 时写入报告文件（每行一条 JSON）。
+	 *
+	 * @throws std::runtime_error 报告文件无法写入时抛出。
+	 */
+	void writeReports(const std::vector<std::string>& reports);
+
+	/**
+	 * @brief 显存分配器压力测试：反复创建、销毁数万个大小随机的缓冲与图像。
+	 *
+	 * 统计分配/释放耗时与分配器状态（内存块数、浪费字节、碎片率），不进行渲染。
+	 *
+	 * @return std::vector<std::string> 单行 JSON 报告。
+	 */
+	std::vector<std::string> benchAllocatorStress();
+
+	/**
+	 * @brief Frames in Flight 基准测试：依次以 1 ~ kMaxFramesInFlight 帧并发渲染，
+	 *        对比吞吐量与 CPU 在栅栏上的阻塞时间。
+	 *
+	 * @return std::vector<std::string> 每种设置一条 JSON 报告。
+	 */
+	std::vector<std::string> benchFramesInFlight();
+
+	/**
+	 * @brief 并行录制基准测试：数千次绘制的场景下，依次以主线程录制与 1、2、4 … N 个工作线程录制，
+	 *        对比吞吐量与 CPU 帧耗时。
+	 *
+	 * @return std::vector<std::string> 每种线程数一条 JSON 报告。
+	 */
+	std::vector<std::string> benchParallelRecord();
+
+	/**
+	 * @brief 实例化基准测试：同样数量的对象分别以逐对象绘制（每次 instanceCount = 1、firstInstance = i）、
+	 *        单次实例化绘制、以及每帧增量更新 1% 实例的单次实例化绘制渲染。
+	 *
+	 * @return std::vector<std::string> 三轮测量的 JSON 报告。
+	 */
+	std::vector<std::string> benchInstancing();
+
+	/**
+	 * @brief GPU 驱动渲染基准测试：100 万个对象（约四分之一在视口内），对比 CPU 逐对象剔除并提交绘制
+	 *        与计算着色器剔除 + 间接绘制的帧耗时。
+	 *
+	 * @return std::vector<std::string> 两轮测量的 JSON 报告。
+	 */
+	std::vector<std::string> benchGpuDriven();
+
+	/**
+	 * @brief 异步计算基准测试：实例运动由计算着色器模拟，分别以串行（计算与图形互相等待）
+	 *        与重叠（第 N 帧计算与第 N - 1 帧图形并行）方式运行，报告计算耗时被图形工作掩盖的比例。
+	 *
+	 * @return std::vector<std::string> 两轮测量的 JSON 报告与一条汇总。
+	 */
+	std::vector<std::string> benchAsyncCompute();
+
+	/**
+	 * @brief 窗口模式的缩放风暴测试：连续 benchFrames 帧（默认 600）每帧改变窗口尺寸，
+	 *        每帧都重建交换链，报告期间的最差帧耗时与重建耗时。
+	 *
+	 * @return std::string 单行 JSON 报告。
+	 */
+	std::string benchResizeStorm();
+
+	/**
+	 * @brief 窗口模式的空闲测试：静态场景下先连续渲染、再按需渲染各 benchSeconds 秒（默认 5），
+	 *        报告两种方式的绘制帧数与空闲等待时间占比。
+	 *
+	 * @return std::vector<std::string> 每种方式一行 JSON 报告。
+	 */
+	std::vector<std::string> benchIdle();
+
+	/**
+	 * @brief 管线变体编译测试：请求 200 个固定功能变体，分别在工作线程池上并行编译与在渲染线程上串行编译，
+	 *        边编译边渲染（未就绪的变体用通用管线代替），报告首帧耗时、全部就绪耗时与使用通用管线的帧数。
+	 *
+	 * @return std::vector<std::string> 每种编译方式一行 JSON 报告。
+	 */
+	std::vector<std::string> benchPipelineVariants();
+
+	/**
+	 * @brief 命令缓冲缓存测试：静态场景下对比每帧重新录制与复用缓存的命令缓冲，报告录制阶段的 CPU 耗时。
+	 *
+	 * @return std::vector<std::string> 每种方式一行 JSON 报告。
+	 */
+	std::vector<std::string> benchCommandCache();
+
+	/**
+	 * @brief 上传批处理测试：上传 4000 个大小随机的设备本地缓冲，对比每个资源单独提交并等待
+	 *        （endSingleTimeCommands）与经 UploadQueue 批量提交，报告总耗时与提交次数。
+	 *
+	 * @return std::vector<std::string> 每种方式一行 JSON 报告。
+	 */
+	std::vector<std::string> benchUploadBatch();
+
+	/**
+	 * @brief 渲染图测试：依次以场景直接输出、模糊链、瞬态图像不共用显存的同一模糊链运行，
+	 *        报告帧耗时、每帧的通道与屏障统计以及瞬态图像的显存占用。
+	 *
+	 * @return std::vector<std::string> 每种配置一行 JSON 报告。
+	 *
+	 * @throws std::runtime_error 未启用渲染图或离屏图像格式不支持 blit 时抛出。
+	 */
+	std::vector<std::string> benchRenderGraph();
+
+	/**
+	 * @brief 纹理流送测试：预取 --texture-dir 中的所有图像，持续渲染直到每个纹理都驻留过一次（或加载失败），
+	 *        报告帧耗时、解码与上传量、峰值显存占用与逐出次数。显存预算小于全部纹理时会边加载边逐出。
+	 *
+	 * @return std::string 单行 JSON 报告。
+	 *
+	 * @throws std::runtime_error 没有指定纹理目录或目录中没有图像时抛出。
+	 */
+	std::string benchTextureStreaming();
+
 	/**
 	 * @brief 清理 Vulkan 使用过程中分配的所有资源。
 	 *
@@ -99,6 +318,51 @@ private:
 	 */
 	void createLogicalDevice();
 
+	/**
+	 * @brief 创建（或从磁盘加载）全局共享的管线缓存。
+	 *
+	 * 缓存在所有 vkCreateGraphicsPipelines 调用以及 ImGui 初始化中共用，
+	 * 并在 cleanup() 中写回磁盘，下次启动即可跳过大部分管线编译。
+	 */
+	void createPipelineCache();
+
+	/**
+	 * @brief 初始化显存分配器。
+	 *
+	 * 之后所有缓冲与图像的显存都从分配器的大块内存中子分配，
+	 * 而不是每个资源单独调用一次 vkAllocateMemory。
+	 */
+	void createAllocator();
+
+	/**
+	 * @brief 创建每帧数据的环形缓冲，以及场景 uniform 的描述符（动态 uniform 缓冲，指向环形缓冲）。
+	 *
+	 * 环形缓冲按 kMaxFramesInFlight 分区，Frames in Flight 变化时不需要重建，描述符也保持有效。
+	 */
+	void createFrameRing();
+
+	/**
+	 * @brief 创建批量异步上传队列：有专用传输队列族时在传输队列上复制，否则在图形队列上复制。
+	 */
+	void createUploadQueue();
+
+	/**
+	 * @brief 指定了纹理目录时创建纹理流送器，并登记目录中 stb_image 支持的所有图像（不立即解码）。
+	 *
+	 * @throws std::runtime_error 纹理目录无法读取时抛出。
+	 */
+	void createTextureStreamer();
+
+	/**
+	 * @brief 启用渲染图时初始化它，并检查交换链（离屏）格式能否用于模糊链的线性 blit。
+	 */
+	void createRenderGraph();
+
+	/**
+	 * @brief 把本帧的场景 uniform 写入环形缓冲，记录绑定用的动态偏移。必须在录制场景绘制前、在主线程调用。
+	 */
+	void writeSceneUniforms();
+
 	/**
 	 * @brief 创建 Vulkan 与窗口系统关联的表面。
 	 *
@@ -129,6 +393,63 @@ private:
 	 */
 	void createImageViews();
 
+	/**
+	 * @brief 创建无头模式下的离屏渲染目标。
+	 *
+	 * 代替交换链图像：创建与 Frames in Flight 数量相同的设备本地 VkImage，
+	 * 填充到 _swapChainImages / _swapChainImageFormat / _swapChainExtent 中，
+	 * 使后续的图像视图、帧缓冲和命令录制流程与窗口模式共用。
+	 *
+	 * @throws std::runtime_error 创建图像或分配内存失败时抛出。
+	 */
+	void createOffscreenTargets();
+
+	/**
+	 * @brief 销毁无头模式的离屏渲染目标（帧缓冲、图像视图、图像及其内存）。
+	 */
+	void cleanupOffscreenTargets();
+
+	/**
+	 * @brief 初始化 GPU 分段计时器，每个帧槽位一段时间戳查询。
+	 *
+	 * 若图形队列族不支持时间戳（timestampValidBits 为 0），计时器为空操作，报告中 GPU 耗时为 null。
+	 */
+	void createGpuProfiler();
+
+	/**
+	 * @brief 按 _recordThreads 创建并行录制器，每个工作线程每帧一个命令池；线程数为 0 时不启用。
+	 */
+	void createParallelRecorder();
+
+	/**
+	 * @brief 运行时修改并行录制的线程数，等待设备空闲后重建并行录制器。
+	 */
+	void setRecordThreads(uint32_t count);
+
+	/**
+	 * @brief 创建 GPU 剔除的计算管线与间接绘制缓冲，对象列表为实例缓冲。
+	 *
+	 * 未启用实例化或图形队列族不支持计算时不创建；此时若要求 GPU 驱动渲染则抛出异常。
+	 */
+	void createGpuCuller();
+
+	/**
+	 * @brief 创建异步计算调度器（每个帧槽位一个计算命令缓冲）；未启用模拟时不创建。
+	 */
+	void createAsyncCompute();
+
+	/**
+	 * @brief 创建实例模拟的计算管线与缓冲，并在计算队列上写入初始状态。
+	 *
+	 * @throws std::runtime_error 未启用实例化时抛出。
+	 */
+	void createInstanceSimulation();
+
+	/**
+	 * @brief 提交本帧的实例模拟到计算队列，必须紧接在本帧图形提交之前调用。
+	 */
+	void submitSimulation();
+
 	/**
 	 * @brief 创建 Vulkan 图形管线（Graphics Pipeline）。
 	 *
@@ -138,18 +459,32 @@ private:
 	 * 本函数执行：
 	 * - 着色器模块加载
 	 * - 固定功能阶段配置（顶点输入、视口、装配、光栅化、混色等）
-	 * - 管线布局创建
+	 * - 管线布局创建（已存在时复用，着色器热重载时只重建管线）
 	 * - 调用 vkCreateGraphicsPipelines 创建图形管线对象
 	 *
 	 * @throws std::runtime_error 如果创建失败
 	 */
 	void createGraphicsPipeline();
 
+	/**
+	 * @brief 按变体批量创建场景管线，一次 vkCreateGraphicsPipelines 调用。
+	 *
+	 * 只读取成员，PipelineManager 的工作线程会同时调用，各线程传入自己的管线缓存。
+	 *
+	 * @throws std::runtime_error 如果创建失败，或请求实例化变体但未启用实例化
+	 */
+	void createScenePipelines(const std::vector<PipelineVariant> &variants, VkPipelineCache cache, std::vector<VkPipeline> &pipelines) const;
+
+	/**
+	 * @brief 以 cache 为主缓存初始化 _pipelineManager，启动 threadCount 个编译线程（0 为同步编译）。
+	 */
+	void createPipelineManager(VkPipelineCache cache, uint32_t threadCount);
+
 	/**
 	 * @brief 创建 Vulkan 渲染通道（Render Pass）。
 	 *
 	 * 渲染通道定义了一次渲染中使用的附件、子通道结构，以及它们的依赖关系。
-	 * 当前只配置了一个颜色附件用于交换链图像的输出。
+	 * 当前只配置了一个颜色附件用于交换链图像的输出。动态渲染模式下不创建。
 	 *
 	 * @throws std::runtime_error 如果创建渲染通道失败。
 	 */
@@ -160,6 +495,7 @@ private:
 	 *
 	 * 每个帧缓冲与一个图像视图绑定，用于在指定的渲染通道（_renderPass）中进行渲染输出。
 	 * 通常每帧渲染对应一个图像视图，因此需创建多个帧缓冲，与交换链图像一一对应。
+	 * 动态渲染模式下直接使用图像视图，不创建帧缓冲。
 	 *
 	 * @throws std::runtime_error 如果帧缓冲创建失败。
 	 */
@@ -177,6 +513,47 @@ private:
 	 */
 	void createCommandPool();
 
+	/**
+	 * @brief 生成场景网格数据（默认三角形或 N×N 四边形网格）。
+	 */
+	void buildSceneMesh();
+
+	/**
+	 * @brief 将场景网格按三角形均匀拆分为 _config.sceneDraws 次绘制，生成 _drawList。
+	 */
+	void buildDrawList();
+
+	/**
+	 * @brief 生成 _instanceCount 个实例（网格排列，随机旋转与颜色）并写入实例缓冲。
+	 */
+	void buildInstances();
+
+	/**
+	 * @brief 创建实例缓冲并上传 _instances；Frames in Flight 变化时重建。
+	 */
+	void createInstanceBuffer();
+
+	/**
+	 * @brief 旋转 _instanceUpdatesPerFrame 个实例（滑动窗口），通过增量更新写入实例缓冲。
+	 */
+	void animateInstances();
+
+	/**
+	 * @brief 本帧场景可录制的条目数：实例化逐对象模式为实例数，实例化与 GPU 驱动模式为 1，否则为绘制列表长度。
+	 */
+	uint32_t sceneItemCount() const;
+
+	/**
+	 * @brief CPU 端视口剔除：实例的包围圆是否与 _cullRect 相交，与 cull.comp 的判断相同。
+	 */
+	bool isInstanceVisible(uint32_t index) const;
+
+	/**
+	 * @brief 创建场景的顶点缓冲与索引缓冲。
+	 *
+	 * 网格数据在运行期间不变，因此放在 DEVICE_LOCAL 内存中，
+	 * 通过暂存缓冲一次性批量上传，避免每帧顶点读取经过 PCIe。
+	 */
 	void createVertexBuffer();
 
 	/**
@@ -187,7 +564,7 @@ private:
 	 *
 	 * - 使用 _commandPool 分配命令缓冲。
 	 * - 命令缓冲级别为 VK_COMMAND_BUFFER_LEVEL_PRIMARY，表示可直接提交给队列。
-	 * - 分配数量等于 _MAX_FRAMES_IN_FLIGHT，用于支持多帧并发。
+	 * - 分配数量等于 _framesInFlight，用于支持多帧并发。
 	 *
 	 * @throws std::runtime_error 如果命令缓冲分配失败。
 	 */
@@ -197,17 +574,42 @@ private:
 	 * @brief 创建每帧所需的同步对象（信号量和栅栏）。
 	 *
 	 * Vulkan 使用同步对象来协调 CPU 与 GPU 之间的执行顺序，避免资源冲突。
-	 * 本函数为每帧并发（通常为 2 或 3 帧）分配以下同步对象：
+	 * 本函数为每帧并发（_framesInFlight 帧）分配以下同步对象：
 	 * - 图像可用信号量（_imageAvailableSemaphores）：在图像获取完成时被触发。
-	 * - 渲染完成信号量（_renderFinishedSemaphores）：在命令缓冲执行完毕时触发，供呈现使用。
 	 * - CPU-GPU 栅栏（_inFlightFences）：确保每帧开始时上一帧的命令已执行完毕。
+	 *   时间线模式下不创建栅栏，改为创建图形队列的时间线信号量（_graphicsTimeline）。
 	 *
+	 * 渲染完成信号量按交换链图像创建，见 createPresentSemaphores()。
 	 * 所有信号量创建为初始未触发状态，栅栏设置为初始“已触发”，以允许第一帧立即开始渲染。
 	 *
 	 * @throws std::runtime_error 如果任一同步对象创建失败。
 	 */
 	void createSyncObjects();
 
+	/**
+	 * @brief 销毁 createSyncObjects() 创建的每帧同步对象。
+	 */
+	void destroySyncObjects();
+
+	/**
+	 * @brief 为每张交换链图像创建一个渲染完成信号量（_renderFinishedSemaphores）。
+	 *
+	 * 呈现引擎等待该信号量的时间由图像何时被再次获取决定，而不是由帧槽位决定，
+	 * 因此信号量必须按图像索引而不是按帧索引复用；交换链重建时随之重建。
+	 *
+	 * @throws std::runtime_error 如果信号量创建失败。
+	 */
+	void createPresentSemaphores();
+
+	/**
+	 * @brief 运行时修改 Frames in Flight 数量（仅无头模式）。
+	 *
+	 * 等待设备空闲后重建命令缓冲、同步对象、时间戳查询池与离屏渲染目标。
+	 *
+	 * @param count 新的并发帧数，取值 1 ~ AppConfig::kMaxFramesInFlight。
+	 */
+	void setFramesInFlight(int count);
+
 	/**
 	 * @brief 每帧渲染逻辑（Frame Rendering）。
 	 *
@@ -223,12 +625,55 @@ private:
 	 * 6. 更新当前帧索引，实现循环帧处理（避免资源冲突）。
 	 *
 	 * 注意：
-	 * - 多帧并发通常设置为 2 或 3 帧；
-	 * - 使用信号量确保图像获取与渲染顺序；
-	 * - 使用栅栏确保命令缓冲在重用前不会被 GPU 使用中。
+	 * - 多帧并发数由 --frames-in-flight 配置（1 ~ 4）；
+	 * - 使用信号量确保图像获取与渲染顺序，渲染完成信号量按图像索引选取；
+	 * - 使用栅栏确保命令缓冲在重用前不会被 GPU 使用中；
+	 * - 等待栅栏与获取图像的阻塞时间记入 _frameStats（指定 --report 时）；
+	 * - 各阶段（栅栏、获取、记录、提交、呈现、重建交换链）的耗时始终记入 _phaseProfiler。
 	 */
 	void drawFrame();
 
+	/**
+	 * @brief 无头模式的每帧渲染逻辑。
+	 *
+	 * 与 drawFrame 相同的栅栏同步，但不获取/呈现交换链图像，
+	 * 直接渲染到当前帧对应的离屏图像；同时回读该帧槽位上一次提交的 GPU 时间戳。
+	 */
+	void drawOffscreenFrame();
+
+	/**
+	 * @brief 回读指定帧槽位上一次提交的 GPU 时间戳，更新分段统计并记录整帧耗时。
+	 *
+	 * 仅在该帧的栅栏已触发后调用，因此不会阻塞等待 GPU。
+	 *
+	 * @param frame 帧槽位索引。
+	 */
+	void collectGpuTime(uint32_t frame);
+
+	/**
+	 * @brief 等待帧槽位上一次的提交完成：栅栏模式等待该槽位的栅栏，时间线模式等待该槽位记录的序号。
+	 *
+	 * @param frame 帧槽位索引。
+	 */
+	void waitForFrame(uint32_t frame);
+
+	/**
+	 * @brief 以当前帧槽位提交一帧的图形命令，并将新的提交序号记入 _frameSerials。
+	 *
+	 * 栅栏模式在提交前重置并绑定该槽位的栅栏；时间线模式在 submitInfo 的信号量之后追加
+	 * 图形时间线信号量，触发值即新的提交序号，不使用栅栏。
+	 *
+	 * @return vkQueueSubmit 的结果。
+	 */
+	VkResult submitFrame(VkSubmitInfo submitInfo);
+
+	/**
+	 * @brief GPU 已完成的最大图形提交序号，不阻塞。任何按序号延迟的工作都可据此判断是否已完成。
+	 *
+	 * 时间线模式只查询一次信号量计数；栅栏模式需要逐个查询帧槽位的栅栏状态。
+	 */
+	uint64_t completedSerial();
+
 private:
 	/**
 	 * @brief 获取当前系统支持的 Vulkan 实例扩展列表。
@@ -263,6 +708,11 @@ private:
 	 */
 	bool checkDeviceExtensionSupport(VkPhysicalDevice device);
 
+	/**
+	 * @brief 检查物理设备是否支持某个可选的设备扩展。
+	 */
+	bool isDeviceExtensionAvailable(VkPhysicalDevice device, const char* name);
+
 	/**
 	 * @brief 评估 Vulkan 物理设备的适用性并打分。
 	 *
@@ -311,8 +761,8 @@ private:
 	/**
 	 * @brief 选择交换链的呈现模式（帧同步方式）。
 	 *
-	 * 优先选择 VK_PRESENT_MODE_MAILBOX_KHR（低延迟、三重缓冲），
-	 * 若不可用，则回退到 VK_PRESENT_MODE_FIFO_KHR（V-Sync，所有设备都支持）。
+	 * 由当前呈现策略决定（见 PresentPacer::ChooseMode()），
+	 * 首选模式不可用时回退到 VK_PRESENT_MODE_FIFO_KHR（V-Sync，所有设备都支持）。
 	 *
 	 * @param availablePresentModes 可用的呈现模式列表。
 	 * @return VkPresentModeKHR 选定的呈现模式。
@@ -332,32 +782,34 @@ private:
 
 private:
 	/**
-	 * @brief 读取指定文件的全部内容（通常用于加载 SPIR-V 着色器字节码）。
-	 *
-	 * 使用二进制方式打开文件，并读取所有数据到缓冲区中返回。
+	 * @brief 批量创建 DEVICE_LOCAL 缓冲并通过 _uploadQueue 上传数据。
 	 *
-	 * @param filename 文件路径（相对或绝对路径）。
-	 * @return std::vector<char> 文件的原始字节内容。
+	 * 所有请求录制到同一批次中提交一次，CPU 不等待。之后提交到图形队列的帧在顺序上位于该批次之后，
+	 * 可以直接使用这些缓冲；在返回的票据完成前不能销毁它们。
 	 *
-	 * @throws std::runtime_error 如果文件打开失败。
+	 * @param uploads 上传请求列表。
+	 * @return UploadQueue::Ticket 本批次的票据。
 	 */
-	static std::vector<char> readFile(const std::string& filename);
+	UploadQueue::Ticket uploadDeviceLocalBuffers(const std::vector<BufferUpload>& uploads);
 
 	/**
-	 * @brief 创建着色器模块（VkShaderModule）。
-	 *
-	 * 从预编译的 SPIR-V 字节码（.spv 文件）创建 Vulkan 着色器模块，
-	 * 该模块可用于后续创建图形管线（如顶点着色器、片段着色器）。
-	 *
-	 * @param code 包含 SPIR-V 字节码的二进制数据（通常通过文件读取得到）。
-	 * @return VkShaderModule 创建成功的着色器模块句柄。
-	 *
-	 * @throws std::runtime_error 如果着色器模块创建失败。
+	 * @brief 以 HOST_VISIBLE | HOST_COHERENT 内存创建场景网格（仅用于基准测试对比）。
 	 */
-	VkShaderModule createShaderModule(const std::vector<char>& code);
+	MeshBuffers createHostVisibleMesh();
 
-private:
-	uint32_t findMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
+	/**
+	 * @brief 销毁网格的顶点/索引缓冲并释放内存。
+	 */
+	void destroyMeshBuffers(MeshBuffers& mesh);
+
+	/**
+	 * @brief 生成覆盖整个视口的 N×N 四边形网格（顺时针三角形，颜色按位置渐变）。
+	 *
+	 * @param n        每个方向上的四边形数量。
+	 * @param vertices 输出：顶点数据。
+	 * @param indices  输出：索引数据。
+	 */
+	static void generateGridMesh(uint32_t n, std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
 
 private:
 	/**
@@ -368,10 +820,93 @@ private:
 	 *
 	 * @param commandBuffer 要写入命令的 VkCommandBuffer（通常为主命令缓冲）。
 	 * @param imageIndex    当前使用的交换链图像索引，用于选择对应的帧缓冲。
+	 * @param cacheable     录制供缓存复用的场景命令：不录制 ImGui，也不使用并行录制的次级命令缓冲
+	 *                      （次级命令缓冲每帧重新录制会使引用它的主命令缓冲失效）。
 	 *
 	 * @throws std::runtime_error 如果命令缓冲录制开始或结束失败。
 	 */
-	void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+	void recordCommandBuffer(VkCommandBuffer commandBuffer, uint32_t imageIndex, bool cacheable);
+
+	/**
+	 * @brief 准备本帧要提交的命令缓冲，结果放在 _frameCommandBuffers 中。
+	 *
+	 * 先写入本帧的场景 uniform 并确定场景管线。未启用缓存时重新录制 _commandBuffers[_currentFrame]；
+	 * 启用时按（帧槽位，图像索引）取缓存的场景命令缓冲，版本过期才重新录制，ImGui 另外录制到
+	 * _commandBuffers[_currentFrame] 中。
+	 */
+	void prepareFrameCommands(uint32_t imageIndex);
+
+	/**
+	 * @brief 当前帧能否使用缓存的命令缓冲。
+	 *
+	 * 每帧更新实例数据或模拟实例运动时命令内容每帧都不同，退回逐帧录制；渲染图模式每帧重新声明并录制。
+	 */
+	bool commandCacheUsable() const;
+
+	/**
+	 * @brief 命令缓冲无法缓存的原因（UTF-8，用于 ImGui 提示），可以缓存时返回 nullptr。
+	 */
+	const char* commandCacheBlocker() const;
+
+	/**
+	 * @brief 使所有缓存的命令缓冲失效，下次使用时重新录制。
+	 */
+	void invalidateCommandCache();
+
+	/**
+	 * @brief 释放缓存的命令缓冲。
+	 *
+	 * @param deferred 为 true 时交给 _deletionQueue，等已提交的帧完成后再释放（交换链重建时使用）。
+	 */
+	void releaseCommandCache(bool deferred);
+
+	/**
+	 * @brief 录制 ImGui 叠加层：以保留原内容的方式再次开始渲染，绘制 ImGui 后转换到呈现布局。
+	 */
+	void recordOverlay(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+
+	/**
+	 * @brief 录制绘制列表中 [first, first + count) 的绘制，包括管线、视口与顶点/索引缓冲的绑定。
+	 *
+	 * 次级命令缓冲不继承这些状态，因此每段都要重新绑定；可在多个工作线程上同时调用。
+	 * 实例化场景下条目为实例（逐对象模式）或唯一的一次实例化绘制。
+	 */
+	void recordSceneDraws(VkCommandBuffer commandBuffer, uint32_t first, uint32_t count);
+
+	/**
+	 * @brief 开始向交换链（或离屏）图像 imageIndex 渲染，清屏为背景色。
+	 *
+	 * 渲染通道模式下调用 vkCmdBeginRenderPass；动态渲染模式下先把图像转换到 COLOR_ATTACHMENT_OPTIMAL，
+	 * 再以图像视图直接调用 vkCmdBeginRenderingKHR。
+	 *
+	 * @param secondary 渲染内容是否全部来自次级命令缓冲。
+	 */
+	void beginSceneRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex, bool secondary);
+
+	/**
+	 * @brief 结束渲染；动态渲染模式下再把图像转换到呈现（无头模式为传输源）布局。
+	 */
+	void endSceneRendering(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+
+	/**
+	 * @brief 渲染图模式下声明本帧的通道（场景、模糊链、ImGui），编译后录制到命令缓冲。
+	 *
+	 * 交换链图像以导入资源的方式加入，布局转换与通道之间的屏障全部由渲染图推导。
+	 */
+	void recordFrameGraph(VkCommandBuffer commandBuffer, uint32_t imageIndex);
+
+	/**
+	 * @brief 渲染图通道内开始动态渲染：单个颜色附件，clear 为 true 时清屏为背景色，否则保留原内容。
+	 *        图像布局已由渲染图转换为 COLOR_ATTACHMENT_OPTIMAL。
+	 */
+	void beginGraphRendering(VkCommandBuffer commandBuffer, VkImageView view, VkExtent2D extent, bool clear);
+
+	/**
+	 * @brief 向渲染图添加一个 blit 通道：把 source 线性缩放到 target 的尺寸。
+	 *
+	 * @return target 被写入后的新版本。
+	 */
+	RenderGraph::Resource addBlitPass(const std::string& name, RenderGraph::Resource source, RenderGraph::Resource target);
 
 private:
 	/**
@@ -387,20 +922,35 @@ private:
 	 */
 	static void framebufferResizeCallback(GLFWwindow* window, int width, int height);
 
+	/**
+	 * @brief 输入与窗口事件（鼠标、键盘、焦点、重绘请求等）的公共回调：按需渲染模式下请求重新绘制。
+	 *
+	 * 在 ImGui 初始化前安装，ImGui 的 GLFW 后端会链式调用这些回调。
+	 */
+	static void inputEventCallback(GLFWwindow* window);
+
 	/**
 	 * @brief 重建交换链及其相关资源。
 	 *
 	 * 当窗口尺寸发生变化（如最小化或用户手动调整大小）后，
 	 * 原有的交换链不再适用。该函数等待窗口恢复有效大小后，
-	 * 先使设备空闲，然后清理旧的交换链资源，再重新创建交换链、
+	 * 以旧交换链作为 oldSwapchain 创建新交换链，再重新创建
 	 * 图像视图和帧缓冲对象等依赖于交换链的资源。
 	 *
+	 * 不等待设备空闲：旧交换链、图像视图、帧缓冲与渲染完成信号量可能仍被在途帧使用，
+	 * 交给 _deletionQueue，在使用过它们的帧的栅栏触发后销毁。
+	 *
 	 * 注意：不要在绘制过程中调用此函数，应在 `vkQueuePresentKHR`
 	 * 返回 `VK_ERROR_OUT_OF_DATE_KHR` 或 `VK_SUBOPTIMAL_KHR` 时调用，
 	 * 或通过窗口大小回调设置的标志位触发。
 	 */
 	void recreateSwapChain();
 
+	/**
+	 * @brief 切换呈现策略，下一帧呈现后重建交换链以应用新的呈现模式。
+	 */
+	void setPresentPolicy(PresentPacer::Policy policy);
+
 	/**
 	 * @brief 清理与交换链相关的资源。
 	 *
@@ -412,6 +962,12 @@ private:
 	 */
 	void cleanupSwapChain();
 
+	/**
+	 * @brief 销毁一组交换链对象（帧缓冲、图像视图、渲染完成信号量与交换链本身）。GPU 必须不再使用它们。
+	 */
+	void destroySwapChainObjects(VkSwapchainKHR swapChain, const std::vector<VkImageView>& imageViews,
+		const std::vector<VkFramebuffer>& framebuffers, const std::vector<VkSemaphore>& semaphores);
+
 private:
 	/**
 	 * @brief 检查当前系统是否支持指定的 Vulkan 验证层（如 VK_LAYER_KHRONOS_validation）。
@@ -546,6 +1102,7 @@ private:
 	 * @brief 结束一次短期使用的命令缓冲录制并提交执行。
 	 *
 	 * 该函数会完成命令缓冲的录制，提交到图形队列执行，并等待执行完成后释放该命令缓冲。
+	 * 只等待这一次提交的栅栏，不等待整个图形队列空闲；批量上传应使用 _uploadQueue。
 	 *
 	 * @param commandBuffer 已开始录制的命令缓冲对象。
 	 */
@@ -560,7 +1117,25 @@ private:
 	 */
 	void renderImGui(VkCommandBuffer cmdBuf);
 
+	/**
+	 * @brief 纹理浏览窗口：流送统计、显存预算与当前页的缩略图。只有当前页的纹理会被请求加载。
+	 */
+	void renderTextureBrowser();
+
+	/**
+	 * @brief 返回纹理缩略图的 ImGui 描述符集，纹理视图变化时重新创建，旧的描述符集延迟释放。
+	 */
+	VkDescriptorSet textureThumbnail(TextureStreamer::Handle handle);
+
+	/**
+	 * @brief 延迟释放所有缩略图描述符集（翻页时调用，避免耗尽 ImGui 的描述符池）。
+	 */
+	void releaseTextureThumbnails();
+
 private:
+	// 运行配置（窗口/无头模式、基准测试参数等）
+	AppConfig _config;
+
 	int _width;
 
 	int _height;
@@ -590,6 +1165,22 @@ private:
 	// 逻辑设备中的呈现队列句柄，用于提交图像呈现请求
 	VkQueue _presentQueue = VK_NULL_HANDLE;
 
+	// 异步计算队列族与队列句柄；没有独立计算队列族时与图形队列相同
+	uint32_t _computeQueueFamily = 0;
+	VkQueue _computeQueue = VK_NULL_HANDLE;
+
+	// 专用传输队列族与队列句柄；没有专用传输队列族时与图形队列相同
+	uint32_t _transferQueueFamily = 0;
+	VkQueue _transferQueue = VK_NULL_HANDLE;
+
+	// 批量异步上传队列（暂存环 + 按批提交）
+	UploadQueue _uploadQueue;
+
+	// 纹理流送（未指定纹理目录时不创建）与纹理浏览器的缩略图、当前页
+	TextureStreamer _textureStreamer;
+	std::vector<TextureThumbnail> _textureThumbnails;
+	int _texturePage = 0;
+
 private:
 	// vulkan窗口表面完全是一个 可选组件，如果你只需要离屏渲染。
 	// Vulkan 浏览器 允许您在没有创建不可见窗口等技巧的情况下执行此作 （对于 OpenGL 是必需的）。
@@ -610,32 +1201,158 @@ private:
 	// 交换链图像的尺寸（宽高），与窗口帧缓冲一致。
 	VkExtent2D _swapChainExtent;
 
-	// 所需启用的逻辑设备扩展列表，目前仅包含 VK_KHR_swapchain。
-	const std::vector<const char*> _deviceExtensions = { VK_KHR_SWAPCHAIN_EXTENSION_NAME };
+	// 所需启用的逻辑设备扩展列表，窗口模式下包含 VK_KHR_swapchain，无头模式下为空。
+	std::vector<const char*> _deviceExtensions;
 
 private:
 	// 交换链图像视图列表，每个交换链图像对应一个 VkImageView，
 	// 用于描述图像在渲染管线中的访问方式和格式信息。
 	std::vector<VkImageView> _swapChainImageViews;
 
+	// 无头模式下离屏渲染目标的显存分配，与 _swapChainImages 一一对应
+	std::vector<GpuAllocation> _offscreenImageAllocations;
+
 private:
-	// 渲染通道对象，用于定义帧缓冲中附件的使用方式和生命周期（如颜色、深度等）。
-	VkRenderPass _renderPass;
+	// 渲染通道对象，用于定义帧缓冲中附件的使用方式和生命周期（如颜色、深度等）；动态渲染模式下为空。
+	VkRenderPass _renderPass = VK_NULL_HANDLE;
+
+	// 叠加层渲染通道：保留场景内容（LOAD）后绘制 ImGui，与 _renderPass 兼容，共用帧缓冲；仅窗口模式的渲染通道路径创建
+	VkRenderPass _overlayRenderPass = VK_NULL_HANDLE;
+
+	// 是否使用 VK_KHR_dynamic_rendering 代替渲染通道与帧缓冲
+	bool _dynamicRendering = false;
+
+	// VK_KHR_dynamic_rendering 的命令，Vulkan 1.0 实例下需通过 vkGetDeviceProcAddr 获取
+	PFN_vkCmdBeginRenderingKHR _cmdBeginRendering = nullptr;
+	PFN_vkCmdEndRenderingKHR _cmdEndRendering = nullptr;
+
+	// 渲染图模式（需要动态渲染）：每帧声明通道，屏障与瞬态图像由渲染图管理
+	bool _renderGraphEnabled = false;
+	RenderGraph _renderGraph;
+
+	// VK_KHR_synchronization2 的屏障命令，设备不支持时为空，渲染图退回 vkCmdPipelineBarrier
+	PFN_vkCmdPipelineBarrier2KHR _cmdPipelineBarrier2 = nullptr;
+
+	// 模糊链的降采样级数；格式不支持线性 blit 时模糊链不可用，级数固定为 0
+	int _blurLevels = 0;
+	bool _blurSupported = false;
 
 	// 图形渲染管线对象，封装了整个图形绘制流程（包含着色器、输入装配、光栅化等阶段）。
 	VkPipeline _graphicsPipeline;
 
+	// 实例化管线：顶点绑定 0 为网格顶点，绑定 1 为每实例数据；未启用实例化时为空
+	VkPipeline _instancedPipeline = VK_NULL_HANDLE;
+
 	// 管线布局对象，指定了着色器所需的资源绑定接口（如 descriptor set、push constant 等）。
-	VkPipelineLayout _pipelineLayout;
+	VkPipelineLayout _pipelineLayout = VK_NULL_HANDLE;
+
+	// 持久化管线缓存，所有管线（含 ImGui）共用
+	PipelineCache _pipelineCache;
+
+	// 场景管线使用的着色器模块（归 _shaderLibrary 所有），编译变体时复用
+	VkShaderModule _vertShaderModule = VK_NULL_HANDLE;
+	VkShaderModule _fragShaderModule = VK_NULL_HANDLE;
+	VkShaderModule _instancedShaderModule = VK_NULL_HANDLE;
+
+	// 管线变体的后台编译；当前选择的变体尚未就绪时用通用管线绘制
+	PipelineManager _pipelineManager;
+	PipelineVariant _pipelineVariant;
+
+	// 本帧场景绘制绑定的管线，录制前在主线程确定，录制线程只读取
+	VkPipeline _scenePipeline = VK_NULL_HANDLE;
+
+	// 因变体尚未编译完成而使用通用管线绘制的帧数
+	uint64_t _pipelineFallbacks = 0;
+
+	// 着色器模块库，按内容去重，模块在所有管线构建之间复用
+	ShaderLibrary _shaderLibrary;
+
+	// 进程内 GLSL 编译器与源文件监视（--hot-reload）
+	ShaderCompiler _shaderCompiler;
+	ShaderWatcher _shaderWatcher;
+
+	// 显存分配器，所有缓冲与图像共用
+	GpuAllocator _allocator;
+
+	// 管线缓存文件路径
+	const std::string _pipelineCachePath = "pipeline_cache.bin";
+
+	// 程序启动时间点，用于统计启动耗时
+	std::chrono::steady_clock::time_point _startTime;
+
+	// 累计的管线创建耗时（毫秒），用于对比冷/热缓存
+	double _pipelineBuildMs = 0.0;
 
 private:
 	// 交换链对应的帧缓冲区列表，每个交换链图像对应一个帧缓冲区
 	std::vector<VkFramebuffer> _swapChainFramebuffers;
 
 private:
-	VkBuffer _vertexBuffer;
+	// 场景网格的 CPU 端数据
+	std::vector<Vertex> _meshVertices;
+
+	std::vector<uint32_t> _meshIndices;
+
+	// 场景网格的 GPU 缓冲（DEVICE_LOCAL）
+	MeshBuffers _mesh;
+
+	// 场景绘制列表
+	std::vector<DrawItem> _drawList;
+
+	// 实例化绘制的实例数，0 表示不使用实例化路径
+	uint32_t _instanceCount = 0;
+
+	// 实例数据的 CPU 端副本与设备缓冲
+	std::vector<InstanceData> _instances;
+	InstanceBuffer _instanceBuffer;
+
+	// 每帧数据的环形缓冲，当前帧槽位的栅栏触发后才开始写入该槽位的分区
+	FrameRingBuffer _frameRing;
+
+	// 场景 uniform 的描述符：一个动态 uniform 缓冲绑定，绘制时以本帧切片的偏移绑定
+	VkDescriptorSetLayout _sceneSetLayout = VK_NULL_HANDLE;
+	VkDescriptorPool _sceneDescriptorPool = VK_NULL_HANDLE;
+	VkDescriptorSet _sceneDescriptorSet = VK_NULL_HANDLE;
+	uint32_t _sceneUniformOffset = 0;
+
+	// 场景色调，与顶点颜色相乘
+	glm::vec4 _sceneTint = glm::vec4(1.0f);
+
+	// 每帧增量更新的实例数，以及滑动窗口的起点
+	uint32_t _instanceUpdatesPerFrame = 0;
+	uint32_t _instanceUpdateCursor = 0;
+
+	// 逐对象绘制实例（用于基准测试对比），否则一次实例化绘制全部实例
+	bool _instancePerObject = false;
+
+	// 实例网格铺开的半宽（NDC），大于 1 时部分实例在视口外
+	float _instanceExtent = 1.0f;
+
+	// 场景网格的包围圆半径，用于剔除
+	float _meshRadius = 0.0f;
+
+	// 剔除使用的视口矩形：最小 x、最小 y、最大 x、最大 y
+	float _cullRect[4] = { -1.0f, -1.0f, 1.0f, 1.0f };
+
+	// GPU 驱动渲染：计算着色器剔除实例并生成间接绘制命令
+	bool _gpuDriven = false;
+	GpuCuller _gpuCuller;
+
+	// 设备是否启用了 VK_KHR_draw_indirect_count 与 multiDrawIndirect
+	bool _drawIndirectCountEnabled = false;
+	bool _multiDrawIndirectEnabled = false;
+
+	// 实例运动由计算着色器模拟，在异步计算队列上提交
+	bool _simulate = false;
+	InstanceSimulation _simulation;
+	AsyncCompute _asyncCompute;
+
+	// 每帧模拟的积分子步数
+	uint32_t _simSubsteps = 0;
+
+	// 本帧图形读取的模拟输出缓冲
+	uint32_t _simOutput = 0;
 
-	VkDeviceMemory _vertexBufferMemory;
 private:
 	// 命令池，用于管理和分配命令缓冲区
 	VkCommandPool _commandPool;
@@ -643,22 +1360,122 @@ private:
 	// 主要的命令缓冲区，用于记录绘制指令
 	std::vector<VkCommandBuffer> _commandBuffers;
 
+	// 本帧提交的命令缓冲：逐帧录制时只有 _commandBuffers[_currentFrame]，缓存时为场景命令缓冲 + ImGui 命令缓冲
+	std::vector<VkCommandBuffer> _frameCommandBuffers;
+
+	// 是否缓存录制好的场景命令缓冲，内容不变时直接重新提交
+	bool _cacheCommands = false;
+
+	// 缓存的场景命令缓冲，下标为 帧槽位 × 图像数 + 图像索引；首次使用时分配
+	std::vector<CachedCommandBuffer> _commandCache;
+
+	// 场景命令的状态版本，任何影响录制内容的变化都使其递增
+	uint64_t _commandVersion = 1;
+
+	// 上一帧的场景管线与背景色：ImGui、管线变体编译完成等直接改变它们，每帧比较一次
+	VkPipeline _cachedScenePipeline = VK_NULL_HANDLE;
+	glm::vec3 _cachedBackColor = glm::vec3(0.0f);
+
+	// 缓存命中（直接重新提交）与重新录制的次数
+	uint64_t _commandCacheHits = 0;
+	uint64_t _commandCacheRecords = 0;
+
+	// 并行录制次级命令缓冲的工作线程数，0 表示在主线程直接录制
+	uint32_t _recordThreads;
+
+	// 并行录制器
+	ParallelRecorder _parallelRecorder;
+
 private:
 	bool _framebufferResized = false;
 
+	// 按需渲染：没有待绘制内容时阻塞等待事件
+	bool _onDemand = false;
+
+	// 按需渲染模式下还需绘制的帧数；ImGui 在事件后的几帧内才稳定（悬停、布局），每次事件请求 kInputRedrawFrames 帧
+	uint32_t _redrawFrames = 0;
+
+	// 上一帧 ImGui 是否有控件处于激活状态（拖动滑条、移动窗口、文本输入等），是则继续绘制
+	bool _imguiActive = false;
+
+	// 上一次迭代没有绘制（空闲或最小化），下一帧需要重新对齐帧节奏
+	bool _idle = false;
+
+	// 帧率上限
+	FrameLimiter _frameLimiter;
+
+	// 窗口模式绘制的帧数、空闲唤醒次数（事件或超时后仍无内容可绘制）与空闲等待的累计时长
+	uint64_t _framesDrawn = 0;
+	uint64_t _idleWakeups = 0;
+	std::chrono::steady_clock::duration _idleTime{ 0 };
+
 	// CPU-GPU 同步对象，标记当前帧是否执行完成
 	std::vector<VkFence> _inFlightFences;
 
 	// 信号量，表示交换链图像是否可用，等待此信号量后开始渲染
 	std::vector<VkSemaphore> _imageAvailableSemaphores;
 
-	// 信号量，表示渲染是否完成，等待此信号量后提交呈现请求
+	// 信号量，表示渲染是否完成，等待此信号量后提交呈现请求；按交换链图像索引
 	std::vector<VkSemaphore> _renderFinishedSemaphores;
 
+	// 图形提交的序号，每次提交加一；时间线模式下即图形时间线的触发值
+	uint64_t _submitSerial = 0;
+
+	// 每个帧槽位最近一次提交的序号，该槽位栅栏触发时此序号及之前的提交都已完成
+	std::vector<uint64_t> _frameSerials;
+
+	// 是否使用时间线信号量代替每帧栅栏
+	bool _timelineSync = false;
+
+	// 图形队列的时间线信号量，仅时间线模式下创建
+	GpuTimeline _graphicsTimeline;
+
+	// 重建交换链时退役的对象，在使用过它们的帧完成后销毁
+	DeletionQueue _deletionQueue;
+
+	// 呈现策略与基于 present_wait 的帧节奏控制
+	PresentPacer _presentPacer;
+
+	// 当前交换链的呈现模式，以及每种策略最近一次实际使用的模式（用于报告）
+	VkPresentModeKHR _presentMode = VK_PRESENT_MODE_FIFO_KHR;
+	std::array<VkPresentModeKHR, PresentPacer::PolicyCount> _policyPresentModes{};
+
+	// 呈现策略已切换，等待重建交换链
+	bool _presentPolicyChanged = false;
+
+	// 设备是否启用了 VK_KHR_present_id 与 VK_KHR_present_wait
+	bool _presentWaitEnabled = false;
+
+	// 实例是否启用了 VK_KHR_get_physical_device_properties2（查询与启用扩展特性需要）
+	bool _properties2Enabled = false;
+
 private:
 	uint32_t _currentFrame = 0;
 
-	const int _MAX_FRAMES_IN_FLIGHT = 2;
+	// 同时在 GPU 上执行的帧数，由配置决定，基准测试中可在运行时修改
+	int _framesInFlight;
+
+	// Surface 要求的最小交换链图像数量，传给 ImGui
+	uint32_t _swapChainMinImageCount = 2;
+
+private:
+	// GPU 分段计时器（整帧、渲染通道、场景绘制、ImGui）
+	GpuProfiler _gpuProfiler;
+
+	// GPU 计时 CSV 导出路径
+	const std::string _gpuProfileCsvPath = "gpu_profile.csv";
+
+	// 帧耗时统计（无头模式，或窗口模式指定 --report 时）
+	FrameStats _frameStats;
+
+	// 最近一次 runHeadlessPass() 的平均帧间隔（毫秒）
+	double _lastPassFrameMs = 0.0;
+
+	// CPU 帧阶段计时（直方图 + 最近若干帧），用于定位帧耗时尖刺
+	FramePhaseProfiler _phaseProfiler;
+
+	// 帧阶段耗时导出路径
+	const std::string _phaseDumpPath = "frame_phases.txt";
 
 private:
 	// 验证层,只有Debug时运行
@@ -0,0 +1,650 @@
+﻿#include "TriangleFunc.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <sstream>
+#include <thread>
+
+namespace {
+	// 分配器压力测试：每轮补足到的存活资源数
+	constexpr size_t kStressLiveResources = 20000;
+
+	// 分配器压力测试轮数，每轮结束时随机释放三分之二的资源
+	constexpr int kStressRounds = 10;
+
+	// 管线变体测试请求的变体数
+	constexpr size_t kPipelineVariants = 200;
+
+	// 上传批处理测试上传的资源数
+	constexpr size_t kUploadAssets = 4000;
+
+	// 渲染图测试未指定 --blur-levels 时的模糊级数
+	constexpr int kBenchBlurLevels = 4;
+}
+
+// 无头模式下的各项基准测试，与主渲染流程分开存放
+
+std::vector<std::string> TriangleFunc::benchVertexMemory()
+{
+	std::vector<std::string> reports;
+
+	// 第一轮：场景默认的 DEVICE_LOCAL 网格
+	reports.push_back(runHeadlessPass("vertex-memory/device-local"));
+
+	// 第二轮：同一网格放在 HOST_VISIBLE 内存中，临时替换场景网格
+	MeshBuffers hostMesh = createHostVisibleMesh();
+	std::swap(_mesh, hostMesh);
+	reports.push_back(runHeadlessPass("vertex-memory/host-visible"));
+	std::swap(_mesh, hostMesh);
+
+	// runHeadlessPass 结束时设备已空闲，可以直接销毁
+	destroyMeshBuffers(hostMesh);
+
+	return reports;
+}
+
+std::vector<std::string> TriangleFunc::benchAllocatorStress()
+{
+	// 一个压力测试资源：缓冲或图像之一
+	struct StressResource {
+		VkBuffer buffer = VK_NULL_HANDLE;
+		VkImage image = VK_NULL_HANDLE;
+		GpuAllocation allocation;
+	};
+
+	std::mt19937 rng(12345);
+	std::uniform_int_distribution<int> bufferShift(8, 16);    // 256 B ~ 64 KiB
+	std::uniform_int_distribution<int> imageShift(4, 8);      // 16 ~ 256 像素
+	std::uniform_int_distribution<int> kind(0, 999);
+
+	std::vector<StressResource> live;
+	live.reserve(kStressLiveResources);
+
+	uint64_t created = 0;
+	uint64_t destroyed = 0;
+	double createMs = 0.0;
+	double destroyMs = 0.0;
+	std::string peakStats;
+	VkDeviceSize peakReserved = 0;
+
+	auto destroyResource = [&](StressResource& resource) {
+		if (resource.buffer != VK_NULL_HANDLE) {
+			_allocator.DestroyBuffer(resource.buffer, resource.allocation);
+		}
+		else {
+			_allocator.DestroyImage(resource.image, resource.allocation);
+		}
+	};
+
+	for (int round = 0; round < kStressRounds; round++) {
+		// 补足存活资源：大部分为小缓冲，约 1/8 为 OPTIMAL 图像，偶尔出现走独占分配的大缓冲
+		auto start = std::chrono::steady_clock::now();
+		while (live.size() < kStressLiveResources) {
+			StressResource resource;
+			int k = kind(rng);
+			if (k < 125) {
+				uint32_t extent = 1u << imageShift(rng);
+
+				VkImageCreateInfo imageInfo{};
+				imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+				imageInfo.imageType = VK_IMAGE_TYPE_2D;
+				imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+				imageInfo.extent = { extent, extent, 1 };
+				imageInfo.mipLevels = 1;
+				imageInfo.arrayLayers = 1;
+				imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+				imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+				imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT;
+				imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+				imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+
+				_allocator.CreateImage(imageInfo, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, resource.image, resource.allocation);
+			}
+			else {
+				VkDeviceSize size = k == 999 ? 48ull * 1024 * 1024 : VkDeviceSize(1) << bufferShift(rng);
+				VkMemoryPropertyFlags properties = (k % 4 == 0)
+					? VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT
+					: VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+				_allocator.CreateBuffer(size, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+					properties, resource.buffer, resource.allocation);
+			}
+			live.push_back(resource);
+			created++;
+		}
+		createMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		// 记录占用最高时的分配器状态
+		GpuAllocatorStats stats = _allocator.GetStats();
+		if (stats.bytesReserved >= peakReserved) {
+			peakReserved = stats.bytesReserved;
+			peakStats = _allocator.StatsJson();
+		}
+
+		// 随机释放三分之二，制造碎片
+		std::shuffle(live.begin(), live.end(), rng);
+		size_t keep = live.size() / 3;
+
+		start = std::chrono::steady_clock::now();
+		for (size_t i = keep; i < live.size(); i++) {
+			destroyResource(live[i]);
+			destroyed++;
+		}
+		destroyMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		live.resize(keep);
+	}
+
+	// 碎片化之后的状态
+	std::string fragmentedStats = _allocator.StatsJson();
+
+	for (auto& resource : live) {
+		destroyResource(resource);
+		destroyed++;
+	}
+
+	std::ostringstream out;
+	out << "{\"name\":\"allocator-stress\""
+		<< ",\"created\":" << created
+		<< ",\"destroyed\":" << destroyed
+		<< ",\"create_us\":" << (created > 0 ? createMs * 1000.0 / created : 0.0)
+		<< ",\"destroy_us\":" << (destroyed > 0 ? destroyMs * 1000.0 / destroyed : 0.0)
+		<< ",\"peak\":" << peakStats
+		<< ",\"fragmented\":" << fragmentedStats
+		<< ",\"final\":" << _allocator.StatsJson()
+		<< "}";
+	return { out.str() };
+}
+
+std::vector<std::string> TriangleFunc::benchUploadBatch()
+{
+	// 资源大小 256 B ~ 64 KiB，内容无关紧要
+	std::mt19937 rng(4321);
+	std::uniform_int_distribution<int> sizeShift(8, 16);
+	std::vector<VkDeviceSize> sizes(kUploadAssets);
+	VkDeviceSize totalBytes = 0;
+	for (auto& size : sizes) {
+		size = VkDeviceSize(1) << sizeShift(rng);
+		totalBytes += size;
+	}
+	std::vector<uint8_t> data(static_cast<size_t>(VkDeviceSize(1) << 16), 0x5a);
+
+	std::vector<VkBuffer> buffers(kUploadAssets);
+	std::vector<GpuAllocation> allocations(kUploadAssets);
+	auto createTargets = [&]() {
+		for (size_t i = 0; i < kUploadAssets; i++) {
+			_allocator.CreateBuffer(sizes[i], VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+				VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffers[i], allocations[i]);
+		}
+	};
+	auto destroyTargets = [&]() {
+		for (size_t i = 0; i < kUploadAssets; i++) {
+			_allocator.DestroyBuffer(buffers[i], allocations[i]);
+		}
+	};
+	auto report = [&](const char* name, double totalMs, double enqueueMs, uint64_t submits, uint64_t stalls) {
+		std::ostringstream out;
+		out << "{\"name\":\"" << name << "\""
+			<< ",\"assets\":" << kUploadAssets
+			<< ",\"bytes\":" << totalBytes
+			<< ",\"dedicated_transfer\":" << (_uploadQueue.IsDedicated() ? 1 : 0)
+			<< ",\"total_ms\":" << totalMs
+			<< ",\"enqueue_ms\":" << enqueueMs
+			<< ",\"submits\":" << submits
+			<< ",\"stalls\":" << stalls
+			<< "}";
+		return out.str();
+	};
+
+	std::vector<std::string> reports;
+	vkDeviceWaitIdle(_device);
+
+	// 第一轮：每个资源单独创建暂存缓冲、提交并等待完成
+	createTargets();
+	auto start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < kUploadAssets; i++) {
+		VkBuffer stagingBuffer;
+		GpuAllocation stagingAlloc;
+		_allocator.CreateBuffer(sizes[i], VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer, stagingAlloc);
+		memcpy(stagingAlloc.mapped, data.data(), static_cast<size_t>(sizes[i]));
+
+		VkCommandBuffer commandBuffer = beginSingleTimeCommands();
+		VkBufferCopy region{};
+		region.size = sizes[i];
+		vkCmdCopyBuffer(commandBuffer, stagingBuffer, buffers[i], 1, &region);
+		endSingleTimeCommands(commandBuffer);
+
+		_allocator.DestroyBuffer(stagingBuffer, stagingAlloc);
+	}
+	double immediateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	destroyTargets();
+	reports.push_back(report("upload-batch/immediate", immediateMs, immediateMs, kUploadAssets, 0));
+
+	// 第二轮：全部写入上传队列，暂存环写满时才提交，最后一次 Flush 后等待
+	createTargets();
+	_uploadQueue.ResetStats();
+	start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < kUploadAssets; i++) {
+		_uploadQueue.UploadBuffer(buffers[i], 0, data.data(), sizes[i]);
+	}
+	UploadQueue::Ticket ticket = _uploadQueue.Flush();
+	double enqueueMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	_uploadQueue.Wait(ticket);
+	double batchedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+	// 专用传输队列时获取屏障在图形队列上，等待设备空闲后再销毁目标缓冲
+	vkDeviceWaitIdle(_device);
+	destroyTargets();
+	const UploadQueue::Stats& stats = _uploadQueue.GetStats();
+	reports.push_back(report("upload-batch/batched", batchedMs, enqueueMs, stats.submits, stats.stalls));
+
+	return reports;
+}
+
+std::vector<std::string> TriangleFunc::benchRenderGraph()
+{
+	if (!_renderGraphEnabled) {
+		throw std::runtime_error("render-graph 基准测试需要 --render-graph 且设备支持动态渲染!");
+	}
+	if (!_blurSupported) {
+		throw std::runtime_error("交换链格式不支持线性 blit，不能运行 render-graph 基准测试!");
+	}
+
+	std::vector<std::string> reports;
+	int originalLevels = _blurLevels;
+	bool originalAliasing = _renderGraph.Aliasing();
+	int levels = _config.blurLevels > 0 ? static_cast<int>(_config.blurLevels) : kBenchBlurLevels;
+
+	// 第一轮：场景直接渲染到离屏目标，只有场景一个通道
+	_blurLevels = 0;
+	reports.push_back(runHeadlessPass("render-graph/direct"));
+
+	// 第二轮：模糊链，生命周期不重叠的瞬态图像共用显存
+	_blurLevels = levels;
+	_renderGraph.SetAliasing(true);
+	reports.push_back(runHeadlessPass("render-graph/blur"));
+
+	// 第三轮：同一模糊链，每个瞬态图像单独占一块显存
+	_renderGraph.SetAliasing(false);
+	reports.push_back(runHeadlessPass("render-graph/blur-no-alias"));
+
+	_renderGraph.SetAliasing(originalAliasing);
+	_blurLevels = originalLevels;
+	return reports;
+}
+
+std::string TriangleFunc::benchTextureStreaming()
+{
+	if (!_textureStreamer.IsValid()) {
+		throw std::runtime_error("texture-streaming 基准测试需要 --texture-dir!");
+	}
+	uint32_t count = _textureStreamer.Count();
+	if (count == 0) {
+		throw std::runtime_error("纹理目录中没有图像: " + _config.textureDir);
+	}
+
+	_frameStats.Clear();
+	_frameStats.AddField("frames_in_flight", _framesInFlight);
+	_phaseProfiler.Reset();
+	_textureStreamer.ResetStats();
+
+	// 一次预取全部纹理：解码受已解码数据上限约束，上传受每帧预算约束，超出显存预算的部分边加载边逐出
+	auto begin = std::chrono::steady_clock::now();
+	for (TextureStreamer::Handle handle = 0; handle < count; handle++) {
+		_textureStreamer.Prefetch(handle);
+	}
+
+	// 没有纹理被显示，不会重新加载被逐出的纹理；每个纹理驻留一次或失败后结束
+	auto frameStart = begin;
+	TextureStreamer::Stats stats = _textureStreamer.GetStats();
+	while (stats.uploads + stats.failed < count) {
+		drawOffscreenFrame();
+		_phaseProfiler.EndFrame();
+
+		auto now = std::chrono::steady_clock::now();
+		_frameStats.AddCpuTime(std::chrono::duration<double, std::milli>(now - frameStart).count());
+		frameStart = now;
+		stats = _textureStreamer.GetStats();
+	}
+
+	vkDeviceWaitIdle(_device);
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	// 最差帧耗时即 cpu_ms.max；流送本身的每帧耗时单独列出
+	FramePhaseProfiler::PhaseSummary stream = _phaseProfiler.Summary(FramePhaseProfiler::Stream);
+	const VkDeviceSize mb = 1024 * 1024;
+	_frameStats.AddField("textures", count);
+	_frameStats.AddField("failed", stats.failed);
+	_frameStats.AddField("decode_threads_ms", std::llround(stats.decodeMs));
+	_frameStats.AddField("uploaded_mb", static_cast<int64_t>(stats.uploadedBytes / mb));
+	_frameStats.AddField("budget_mb", static_cast<int64_t>(_textureStreamer.GetSettings().memoryBudget / mb));
+	_frameStats.AddField("peak_resident_mb", static_cast<int64_t>(stats.peakResidentBytes / mb));
+	_frameStats.AddField("evictions", static_cast<int64_t>(stats.evictions));
+	_frameStats.AddField("compressed_uploads", static_cast<int64_t>(stats.compressedUploads));
+	_frameStats.AddField("transcodes", static_cast<int64_t>(stats.transcodes));
+	_frameStats.AddField("busy_frames", static_cast<int64_t>(stats.busyFrames));
+	_frameStats.AddField("stream_p99_us", std::llround(stream.p99 * 1000.0));
+	_frameStats.AddField("stream_max_us", std::llround(stream.max * 1000.0));
+
+	return _frameStats.ToJson("texture-streaming", elapsed);
+}
+
+std::vector<std::string> TriangleFunc::benchFramesInFlight()
+{
+	std::vector<std::string> reports;
+	int original = _framesInFlight;
+
+	// 帧数越多，CPU 越少在栅栏上阻塞，但帧延迟随之增加
+	for (int count = 1; count <= AppConfig::kMaxFramesInFlight; count++) {
+		setFramesInFlight(count);
+		reports.push_back(runHeadlessPass("frames-in-flight/" + std::to_string(count)));
+	}
+
+	setFramesInFlight(original);
+	return reports;
+}
+
+std::vector<std::string> TriangleFunc::benchParallelRecord()
+{
+	std::vector<std::string> reports;
+	uint32_t original = _recordThreads;
+
+	// 基线：主线程直接录制主命令缓冲
+	setRecordThreads(0);
+	reports.push_back(runHeadlessPass("parallel-record/inline"));
+
+	// 1、2、4 … 个工作线程，最后一轮为全部硬件线程
+	uint32_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+	for (uint32_t count = 1; ; count *= 2) {
+		count = std::min(count, maxThreads);
+		setRecordThreads(count);
+		reports.push_back(runHeadlessPass("parallel-record/" + std::to_string(count)));
+		if (count == maxThreads) {
+			break;
+		}
+	}
+
+	setRecordThreads(original);
+	return reports;
+}
+
+std::vector<std::string> TriangleFunc::benchInstancing()
+{
+	std::vector<std::string> reports;
+
+	// 逐对象绘制：与实例化绘制使用同一管线与实例数据，只是每个对象一次 vkCmdDrawIndexed
+	_instancePerObject = true;
+	reports.push_back(runHeadlessPass("instancing/per-object"));
+
+	// 单次实例化绘制
+	_instancePerObject = false;
+	reports.push_back(runHeadlessPass("instancing/instanced"));
+
+	// 每帧增量更新 1% 的实例
+	uint32_t original = _instanceUpdatesPerFrame;
+	_instanceUpdatesPerFrame = std::max(1u, _instanceCount / 100);
+	reports.push_back(runHeadlessPass("instancing/instanced-update"));
+	_instanceUpdatesPerFrame = original;
+
+	return reports;
+}
+
+std::vector<std::string> TriangleFunc::benchGpuDriven()
+{
+	if (!_gpuCuller.IsValid()) {
+		throw std::runtime_error("GPU 剔除不可用，无法运行 gpu-driven 基准测试!");
+	}
+
+	std::vector<std::string> reports;
+	bool originalPerObject = _instancePerObject;
+	bool originalGpuDriven = _gpuDriven;
+
+	// CPU 提交：CPU 逐对象剔除，每个可见对象一次 vkCmdDrawIndexed
+	_gpuDriven = false;
+	_instancePerObject = true;
+	reports.push_back(runHeadlessPass("gpu-driven/cpu-submitted"));
+
+	// GPU 驱动：一次派发 + 一次间接绘制
+	_gpuDriven = true;
+	_instancePerObject = false;
+	reports.push_back(runHeadlessPass(_gpuCuller.UsesDrawCount() ? "gpu-driven/indirect-count" : "gpu-driven/indirect"));
+
+	_instancePerObject = originalPerObject;
+	_gpuDriven = originalGpuDriven;
+
+	return reports;
+}
+
+std::vector<std::string> TriangleFunc::benchAsyncCompute()
+{
+	if (!_simulation.IsValid()) {
+		throw std::runtime_error("实例模拟未启用，无法运行 async-compute 基准测试!");
+	}
+
+	std::vector<std::string> reports;
+
+	// 串行：第 N 帧计算等待第 N - 1 帧图形，图形再等待计算，两者在 GPU 上交替执行；
+	// 这一轮的计算耗时不受图形工作干扰，作为计算本身的耗时
+	vkDeviceWaitIdle(_device);
+	_asyncCompute.SetLatency(1);
+	_asyncCompute.ResetStats();
+	reports.push_back(runHeadlessPass("async-compute/serial"));
+	double computeMs = _asyncCompute.AverageMs();
+	double serialMs = _lastPassFrameMs;
+
+	// 重叠：第 N 帧计算只等待第 N - 2 帧图形，与第 N - 1 帧图形并行
+	vkDeviceWaitIdle(_device);
+	_asyncCompute.SetLatency(AsyncCompute::kMaxLatency);
+	_asyncCompute.ResetStats();
+	reports.push_back(runHeadlessPass("async-compute/overlapped"));
+	double overlappedMs = _lastPassFrameMs;
+
+	// 被掩盖的比例 = 重叠节省的帧时间 / 计算耗时；队列不支持时间戳时无法计算
+	std::ostringstream out;
+	out << "{\"name\":\"async-compute/overlap\""
+		<< ",\"async_queue\":" << (_asyncCompute.IsAsync() ? "true" : "false")
+		<< ",\"instances\":" << _instanceCount
+		<< ",\"substeps\":" << _simSubsteps
+		<< ",\"serial_frame_ms\":" << serialMs
+		<< ",\"overlapped_frame_ms\":" << overlappedMs;
+	if (computeMs > 0.0) {
+		double hidden = std::clamp((serialMs - overlappedMs) / computeMs, 0.0, 1.0);
+		out << ",\"compute_ms\":" << computeMs << ",\"hidden_pct\":" << hidden * 100.0;
+	}
+	else {
+		out << ",\"compute_ms\":null,\"hidden_pct\":null";
+	}
+	out << "}";
+	reports.push_back(out.str());
+
+	return reports;
+}
+
+std::vector<std::string> TriangleFunc::benchPipelineVariants()
+{
+	// 剔除模式 × 正面朝向 × 混合 × 写入掩码共 256 种组合，跳过通用管线本身后取前 kPipelineVariants 个
+	bool instanced = _instanceCount > 0;
+	PipelineVariant generic;
+	generic.instanced = instanced;
+	std::vector<uint64_t> keys;
+	for (uint64_t bits = 0; keys.size() < kPipelineVariants; bits++) {
+		PipelineVariant variant = PipelineVariant::FromKey(bits);
+		variant.instanced = instanced;
+		if (variant.Key() != generic.Key()) {
+			keys.push_back(variant.Key());
+		}
+	}
+
+	std::vector<std::string> reports;
+	uint32_t originalThreads = _pipelineManager.ThreadCount();
+	PipelineVariant originalVariant = _pipelineVariant;
+
+	// 并行：请求后立即开始渲染，未就绪的变体用通用管线代替；串行：在渲染线程上逐个编译完才出第一帧
+	uint32_t parallelThreads = originalThreads > 0 ? originalThreads : std::max(1u, std::thread::hardware_concurrency());
+	for (uint32_t threads : { parallelThreads, 0u }) {
+		// 每轮使用空的管线缓存，不复用上一轮的编译结果
+		vkDeviceWaitIdle(_device);
+		_pipelineManager.Destroy();
+
+		VkPipelineCacheCreateInfo cacheInfo{};
+		cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		VkPipelineCache cache = VK_NULL_HANDLE;
+		if (vkCreatePipelineCache(_device, &cacheInfo, nullptr, &cache) != VK_SUCCESS) {
+			throw std::runtime_error("failed to create pipeline cache!");
+		}
+		createPipelineManager(cache, threads);
+
+		auto begin = std::chrono::steady_clock::now();
+		for (uint64_t key : keys) {
+			_pipelineManager.Request(key);
+		}
+
+		// 每帧换一个变体绘制，直到所有变体编译完成
+		double firstFrameMs = 0.0;
+		uint32_t frames = 0;
+		uint64_t fallbacksBefore = _pipelineFallbacks;
+		while (frames == 0 || _pipelineManager.PendingCount() > 0) {
+			_pipelineVariant = PipelineVariant::FromKey(keys[frames % keys.size()]);
+			drawOffscreenFrame();
+			if (frames == 0) {
+				firstFrameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+			}
+			frames++;
+		}
+		double allReadyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+		PipelineManager::Stats stats = _pipelineManager.GetStats();
+
+		std::ostringstream out;
+		out << "{\"name\":\"pipeline-variants/" << (threads > 0 ? "parallel" : "serial") << "\""
+			<< ",\"variants\":" << keys.size()
+			<< ",\"threads\":" << threads
+			<< ",\"first_frame_ms\":" << firstFrameMs
+			<< ",\"all_ready_ms\":" << allReadyMs
+			<< ",\"compile_ms\":" << stats.compileMs
+			<< ",\"frames\":" << frames
+			<< ",\"fallback_frames\":" << _pipelineFallbacks - fallbacksBefore
+			<< ",\"failed\":" << stats.failed
+			<< "}";
+		reports.push_back(out.str());
+
+		vkDeviceWaitIdle(_device);
+		_pipelineManager.Destroy();
+		vkDestroyPipelineCache(_device, cache, nullptr);
+	}
+
+	_pipelineVariant = originalVariant;
+	createPipelineManager(_pipelineCache.Get(), originalThreads);
+	return reports;
+}
+
+std::vector<std::string> TriangleFunc::benchCommandCache()
+{
+	if (_simulation.IsValid() || _instanceUpdatesPerFrame > 0) {
+		throw std::runtime_error("实例数据每帧变化，命令缓冲无法缓存，不能运行 command-cache 基准测试!");
+	}
+
+	std::vector<std::string> reports;
+	bool original = _cacheCommands;
+
+	// 每帧重新录制全部绘制命令
+	_cacheCommands = false;
+	reports.push_back(runHeadlessPass("command-cache/record"));
+
+	// 每个帧槽位只在第一帧录制，之后直接重新提交
+	_cacheCommands = true;
+	reports.push_back(runHeadlessPass("command-cache/cached"));
+
+	_cacheCommands = original;
+	return reports;
+}
+
+std::string TriangleFunc::benchResizeStorm()
+{
+	uint32_t maxFrames = _config.benchFrames > 0 ? _config.benchFrames : 600;
+
+	_frameStats.Clear();
+	_frameStats.Reserve(maxFrames);
+	_frameStats.AddField("frames_in_flight", _framesInFlight);
+	_frameStats.AddField("dynamic_rendering", _dynamicRendering ? 1 : 0);
+	_phaseProfiler.Reset();
+
+	auto begin = std::chrono::steady_clock::now();
+	auto frameStart = begin;
+	for (uint32_t frame = 0; frame < maxFrames && !glfwWindowShouldClose(_window); frame++) {
+		// 窗口尺寸在配置尺寸的 50% ~ 100% 之间往复变化，每帧都不同，每帧都会触发交换链重建
+		float scale = 0.75f + 0.25f * std::cos(static_cast<float>(frame) * 0.1f);
+		int width = std::max(1, static_cast<int>(static_cast<float>(_width) * scale));
+		int height = std::max(1, static_cast<int>(static_cast<float>(_height) * scale));
+		glfwSetWindowSize(_window, width, height);
+
+		auto pollStart = std::chrono::steady_clock::now();
+		glfwPollEvents();
+		_phaseProfiler.Add(FramePhaseProfiler::PollEvents, std::chrono::steady_clock::now() - pollStart);
+
+		drawFrame();
+		_phaseProfiler.EndFrame();
+
+		auto now = std::chrono::steady_clock::now();
+		_frameStats.AddCpuTime(std::chrono::duration<double, std::milli>(now - frameStart).count());
+		frameStart = now;
+	}
+
+	vkDeviceWaitIdle(_device);
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	// 最差帧耗时即 cpu_ms.max；另外单独列出交换链重建本身的耗时
+	FramePhaseProfiler::PhaseSummary recreate = _phaseProfiler.Summary(FramePhaseProfiler::Recreate);
+	_frameStats.AddField("recreates", static_cast<int64_t>(recreate.count));
+	_frameStats.AddField("recreate_p99_us", std::llround(recreate.p99 * 1000.0));
+	_frameStats.AddField("recreate_max_us", std::llround(recreate.max * 1000.0));
+	_frameStats.AddField("pending_deletions", static_cast<int64_t>(_deletionQueue.PendingCount()));
+
+	return _frameStats.ToJson("resize-storm", elapsed);
+}
+
+std::vector<std::string> TriangleFunc::benchIdle()
+{
+	double seconds = _config.benchSeconds > 0.0 ? _config.benchSeconds : 5.0;
+	bool onDemand = _onDemand;
+
+	std::vector<std::string> reports;
+	for (bool mode : { false, true }) {
+		_onDemand = mode;
+		_frameStats.Clear();
+		_frameStats.AddField("on_demand", mode ? 1 : 0);
+		_frameStats.AddField("max_fps", std::llround(_frameLimiter.TargetFps()));
+		_phaseProfiler.Reset();
+
+		uint64_t framesBefore = _framesDrawn;
+		uint64_t wakeupsBefore = _idleWakeups;
+		auto idleBefore = _idleTime;
+
+		auto begin = std::chrono::steady_clock::now();
+		auto frameStart = begin;
+		while (std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count() < seconds
+			&& !glfwWindowShouldClose(_window)) {
+			if (!pumpFrame()) {
+				frameStart = std::chrono::steady_clock::now();
+				continue;
+			}
+
+			auto now = std::chrono::steady_clock::now();
+			_frameStats.AddCpuTime(std::chrono::duration<double, std::milli>(now - frameStart).count());
+			frameStart = now;
+		}
+
+		vkDeviceWaitIdle(_device);
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+		// 空闲等待时间占比（千分比），连续渲染时接近 0，静态场景按需渲染时接近 1000
+		double idleSeconds = std::chrono::duration<double>(_idleTime - idleBefore).count();
+		_frameStats.AddField("frames_drawn", static_cast<int64_t>(_framesDrawn - framesBefore));
+		_frameStats.AddField("idle_wakeups", static_cast<int64_t>(_idleWakeups - wakeupsBefore));
+		_frameStats.AddField("idle_permille", std::llround(idleSeconds / elapsed * 1000.0));
+		reports.push_back(_frameStats.ToJson(mode ? "idle/on-demand" : "idle/continuous", elapsed));
+	}
+
+	_onDemand = onDemand;
+	return reports;
+}
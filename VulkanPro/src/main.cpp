@@ -1,11 +1,170 @@
-﻿#include <stdexcept>
+﻿#include <cstring>
+#include <stdexcept>
+#include <string>
 
 #include "TriangleFunc.h"
 
-int main()
+/**
+ * @brief 解析命令行参数。
+ *
+ * 支持的参数：
+ *   --headless               无头模式（离屏渲染 + 基准测试报告）
+ *   --width <w> --height <h> 窗口或离屏目标尺寸
+ *   --frames-in-flight <n>   同时在 GPU 上执行的帧数（1 ~ 4）
+ *   --swapchain-images <n>   期望的交换链图像数量
+ *   --frames <n>             无头模式渲染帧数
+ *   --seconds <s>            无头模式渲染时长
+ *   --report <file>          基准测试报告输出文件
+ *   --bench <name>           基准测试（vertex-memory / allocator-stress / frames-in-flight / parallel-record / instancing / gpu-driven / async-compute / pipeline-variants / command-cache / upload-batch / render-graph / texture-streaming / resize-storm / idle）
+ *   --mesh-grid <n>          场景使用 n×n 四边形网格代替默认三角形
+ *   --draws <n>              场景网格拆分为 n 次绘制
+ *   --record-threads <n>     并行录制命令的工作线程数（0 为主线程录制）
+ *   --instances <n>          以实例化方式绘制 n 份场景网格
+ *   --instance-updates <n>   每帧增量更新的实例数
+ *   --gpu-driven             实例化场景使用计算着色器剔除 + 间接绘制
+ *   --async-compute          实例运动在异步计算队列上模拟
+ *   --sim-substeps <n>       实例模拟每帧的积分子步数
+ *   --dynamic-rendering      使用动态渲染代替渲染通道与帧缓冲
+ *   --present-policy <name>  呈现策略（low-latency / power-saver / uncapped）
+ *   --present-latency <n>    支持 present_wait 时 CPU 最多领先显示的帧数
+ *   --timeline-sync          使用时间线信号量代替每帧栅栏
+ *   --shader-dir <dir>       SPIR-V 着色器目录（默认 spv）
+ *   --shader-source-dir <d>  GLSL 着色器源文件目录（默认 vertFrag）
+ *   --shader-cache-dir <d>   着色器编译结果的磁盘缓存目录（默认 spv_cache）
+ *   --shader-define <d>      编译着色器时的宏定义 NAME 或 NAME=VALUE，可重复
+ *   --compile-shaders        编译所有着色器到 SPIR-V 目录后退出
+ *   --hot-reload             修改顶点 / 片段着色器源文件后自动重新编译并替换管线
+ *   --pipeline-threads <n>   管线变体的后台编译线程数（0 为硬件线程数 - 1）
+ *   --cache-commands         场景不变时复用录制好的命令缓冲
+ *   --on-demand              按需渲染，没有输入与场景变化时不绘制
+ *   --max-fps <n>            窗口模式帧率上限（0 为不限制）
+ *   --texture-dir <dir>      纹理流送的图像目录
+ *   --texture-budget <mb>    驻留纹理的显存预算（默认 256）
+ *   --texture-upload <kb>    每帧最多上传的纹理数据量（默认 8192）
+ *   --texture-threads <n>    纹理解码线程数（0 为硬件线程数 - 1）
+ *   --render-graph           以渲染图声明每帧的通道，自动推导屏障并复用瞬态图像的显存
+ *   --blur-levels <n>        渲染图中模糊链的降采样级数（0 ~ 8，隐含 --render-graph）
+ *
+ * @throws std::runtime_error 参数未知、缺少参数值或取值超出范围时抛出。
+ */
+static AppConfig parseArgs(int argc, char **argv)
+{
+    AppConfig config;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        // 读取当前参数的值
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::runtime_error("缺少参数值: " + arg);
+            }
+            return argv[++i];
+        };
+
+        if (arg == "--headless") {
+            config.headless = true;
+        } else if (arg == "--width") {
+            config.width = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "--height") {
+            config.height = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "--frames-in-flight") {
+            config.framesInFlight = std::stoi(value());
+            if (config.framesInFlight < 1 || config.framesInFlight > AppConfig::kMaxFramesInFlight) {
+                throw std::runtime_error("--frames-in-flight 取值范围为 1 ~ " + std::to_string(AppConfig::kMaxFramesInFlight));
+            }
+        } else if (arg == "--swapchain-images") {
+            config.swapchainImages = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "--frames") {
+            config.benchFrames = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "--seconds") {
+            config.benchSeconds = std::stod(value());
+        } else if (arg == "--report") {
+            config.reportPath = value();
+        } else if (arg == "--bench") {
+            config.bench = value();
+        } else if (arg == "--mesh-grid") {
+            config.meshGrid = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "--draws") {
+            config.sceneDraws = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "--record-threads") {
+            config.recordThreads = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "--instances") {
+            config.instances = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "--instance-updates") {
+            config.instanceUpdates = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "--gpu-driven") {
+            config.gpuDriven = true;
+        } else if (arg == "--async-compute") {
+            config.asyncCompute = true;
+        } else if (arg == "--sim-substeps") {
+            config.simSubsteps = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "--dynamic-rendering") {
+            config.dynamicRendering = true;
+        } else if (arg == "--present-policy") {
+            config.presentPolicy = value();
+            PresentPacer::ParsePolicy(config.presentPolicy);    // 名称未知时抛出，无头模式同样检查
+        } else if (arg == "--present-latency") {
+            config.presentLatencyFrames = static_cast<uint32_t>(std::stoul(value()));
+            if (config.presentLatencyFrames < 1 || config.presentLatencyFrames > PresentPacer::kMaxLatencyFrames) {
+                throw std::runtime_error("--present-latency 取值范围为 1 ~ " + std::to_string(PresentPacer::kMaxLatencyFrames));
+            }
+        } else if (arg == "--timeline-sync") {
+            config.timelineSync = true;
+        } else if (arg == "--shader-dir") {
+            config.shaderDir = value();
+        } else if (arg == "--shader-source-dir") {
+            config.shaderSourceDir = value();
+        } else if (arg == "--shader-cache-dir") {
+            config.shaderCacheDir = value();
+        } else if (arg == "--shader-define") {
+            config.shaderDefines.push_back(value());
+        } else if (arg == "--compile-shaders") {
+            config.compileShaders = true;
+        } else if (arg == "--hot-reload") {
+            config.hotReload = true;
+        } else if (arg == "--pipeline-threads") {
+            config.pipelineThreads = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "--cache-commands") {
+            config.cacheCommands = true;
+        } else if (arg == "--on-demand") {
+            config.onDemand = true;
+        } else if (arg == "--max-fps") {
+            config.maxFps = std::stod(value());
+            if (config.maxFps < 0.0) {
+                throw std::runtime_error("--max-fps 不能为负数");
+            }
+        } else if (arg == "--texture-dir") {
+            config.textureDir = value();
+        } else if (arg == "--texture-budget") {
+            config.textureBudgetMB = static_cast<uint32_t>(std::stoul(value()));
+            if (config.textureBudgetMB == 0) {
+                throw std::runtime_error("--texture-budget 必须大于 0");
+            }
+        } else if (arg == "--texture-upload") {
+            config.textureUploadKB = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "--texture-threads") {
+            config.textureThreads = static_cast<uint32_t>(std::stoul(value()));
+        } else if (arg == "--render-graph") {
+            config.renderGraph = true;
+        } else if (arg == "--blur-levels") {
+            config.blurLevels = static_cast<uint32_t>(std::stoul(value()));
+            if (config.blurLevels > static_cast<uint32_t>(AppConfig::kMaxBlurLevels)) {
+                throw std::runtime_error("--blur-levels 取值范围为 0 ~ " + std::to_string(AppConfig::kMaxBlurLevels));
+            }
+            config.renderGraph = true;
+        } else {
+            throw std::runtime_error("未知参数: " + arg);
+        }
+    }
+
+    return config;
+}
+
+int main(int argc, char **argv)
 {
-    TriangleFunc app;
     try {
+        TriangleFunc app(parseArgs(argc, argv));
         app.Run();
     } catch (const std::exception &e) {
         std::cerr << e.what() << std::endl;
@@ -13,4 +172,4 @@ int main()
     }
 
     return 0;
-}
\ No newline at end of file
+}